@@ -0,0 +1,1036 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "NormalRandomVariable/NormalRandomVariable.h"
+#include "NormalRandomVariable/NormalRandomVariableArray.h"
+#include "NormalRandomVariable/Gradient.h"
+#include "NormalRandomVariable/Parallel.h"
+#include "NormalRandomVariable/LookupTable.h"
+#include "NormalRandomVariable/MemoCache.h"
+#include "NormalRandomVariable/Simd.h"
+#include "NormalRandomVariable/ExpressionGraph.h"
+#include "NormalRandomVariable/MemoryResource.h"
+#include "NormalRandomVariable/TaskNetwork.h"
+#include "NormalRandomVariable/ContentionQueue.h"
+#include "NormalRandomVariable/NormalMixture.h"
+
+/**
+ * Benchmarks of the operations on single random variables (ns/op and ops/s), and of the array operations compared
+ * side by side with a loop of the corresponding scalar operation (per element)
+ * Note: Build with CMAKE_BUILD_TYPE=Release to get meaningful results
+ */
+
+namespace {
+
+typedef NRV::NormalRandomVariable RV;
+typedef NRV::NormalRandomVariableArray Array;
+
+/**
+ * Measures operation applied to rv1 and rv2. The inputs are hidden from the optimiser on every iteration so that
+ * the operation can not be hoisted out of the loop or evaluated at compile time
+ */
+template<class Operation>
+void scalarBenchmark(benchmark::State& state, RV rv1, RV rv2, Operation operation)
+{
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(rv1);
+        benchmark::DoNotOptimize(rv2);
+        auto result = operation(rv1, rv2);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Inputs for the scalar benchmarks
+const RV standard(0, 1);
+const RV other(1, 2);
+const RV far_from_zero(10, 1);
+
+// Bounds that select each branch of truncate(RV, RV)
+const RV wide_lower(-5, 1), wide_upper(5, 1);
+const RV method_2_lower(0, 1.2), method_2_upper(1, 1);
+const RV method_3_lower(-1, 1), method_3_upper(0, 1.2);
+
+/**
+ * Random variables with means uniformly distributed in [-1, 1] and variances in [0.5, 2]
+ */
+std::vector<RV> randomVariables(std::size_t size, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> mean(-1, 1), variance(0.5, 2);
+
+    std::vector<RV> random_variables;
+    random_variables.reserve(size);
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        random_variables.push_back(RV(mean(generator), variance(generator)));
+    }
+
+    return random_variables;
+}
+
+Array toArray(const std::vector<RV>& random_variables)
+{
+    std::vector<double> means, variances;
+    for(const auto& rv : random_variables)
+    {
+        means.push_back(rv.mean());
+        variances.push_back(rv.variance());
+    }
+
+    return Array(means, variances);
+}
+
+/**
+ * Measures an array operation on arrays of state.range(0) random variables, using the instruction set
+ * state.range(1). Throughput is reported per element
+ */
+template<class Operation>
+void arrayBenchmark(benchmark::State& state, Operation operation)
+{
+    auto instruction_set = static_cast<NRV::InstructionSet>(state.range(1));
+    if(!NRV::instructionSetSupported(instruction_set))
+    {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+
+    NRV::InstructionSet previous = NRV::activeInstructionSet();
+    NRV::setInstructionSet(instruction_set);
+
+    std::size_t size = static_cast<std::size_t>(state.range(0));
+    Array rv1 = toArray(randomVariables(size, 1));
+    Array rv2 = toArray(randomVariables(size, 2));
+    for(auto _ : state)
+    {
+        auto result = operation(rv1, rv2);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    NRV::setInstructionSet(previous);
+}
+
+/**
+ * Measures a loop of the scalar operation over state.range(0) random variables, for comparison with arrayBenchmark
+ */
+template<class Operation>
+void loopBenchmark(benchmark::State& state, Operation operation)
+{
+    std::size_t size = static_cast<std::size_t>(state.range(0));
+    std::vector<RV> rv1 = randomVariables(size, 1);
+    std::vector<RV> rv2 = randomVariables(size, 2);
+    std::vector<RV> result(size);
+    for(auto _ : state)
+    {
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            result[i] = operation(rv1[i], rv2[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Array sizes, and the instruction sets to compare (see NRV::InstructionSet)
+ */
+void arrayArguments(benchmark::internal::Benchmark* benchmark)
+{
+    for(int64_t size : {1024, 65536})
+    {
+        for(int64_t instruction_set = 0; instruction_set < 4; ++instruction_set)
+        {
+            benchmark->Args({size, instruction_set});
+        }
+    }
+    benchmark->ArgNames({"size", "isa"});
+}
+
+/**
+ * Array sizes for operations that do not depend on the instruction set
+ */
+void elementWiseArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->Args({1024, 0})->Args({65536, 0})->ArgNames({"size", "isa"});
+}
+
+void loopArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->Arg(1024)->Arg(65536)->ArgName("size");
+}
+
+} // namespace
+
+/**
+ * Construction and the operations defined in the header
+ */
+static void Scalar_Construct(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return RV(rv1.mean(), rv1.variance()); });
+}
+BENCHMARK(Scalar_Construct);
+
+static void Scalar_TryCreate(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return RV::tryCreate(rv1.mean(), rv1.variance()); });
+}
+BENCHMARK(Scalar_TryCreate);
+
+static void Scalar_Add(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1 + rv2; });
+}
+BENCHMARK(Scalar_Add);
+
+static void Scalar_AddConstant(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1 + rv2.mean(); });
+}
+BENCHMARK(Scalar_AddConstant);
+
+static void Scalar_Subtract(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1 - rv2; });
+}
+BENCHMARK(Scalar_Subtract);
+
+static void Scalar_SubtractConstant(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv2.mean() - rv1; });
+}
+BENCHMARK(Scalar_SubtractConstant);
+
+static void Scalar_Negate(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return -rv1; });
+}
+BENCHMARK(Scalar_Negate);
+
+static void Scalar_MultiplyConstant(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1 * rv2.mean(); });
+}
+BENCHMARK(Scalar_MultiplyConstant);
+
+static void Scalar_DivideConstant(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1 / rv2.mean(); });
+}
+BENCHMARK(Scalar_DivideConstant);
+
+/**
+ * Multiplication, inverse and division
+ */
+static void Scalar_Multiply(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1 * rv2; });
+}
+BENCHMARK(Scalar_Multiply);
+
+static void Scalar_Inverse(benchmark::State& state)
+{
+    scalarBenchmark(state, far_from_zero, other, [](RV rv1, RV) { return rv1.inverse(); });
+}
+BENCHMARK(Scalar_Inverse);
+
+static void Scalar_DivideConstantByRV(benchmark::State& state)
+{
+    scalarBenchmark(state, far_from_zero, other, [](RV rv1, RV rv2) { return rv2.mean() / rv1; });
+}
+BENCHMARK(Scalar_DivideConstantByRV);
+
+// The ratio approximation is valid when the numerator is close to 0 and the denominator is far from 0
+static void Scalar_DivideRatio(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, far_from_zero, [](RV rv1, RV rv2) { return rv1 / rv2; });
+}
+BENCHMARK(Scalar_DivideRatio);
+
+// Otherwise the numerator is multiplied by the inverse of the denominator
+static void Scalar_DivideByInverse(benchmark::State& state)
+{
+    scalarBenchmark(state, far_from_zero, far_from_zero, [](RV rv1, RV rv2) { return rv1 / rv2; });
+}
+BENCHMARK(Scalar_DivideByInverse);
+
+static void Scalar_TryDivide(benchmark::State& state)
+{
+    scalarBenchmark(state, far_from_zero, far_from_zero, [](RV rv1, RV rv2) { return NRV::tryDivide(rv1, rv2); });
+}
+BENCHMARK(Scalar_TryDivide);
+
+/**
+ * Rectification and truncation by constants
+ */
+static void Scalar_Rectify(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.rectify(-1, 1); });
+}
+BENCHMARK(Scalar_Rectify);
+
+static void Scalar_RectifyLower(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.rectifyLower(-1); });
+}
+BENCHMARK(Scalar_RectifyLower);
+
+static void Scalar_RectifyUpper(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.rectifyUpper(1); });
+}
+BENCHMARK(Scalar_RectifyUpper);
+
+static void Scalar_Truncate(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.truncate(-1, 1); });
+}
+BENCHMARK(Scalar_Truncate);
+
+static void Scalar_TruncateLower(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.truncateLower(-1); });
+}
+BENCHMARK(Scalar_TruncateLower);
+
+static void Scalar_TruncateUpper(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.truncateUpper(1); });
+}
+BENCHMARK(Scalar_TruncateUpper);
+
+static void Scalar_TryTruncate(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.tryTruncate(-1, 1); });
+}
+BENCHMARK(Scalar_TryTruncate);
+
+static void Scalar_TruncateWithMass(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.truncateWithMass(-1, 1); });
+}
+BENCHMARK(Scalar_TruncateWithMass);
+
+/**
+ * Truncation by random variables, including each branch of truncate(RV, RV)
+ */
+static void Scalar_TruncateByRV_Gamma(benchmark::State& state)
+{
+    scalarBenchmark(state, wide_lower, wide_upper, [](RV lower, RV upper) { return standard.truncate(lower, upper); });
+}
+BENCHMARK(Scalar_TruncateByRV_Gamma);
+
+static void Scalar_TruncateByRV_Method2(benchmark::State& state)
+{
+    scalarBenchmark(state, method_2_lower, method_2_upper, [](RV lower, RV upper) { return standard.truncate(lower, upper); });
+}
+BENCHMARK(Scalar_TruncateByRV_Method2);
+
+static void Scalar_TruncateByRV_Method3(benchmark::State& state)
+{
+    scalarBenchmark(state, method_3_lower, method_3_upper, [](RV lower, RV upper) { return standard.truncate(lower, upper); });
+}
+BENCHMARK(Scalar_TruncateByRV_Method3);
+
+static void Scalar_TruncateByRVWithMass(benchmark::State& state)
+{
+    scalarBenchmark(state, wide_lower, wide_upper, [](RV lower, RV upper) { return standard.truncateWithMass(lower, upper); });
+}
+BENCHMARK(Scalar_TruncateByRVWithMass);
+
+static void Scalar_TruncateLowerByRV(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1.truncateLower(rv2); });
+}
+BENCHMARK(Scalar_TruncateLowerByRV);
+
+static void Scalar_TruncateUpperByRV(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1.truncateUpper(rv2); });
+}
+BENCHMARK(Scalar_TruncateUpperByRV);
+
+/**
+ * Operations with their partial derivatives, to compare with the operations above
+ */
+static void Gradient_Max(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return NRV::maxWithGradient(rv1, rv2); });
+}
+BENCHMARK(Gradient_Max);
+
+static void Gradient_Rectify(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return NRV::rectifyWithGradient(rv1, -1, 1); });
+}
+BENCHMARK(Gradient_Rectify);
+
+static void Gradient_Truncate(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return NRV::truncateWithGradient(rv1, -1, 1); });
+}
+BENCHMARK(Gradient_Truncate);
+
+static void Gradient_TruncateByRV_Method2(benchmark::State& state)
+{
+    scalarBenchmark(state, method_2_lower, method_2_upper, [](RV lower, RV upper) { return NRV::truncateWithGradient(standard, lower, upper); });
+}
+BENCHMARK(Gradient_TruncateByRV_Method2);
+
+/**
+ * Truncation and rectification using the lookup table with the error state.range(0) (as a negative power of 10)
+ */
+template<class Operation>
+void lookupTableBenchmark(benchmark::State& state, RV rv1, RV rv2, Operation operation)
+{
+    state.counters["max_error"] = NRV::enableLookupTable(std::pow(10.0, -static_cast<double>(state.range(0))));
+    scalarBenchmark(state, rv1, rv2, operation);
+    NRV::disableLookupTable();
+}
+
+static void Scalar_Rectify_LookupTable(benchmark::State& state)
+{
+    lookupTableBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.rectify(-1, 1); });
+}
+BENCHMARK(Scalar_Rectify_LookupTable)->Arg(6)->Arg(12)->ArgName("digits");
+
+static void Scalar_Truncate_LookupTable(benchmark::State& state)
+{
+    lookupTableBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.truncate(-1, 1); });
+}
+BENCHMARK(Scalar_Truncate_LookupTable)->Arg(6)->Arg(12)->ArgName("digits");
+
+static void Scalar_TruncateLower_LookupTable(benchmark::State& state)
+{
+    lookupTableBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.truncateLower(-1); });
+}
+BENCHMARK(Scalar_TruncateLower_LookupTable)->Arg(6)->Arg(12)->ArgName("digits");
+
+static void Scalar_TruncateByRV_Gamma_LookupTable(benchmark::State& state)
+{
+    lookupTableBenchmark(state, wide_lower, wide_upper, [](RV lower, RV upper) { return standard.truncate(lower, upper); });
+}
+BENCHMARK(Scalar_TruncateByRV_Gamma_LookupTable)->Arg(6)->Arg(12)->ArgName("digits");
+
+/**
+ * Repeated operations with the memo cache enabled (i.e., every lookup after the first is a hit)
+ */
+template<class Operation>
+void memoCacheBenchmark(benchmark::State& state, RV rv1, RV rv2, Operation operation)
+{
+    NRV::enableMemoCache();
+    scalarBenchmark(state, rv1, rv2, operation);
+    NRV::MemoCacheStatistics statistics = NRV::memoCacheStatistics();
+    state.counters["hit_rate"] = static_cast<double>(statistics.hits) / static_cast<double>(statistics.hits + statistics.misses);
+    NRV::disableMemoCache();
+}
+
+static void Scalar_TruncateUpperByRV_MemoCache(benchmark::State& state)
+{
+    memoCacheBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1.truncateUpper(rv2); });
+}
+BENCHMARK(Scalar_TruncateUpperByRV_MemoCache);
+
+static void Scalar_Max_MemoCache(benchmark::State& state)
+{
+    memoCacheBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1.max(rv2); });
+}
+BENCHMARK(Scalar_Max_MemoCache);
+
+/**
+ * Operations with each accuracy (state.range(0) is the value of NRV::Accuracy), applied to size different inputs in
+ * turn. The counters are the largest errors over the inputs compared to Accuracy::Exact in long double precision, in
+ * the mean (relative to the standard deviation) and the variance (relative to the variance)
+ */
+typedef NRV::BasicNormalRandomVariable<long double> LongRV;
+
+const std::size_t accuracy_inputs = 256;
+
+LongRV toLong(RV random_variable)
+{
+    return LongRV(random_variable.mean(), random_variable.variance());
+}
+
+std::vector<double> uniform(double lower, double upper, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(lower, upper);
+
+    std::vector<double> values(accuracy_inputs);
+    for(double& value : values)
+    {
+        value = distribution(generator);
+    }
+
+    return values;
+}
+
+template<class Operation, class Reference>
+void accuracyBenchmark(benchmark::State& state, Operation operation, Reference reference)
+{
+    auto accuracy = static_cast<NRV::Accuracy>(state.range(0));
+
+    double mean_error = 0;
+    double variance_error = 0;
+    for(std::size_t i = 0; i < accuracy_inputs; ++i)
+    {
+        RV result = operation(i, accuracy);
+        LongRV expected = reference(i);
+        mean_error = std::max(mean_error, static_cast<double>(std::abs(result.mean() - expected.mean()) / std::sqrt(expected.variance())));
+        variance_error = std::max(variance_error, static_cast<double>(std::abs(result.variance() / expected.variance() - 1)));
+    }
+
+    std::size_t i = 0;
+    for(auto _ : state)
+    {
+        RV result = operation(i, accuracy);
+        benchmark::DoNotOptimize(result);
+        i = i + 1 < accuracy_inputs ? i + 1 : 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["mean_error"] = mean_error;
+    state.counters["variance_error"] = variance_error;
+}
+
+void accuracyArguments(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->Arg(static_cast<int64_t>(NRV::Accuracy::Exact))->Arg(static_cast<int64_t>(NRV::Accuracy::Default))
+            ->Arg(static_cast<int64_t>(NRV::Accuracy::Fast))->ArgName("accuracy");
+}
+
+static void Accuracy_Truncate(benchmark::State& state)
+{
+    std::vector<RV> rv = randomVariables(accuracy_inputs, 1);
+    std::vector<double> lower = uniform(-3, 2, 2), width = uniform(0.2, 3, 3);
+    accuracyBenchmark(state, [&](std::size_t i, NRV::Accuracy accuracy) {
+        return rv[i].truncate(lower[i], lower[i] + width[i], accuracy);
+    }, [&](std::size_t i) {
+        return toLong(rv[i]).truncate(lower[i], lower[i] + width[i], NRV::Accuracy::Exact);
+    });
+}
+BENCHMARK(Accuracy_Truncate)->Apply(accuracyArguments);
+
+static void Accuracy_Rectify(benchmark::State& state)
+{
+    std::vector<RV> rv = randomVariables(accuracy_inputs, 1);
+    std::vector<double> lower = uniform(-3, 2, 2), width = uniform(0.2, 3, 3);
+    accuracyBenchmark(state, [&](std::size_t i, NRV::Accuracy accuracy) {
+        return rv[i].rectify(lower[i], lower[i] + width[i], accuracy);
+    }, [&](std::size_t i) {
+        return toLong(rv[i]).rectify(lower[i], lower[i] + width[i], NRV::Accuracy::Exact);
+    });
+}
+BENCHMARK(Accuracy_Rectify)->Apply(accuracyArguments);
+
+static void Accuracy_TruncateByRV(benchmark::State& state)
+{
+    std::vector<RV> rv = randomVariables(accuracy_inputs, 1);
+    std::vector<double> lower_mean = uniform(-3, 0, 2), lower_variance = uniform(0.1, 2, 3);
+    std::vector<double> upper_mean = uniform(0, 3, 4), upper_variance = uniform(0.1, 2, 5);
+    accuracyBenchmark(state, [&](std::size_t i, NRV::Accuracy accuracy) {
+        return rv[i].truncate(RV(lower_mean[i], lower_variance[i]), RV(upper_mean[i], upper_variance[i]), accuracy);
+    }, [&](std::size_t i) {
+        return toLong(rv[i]).truncate(LongRV(lower_mean[i], lower_variance[i]), LongRV(upper_mean[i], upper_variance[i]),
+                NRV::Accuracy::Exact);
+    });
+}
+BENCHMARK(Accuracy_TruncateByRV)->Apply(accuracyArguments);
+
+static void Accuracy_Max(benchmark::State& state)
+{
+    std::vector<RV> rv1 = randomVariables(accuracy_inputs, 1);
+    std::vector<RV> rv2 = randomVariables(accuracy_inputs, 2);
+    accuracyBenchmark(state, [&](std::size_t i, NRV::Accuracy accuracy) {
+        return rv1[i].max(rv2[i], accuracy);
+    }, [&](std::size_t i) {
+        return toLong(rv1[i]).max(toLong(rv2[i]), NRV::Accuracy::Exact);
+    });
+}
+BENCHMARK(Accuracy_Max)->Apply(accuracyArguments);
+
+/**
+ * Inverse and division by random variables whose means are 5 to 20 standard deviations from 0
+ */
+static void Accuracy_Inverse(benchmark::State& state)
+{
+    std::vector<double> mean = uniform(5, 20, 2);
+    accuracyBenchmark(state, [&](std::size_t i, NRV::Accuracy accuracy) {
+        return RV(mean[i], 1).inverse(accuracy);
+    }, [&](std::size_t i) {
+        return LongRV(mean[i], 1).inverse(NRV::Accuracy::Exact);
+    });
+}
+BENCHMARK(Accuracy_Inverse)->Apply(accuracyArguments);
+
+static void Accuracy_Divide(benchmark::State& state)
+{
+    std::vector<RV> rv = randomVariables(accuracy_inputs, 1);
+    std::vector<double> mean = uniform(5, 20, 2);
+    accuracyBenchmark(state, [&](std::size_t i, NRV::Accuracy accuracy) {
+        return NRV::divide(rv[i], RV(mean[i], 1), accuracy);
+    }, [&](std::size_t i) {
+        return NRV::divide(toLong(rv[i]), LongRV(mean[i], 1), NRV::Accuracy::Exact);
+    });
+}
+BENCHMARK(Accuracy_Divide)->Apply(accuracyArguments);
+
+/**
+ * Maximum and minimum
+ */
+static void Scalar_Max(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1.max(rv2); });
+}
+BENCHMARK(Scalar_Max);
+
+static void Scalar_Min(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1.min(rv2); });
+}
+BENCHMARK(Scalar_Min);
+
+static void Scalar_MaxOfMany(benchmark::State& state)
+{
+    std::vector<RV> random_variables = randomVariables(static_cast<std::size_t>(state.range(0)), 1);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(NRV::max(random_variables));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Scalar_MaxOfMany)->Arg(16)->Arg(1024)->Arg(65536)->ArgName("size");
+
+/**
+ * Probability queries
+ */
+static void Scalar_Cdf(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1.cdf(rv2.mean()); });
+}
+BENCHMARK(Scalar_Cdf);
+
+static void Scalar_Quantile(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV) { return rv1.quantile(0.95); });
+}
+BENCHMARK(Scalar_Quantile);
+
+static void Scalar_ProbabilityLessThan(benchmark::State& state)
+{
+    scalarBenchmark(state, standard, other, [](RV rv1, RV rv2) { return rv1.probabilityLessThan(rv2); });
+}
+BENCHMARK(Scalar_ProbabilityLessThan);
+
+/**
+ * Array operations and the corresponding loops of scalar operations
+ */
+static void Array_Add(benchmark::State& state)
+{
+    arrayBenchmark(state, [](const Array& rv1, const Array& rv2) { return rv1 + rv2; });
+}
+BENCHMARK(Array_Add)->Apply(elementWiseArguments);
+
+static void Loop_Add(benchmark::State& state)
+{
+    loopBenchmark(state, [](RV rv1, RV rv2) { return rv1 + rv2; });
+}
+BENCHMARK(Loop_Add)->Apply(loopArguments);
+
+static void Array_Multiply(benchmark::State& state)
+{
+    arrayBenchmark(state, [](const Array& rv1, const Array& rv2) { return rv1 * rv2; });
+}
+BENCHMARK(Array_Multiply)->Apply(elementWiseArguments);
+
+static void Loop_Multiply(benchmark::State& state)
+{
+    loopBenchmark(state, [](RV rv1, RV rv2) { return rv1 * rv2; });
+}
+BENCHMARK(Loop_Multiply)->Apply(loopArguments);
+
+static void Array_Rectify(benchmark::State& state)
+{
+    arrayBenchmark(state, [](const Array& rv1, const Array&) { return rv1.rectify(-1, 1); });
+}
+BENCHMARK(Array_Rectify)->Apply(arrayArguments);
+
+static void Loop_Rectify(benchmark::State& state)
+{
+    loopBenchmark(state, [](RV rv1, RV) { return rv1.rectify(-1, 1); });
+}
+BENCHMARK(Loop_Rectify)->Apply(loopArguments);
+
+static void Array_Truncate(benchmark::State& state)
+{
+    arrayBenchmark(state, [](const Array& rv1, const Array&) { return rv1.truncate(-1, 1); });
+}
+BENCHMARK(Array_Truncate)->Apply(arrayArguments);
+
+static void Loop_Truncate(benchmark::State& state)
+{
+    loopBenchmark(state, [](RV rv1, RV) { return rv1.truncate(-1, 1); });
+}
+BENCHMARK(Loop_Truncate)->Apply(loopArguments);
+
+static void Array_TruncateLower(benchmark::State& state)
+{
+    arrayBenchmark(state, [](const Array& rv1, const Array&) { return rv1.truncateLower(-1); });
+}
+BENCHMARK(Array_TruncateLower)->Apply(arrayArguments);
+
+static void Loop_TruncateLower(benchmark::State& state)
+{
+    loopBenchmark(state, [](RV rv1, RV) { return rv1.truncateLower(-1); });
+}
+BENCHMARK(Loop_TruncateLower)->Apply(loopArguments);
+
+static void Array_Max(benchmark::State& state)
+{
+    arrayBenchmark(state, [](const Array& rv1, const Array& rv2) { return rv1.max(rv2); });
+}
+BENCHMARK(Array_Max)->Apply(arrayArguments);
+
+static void Loop_Max(benchmark::State& state)
+{
+    loopBenchmark(state, [](RV rv1, RV rv2) { return rv1.max(rv2); });
+}
+BENCHMARK(Loop_Max)->Apply(loopArguments);
+
+static void Array_TruncateByRV(benchmark::State& state)
+{
+    arrayBenchmark(state, [](const Array& rv1, const Array& rv2) { return rv1.truncate(rv2 - 2, rv2 + 2); });
+}
+BENCHMARK(Array_TruncateByRV)->Apply(arrayArguments);
+
+static void Loop_TruncateByRV(benchmark::State& state)
+{
+    loopBenchmark(state, [](RV rv1, RV rv2) { return rv1.truncate(rv2 - 2, rv2 + 2); });
+}
+BENCHMARK(Loop_TruncateByRV)->Apply(loopArguments);
+
+static void Array_Cdf(benchmark::State& state)
+{
+    arrayBenchmark(state, [](const Array& rv1, const Array&) { return rv1.cdf(0.5); });
+}
+BENCHMARK(Array_Cdf)->Apply(arrayArguments);
+
+static void Array_ProbabilityLessThan(benchmark::State& state)
+{
+    arrayBenchmark(state, [](const Array& rv1, const Array& rv2) { return rv1.probabilityLessThan(rv2); });
+}
+BENCHMARK(Array_ProbabilityLessThan)->Apply(arrayArguments);
+
+/**
+ * Probability that each of state.range(0) random variables is less than each of state.range(0) others, using the
+ * instruction set state.range(1). Throughput is reported per pair, and as the bytes of the matrix that are written
+ */
+static void Pairwise_ProbabilityLessThan(benchmark::State& state)
+{
+    auto instruction_set = static_cast<NRV::InstructionSet>(state.range(1));
+    if(!NRV::instructionSetSupported(instruction_set))
+    {
+        state.SkipWithError("Instruction set not supported");
+        return;
+    }
+
+    NRV::InstructionSet previous = NRV::activeInstructionSet();
+    NRV::setInstructionSet(instruction_set);
+
+    std::size_t size = static_cast<std::size_t>(state.range(0));
+    Array rv1 = toArray(randomVariables(size, 1));
+    Array rv2 = toArray(randomVariables(size, 2));
+    std::vector<double> result(size * size);
+    for(auto _ : state)
+    {
+        NRV::pairwiseProbabilityLessThan(rv1, rv2, result.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+    state.SetBytesProcessed(state.iterations() * state.range(0) * state.range(0) * static_cast<std::int64_t>(sizeof(double)));
+
+    NRV::setInstructionSet(previous);
+}
+BENCHMARK(Pairwise_ProbabilityLessThan)->ArgsProduct({{256, 4096}, {0, 1, 2, 3}})->ArgNames({"size", "isa"});
+
+/**
+ * Multi-threaded array operations on 2^20 random variables, using state.range(0) threads (0 for one per hardware
+ * thread), for comparison with the corresponding single-threaded array operation
+ */
+template<class Operation>
+void parallelBenchmark(benchmark::State& state, Operation operation)
+{
+    std::size_t size = 1 << 20;
+    Array rv1 = toArray(randomVariables(size, 1));
+    Array rv2 = toArray(randomVariables(size, 2));
+    NRV::parallel::setThreads(static_cast<unsigned int>(state.range(0)));
+    for(auto _ : state)
+    {
+        auto result = operation(rv1, rv2);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(size));
+    NRV::parallel::setThreads(0);
+}
+
+static void Parallel_Max(benchmark::State& state)
+{
+    parallelBenchmark(state, [](const Array& rv1, const Array& rv2) { return NRV::parallel::max(rv1, rv2); });
+}
+BENCHMARK(Parallel_Max)->Arg(1)->Arg(0)->ArgName("threads")->UseRealTime();
+
+static void Parallel_Truncate(benchmark::State& state)
+{
+    parallelBenchmark(state, [](const Array& rv1, const Array&) { return NRV::parallel::truncate(rv1, -0.5, 0.5); });
+}
+BENCHMARK(Parallel_Truncate)->Arg(1)->Arg(0)->ArgName("threads")->UseRealTime();
+
+static void Parallel_Divide(benchmark::State& state)
+{
+    parallelBenchmark(state, [](const Array& rv1, const Array& rv2) { return NRV::parallel::divide(rv1, rv2 + 10.0); });
+}
+BENCHMARK(Parallel_Divide)->Arg(1)->Arg(0)->ArgName("threads")->UseRealTime();
+
+static void Parallel_PairwiseProbabilityLessThan(benchmark::State& state)
+{
+    std::size_t size = 4096;
+    Array rv1 = toArray(randomVariables(size, 1));
+    Array rv2 = toArray(randomVariables(size, 2));
+    std::vector<double> result(size * size);
+    NRV::parallel::setThreads(static_cast<unsigned int>(state.range(0)));
+    for(auto _ : state)
+    {
+        NRV::parallel::pairwiseProbabilityLessThan(rv1, rv2, result.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(size * size));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(size * size * sizeof(double)));
+    NRV::parallel::setThreads(0);
+}
+BENCHMARK(Parallel_PairwiseProbabilityLessThan)->Arg(1)->Arg(0)->ArgName("threads")->UseRealTime();
+
+/**
+ * Evaluation of a task network of layers of 10000 tasks, which each depend on 3 random tasks of the previous layer.
+ * The levels are built before the first iteration, so only the calculation of the completion times is measured
+ */
+static void Network_Evaluate(benchmark::State& state)
+{
+    const std::size_t size = static_cast<std::size_t>(state.range(0)), width = 10000;
+    NRV::TaskNetwork network(static_cast<unsigned int>(state.range(1)));
+    network.reserve(size, 3 * size);
+
+    std::vector<RV> durations = randomVariables(size, 1);
+    std::mt19937 generator(3);
+    for(std::size_t task = 0; task < size; ++task)
+    {
+        network.addTask(durations[task] + 5.0);
+        for(int i = 0; task >= width && i < 3; ++i)
+        {
+            network.addDependency(task - width - task % width + generator() % width, task);
+        }
+    }
+    network.evaluate();
+
+    for(auto _ : state)
+    {
+        network.evaluate();
+        benchmark::DoNotOptimize(network.tryCompletion(size - 1));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Network_Evaluate)->ArgsProduct({{100000, 1000000}, {1, 0}})->ArgNames({"size", "threads"})
+        ->Unit(benchmark::kMillisecond);
+
+/**
+ * Evaluation of a station shared by robots that arrive about once per service time
+ */
+static void Queue_Evaluate(benchmark::State& state)
+{
+    const std::size_t size = static_cast<std::size_t>(state.range(0));
+    NRV::ContentionQueue queue(static_cast<std::size_t>(state.range(1)));
+    queue.reserve(size);
+
+    std::vector<RV> arrivals = randomVariables(size, 1);
+    for(std::size_t robot = 0; robot < size; ++robot)
+    {
+        queue.addRobot(arrivals[robot] + static_cast<double>(robot), RV(1, 0.1));
+    }
+
+    for(auto _ : state)
+    {
+        queue.evaluate();
+        benchmark::DoNotOptimize(queue.tryWait(size - 1));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Queue_Evaluate)->ArgsProduct({{100, 1000}, {1, 4}})->ArgNames({"robots", "servers"})
+        ->Unit(benchmark::kMicrosecond);
+
+/**
+ * Storage for each planning cycle of the cycle benchmarks: a new object with the default resource (0), a new object
+ * with an arena that is reset after each cycle (1), or the same object cleared after each cycle (2)
+ */
+enum CycleStorage {
+    NewObject,
+    NewObjectInArena,
+    ClearObject
+};
+
+/**
+ * Records and evaluates a graph of chains of max, truncation and sums over the inputs in each cycle, so that the
+ * time includes building the graph
+ */
+static void Graph_Cycle(benchmark::State& state)
+{
+    const std::size_t size = static_cast<std::size_t>(state.range(0));
+    const CycleStorage storage = static_cast<CycleStorage>(state.range(1));
+    std::vector<RV> inputs = randomVariables(size, 1);
+
+    auto cycle = [&](NRV::ExpressionGraph& graph) {
+        auto result = graph.input(inputs[0]);
+        for(std::size_t i = 1; i < size; ++i)
+        {
+            auto x = graph.input(inputs[i]);
+            result = (result.max(x) + x * 0.5).truncateLower(-10.0);
+        }
+        benchmark::DoNotOptimize(graph.tryEvaluate(result));
+    };
+
+    NRV::Arena arena;
+    NRV::ExpressionGraph cleared;
+    for(auto _ : state)
+    {
+        if(storage == NewObject)
+        {
+            NRV::ExpressionGraph graph;
+            cycle(graph);
+        }
+        else if(storage == NewObjectInArena)
+        {
+            {
+                NRV::ExpressionGraph graph(&arena);
+                cycle(graph);
+            }
+            arena.reset();
+        }
+        else
+        {
+            cleared.clear();
+            cycle(cleared);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Graph_Cycle)->ArgsProduct({{100, 10000}, {NewObject, NewObjectInArena, ClearObject}})
+        ->ArgNames({"inputs", "storage"})->Unit(benchmark::kMicrosecond);
+
+/**
+ * Builds and evaluates a task network of layers of 100 tasks in each cycle, where each task depends on 3 tasks of
+ * the previous layer
+ */
+static void Network_Cycle(benchmark::State& state)
+{
+    const std::size_t size = static_cast<std::size_t>(state.range(0)), width = 100;
+    const CycleStorage storage = static_cast<CycleStorage>(state.range(1));
+    std::vector<RV> durations = randomVariables(size, 1);
+
+    auto cycle = [&](NRV::TaskNetwork& network) {
+        for(std::size_t task = 0; task < size; ++task)
+        {
+            network.addTask(durations[task] + 5.0);
+            for(std::size_t i = 0; task >= width && i < 3; ++i)
+            {
+                network.addDependency(task - width - task % width + (task * 7 + i * 31) % width, task);
+            }
+        }
+        network.evaluate();
+        benchmark::DoNotOptimize(network.tryCompletion(size - 1));
+    };
+
+    NRV::Arena arena;
+    NRV::TaskNetwork cleared(1);
+    for(auto _ : state)
+    {
+        if(storage == NewObject)
+        {
+            NRV::TaskNetwork network(1);
+            cycle(network);
+        }
+        else if(storage == NewObjectInArena)
+        {
+            {
+                NRV::TaskNetwork network(1, &arena);
+                cycle(network);
+            }
+            arena.reset();
+        }
+        else
+        {
+            cleared.clear();
+            cycle(cleared);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(Network_Cycle)->ArgsProduct({{1000, 100000}, {NewObject, NewObjectInArena, ClearObject}})
+        ->ArgNames({"tasks", "storage"})->Unit(benchmark::kMicrosecond);
+
+/**
+ * Operations on full mixtures of 8 components, including merging the results back to 8 components
+ */
+static void Mixture_Max(benchmark::State& state)
+{
+    NRV::NormalMixture mixture = standard;
+    for(int i = 0; i < 3; ++i)
+    {
+        mixture = mixture.max(RV(i, 1)) + 1.0;
+    }
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(mixture);
+        auto result = mixture.max(other);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Mixture_Max);
+
+static void Mixture_MaxOfMixtures(benchmark::State& state)
+{
+    NRV::NormalMixture mixture = standard;
+    for(int i = 0; i < 3; ++i)
+    {
+        mixture = mixture.max(RV(i, 1)) + 1.0;
+    }
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(mixture);
+        auto result = mixture.max(mixture - 1.0);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Mixture_MaxOfMixtures);
+
+static void Mixture_Rectify(benchmark::State& state)
+{
+    NRV::NormalMixture mixture = standard;
+    for(int i = 0; i < 3; ++i)
+    {
+        mixture = mixture.max(RV(i, 1)) + 1.0;
+    }
+
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(mixture);
+        auto result = mixture.rectify(2, 5);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Mixture_Rectify);
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MemoryResource.h"
+#include "NormalRandomVariable.h"
+
+namespace NRV {
+
+namespace detail {
+template<class T>
+struct Moments;
+} // namespace detail
+
+/**
+ * Class that evaluates the contention of many robots for a shared station (e.g., a replenishment point) with a number
+ * of servers, each of which serves one robot at a time, as in Palmer et al. (2018). Each robot has a normally
+ * distributed arrival time and service time, and the distributions of the start and departure times of each robot
+ * are propagated analytically through the station
+ * - Robots are served first come first served. They are considered in the order of their mean arrival times (ties in
+ *   the order they were added), and each robot either arrives after the robot in front of it or overtakes it, with
+ *   the probability that its arrival time is less. In each case the arrival times of the 2 robots are conditioned on
+ *   their order (see truncateLower and truncateUpper), and the times of both robots and the servers are mixtures of
+ *   the 2 cases. A robot overtaking more than one other robot is not modelled
+ * - A robot starts at the maximum of its arrival time and the time the first server becomes free, which is the minimum
+ *   of the departure times of the robots at the servers, conditioned on whether it arrives before or after that time.
+ *   The robot is then assumed to have taken the server with the earliest mean departure time
+ * - The probability that a robot waits, and its wait given that it waits, are calculated together by truncating the
+ *   difference between the time the server becomes free and its arrival time at 0 (see truncateLowerWithMass)
+ * - All of the storage is allocated from a MemoryResource, and clear keeps it, so evaluating a station of the same
+ *   size again does not allocate
+ * Note: Start and departure times are approximated as independent, as with the other operations of
+ * BasicNormalRandomVariable
+ */
+template<class T>
+class BasicContentionQueue {
+public:
+    typedef T value_type;
+
+    /**
+     * Constructor for a station with the specified number of servers
+     * Note: Will throw an exception if servers is 0
+     */
+    explicit BasicContentionQueue(std::size_t servers = 1);
+
+    /**
+     * Constructor for a station that allocates its storage from resource, which must outlive the station
+     * Note: Will throw an exception if servers is 0
+     */
+    BasicContentionQueue(std::size_t servers, MemoryResource* resource);
+
+    /**
+     * Copies use the default resource (see Allocator). These are compiled into the library, since the storage uses
+     * types that are only defined there
+     */
+    BasicContentionQueue(const BasicContentionQueue& queue);
+    BasicContentionQueue(BasicContentionQueue&& queue) noexcept;
+    ~BasicContentionQueue();
+    BasicContentionQueue& operator=(const BasicContentionQueue& queue);
+    BasicContentionQueue& operator=(BasicContentionQueue&& queue);
+
+    /**
+     * Reserves storage for the specified number of robots
+     */
+    void reserve(std::size_t robots);
+
+    /**
+     * Removes all of the robots, keeping the allocated storage
+     */
+    void clear();
+
+    /**
+     * Adds a robot with the specified arrival and service times, and returns its index
+     * Note: Will throw an exception if the station already has the maximum number of robots (2^32 - 1)
+     */
+    std::size_t addRobot(const BasicNormalRandomVariable<T>& arrival, const BasicNormalRandomVariable<T>& service);
+
+    /**
+     * Get or change the arrival and service times of a robot
+     */
+    BasicNormalRandomVariable<T> arrival(std::size_t robot) const;
+    BasicNormalRandomVariable<T> service(std::size_t robot) const;
+    void setArrival(std::size_t robot, const BasicNormalRandomVariable<T>& arrival);
+    void setService(std::size_t robot, const BasicNormalRandomVariable<T>& service);
+
+    /**
+     * Calculates the start and departure times of all of the robots
+     */
+    void evaluate();
+
+    /**
+     * Get the index of the robot that is served at the specified position in the queue
+     * Note: Will throw an exception if the station has changed since it was evaluated
+     */
+    std::size_t served(std::size_t position) const;
+
+    /**
+     * Get the time a robot starts being served, and the time it departs, calculated by the last evaluation
+     * Note: Will throw an exception if the station has changed since it was evaluated
+     */
+    BasicNormalRandomVariable<T> start(std::size_t robot) const;
+    BasicNormalRandomVariable<T> departure(std::size_t robot) const;
+
+    /**
+     * Get the probability that a robot waits for a server, and the mean of its wait (including the robots that do not
+     * wait)
+     * Note: Will throw an exception if the station has changed since it was evaluated
+     */
+    T waitProbability(std::size_t robot) const;
+    T expectedWait(std::size_t robot) const;
+
+    /**
+     * Get the wait of a robot given that it waits
+     * Note: Will throw an exception if the station has changed since it was evaluated, or the wait does not have a
+     * valid variance (e.g., a server is free when it arrives)
+     */
+    BasicNormalRandomVariable<T> wait(std::size_t robot) const;
+
+    /**
+     * Version of wait that returns a status instead of throwing an exception (OutOfRange if robot is not a robot at
+     * the station, NotEvaluated if the station has changed since it was evaluated, or InvalidVariance)
+     */
+    TryResult<T> tryWait(std::size_t robot) const noexcept;
+
+    /**
+     * Get the time the station is free of all of the robots (i.e., the maximum of the last departure times from each
+     * server)
+     * Note: Will throw an exception if the station has no robots or has changed since it was evaluated
+     */
+    BasicNormalRandomVariable<T> makespan() const;
+
+    /**
+     * Get the number of robots and servers
+     */
+    std::size_t size() const;
+    std::size_t servers() const;
+
+private:
+    template<class U>
+    using Vector = std::vector<U, Allocator<U>>;
+
+    /**
+     * Throws an exception if robot does not exist, or the times have not been calculated
+     */
+    void checkRobot(std::size_t robot) const;
+    void checkEvaluated() const;
+
+    std::size_t servers_;
+
+    // Arrival and service times of the robots
+    Vector<T> arrival_means_;
+    Vector<T> arrival_variances_;
+    Vector<T> service_means_;
+    Vector<T> service_variances_;
+
+    // Robots in the order they are served
+    Vector<std::uint32_t> order_;
+
+    // Departure times of the last robot at each server, and storage for the times they become free
+    Vector<T> server_means_;
+    Vector<T> server_variances_;
+    Vector<detail::Moments<T>> free_times_;
+
+    // Departure times at each server before the previous robot was served, and after the current robot and the
+    // previous robot are served in the opposite order
+    Vector<T> before_means_;
+    Vector<T> before_variances_;
+    Vector<T> swapped_means_;
+    Vector<T> swapped_variances_;
+
+    // Times calculated by the last evaluation
+    Vector<T> start_means_;
+    Vector<T> start_variances_;
+    Vector<T> departure_means_;
+    Vector<T> departure_variances_;
+    Vector<T> wait_probabilities_;
+    Vector<T> wait_means_;
+    Vector<T> wait_variances_;
+
+    bool evaluated_;
+};
+
+/**
+ * Contention queue using double precision
+ */
+typedef BasicContentionQueue<double> ContentionQueue;
+
+} // namespace NRV
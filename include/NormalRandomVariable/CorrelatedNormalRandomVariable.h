@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "NormalRandomVariable.h"
+
+namespace NRV {
+
+template<class T>
+class BasicCovarianceStore;
+
+/**
+ * Handle to a normal random variable in a BasicCovarianceStore, which tracks its covariance with the other random
+ * variables in the store. The operations add a new random variable to the store, using Clark's formulas for the
+ * covariance of the maximum and minimum with the other random variables
+ * Note: The store must outlive its random variables, and random variables from different stores can not be combined
+ */
+template<class T>
+class BasicCorrelatedNormalRandomVariable {
+public:
+    typedef T value_type;
+
+    /**
+     * Get the mean and variance of the random variable
+     */
+    T mean() const;
+    T variance() const;
+
+    /**
+     * Get the covariance and correlation coefficient with another random variable in the same store
+     */
+    T covariance(const BasicCorrelatedNormalRandomVariable& random_variable) const;
+    T correlation(const BasicCorrelatedNormalRandomVariable& random_variable) const;
+
+    /**
+     * Returns the distribution of the random variable on its own (i.e., without the covariances)
+     */
+    BasicNormalRandomVariable<T> toIndependent() const;
+
+    /**
+     * Returns the maximum or minimum of itself and random_variable, taking into account their correlation
+     */
+    BasicCorrelatedNormalRandomVariable max(const BasicCorrelatedNormalRandomVariable& random_variable) const;
+    BasicCorrelatedNormalRandomVariable min(const BasicCorrelatedNormalRandomVariable& random_variable) const;
+
+    /**
+     * Get the store that the random variable belongs to, and its index in the store
+     */
+    BasicCovarianceStore<T>& store() const
+    {
+        return *store_;
+    }
+
+    std::size_t index() const
+    {
+        return index_;
+    }
+
+private:
+    friend class BasicCovarianceStore<T>;
+
+    BasicCorrelatedNormalRandomVariable(BasicCovarianceStore<T>* store, std::size_t index)
+    : store_(store), index_(index)
+    {
+
+    }
+
+    BasicCovarianceStore<T>* store_;
+    std::size_t index_;
+};
+
+/**
+ * Class that stores the means, variances and covariances of a set of normal random variables. Only the non-zero
+ * covariances are stored, as sparse rows whose entries are allocated from a shared pool of fixed-size blocks, so
+ * that the store can grow to many thousands of random variables that are each correlated with only a few others
+ * - Covariances are symmetric and are stored in the row of both random variables
+ * - Optionally, covariances with a correlation coefficient below a tolerance are not stored (see setTolerance)
+ * Note: The store can not be copied, since its random variables refer to it
+ */
+template<class T>
+class BasicCovarianceStore {
+public:
+    typedef T value_type;
+
+    BasicCovarianceStore();
+
+    BasicCovarianceStore(const BasicCovarianceStore&) = delete;
+    BasicCovarianceStore& operator=(const BasicCovarianceStore&) = delete;
+
+    /**
+     * Adds a random variable that is independent of the other random variables in the store
+     */
+    BasicCorrelatedNormalRandomVariable<T> add(const BasicNormalRandomVariable<T>& random_variable);
+
+    /**
+     * Adds a random variable with the specified covariances with random variables already in the store. It is up
+     * to the user to ensure that the resulting covariance matrix is positive semi-definite
+     * Note: Will throw an exception if any of the random variables belong to a different store
+     */
+    BasicCorrelatedNormalRandomVariable<T> add(const BasicNormalRandomVariable<T>& random_variable,
+            const std::vector<std::pair<BasicCorrelatedNormalRandomVariable<T>, T>>& covariances);
+
+    /**
+     * Get the random variable at index
+     */
+    BasicCorrelatedNormalRandomVariable<T> operator[](std::size_t index);
+
+    /**
+     * Get the number of random variables in the store
+     */
+    std::size_t size() const;
+
+    /**
+     * Get the number of covariances stored (each pair of correlated random variables is counted twice)
+     */
+    std::size_t nonZeros() const;
+
+    /**
+     * Covariances of new random variables with a correlation coefficient smaller in magnitude than tolerance are
+     * not stored (i.e., treated as 0). The default of 0 only discards covariances that are exactly 0
+     */
+    void setTolerance(T tolerance);
+
+    /**
+     * Removes all of the random variables, keeping the allocated storage
+     */
+    void clear();
+
+private:
+    friend class BasicCorrelatedNormalRandomVariable<T>;
+    template<class U> friend BasicCorrelatedNormalRandomVariable<U> operator+(const BasicCorrelatedNormalRandomVariable<U>&, const BasicCorrelatedNormalRandomVariable<U>&);
+    template<class U> friend BasicCorrelatedNormalRandomVariable<U> operator-(const BasicCorrelatedNormalRandomVariable<U>&, const BasicCorrelatedNormalRandomVariable<U>&);
+    template<class U> friend BasicCorrelatedNormalRandomVariable<U> operator*(const BasicCorrelatedNormalRandomVariable<U>&, const BasicCorrelatedNormalRandomVariable<U>&);
+    template<class U> friend BasicCorrelatedNormalRandomVariable<U> affine(const BasicCorrelatedNormalRandomVariable<U>&, U, U);
+
+    static constexpr std::uint32_t block_size = 15;
+    static constexpr std::uint32_t no_block = 0xffffffff;
+
+    struct Entry {
+        std::uint32_t index;
+        T covariance;
+    };
+
+    /**
+     * Block of entries of a row, sorted by index. Blocks are linked in order of increasing index
+     */
+    struct Block {
+        Entry entries[block_size];
+        std::uint32_t size;
+        std::uint32_t next;
+    };
+
+    struct Row {
+        std::uint32_t first;
+        std::uint32_t last;
+    };
+
+    /**
+     * Returns the index of random_variable, checking that it belongs to this store
+     */
+    std::size_t indexOf(const BasicCorrelatedNormalRandomVariable<T>& random_variable) const;
+
+    /**
+     * Get the covariance of the random variables at index1 and index2
+     */
+    T covariance(std::size_t index1, std::size_t index2) const;
+
+    /**
+     * Appends an entry to the end of a row
+     */
+    void append(Row& row, std::uint32_t index, T covariance);
+
+    /**
+     * Adds a random variable whose covariance with every other random variable W is
+     * weight1 * cov(X1, W) + weight2 * cov(X2, W), where X1 and X2 are the random variables at index1 and index2
+     */
+    BasicCorrelatedNormalRandomVariable<T> combine(T mean, T variance, std::size_t index1, T weight1,
+            std::size_t index2, T weight2);
+
+    std::vector<T> means_;
+    std::vector<T> variances_;
+    std::vector<Row> rows_;
+    std::vector<Block> blocks_;
+    std::size_t non_zeros_;
+    T tolerance_;
+};
+
+/**
+ * Addition, subtraction and multiplication of 2 correlated random variables. The product of 2 correlated normal
+ * random variables is approximated by a normal random variable with the same mean and variance
+ */
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator+(const BasicCorrelatedNormalRandomVariable<T>& rv1, const BasicCorrelatedNormalRandomVariable<T>& rv2);
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator-(const BasicCorrelatedNormalRandomVariable<T>& rv1, const BasicCorrelatedNormalRandomVariable<T>& rv2);
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator*(const BasicCorrelatedNormalRandomVariable<T>& rv1, const BasicCorrelatedNormalRandomVariable<T>& rv2);
+
+/**
+ * Returns rv * scale + offset
+ */
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> affine(const BasicCorrelatedNormalRandomVariable<T>& rv, T scale, T offset);
+
+/**
+ * Addition, subtraction and multiplication with constants, and negation
+ */
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator+(const BasicCorrelatedNormalRandomVariable<T>& rv, typename BasicCorrelatedNormalRandomVariable<T>::value_type num)
+{
+    return affine(rv, T(1), num);
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator+(typename BasicCorrelatedNormalRandomVariable<T>::value_type num, const BasicCorrelatedNormalRandomVariable<T>& rv)
+{
+    return affine(rv, T(1), num);
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator-(const BasicCorrelatedNormalRandomVariable<T>& rv, typename BasicCorrelatedNormalRandomVariable<T>::value_type num)
+{
+    return affine(rv, T(1), -num);
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator-(typename BasicCorrelatedNormalRandomVariable<T>::value_type num, const BasicCorrelatedNormalRandomVariable<T>& rv)
+{
+    return affine(rv, T(-1), num);
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator-(const BasicCorrelatedNormalRandomVariable<T>& rv)
+{
+    return affine(rv, T(-1), T(0));
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator*(const BasicCorrelatedNormalRandomVariable<T>& rv, typename BasicCorrelatedNormalRandomVariable<T>::value_type num)
+{
+    return affine(rv, num, T(0));
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator*(typename BasicCorrelatedNormalRandomVariable<T>::value_type num, const BasicCorrelatedNormalRandomVariable<T>& rv)
+{
+    return affine(rv, num, T(0));
+}
+
+/**
+ * Covariance store and correlated random variables using double precision
+ */
+typedef BasicCovarianceStore<double> CovarianceStore;
+typedef BasicCorrelatedNormalRandomVariable<double> CorrelatedNormalRandomVariable;
+
+} // namespace NRV
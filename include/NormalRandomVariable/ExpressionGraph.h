@@ -0,0 +1,327 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "MemoryResource.h"
+#include "NormalRandomVariable.h"
+
+namespace NRV {
+
+template<class T>
+class BasicExpressionGraph;
+
+/**
+ * Handle to a node of a BasicExpressionGraph. The operations record a new node in the graph rather than
+ * calculating the result, which is only calculated when the graph is evaluated
+ * Note: The graph must outlive its expressions, and expressions from different graphs can not be combined
+ */
+template<class T>
+class BasicExpression {
+public:
+    typedef T value_type;
+
+    /**
+     * Get the graph that the expression belongs to
+     */
+    BasicExpressionGraph<T>& graph() const
+    {
+        return *graph_;
+    }
+
+    /**
+     * Get the index of the node in the graph
+     */
+    std::size_t index() const
+    {
+        return index_;
+    }
+
+    /**
+     * See the corresponding operations of BasicNormalRandomVariable
+     * Note: Will throw an exception if the lower bound is not less than the upper bound
+     */
+    BasicExpression rectify(T lower, T upper) const;
+    BasicExpression rectifyLower(T lower) const;
+    BasicExpression rectifyUpper(T upper) const;
+    BasicExpression truncate(T lower, T upper) const;
+    BasicExpression truncateLower(T lower) const;
+    BasicExpression truncateUpper(T upper) const;
+    BasicExpression truncate(const BasicExpression& lower, const BasicExpression& upper) const;
+    BasicExpression truncateLower(const BasicExpression& lower) const;
+    BasicExpression truncateUpper(const BasicExpression& upper) const;
+    BasicExpression max(const BasicExpression& expression) const;
+    BasicExpression min(const BasicExpression& expression) const;
+
+private:
+    friend class BasicExpressionGraph<T>;
+
+    BasicExpression(BasicExpressionGraph<T>* graph, std::size_t index)
+    : graph_(graph), index_(index)
+    {
+
+    }
+
+    BasicExpressionGraph<T>* graph_;
+    std::size_t index_;
+};
+
+/**
+ * Class that records chains of operations on random variables as a directed acyclic graph, and evaluates them
+ * in a single pass without creating temporary random variables or checking the intermediate variances
+ * - Identical operations on the same operands (including commutative operations with swapped operands) are only
+ *   recorded once, so common subexpressions are shared
+ * - Addition, subtraction and multiplication by constants and negation are fused into a single scale and offset
+ * - The results are cached. Changing an input (see set) marks the nodes that depend on it as dirty, and
+ *   evaluating an expression only recalculates the dirty nodes that it depends on
+ * - Nodes, the table of recorded operations and the links to dependents are stored in flat arrays from a
+ *   MemoryResource (e.g., an Arena for each planning cycle). clear removes the nodes but keeps the storage, so
+ *   recording a graph of the same size again does not allocate
+ * Note: Fusing constant operations can change the result by rounding error compared to applying them one at a
+ * time with BasicNormalRandomVariable
+ */
+template<class T>
+class BasicExpressionGraph {
+public:
+    typedef T value_type;
+
+    BasicExpressionGraph();
+
+    /**
+     * Constructor for a graph that allocates its storage from resource, which must outlive the graph
+     */
+    explicit BasicExpressionGraph(MemoryResource* resource);
+
+    // Expressions refer to the graph, so it can not be copied or moved
+    BasicExpressionGraph(const BasicExpressionGraph&) = delete;
+    BasicExpressionGraph& operator=(const BasicExpressionGraph&) = delete;
+
+    /**
+     * Adds an input to the graph with the initial value random_variable
+     */
+    BasicExpression<T> input(const BasicNormalRandomVariable<T>& random_variable);
+
+    /**
+     * Changes the value of an input
+     * Note: Will throw an exception if the expression is not an input of this graph
+     */
+    void set(const BasicExpression<T>& input, const BasicNormalRandomVariable<T>& random_variable);
+
+    /**
+     * Evaluates the expression, only calculating the nodes it depends on that have not been calculated since they
+     * were recorded or their inputs changed
+     * Note: Will throw an exception if the result does not have a valid variance
+     */
+    BasicNormalRandomVariable<T> evaluate(const BasicExpression<T>& expression);
+
+    /**
+     * Version of evaluate that returns a status instead of throwing an exception
+     * Note: The expression must belong to this graph
+     */
+    TryResult<T> tryEvaluate(const BasicExpression<T>& expression) noexcept;
+
+    /**
+     * Removes all of the nodes (invalidating their expressions) and resets the number of calculations, keeping the
+     * allocated storage
+     */
+    void clear();
+
+    /**
+     * Reserves storage for the specified number of nodes (including inputs)
+     */
+    void reserve(std::size_t nodes);
+
+    /**
+     * Get the number of nodes in the graph (including inputs)
+     */
+    std::size_t size() const;
+
+    /**
+     * Get the total number of node calculations performed by the graph (e.g., to measure how much of the graph is
+     * recalculated when an input changes)
+     */
+    std::size_t calculations() const;
+
+private:
+    friend class BasicExpression<T>;
+    template<class U> friend BasicExpression<U> operator+(const BasicExpression<U>&, const BasicExpression<U>&);
+    template<class U> friend BasicExpression<U> operator-(const BasicExpression<U>&, const BasicExpression<U>&);
+    template<class U> friend BasicExpression<U> operator*(const BasicExpression<U>&, const BasicExpression<U>&);
+    template<class U> friend BasicExpression<U> affine(const BasicExpression<U>&, U, U);
+
+    enum class Operation : unsigned char {
+        Input,
+        Affine,
+        Add,
+        Subtract,
+        Multiply,
+        Max,
+        Min,
+        Rectify,
+        RectifyLower,
+        RectifyUpper,
+        Truncate,
+        TruncateLower,
+        TruncateUpper,
+        TruncateBy,
+        TruncateLowerBy,
+        TruncateUpperBy
+    };
+
+    /**
+     * Node of the graph. operands are indices of earlier nodes, and parameters are constants (e.g., bounds)
+     */
+    struct Node {
+        Operation operation;
+        std::size_t operands[3];
+        T parameters[2];
+    };
+
+    template<class U>
+    using Vector = std::vector<U, Allocator<U>>;
+
+    /**
+     * Value of recorded_ for a slot without a node, and of the links to dependents for the end of a list
+     */
+    static constexpr std::size_t none = static_cast<std::size_t>(-1);
+
+    /**
+     * Records a node, or returns the existing node if the same operation has already been recorded
+     */
+    BasicExpression<T> record(Operation operation, std::size_t operand1, std::size_t operand2, std::size_t operand3,
+            T parameter1, T parameter2);
+
+    /**
+     * Returns the slot of recorded_ for node, which is either the slot of an identical node or an empty slot
+     */
+    std::size_t find(const Node& node) const;
+
+    /**
+     * Changes the size of recorded_ to size (a power of 2), and inserts the recorded nodes again
+     */
+    void rehash(std::size_t size);
+
+    /**
+     * Returns the expression for the node at index
+     */
+    BasicExpression<T> expression(std::size_t index);
+
+    /**
+     * Returns the index of expression, checking that it belongs to this graph
+     */
+    std::size_t indexOf(const BasicExpression<T>& expression) const;
+
+    /**
+     * Calculates the dirty nodes that the node at index depends on (including itself)
+     */
+    void calculate(std::size_t index) noexcept;
+
+    /**
+     * Calculates the node at index from its operands
+     */
+    void calculateNode(std::size_t index) noexcept;
+
+    Vector<Node> nodes_;
+    Vector<T> means_;
+    Vector<T> variances_;
+
+    // Hash table of the indices of the recorded operations (inputs are not shared, so are not included), with open
+    // addressing and a power of 2 size that is kept at least twice the number of recorded operations
+    Vector<std::size_t> recorded_;
+    std::size_t recorded_size_;
+
+    // Linked lists of the nodes that use each node as an operand: the first link of each node, and the dependent
+    // and next link of each link
+    Vector<std::size_t> first_dependents_;
+    Vector<std::size_t> dependents_;
+    Vector<std::size_t> next_dependents_;
+
+    // A dirty node needs to be recalculated, and all of the nodes that depend on it are also dirty
+    Vector<bool> dirty_;
+
+    // Storage for set and calculate, reserved when nodes are recorded so that they do not need to allocate
+    Vector<std::size_t> stack_;
+    Vector<std::size_t> pending_;
+
+    std::size_t calculations_;
+};
+
+template<class T>
+constexpr std::size_t BasicExpressionGraph<T>::none;
+
+/**
+ * Addition of 2 expressions, or an expression with a constant
+ */
+template<class T>
+BasicExpression<T> operator+(const BasicExpression<T>& expression1, const BasicExpression<T>& expression2);
+
+template<class T>
+BasicExpression<T> operator+(const BasicExpression<T>& expression, typename BasicExpression<T>::value_type num)
+{
+    return affine(expression, T(1), num);
+}
+
+template<class T>
+BasicExpression<T> operator+(typename BasicExpression<T>::value_type num, const BasicExpression<T>& expression)
+{
+    return affine(expression, T(1), num);
+}
+
+/**
+ * Subtraction of 2 expressions, or an expression with a constant
+ */
+template<class T>
+BasicExpression<T> operator-(const BasicExpression<T>& expression1, const BasicExpression<T>& expression2);
+
+template<class T>
+BasicExpression<T> operator-(const BasicExpression<T>& expression, typename BasicExpression<T>::value_type num)
+{
+    return affine(expression, T(1), -num);
+}
+
+template<class T>
+BasicExpression<T> operator-(typename BasicExpression<T>::value_type num, const BasicExpression<T>& expression)
+{
+    return affine(expression, T(-1), num);
+}
+
+/**
+ * Negation
+ */
+template<class T>
+BasicExpression<T> operator-(const BasicExpression<T>& expression)
+{
+    return affine(expression, T(-1), T(0));
+}
+
+/**
+ * Multiplication of 2 expressions, or an expression with a constant
+ */
+template<class T>
+BasicExpression<T> operator*(const BasicExpression<T>& expression1, const BasicExpression<T>& expression2);
+
+template<class T>
+BasicExpression<T> operator*(const BasicExpression<T>& expression, typename BasicExpression<T>::value_type num)
+{
+    return affine(expression, num, T(0));
+}
+
+template<class T>
+BasicExpression<T> operator*(typename BasicExpression<T>::value_type num, const BasicExpression<T>& expression)
+{
+    return affine(expression, num, T(0));
+}
+
+/**
+ * Records expression * scale + offset
+ */
+template<class T>
+BasicExpression<T> affine(const BasicExpression<T>& expression, T scale, T offset);
+
+/**
+ * Expression graph using double precision
+ */
+typedef BasicExpressionGraph<double> ExpressionGraph;
+typedef BasicExpression<double> Expression;
+
+} // namespace NRV
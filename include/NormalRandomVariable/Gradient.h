@@ -0,0 +1,274 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "NormalRandomVariable.h"
+
+namespace NRV {
+
+/**
+ * Partial derivatives of the mean and variance of the result of an operation with respect to one of its inputs
+ */
+template<class T>
+struct Partial {
+    T mean;
+    T variance;
+};
+
+/**
+ * Result of an operation and the partial derivatives of its mean and variance with respect to each of the N inputs,
+ * in the order of the arguments (the mean and then the variance of each random variable, and each scalar bound)
+ */
+template<class T, std::size_t N>
+struct WithGradient {
+    BasicNormalRandomVariable<T> value;
+    std::array<Partial<T>, N> partials;
+};
+
+/**
+ * Operations that also return their analytic partial derivatives, calculated in a single extra pass over the values
+ * used by the operation (rather than by finite differences). The value is identical to that of the operation, and
+ * exceptions are thrown in the same cases
+ * Note: Truncation by random variables and division switch between approximations depending on the inputs, and the
+ * derivatives are those of the approximation that is used (i.e., they do not include the jump at the switch)
+ */
+template<class T>
+WithGradient<T, 4> maxWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2);
+
+template<class T>
+WithGradient<T, 4> minWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2);
+
+template<class T>
+WithGradient<T, 4> multiplyWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2);
+
+template<class T>
+WithGradient<T, 4> divideWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2);
+
+template<class T>
+WithGradient<T, 2> inverseWithGradient(const BasicNormalRandomVariable<T>& rv);
+
+template<class T>
+WithGradient<T, 4> rectifyWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type lower, typename BasicNormalRandomVariable<T>::value_type upper);
+
+template<class T>
+WithGradient<T, 3> rectifyLowerWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type lower);
+
+template<class T>
+WithGradient<T, 3> rectifyUpperWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type upper);
+
+template<class T>
+WithGradient<T, 4> truncateWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type lower, typename BasicNormalRandomVariable<T>::value_type upper);
+
+template<class T>
+WithGradient<T, 3> truncateLowerWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type lower);
+
+template<class T>
+WithGradient<T, 3> truncateUpperWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type upper);
+
+template<class T>
+WithGradient<T, 6> truncateWithGradient(const BasicNormalRandomVariable<T>& rv,
+        const BasicNormalRandomVariable<T>& lower, const BasicNormalRandomVariable<T>& upper);
+
+template<class T>
+WithGradient<T, 4> truncateLowerWithGradient(const BasicNormalRandomVariable<T>& rv,
+        const BasicNormalRandomVariable<T>& lower);
+
+template<class T>
+WithGradient<T, 4> truncateUpperWithGradient(const BasicNormalRandomVariable<T>& rv,
+        const BasicNormalRandomVariable<T>& upper);
+
+/**
+ * Dual number for forward-mode differentiation: a value and its derivatives (tangents) with respect to any number
+ * of parameters. Missing tangents are 0, so constants do not need to know the number of parameters
+ */
+template<class T>
+class BasicDual {
+public:
+    typedef T value_type;
+
+    /**
+     * Constructor for a constant (all tangents are 0)
+     */
+    BasicDual(T value = 0)
+    : value_(value)
+    {
+
+    }
+
+    /**
+     * Constructor for a value with the specified tangents
+     */
+    BasicDual(T value, std::vector<T> tangents)
+    : value_(value), tangents_(std::move(tangents))
+    {
+
+    }
+
+    /**
+     * Returns parameter index out of parameters, with a tangent of 1 with respect to itself
+     */
+    static BasicDual parameter(T value, std::size_t index, std::size_t parameters);
+
+    /**
+     * Get the value
+     */
+    T value() const
+    {
+        return value_;
+    }
+
+    /**
+     * Get the derivative with respect to parameter index (0 if it has not been set)
+     */
+    T tangent(std::size_t index) const
+    {
+        return index < tangents_.size() ? tangents_[index] : T(0);
+    }
+
+    /**
+     * Get the stored tangents
+     */
+    const std::vector<T>& tangents() const
+    {
+        return tangents_;
+    }
+
+private:
+    T value_;
+    std::vector<T> tangents_;
+};
+
+/**
+ * Arithmetic of dual numbers
+ */
+template<class T>
+BasicDual<T> operator+(const BasicDual<T>& a, const BasicDual<T>& b);
+
+template<class T>
+BasicDual<T> operator-(const BasicDual<T>& a, const BasicDual<T>& b);
+
+template<class T>
+BasicDual<T> operator*(const BasicDual<T>& a, const BasicDual<T>& b);
+
+template<class T>
+BasicDual<T> operator/(const BasicDual<T>& a, const BasicDual<T>& b);
+
+template<class T>
+BasicDual<T> operator-(const BasicDual<T>& a);
+
+/**
+ * Normal random variable whose mean and variance are dual numbers, so that each operation also propagates the
+ * derivatives of the result with respect to the parameters (e.g., departure times and deadlines). The derivatives of
+ * a whole calculation are therefore obtained in the same pass as its value, using the partial derivatives of each
+ * operation above
+ */
+template<class T>
+class BasicDualNormalRandomVariable {
+public:
+    typedef T value_type;
+    typedef BasicDual<T> dual_type;
+
+    /**
+     * Constructor for a random variable with the specified mean and variance
+     * Note: Will throw an exception if the variance is not greater than 0
+     */
+    BasicDualNormalRandomVariable(BasicDual<T> mean, BasicDual<T> variance);
+
+    /**
+     * Constructor for a constant random variable (all tangents are 0)
+     */
+    BasicDualNormalRandomVariable(const BasicNormalRandomVariable<T>& random_variable)
+    : mean_(random_variable.mean()), variance_(random_variable.variance())
+    {
+
+    }
+
+    /**
+     * Get the mean and variance, with their tangents
+     */
+    const BasicDual<T>& mean() const
+    {
+        return mean_;
+    }
+
+    const BasicDual<T>& variance() const
+    {
+        return variance_;
+    }
+
+    /**
+     * Get the random variable without the tangents
+     */
+    BasicNormalRandomVariable<T> value() const
+    {
+        return BasicNormalRandomVariable<T>(mean_.value(), variance_.value());
+    }
+
+    /**
+     * Operations of BasicNormalRandomVariable
+     */
+    BasicDualNormalRandomVariable inverse() const;
+    BasicDualNormalRandomVariable rectify(const BasicDual<T>& lower, const BasicDual<T>& upper) const;
+    BasicDualNormalRandomVariable rectifyLower(const BasicDual<T>& lower) const;
+    BasicDualNormalRandomVariable rectifyUpper(const BasicDual<T>& upper) const;
+    BasicDualNormalRandomVariable truncate(const BasicDual<T>& lower, const BasicDual<T>& upper) const;
+    BasicDualNormalRandomVariable truncateLower(const BasicDual<T>& lower) const;
+    BasicDualNormalRandomVariable truncateUpper(const BasicDual<T>& upper) const;
+    BasicDualNormalRandomVariable truncate(const BasicDualNormalRandomVariable& lower,
+            const BasicDualNormalRandomVariable& upper) const;
+    BasicDualNormalRandomVariable truncateLower(const BasicDualNormalRandomVariable& lower) const;
+    BasicDualNormalRandomVariable truncateUpper(const BasicDualNormalRandomVariable& upper) const;
+    BasicDualNormalRandomVariable max(const BasicDualNormalRandomVariable& random_variable) const;
+    BasicDualNormalRandomVariable min(const BasicDualNormalRandomVariable& random_variable) const;
+
+private:
+    BasicDual<T> mean_;
+    BasicDual<T> variance_;
+};
+
+/**
+ * Arithmetic of dual random variables, with each other and with dual numbers (or constants)
+ */
+template<class T>
+BasicDualNormalRandomVariable<T> operator+(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2);
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator+(const BasicDualNormalRandomVariable<T>& rv, const typename BasicDualNormalRandomVariable<T>::dual_type& num);
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator-(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2);
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator-(const BasicDualNormalRandomVariable<T>& rv, const typename BasicDualNormalRandomVariable<T>::dual_type& num);
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator-(const BasicDualNormalRandomVariable<T>& rv);
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator*(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2);
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator*(const BasicDualNormalRandomVariable<T>& rv, const typename BasicDualNormalRandomVariable<T>::dual_type& num);
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator/(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2);
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator/(const BasicDualNormalRandomVariable<T>& rv, const typename BasicDualNormalRandomVariable<T>::dual_type& num);
+
+/**
+ * Dual numbers and random variables using double precision
+ */
+typedef BasicDual<double> Dual;
+typedef BasicDualNormalRandomVariable<double> DualNormalRandomVariable;
+
+} // namespace NRV
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace NRV {
+
+/**
+ * Operations of BasicNormalRandomVariable that are instrumented. Operations that call other operations (e.g.,
+ * division by a random variable that is approximated using its inverse) also count those operations
+ */
+enum class InstrumentedOperation : unsigned char {
+    Inverse,
+    Rectify,
+    RectifyLower,
+    RectifyUpper,
+    Truncate,
+    TruncateLower,
+    TruncateUpper,
+    TruncateBy,
+    TruncateLowerBy,
+    TruncateUpperBy,
+    Max,
+    Min,
+    Multiply,
+    Divide,
+    DivideConstant
+};
+
+constexpr std::size_t instrumented_operation_count = 15;
+
+/**
+ * Approximation branches that are counted
+ * InverseOutOfRange: inverse (or division) rejected a random variable whose mean is within 4 standard deviations of 0
+ * DivideClosedForm, DivideByInverse: division used the closed-form approximation, or multiplied by the inverse
+ * TruncateTogether, TruncateLowerFirst, TruncateUpperFirst: the method chosen by truncation by 2 random variables
+ */
+enum class InstrumentedBranch : unsigned char {
+    InverseOutOfRange,
+    DivideClosedForm,
+    DivideByInverse,
+    TruncateTogether,
+    TruncateLowerFirst,
+    TruncateUpperFirst
+};
+
+constexpr std::size_t instrumented_branch_count = 6;
+
+/**
+ * One in every instrumentation_sample_period operations on each thread is timed
+ */
+constexpr std::uint32_t instrumentation_sample_period = 64;
+
+/**
+ * Counters of one operation: the number of calls, the number that threw an exception, and the number of calls that
+ * were timed with their total duration in ticks (cycles of the time-stamp counter on x86, otherwise nanoseconds)
+ */
+struct OperationCounters {
+    std::uint64_t calls;
+    std::uint64_t exceptions;
+    std::uint64_t sampled_calls;
+    std::uint64_t sampled_ticks;
+};
+
+/**
+ * Totals of the counters of all threads since the last reset
+ */
+struct InstrumentationSnapshot {
+    std::array<OperationCounters, instrumented_operation_count> operations;
+    std::array<std::uint64_t, instrumented_branch_count> branches;
+
+    const OperationCounters& operator[](InstrumentedOperation operation) const
+    {
+        return operations[static_cast<std::size_t>(operation)];
+    }
+
+    std::uint64_t operator[](InstrumentedBranch branch) const
+    {
+        return branches[static_cast<std::size_t>(branch)];
+    }
+};
+
+/**
+ * Returns true if the library was built with instrumentation (the ENABLE_INSTRUMENTATION CMake option, which defines
+ * NRV_INSTRUMENTATION). Otherwise the operations are not instrumented at all, and the snapshots are always 0
+ */
+constexpr bool instrumentationEnabled()
+{
+#ifdef NRV_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Get the totals of the counters of all threads (including threads that have exited) since the last reset. Each
+ * thread only writes its own counters, without locks or atomic read-modify-write operations, so a snapshot taken
+ * while other threads are calculating may miss their most recent operations
+ */
+InstrumentationSnapshot instrumentationSnapshot();
+
+/**
+ * Resets the counters of all threads to 0
+ */
+void resetInstrumentation();
+
+/**
+ * Get the name of an operation or branch (e.g., for labelling metrics)
+ */
+const char* instrumentationName(InstrumentedOperation operation);
+const char* instrumentationName(InstrumentedBranch branch);
+
+} // namespace NRV
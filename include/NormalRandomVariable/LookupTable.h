@@ -0,0 +1,29 @@
+#pragma once
+
+namespace NRV {
+
+/**
+ * Switches truncation and rectification (by constants and by random variables) from std::erf and std::exp to
+ * cubic interpolation in a table of the standard normal distribution, which trades a small error for higher
+ * throughput. The table is chosen to have the smallest number of points that gives an absolute error in the
+ * interpolated erf and exp of at most max_error, and the actual maximum error is returned
+ * - This affects BasicNormalRandomVariable, BasicExpressionGraph and the array operations that are not vectorised
+ *   (i.e., float, long double, or when the instruction set is Scalar)
+ * - Tables are built once for each accuracy and are never freed, so they are shared read-only by all threads and
+ *   the mode can be changed at any time
+ * Note: Will throw an exception if max_error is not positive or is smaller than the finest table can achieve
+ * (around 1e-14). The table is calculated in double precision, which limits the accuracy of long double
+ */
+double enableLookupTable(double max_error = 1e-9);
+
+/**
+ * Switches back to calculating std::erf and std::exp (the default)
+ */
+void disableLookupTable();
+
+/**
+ * Get the maximum error of the active table, or 0 if the lookup table is not enabled
+ */
+double lookupTableError();
+
+} // namespace NRV
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+namespace NRV {
+
+/**
+ * Number of lookups in the memo cache that found a previous result (hits) or had to calculate it (misses)
+ */
+struct MemoCacheStatistics {
+    std::size_t hits;
+    std::size_t misses;
+};
+
+/**
+ * Enables a bounded cache of the results of rectify, truncate (by constants and by random variables), max and min
+ * of BasicNormalRandomVariable, keyed on the operation and the means and variances of its operands. This helps
+ * when the same operations are requested repeatedly (e.g., in every iteration of an optimiser)
+ * - The cache holds up to capacity results of each floating point type, in shards with their own locks so that
+ *   threads rarely wait for each other. A new result replaces any older result in the same slot
+ * - Enabling the cache (again) clears it and resets the statistics
+ * Note: Will throw an exception if capacity is less than 16 (the number of shards, which each hold at least one
+ * result). The try versions of the operations are not cached
+ */
+void enableMemoCache(std::size_t capacity = 65536);
+
+/**
+ * Disables the cache, so that every operation is calculated
+ */
+void disableMemoCache();
+
+/**
+ * Removes all of the cached results and resets the statistics
+ */
+void clearMemoCache();
+
+/**
+ * Get the number of hits and misses since the cache was enabled or cleared
+ */
+MemoCacheStatistics memoCacheStatistics();
+
+} // namespace NRV
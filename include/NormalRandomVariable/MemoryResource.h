@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+#endif
+
+namespace NRV {
+
+/**
+ * Interface of a source of memory for the graphs and networks (e.g., BasicExpressionGraph and BasicTaskNetwork), with
+ * the same functions as std::pmr::memory_resource so that it can be used with C++11 (see PmrMemoryResource)
+ */
+class MemoryResource {
+public:
+    virtual ~MemoryResource() = default;
+
+    /**
+     * Allocates at least bytes bytes aligned to alignment (a power of 2)
+     * Note: Will throw an exception (e.g., std::bad_alloc) if the memory can not be allocated
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        return doAllocate(bytes, alignment);
+    }
+
+    /**
+     * Returns memory from allocate with the same size and alignment
+     */
+    void deallocate(void* pointer, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept
+    {
+        doDeallocate(pointer, bytes, alignment);
+    }
+
+private:
+    virtual void* doAllocate(std::size_t bytes, std::size_t alignment) = 0;
+    virtual void doDeallocate(void* pointer, std::size_t bytes, std::size_t alignment) noexcept = 0;
+};
+
+/**
+ * Returns the resource that uses operator new and delete, which is used when no resource is specified
+ */
+MemoryResource* defaultMemoryResource() noexcept;
+
+/**
+ * Resource that allocates by incrementing a pointer through blocks of memory from an upstream resource, and only
+ * frees them all at once, so that a whole planning cycle of graphs can be freed in O(1)
+ * - deallocate does nothing. The memory is reused once reset is called, which keeps the blocks, so repeating the
+ *   same work after each reset does not allocate from the upstream resource
+ * - Blocks grow geometrically from block_size, and requests larger than a block get a block of their own
+ * Note: The objects that use the arena must be destroyed (or cleared) before it is reset, and it is not thread safe
+ */
+class Arena : public MemoryResource {
+public:
+    explicit Arena(std::size_t block_size = 64 * 1024, MemoryResource* upstream = defaultMemoryResource());
+    ~Arena() override;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Makes all of the memory available again, keeping the blocks
+     */
+    void reset() noexcept;
+
+    /**
+     * Returns all of the blocks to the upstream resource
+     */
+    void release() noexcept;
+
+    /**
+     * Get the number of bytes allocated since the last reset (including alignment), and the total size of the blocks
+     */
+    std::size_t used() const;
+    std::size_t capacity() const;
+
+    /**
+     * Get the resource the blocks are allocated from
+     */
+    MemoryResource* upstream() const;
+
+private:
+    struct Block {
+        Block* next;
+        std::size_t size;
+    };
+
+    void* doAllocate(std::size_t bytes, std::size_t alignment) override;
+    void doDeallocate(void* pointer, std::size_t bytes, std::size_t alignment) noexcept override;
+
+    /**
+     * Returns the start of the memory of a block, which follows its header
+     */
+    static char* begin(Block* block);
+
+    MemoryResource* upstream_;
+    std::size_t block_size_;
+
+    // Blocks in the order they were allocated, with the block being used and the next free byte in it
+    Block* first_;
+    Block* current_;
+    char* position_;
+
+    // Bytes used in the blocks before current_
+    std::size_t used_;
+    std::size_t capacity_;
+};
+
+/**
+ * Allocator for standard containers that allocates from a MemoryResource, like std::pmr::polymorphic_allocator.
+ * Containers keep their resource when they are moved, and copies use the default resource
+ */
+template<class T>
+class Allocator {
+public:
+    typedef T value_type;
+
+    Allocator() noexcept
+    : resource_(defaultMemoryResource())
+    {
+
+    }
+
+    Allocator(MemoryResource* resource) noexcept
+    : resource_(resource)
+    {
+
+    }
+
+    template<class U>
+    Allocator(const Allocator<U>& allocator) noexcept
+    : resource_(allocator.resource())
+    {
+
+    }
+
+    T* allocate(std::size_t size)
+    {
+        if(size > std::numeric_limits<std::size_t>::max() / sizeof(T))
+        {
+            throw std::bad_array_new_length();
+        }
+
+        return static_cast<T*>(resource_->allocate(size * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t size) noexcept
+    {
+        resource_->deallocate(pointer, size * sizeof(T), alignof(T));
+    }
+
+    Allocator select_on_container_copy_construction() const
+    {
+        return Allocator();
+    }
+
+    MemoryResource* resource() const
+    {
+        return resource_;
+    }
+
+private:
+    MemoryResource* resource_;
+};
+
+template<class T, class U>
+bool operator==(const Allocator<T>& allocator1, const Allocator<U>& allocator2)
+{
+    return allocator1.resource() == allocator2.resource();
+}
+
+template<class T, class U>
+bool operator!=(const Allocator<T>& allocator1, const Allocator<U>& allocator2)
+{
+    return !(allocator1 == allocator2);
+}
+
+#if defined(__cpp_lib_memory_resource)
+
+/**
+ * Resource that allocates from a std::pmr::memory_resource (e.g., std::pmr::monotonic_buffer_resource), which is
+ * available with C++17
+ */
+class PmrMemoryResource : public MemoryResource {
+public:
+    explicit PmrMemoryResource(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+    : resource_(resource)
+    {
+
+    }
+
+    /**
+     * Get the standard resource that is used
+     */
+    std::pmr::memory_resource* resource() const
+    {
+        return resource_;
+    }
+
+private:
+    void* doAllocate(std::size_t bytes, std::size_t alignment) override
+    {
+        return resource_->allocate(bytes, alignment);
+    }
+
+    void doDeallocate(void* pointer, std::size_t bytes, std::size_t alignment) noexcept override
+    {
+        resource_->deallocate(pointer, bytes, alignment);
+    }
+
+    std::pmr::memory_resource* resource_;
+};
+
+#endif
+
+} // namespace NRV
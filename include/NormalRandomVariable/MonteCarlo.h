@@ -0,0 +1,325 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "NormalRandomVariable.h"
+
+namespace NRV {
+
+/**
+ * Counter-based random number generator (Philox4x32-10, Salmon et al. 2011). Each counter is mapped to 4 random
+ * 32-bit integers, so any part of a random stream can be generated independently of the rest (e.g., on different
+ * threads) and the result does not depend on the order in which it is generated
+ */
+class Philox4x32 {
+public:
+    typedef std::array<std::uint32_t, 4> Counter;
+    typedef std::array<std::uint32_t, 2> Key;
+
+    explicit Philox4x32(Key key)
+    : key_(key)
+    {
+
+    }
+
+    explicit Philox4x32(std::uint64_t seed)
+    : key_{{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}}
+    {
+
+    }
+
+    /**
+     * Get the random integers for counter
+     */
+    Counter operator()(Counter counter) const;
+
+private:
+    Key key_;
+};
+
+/**
+ * Streaming accumulator for the mean and variance of samples (Welford's algorithm), which can be merged with other
+ * accumulators (Chan et al.) to combine the samples of several threads
+ */
+template<class T>
+class BasicWelfordAccumulator {
+public:
+    typedef T value_type;
+
+    BasicWelfordAccumulator()
+    : count_(0), mean_(0), sum_squares_(0)
+    {
+
+    }
+
+    /**
+     * Adds a sample
+     */
+    void add(T sample)
+    {
+        ++count_;
+        T delta = sample - mean_;
+        mean_ += delta / static_cast<T>(count_);
+        sum_squares_ += delta * (sample - mean_);
+    }
+
+    /**
+     * Adds size samples. The batch is reduced on its own before being merged, which only requires one division
+     */
+    void add(const T* samples, std::size_t size);
+
+    /**
+     * Adds the samples of another accumulator
+     */
+    void merge(const BasicWelfordAccumulator& accumulator);
+
+    /**
+     * Get the number of samples, and their mean and (population) variance
+     * Note: The mean and variance are not a number if there are no samples
+     */
+    std::size_t count() const
+    {
+        return count_;
+    }
+
+    T mean() const
+    {
+        return count_ == 0 ? std::numeric_limits<T>::quiet_NaN() : mean_;
+    }
+
+    T variance() const
+    {
+        return count_ == 0 ? std::numeric_limits<T>::quiet_NaN() : sum_squares_ / static_cast<T>(count_);
+    }
+
+private:
+    std::size_t count_;
+    T mean_;
+    T sum_squares_;
+};
+
+/**
+ * Read-only view of the sampled inputs that are passed to the function being sampled by BasicMonteCarlo
+ */
+template<class T>
+class BasicSampleView {
+public:
+    typedef T value_type;
+
+    BasicSampleView(const T* samples, std::size_t size)
+    : samples_(samples), size_(size)
+    {
+
+    }
+
+    /**
+     * Implicit conversion from a vector, so that the same function can be applied to the random variables
+     * themselves (e.g., f<NormalRandomVariable>(inputs)) and to the samples
+     */
+    BasicSampleView(const std::vector<T>& samples)
+    : samples_(samples.data()), size_(samples.size())
+    {
+
+    }
+
+    const T& operator[](std::size_t index) const
+    {
+        return samples_[index];
+    }
+
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    const T* begin() const
+    {
+        return samples_;
+    }
+
+    const T* end() const
+    {
+        return samples_ + size_;
+    }
+
+private:
+    const T* samples_;
+    std::size_t size_;
+};
+
+/**
+ * Class that estimates the distribution of a function of independent normal random variables by Monte Carlo
+ * sampling (e.g., to validate the approximations of the operations)
+ * - Each block of samples is generated from its own part of a Philox4x32 stream, and the blocks are merged in order,
+ *   so the result only depends on the seed and the number of samples (not on the number of threads)
+ * - The inputs are generated in batches using the Box-Muller transform, and the results are accumulated with
+ *   BasicWelfordAccumulator
+ * - The function is a template parameter, so it can be inlined and is never copied to the heap. It is called as
+ *   function(BasicSampleView<T>) and returns T. Results that are not finite (e.g., NaN for samples that are outside
+ *   the domain of the operation) are discarded
+ */
+template<class T>
+class BasicMonteCarlo {
+public:
+    typedef T value_type;
+
+    /**
+     * Number of samples in each block, and in each batch that is generated at once
+     */
+    static constexpr std::size_t block_size = 4096;
+    static constexpr std::size_t batch_size = 256;
+
+    /**
+     * Constructor for a sampler with the specified seed, which runs on threads threads (or one per hardware thread
+     * if threads is 0)
+     */
+    explicit BasicMonteCarlo(std::uint64_t seed = 0, unsigned int threads = 0);
+
+    /**
+     * Samples function number_of_samples times, and returns the accumulated results
+     * Note: Exceptions thrown by function are rethrown once all of the threads have stopped
+     */
+    template<class Function>
+    BasicWelfordAccumulator<T> sample(Function function, const std::vector<BasicNormalRandomVariable<T>>& inputs,
+            std::size_t number_of_samples) const;
+
+    /**
+     * Samples function and returns a random variable with the mean and variance of the results
+     * Note: Will throw an exception if the variance of the results is not greater than 0
+     */
+    template<class Function>
+    BasicNormalRandomVariable<T> estimate(Function function, const std::vector<BasicNormalRandomVariable<T>>& inputs,
+            std::size_t number_of_samples) const
+    {
+        BasicWelfordAccumulator<T> accumulator = sample(function, inputs, number_of_samples);
+        return BasicNormalRandomVariable<T>(accumulator.mean(), accumulator.variance());
+    }
+
+    /**
+     * Get the number of threads that are used
+     */
+    unsigned int threads() const;
+
+private:
+    /**
+     * Generates size samples (size must be even) of the input at input_index for the batch at batch_index, writing
+     * them to output with the given stride
+     */
+    void generate(std::uint64_t batch_index, std::size_t input_index, const BasicNormalRandomVariable<T>& input,
+            std::size_t size, T* output, std::size_t stride) const;
+
+    Philox4x32 generator_;
+    unsigned int threads_;
+};
+
+template<class T>
+constexpr std::size_t BasicMonteCarlo<T>::block_size;
+
+template<class T>
+constexpr std::size_t BasicMonteCarlo<T>::batch_size;
+
+template<class T>
+template<class Function>
+BasicWelfordAccumulator<T> BasicMonteCarlo<T>::sample(Function function,
+        const std::vector<BasicNormalRandomVariable<T>>& inputs, std::size_t number_of_samples) const
+{
+    std::size_t blocks = (number_of_samples + block_size - 1) / block_size;
+    std::vector<BasicWelfordAccumulator<T>> block_results(blocks);
+    std::size_t threads = std::max<std::size_t>(1, std::min<std::size_t>(threads_, blocks));
+    std::vector<std::exception_ptr> errors(threads);
+
+    auto sampleBlocks = [&](std::size_t thread) {
+        try
+        {
+            std::size_t stride = inputs.size();
+            std::vector<T> samples(batch_size * stride);
+            std::vector<T> results(batch_size);
+            for(std::size_t block = thread; block < blocks; block += threads)
+            {
+                std::size_t block_samples = std::min(block_size, number_of_samples - block * block_size);
+                for(std::size_t first = 0; first < block_samples; first += batch_size)
+                {
+                    std::size_t size = std::min(batch_size, block_samples - first);
+                    std::uint64_t batch_index = (block * block_size + first) / batch_size;
+                    for(std::size_t input = 0; input < inputs.size(); ++input)
+                    {
+                        generate(batch_index, input, inputs[input], size + size % 2, samples.data() + input, stride);
+                    }
+
+                    std::size_t valid = 0;
+                    for(std::size_t i = 0; i < size; ++i)
+                    {
+                        T result = function(BasicSampleView<T>(samples.data() + i * stride, stride));
+                        if(std::isfinite(result))
+                        {
+                            results[valid++] = result;
+                        }
+                    }
+                    block_results[block].add(results.data(), valid);
+                }
+            }
+        }
+        catch(...)
+        {
+            errors[thread] = std::current_exception();
+        }
+    };
+
+    // If a thread can not be started, the calling thread samples its blocks and those of the later threads
+    std::vector<std::thread> workers;
+    std::size_t started = 1;
+    for(; started < threads; ++started)
+    {
+        try
+        {
+            workers.emplace_back(sampleBlocks, started);
+        }
+        catch(const std::system_error&)
+        {
+            break;
+        }
+    }
+    sampleBlocks(0);
+    for(std::size_t thread = started; thread < threads; ++thread)
+    {
+        sampleBlocks(thread);
+    }
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    for(const auto& error : errors)
+    {
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    BasicWelfordAccumulator<T> result;
+    for(const auto& block_result : block_results)
+    {
+        result.merge(block_result);
+    }
+
+    return result;
+}
+
+/**
+ * Monte Carlo sampling using double precision
+ */
+typedef BasicWelfordAccumulator<double> WelfordAccumulator;
+typedef BasicSampleView<double> SampleView;
+typedef BasicMonteCarlo<double> MonteCarlo;
+
+} // namespace NRV
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+
+#include "NormalRandomVariable.h"
+
+namespace NRV {
+
+/**
+ * Component of a mixture of normal distributions, with its weight (probability). Components may have a variance of 0
+ * (e.g., the probability mass that rectification moves to a bound)
+ */
+template<class T>
+struct MixtureComponent {
+    T weight;
+    T mean;
+    T variance;
+};
+
+namespace detail {
+
+/**
+ * Operations on the components of mixtures, which are compiled into the library for float, double and long double.
+ * Each writes the resulting components to result and returns the number of them, with weights that sum to 1
+ */
+enum class MixtureOperation : unsigned char {
+    Rectify,
+    RectifyLower,
+    RectifyUpper,
+    Truncate,
+    TruncateLower,
+    TruncateUpper,
+    TruncateBy,
+    TruncateLowerBy,
+    TruncateUpperBy
+};
+
+/**
+ * Applies a rectification or truncation to each component. The parameters are the bounds (lower then upper), or the
+ * means and variances of the bounds for truncation by random variables (lower mean, lower variance, upper mean,
+ * upper variance). result must have space for 3 * size components (rectification) or size components (truncation)
+ * Note: Will throw an exception if the bounds are invalid or truncation leaves no probability mass
+ */
+template<class T>
+std::size_t transformMixture(MixtureOperation operation, const std::array<T, 4>& parameters,
+        const MixtureComponent<T>* components, std::size_t size, MixtureComponent<T>* result);
+
+/**
+ * Maximum of 2 mixtures. The maximum of each pair of components is split into the 2 cases of which is greater (each
+ * a truncation by the other, weighted by its probability). result must have space for 2 * size1 * size2 components
+ */
+template<class T>
+std::size_t maxOfMixtures(const MixtureComponent<T>* components1, std::size_t size1,
+        const MixtureComponent<T>* components2, std::size_t size2, MixtureComponent<T>* result);
+
+/**
+ * Reduces the components to at most capacity by merging the pairs of components that are adjacent in mean whose merge
+ * increases the variance of the components the least (Salmond's criterion), in passes that each merge up to half of
+ * the excess components. Merging preserves the mean and variance of the mixture. The components are left sorted by
+ * mean. costs must have space for 2 * size values
+ */
+template<class T>
+std::size_t mergeMixture(MixtureComponent<T>* components, std::size_t size, std::size_t capacity, T* costs);
+
+/**
+ * Removes the components with a weight less than min_weight (keeping at least the heaviest component), and
+ * renormalises the weights of the others
+ */
+template<class T>
+std::size_t pruneMixture(MixtureComponent<T>* components, std::size_t size, T min_weight);
+
+} // namespace detail
+
+/**
+ * Class that implements a mixture of at most N normal distributions (with inline storage, so it never allocates), as
+ * a more accurate alternative to BasicNormalRandomVariable for long chains of max, min, rectify and truncate.
+ * BasicNormalRandomVariable approximates the result of each of these by a single normal distribution, so the errors
+ * of chains of them accumulate. The mixture instead keeps the shape of the results (e.g., the skew of a maximum, or
+ * the probability mass that rectification moves to the bounds), and merges components once there are more than N
+ * - Each operation costs at most a fixed number of the corresponding BasicNormalRandomVariable operations (e.g., 2 *
+ *   N * N truncations for the maximum of 2 mixtures), and temporarily uses space for that many components on the
+ *   stack
+ * - The results have the same mean and variance as the exact results of the operations on the mixture, except for
+ *   truncation by 2 random variables (which uses the same approximation as BasicNormalRandomVariable). Each of the
+ *   cases that a component is split into is still approximated by a normal distribution, so chains of operations
+ *   accumulate smaller errors rather than none
+ * Note: The components are independent of other random variables, as with BasicNormalRandomVariable
+ */
+template<class T, std::size_t N>
+class BasicNormalMixture {
+public:
+    static_assert(N >= 1, "NormalMixture: Must have space for at least one component");
+
+    typedef T value_type;
+    typedef MixtureComponent<T> component_type;
+
+    /**
+     * Maximum number of components
+     */
+    static constexpr std::size_t capacity = N;
+
+    /**
+     * Constructor for a mixture of a single standard normal distribution
+     */
+    BasicNormalMixture()
+    : size_(1)
+    {
+        components_[0] = {1, 0, 1};
+    }
+
+    /**
+     * Constructor for a mixture of a single normal distribution
+     */
+    BasicNormalMixture(const BasicNormalRandomVariable<T>& random_variable)
+    : size_(1)
+    {
+        components_[0] = {1, random_variable.mean(), random_variable.variance()};
+    }
+
+    /**
+     * Get the number of components, and each component
+     */
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    const component_type& operator[](std::size_t index) const
+    {
+        return components_[index];
+    }
+
+    const component_type* begin() const
+    {
+        return components_.data();
+    }
+
+    const component_type* end() const
+    {
+        return components_.data() + size_;
+    }
+
+    /**
+     * Get the mean and variance of the mixture
+     */
+    T mean() const
+    {
+        T mean = 0;
+        for(const component_type& component : *this)
+        {
+            mean += component.weight * component.mean;
+        }
+
+        return mean;
+    }
+
+    T variance() const
+    {
+        T mean = this->mean();
+        T variance = 0;
+        for(const component_type& component : *this)
+        {
+            T difference = component.mean - mean;
+            variance += component.weight * (component.variance + difference * difference);
+        }
+
+        return variance;
+    }
+
+    /**
+     * Returns the normal random variable with the same mean and variance as the mixture
+     * Note: Will throw an exception if the variance is not greater than 0
+     */
+    BasicNormalRandomVariable<T> collapse() const
+    {
+        return BasicNormalRandomVariable<T>(mean(), variance());
+    }
+
+    /**
+     * Returns the maximum or minimum of the mixture and another mixture (or random variable)
+     */
+    BasicNormalMixture max(const BasicNormalMixture& mixture) const
+    {
+        std::array<component_type, 2 * N * N> result;
+        std::size_t size = detail::maxOfMixtures(components_.data(), size_, mixture.components_.data(), mixture.size_,
+                result.data());
+        return BasicNormalMixture(result, size);
+    }
+
+    BasicNormalMixture min(const BasicNormalMixture& mixture) const
+    {
+        return -(-*this).max(-mixture);
+    }
+
+    /**
+     * Returns the rectified mixture between the bounds, where the components that are rectified are split into the
+     * probability mass at each bound and the truncated distribution between them
+     * Note: Will throw an exception if the lower bound is not less than the upper bound
+     */
+    BasicNormalMixture rectify(T lower, T upper) const
+    {
+        return transform<3>(detail::MixtureOperation::Rectify, {{lower, upper, 0, 0}});
+    }
+
+    BasicNormalMixture rectifyLower(T lower) const
+    {
+        return transform<3>(detail::MixtureOperation::RectifyLower, {{lower, 0, 0, 0}});
+    }
+
+    BasicNormalMixture rectifyUpper(T upper) const
+    {
+        return transform<3>(detail::MixtureOperation::RectifyUpper, {{0, upper, 0, 0}});
+    }
+
+    /**
+     * Returns the truncated mixture, where each component is truncated and weighted by the probability mass that it
+     * keeps
+     * Note: Will throw an exception if the lower bound is not less than the upper bound, or no probability mass is kept
+     */
+    BasicNormalMixture truncate(T lower, T upper) const
+    {
+        return transform<1>(detail::MixtureOperation::Truncate, {{lower, upper, 0, 0}});
+    }
+
+    BasicNormalMixture truncateLower(T lower) const
+    {
+        return transform<1>(detail::MixtureOperation::TruncateLower, {{lower, 0, 0, 0}});
+    }
+
+    BasicNormalMixture truncateUpper(T upper) const
+    {
+        return transform<1>(detail::MixtureOperation::TruncateUpper, {{0, upper, 0, 0}});
+    }
+
+    BasicNormalMixture truncate(const BasicNormalRandomVariable<T>& lower, const BasicNormalRandomVariable<T>& upper) const
+    {
+        return transform<1>(detail::MixtureOperation::TruncateBy,
+                {{lower.mean(), lower.variance(), upper.mean(), upper.variance()}});
+    }
+
+    BasicNormalMixture truncateLower(const BasicNormalRandomVariable<T>& lower) const
+    {
+        return transform<1>(detail::MixtureOperation::TruncateLowerBy, {{lower.mean(), lower.variance(), 0, 0}});
+    }
+
+    BasicNormalMixture truncateUpper(const BasicNormalRandomVariable<T>& upper) const
+    {
+        return transform<1>(detail::MixtureOperation::TruncateUpperBy, {{0, 0, upper.mean(), upper.variance()}});
+    }
+
+    /**
+     * Merges components until there are at most the specified number (see detail::mergeMixture), which preserves the
+     * mean and variance of the mixture
+     */
+    void merge(std::size_t components)
+    {
+        std::array<T, 2 * N> costs;
+        size_ = detail::mergeMixture(components_.data(), size_, components == 0 ? 1 : components, costs.data());
+    }
+
+    /**
+     * Removes the components with a weight less than min_weight, keeping at least one component
+     */
+    void prune(T min_weight)
+    {
+        size_ = detail::pruneMixture(components_.data(), size_, min_weight);
+    }
+
+    /**
+     * Addition and subtraction of mixtures, random variables and constants, and multiplication and division by
+     * constants. Sums of 2 mixtures contain every pair of their components, which are then merged
+     */
+    friend BasicNormalMixture operator+(const BasicNormalMixture& mixture1, const BasicNormalMixture& mixture2)
+    {
+        std::array<component_type, N * N> result;
+        std::size_t size = 0;
+        for(const component_type& component1 : mixture1)
+        {
+            for(const component_type& component2 : mixture2)
+            {
+                result[size++] = {component1.weight * component2.weight, component1.mean + component2.mean,
+                        component1.variance + component2.variance};
+            }
+        }
+
+        return BasicNormalMixture(result, size);
+    }
+
+    friend BasicNormalMixture operator-(const BasicNormalMixture& mixture1, const BasicNormalMixture& mixture2)
+    {
+        return mixture1 + -mixture2;
+    }
+
+    friend BasicNormalMixture operator+(BasicNormalMixture mixture, T num)
+    {
+        for(std::size_t i = 0; i < mixture.size_; ++i)
+        {
+            mixture.components_[i].mean += num;
+        }
+
+        return mixture;
+    }
+
+    friend BasicNormalMixture operator+(T num, const BasicNormalMixture& mixture)
+    {
+        return mixture + num;
+    }
+
+    friend BasicNormalMixture operator-(const BasicNormalMixture& mixture, T num)
+    {
+        return mixture + -num;
+    }
+
+    friend BasicNormalMixture operator-(T num, const BasicNormalMixture& mixture)
+    {
+        return -mixture + num;
+    }
+
+    friend BasicNormalMixture operator-(BasicNormalMixture mixture)
+    {
+        for(std::size_t i = 0; i < mixture.size_; ++i)
+        {
+            mixture.components_[i].mean = -mixture.components_[i].mean;
+        }
+
+        return mixture;
+    }
+
+    friend BasicNormalMixture operator*(BasicNormalMixture mixture, T num)
+    {
+        for(std::size_t i = 0; i < mixture.size_; ++i)
+        {
+            mixture.components_[i].mean *= num;
+            mixture.components_[i].variance *= num * num;
+        }
+
+        return mixture;
+    }
+
+    friend BasicNormalMixture operator*(T num, const BasicNormalMixture& mixture)
+    {
+        return mixture * num;
+    }
+
+    friend BasicNormalMixture operator/(const BasicNormalMixture& mixture, T num)
+    {
+        return mixture * (1 / num);
+    }
+
+private:
+    /**
+     * Constructor for a mixture of the first size components, which are merged if there are more than N
+     */
+    template<std::size_t Size>
+    BasicNormalMixture(std::array<component_type, Size>& components, std::size_t size)
+    {
+        std::array<T, 2 * Size> costs;
+        size_ = detail::mergeMixture(components.data(), size, N, costs.data());
+        for(std::size_t i = 0; i < size_; ++i)
+        {
+            components_[i] = components[i];
+        }
+    }
+
+    /**
+     * Applies a rectification or truncation, which produces at most Split components from each component
+     */
+    template<std::size_t Split>
+    BasicNormalMixture transform(detail::MixtureOperation operation, const std::array<T, 4>& parameters) const
+    {
+        std::array<component_type, Split * N> result;
+        std::size_t size = detail::transformMixture(operation, parameters, components_.data(), size_, result.data());
+        return BasicNormalMixture(result, size);
+    }
+
+    std::array<component_type, N> components_;
+    std::size_t size_;
+};
+
+template<class T, std::size_t N>
+constexpr std::size_t BasicNormalMixture<T, N>::capacity;
+
+/**
+ * Mixture of up to 8 normal distributions using double precision
+ */
+typedef BasicNormalMixture<double, 8> NormalMixture;
+
+} // namespace NRV
@@ -1,122 +1,313 @@
 #pragma once
 
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
 namespace NRV {
 
 /**
- * Class that implements an independent normal random variable and various operations
+ * Status returned by the operations that report failures instead of throwing an exception (e.g., tryInverse)
+ * InvalidVariance: The variance of the result is not greater than 0 (or is not a number)
+ * InvalidBounds: The lower bound is not less than the upper bound
+ * InvalidApproximation: The inputs are outside the range of validity of the approximation
+ * OutOfRange: An index is not less than the number of elements (e.g., of tasks in a network)
+ * NotEvaluated: The object has changed since it was last evaluated (e.g., tasks were added to a network)
+ */
+enum class Status : unsigned char {
+    Ok,
+    InvalidVariance,
+    InvalidBounds,
+    InvalidApproximation,
+    OutOfRange,
+    NotEvaluated
+};
+
+/**
+ * Accuracy of the approximations used by an operation, so that, e.g., an inner loop can use Fast and the final
+ * report Exact
+ * Exact: The tails of erf are calculated with erfc, so truncations far into the tails keep their relative accuracy,
+ *        truncation by 2 random variables uses the exact bivariate normal moments instead of truncating by one bound
+ *        after the other, and inverse and division use the asymptotic series of the moments of 1/X
+ * Default: The approximations of the papers (e.g., erf and the lookup table, if enabled), and the only accuracy
+ *          whose results are cached by the memo cache
+ * Fast: erfc is approximated by a short polynomial (relative error 2e-8) that shares the exp of the PDF, max and min
+ *       evaluate it once rather than twice, inverse needs a single division, and division always multiplies by the
+ *       inverse
  */
-class NormalRandomVariable {
+enum class Accuracy : unsigned char {
+    Exact,
+    Default,
+    Fast
+};
+
+template<class T>
+struct TryResult;
+
+template<class T>
+struct TruncationResult;
+
+class MemoryResource;
+
+/**
+ * Class that implements an independent normal random variable and various operations, using the floating point
+ * type T (float, double or long double) for the mean and variance
+ * Note: The operations that are not defined in this header are compiled into the library for float, double and
+ * long double
+ */
+template<class T>
+class BasicNormalRandomVariable {
 public:
+    typedef T value_type;
+
     /**
      * Constructor for a normally distributed random variable with a standard normal distribution
      */
-    NormalRandomVariable();
+    constexpr BasicNormalRandomVariable()
+    : mean_(0), variance_(1)
+    {
+
+    }
 
     /**
      * Constructor for a normally distributed random variable with specified mean and variance
-     * Note: Will throw an exception if variance is not greater than 0
+     * Note: Will throw an exception if variance is not greater than 0 (or fail to compile if used in a constant expression)
      */
-    NormalRandomVariable(double mean, double variance);
+    constexpr BasicNormalRandomVariable(T mean, T variance)
+    : mean_(mean), variance_(variance <= 0 ? throw std::range_error("NormalRandomVariable: Variance must be greater than 0") : variance)
+    {
+
+    }
+
+    /**
+     * Creates a random variable without throwing an exception. The status is InvalidVariance if variance is not
+     * greater than 0
+     */
+    static constexpr TryResult<T> tryCreate(T mean, T variance) noexcept;
 
     /**
      * Get the mean of the random variable
      */
-    double mean() const;
+    constexpr T mean() const
+    {
+        return mean_;
+    }
 
     /**
      * Get the variance of the random variable
      */
-    double variance() const;
+    constexpr T variance() const
+    {
+        return variance_;
+    }
 
     /**
      * Calculates the inverse of the random variable (i.e., 1/X where X is the random variable)
      */
-    NormalRandomVariable inverse() const;
+    BasicNormalRandomVariable inverse(Accuracy accuracy = Accuracy::Default) const;
 
     /**
      * Returns a rectified normal variable between lower and upper bounds
      */
-    NormalRandomVariable rectify(double lower, double upper) const;
+    BasicNormalRandomVariable rectify(T lower, T upper, Accuracy accuracy = Accuracy::Default) const;
 
     /**
      * Returns a rectified normal variable above the lower bound
      */
-    NormalRandomVariable rectifyLower(double lower) const;
+    BasicNormalRandomVariable rectifyLower(T lower, Accuracy accuracy = Accuracy::Default) const;
 
     /**
      * Returns a rectified normal variable below the upper bound
      */
-    NormalRandomVariable rectifyUpper(double upper) const;
+    BasicNormalRandomVariable rectifyUpper(T upper, Accuracy accuracy = Accuracy::Default) const;
 
     /**
      * Returns a truncated normal variable between the lower and upper bounds
      */
-    NormalRandomVariable truncate(double lower, double upper) const;
+    BasicNormalRandomVariable truncate(T lower, T upper, Accuracy accuracy = Accuracy::Default) const;
 
     /**
      * Returns a truncated normal variable above the lower bound
      */
-    NormalRandomVariable truncateLower(double lower) const;
+    BasicNormalRandomVariable truncateLower(T lower, Accuracy accuracy = Accuracy::Default) const;
 
     /**
      * Returns a truncated normal variable under the upper bound
      */
-    NormalRandomVariable truncateUpper(double upper) const;
+    BasicNormalRandomVariable truncateUpper(T upper, Accuracy accuracy = Accuracy::Default) const;
 
     /**
      * Returns a truncated normal variable between the lower and upper bounds
      */
-    NormalRandomVariable truncate(NormalRandomVariable lower, NormalRandomVariable upper) const;
+    BasicNormalRandomVariable truncate(BasicNormalRandomVariable lower, BasicNormalRandomVariable upper,
+            Accuracy accuracy = Accuracy::Default) const;
 
     /**
      * Returns a truncated normal variable above the lower bound
      */
-    NormalRandomVariable truncateLower(NormalRandomVariable lower) const;
+    BasicNormalRandomVariable truncateLower(BasicNormalRandomVariable lower, Accuracy accuracy = Accuracy::Default) const;
 
     /**
      * Returns a truncated normal variable under the upper bound
      */
-    NormalRandomVariable truncateUpper(NormalRandomVariable upper) const;
+    BasicNormalRandomVariable truncateUpper(BasicNormalRandomVariable upper, Accuracy accuracy = Accuracy::Default) const;
+
+    /**
+     * Versions of truncate that also return the probability that the random variable is within the bounds (the
+     * normaliser of the truncated distribution), which is calculated together with the truncated distribution
+     */
+    TruncationResult<T> truncateWithMass(T lower, T upper, Accuracy accuracy = Accuracy::Default) const;
+    TruncationResult<T> truncateLowerWithMass(T lower, Accuracy accuracy = Accuracy::Default) const;
+    TruncationResult<T> truncateUpperWithMass(T upper, Accuracy accuracy = Accuracy::Default) const;
+    TruncationResult<T> truncateWithMass(BasicNormalRandomVariable lower, BasicNormalRandomVariable upper,
+            Accuracy accuracy = Accuracy::Default) const;
+    TruncationResult<T> truncateLowerWithMass(BasicNormalRandomVariable lower, Accuracy accuracy = Accuracy::Default) const;
+    TruncationResult<T> truncateUpperWithMass(BasicNormalRandomVariable upper, Accuracy accuracy = Accuracy::Default) const;
 
     /** 
      * Returns the maximum of itself and random_variable
      */
-    NormalRandomVariable max(NormalRandomVariable random_variable) const;
+    BasicNormalRandomVariable max(BasicNormalRandomVariable random_variable, Accuracy accuracy = Accuracy::Default) const;
 
     /** 
      * Returns the minimum of itself and random_variable
      */
-    NormalRandomVariable min(NormalRandomVariable random_variable) const;
+    BasicNormalRandomVariable min(BasicNormalRandomVariable random_variable, Accuracy accuracy = Accuracy::Default) const;
+
+    /**
+     * Returns the probability density, or the probability that the random variable is at most x (which keeps its
+     * relative accuracy far into the lower tail)
+     */
+    T pdf(T x) const;
+    T cdf(T x) const;
+
+    /**
+     * Returns the value that the random variable is at most with the specified probability (the inverse of cdf)
+     * Note: Will throw an exception if probability is not between 0 and 1 (exclusive)
+     */
+    T quantile(T probability) const;
+
+    /**
+     * Returns the probability that the random variable is less than random_variable (e.g., that a robot arrives
+     * before another robot or a deadline)
+     */
+    T probabilityLessThan(BasicNormalRandomVariable random_variable) const;
+
+    /**
+     * Versions of inverse, rectify and truncate that return a status instead of throwing an exception, including
+     * when the result does not have a valid variance (e.g., truncating far into the tail)
+     */
+    TryResult<T> tryInverse(Accuracy accuracy = Accuracy::Default) const noexcept;
+    TryResult<T> tryRectify(T lower, T upper, Accuracy accuracy = Accuracy::Default) const noexcept;
+    TryResult<T> tryTruncate(T lower, T upper, Accuracy accuracy = Accuracy::Default) const noexcept;
+    TryResult<T> tryTruncateLower(T lower, Accuracy accuracy = Accuracy::Default) const noexcept;
+    TryResult<T> tryTruncateUpper(T upper, Accuracy accuracy = Accuracy::Default) const noexcept;
+    TryResult<T> tryTruncate(BasicNormalRandomVariable lower, BasicNormalRandomVariable upper,
+            Accuracy accuracy = Accuracy::Default) const noexcept;
 
 private:
-    double mean_;
-    double variance_;
+    T mean_;
+    T variance_;
 };
 
+/**
+ * Result of an operation that reports failures instead of throwing an exception. If the operation failed, value
+ * is a standard normal distribution
+ */
+template<class T>
+struct TryResult {
+    BasicNormalRandomVariable<T> value;
+    Status status;
+
+    /**
+     * Returns true if the operation succeeded
+     */
+    constexpr bool ok() const noexcept
+    {
+        return status == Status::Ok;
+    }
+};
+
+/**
+ * Result of a truncation, with the probability mass of the original random variable that is within the bounds. For
+ * bounds that are random variables, this is the probability that the random variable is between them, approximated
+ * in the same way as the truncation
+ */
+template<class T>
+struct TruncationResult {
+    BasicNormalRandomVariable<T> value;
+    T mass;
+};
+
+template<class T>
+constexpr TryResult<T> BasicNormalRandomVariable<T>::tryCreate(T mean, T variance) noexcept
+{
+    return variance > 0 ? TryResult<T>{BasicNormalRandomVariable(mean, variance), Status::Ok}
+            : TryResult<T>{BasicNormalRandomVariable(), Status::InvalidVariance};
+}
+
 /**
  * Addition of 2 random variables, or 1 random variable with a constant
  */
-NormalRandomVariable operator+(const NormalRandomVariable& rv1, const NormalRandomVariable& rv2);
-NormalRandomVariable operator+(const NormalRandomVariable& rv, double num);
-NormalRandomVariable operator+(double num, const NormalRandomVariable& rv);
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator+(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2)
+{
+    return BasicNormalRandomVariable<T>(rv1.mean() + rv2.mean(), rv1.variance() + rv2.variance());
+}
+
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator+(const BasicNormalRandomVariable<T>& rv, typename BasicNormalRandomVariable<T>::value_type num)
+{
+    return BasicNormalRandomVariable<T>(rv.mean() + num, rv.variance());
+}
+
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator+(typename BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv)
+{
+    return rv + num;
+}
 
 /**
  * Subtraction of 2 random variables, or 1 random variable with a constant
  */
-NormalRandomVariable operator-(const NormalRandomVariable& rv1, const NormalRandomVariable& rv2);
-NormalRandomVariable operator-(const NormalRandomVariable& rv, double num);
-NormalRandomVariable operator-(double num, const NormalRandomVariable& rv);
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator-(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2)
+{
+    return BasicNormalRandomVariable<T>(rv1.mean() - rv2.mean(), rv1.variance() + rv2.variance());
+}
+
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator-(const BasicNormalRandomVariable<T>& rv, typename BasicNormalRandomVariable<T>::value_type num)
+{
+    return BasicNormalRandomVariable<T>(rv.mean() - num, rv.variance());
+}
+
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator-(typename BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv)
+{
+    return BasicNormalRandomVariable<T>(num - rv.mean(), rv.variance());
+}
 
 /**
  * Negation
  */
-NormalRandomVariable operator-(const NormalRandomVariable& rv);
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator-(const BasicNormalRandomVariable<T>& rv)
+{
+    return BasicNormalRandomVariable<T>(-rv.mean(), rv.variance());
+}
 
 /**
  * Division of random variable with a constant
  */
-NormalRandomVariable operator/(const NormalRandomVariable& rv, double num);
-NormalRandomVariable operator/(double num, const NormalRandomVariable& rv);
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator/(const BasicNormalRandomVariable<T>& rv, typename BasicNormalRandomVariable<T>::value_type num)
+{
+    return BasicNormalRandomVariable<T>(rv.mean() / num, rv.variance() / (num * num));
+}
+
+template<class T>
+BasicNormalRandomVariable<T> operator/(typename BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv);
 
 /**
  * Division of 2 random variables
@@ -124,17 +315,111 @@ NormalRandomVariable operator/(double num, const NormalRandomVariable& rv);
  * rules (i.e., when the variance of rv1 becomes too small), the distribution approaches
  * simply division of the mean of rv1 by the random variable rv2. 
  */
-NormalRandomVariable operator/(const NormalRandomVariable& rv1, const NormalRandomVariable& rv2);
+template<class T>
+BasicNormalRandomVariable<T> operator/(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2);
+
+/**
+ * Versions of division by a random variable with the approximations of accuracy (operator/ uses Accuracy::Default)
+ * Note: Except with Default, rv1 is always multiplied by the inverse of rv2, so the mean of rv2 must be at least 4
+ * standard deviations from 0
+ */
+template<class T>
+BasicNormalRandomVariable<T> divide(typename BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv, Accuracy accuracy);
+
+template<class T>
+BasicNormalRandomVariable<T> divide(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2, Accuracy accuracy);
 
 /**
  * Multiplication of random variable with a constant
  */
-NormalRandomVariable operator*(const NormalRandomVariable& rv, double num);
-NormalRandomVariable operator*(double num, const NormalRandomVariable& rv);
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator*(const BasicNormalRandomVariable<T>& rv, typename BasicNormalRandomVariable<T>::value_type num)
+{
+    return BasicNormalRandomVariable<T>(rv.mean() * num, rv.variance() * (num * num));
+}
+
+template<class T>
+constexpr BasicNormalRandomVariable<T> operator*(typename BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv)
+{
+    return BasicNormalRandomVariable<T>(rv.mean() * num, rv.variance() * (num * num));
+}
 
 /**
  * Multiplication of 2 random variables
  */
-NormalRandomVariable operator*(const NormalRandomVariable& rv1, const NormalRandomVariable& rv2);
+template<class T>
+BasicNormalRandomVariable<T> operator*(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2);
+
+/**
+ * Versions of division that return a status instead of throwing an exception
+ */
+template<class T>
+constexpr TryResult<T> tryDivide(const BasicNormalRandomVariable<T>& rv, typename BasicNormalRandomVariable<T>::value_type num) noexcept
+{
+    return BasicNormalRandomVariable<T>::tryCreate(rv.mean() / num, rv.variance() / (num * num));
+}
+
+template<class T>
+TryResult<T> tryDivide(typename BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv,
+        Accuracy accuracy = Accuracy::Default) noexcept;
+
+template<class T>
+TryResult<T> tryDivide(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2,
+        Accuracy accuracy = Accuracy::Default) noexcept;
+
+/**
+ * Maximum and minimum of size random variables (e.g., the latest of many arrival times). Rather than chaining
+ * max or min in the order given, the random variables are combined in order of increasing variance, which is
+ * typically the most accurate order, and large inputs are reduced in parallel
+ * Note: Will throw an exception if there are no random variables
+ */
+template<class T>
+BasicNormalRandomVariable<T> max(const BasicNormalRandomVariable<T>* random_variables, std::size_t size);
+
+template<class T>
+BasicNormalRandomVariable<T> min(const BasicNormalRandomVariable<T>* random_variables, std::size_t size);
+
+template<class T>
+BasicNormalRandomVariable<T> max(const std::vector<BasicNormalRandomVariable<T>>& random_variables)
+{
+    return max(random_variables.data(), random_variables.size());
+}
+
+template<class T>
+BasicNormalRandomVariable<T> min(const std::vector<BasicNormalRandomVariable<T>>& random_variables)
+{
+    return min(random_variables.data(), random_variables.size());
+}
+
+/**
+ * Versions of max and min that allocate their storage for the inputs from resource (e.g., an Arena, see
+ * MemoryResource.h) instead of the default resource
+ */
+template<class T>
+BasicNormalRandomVariable<T> max(const BasicNormalRandomVariable<T>* random_variables, std::size_t size,
+        MemoryResource* resource);
+
+template<class T>
+BasicNormalRandomVariable<T> min(const BasicNormalRandomVariable<T>* random_variables, std::size_t size,
+        MemoryResource* resource);
+
+template<class T>
+BasicNormalRandomVariable<T> max(const std::vector<BasicNormalRandomVariable<T>>& random_variables,
+        MemoryResource* resource)
+{
+    return max(random_variables.data(), random_variables.size(), resource);
+}
+
+template<class T>
+BasicNormalRandomVariable<T> min(const std::vector<BasicNormalRandomVariable<T>>& random_variables,
+        MemoryResource* resource)
+{
+    return min(random_variables.data(), random_variables.size(), resource);
+}
+
+/**
+ * Normal random variable using double precision
+ */
+typedef BasicNormalRandomVariable<double> NormalRandomVariable;
 
 } // namespace NRV
\ No newline at end of file
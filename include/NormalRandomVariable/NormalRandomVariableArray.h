@@ -0,0 +1,357 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "MemoryResource.h"
+#include "NormalRandomVariable.h"
+
+namespace NRV {
+
+/**
+ * Class that stores an array of independent normal random variables as contiguous arrays of means and
+ * variances (structure of arrays) of type T (float, double or long double), and implements element-wise versions of
+ * the NormalRandomVariable operations
+ * Note: Unlike NormalRandomVariable, the element-wise operations do not check that the resulting variances are
+ * greater than 0 or that each element is within the range of validity of the approximation. It is up to the user
+ * to ensure that the inputs are valid, otherwise the affected elements will contain invalid values (e.g., NaN)
+ * The operations are compiled into the library for float, double and long double, and only double uses the
+ * vectorised batch operations (see Simd.h)
+ * The storage can be allocated from a MemoryResource, and each operation has a version that writes to an existing
+ * array, so a loop that reuses its arrays does not allocate. Copies, and the arrays returned by the operations, use
+ * the default resource (see Allocator)
+ */
+template<class T>
+class BasicNormalRandomVariableArray {
+public:
+    typedef T value_type;
+
+    /**
+     * Constructor for an empty array
+     */
+    BasicNormalRandomVariableArray();
+
+    /**
+     * Constructor for an array of size random variables with a standard normal distribution
+     */
+    explicit BasicNormalRandomVariableArray(std::size_t size);
+
+    /**
+     * Constructors for an empty array, or an array of size random variables with a standard normal distribution, that
+     * allocate their storage from resource, which must outlive the array
+     */
+    explicit BasicNormalRandomVariableArray(MemoryResource* resource);
+    BasicNormalRandomVariableArray(std::size_t size, MemoryResource* resource);
+
+    /**
+     * Constructor for an array with the specified means and variances
+     * Note: Will throw an exception if the sizes do not match or any variance is not greater than 0
+     */
+    BasicNormalRandomVariableArray(std::vector<T> means, std::vector<T> variances);
+
+    /**
+     * Constructor for an array containing copies of the random variables
+     */
+    explicit BasicNormalRandomVariableArray(const std::vector<BasicNormalRandomVariable<T>>& random_variables);
+
+    /**
+     * Get the resource the storage is allocated from
+     */
+    MemoryResource* resource() const;
+
+    /**
+     * Get the number of random variables in the array
+     */
+    std::size_t size() const;
+
+    /**
+     * Returns true if the array contains no random variables
+     */
+    bool empty() const;
+
+    /**
+     * Resizes the array. Any new random variables have a standard normal distribution
+     */
+    void resize(std::size_t size);
+
+    /**
+     * Reserves storage for at least size random variables
+     */
+    void reserve(std::size_t size);
+
+    /**
+     * Appends a random variable to the end of the array
+     */
+    void push_back(const BasicNormalRandomVariable<T>& random_variable);
+
+    /**
+     * Get the random variable at index. Will throw an exception if the index is out of range or the element
+     * does not have a valid variance
+     */
+    BasicNormalRandomVariable<T> at(std::size_t index) const;
+
+    /**
+     * Get the random variable at index without bounds checking
+     */
+    BasicNormalRandomVariable<T> operator[](std::size_t index) const;
+
+    /**
+     * Replace the random variable at index (without bounds checking)
+     */
+    void set(std::size_t index, const BasicNormalRandomVariable<T>& random_variable);
+
+    /**
+     * Access to the contiguous array of means
+     */
+    const T* means() const;
+    T* means();
+
+    /**
+     * Access to the contiguous array of variances
+     */
+    const T* variances() const;
+    T* variances();
+
+    /**
+     * Converts the array to a vector of random variables
+     * Note: Will throw an exception if any element does not have a valid variance
+     */
+    std::vector<BasicNormalRandomVariable<T>> toVector() const;
+
+    /**
+     * Element-wise inverse (see NormalRandomVariable::inverse)
+     */
+    BasicNormalRandomVariableArray inverse() const;
+
+    /**
+     * Element-wise rectification (see NormalRandomVariable::rectify)
+     * Note: Will throw an exception if lower is not less than upper
+     */
+    BasicNormalRandomVariableArray rectify(T lower, T upper) const;
+    BasicNormalRandomVariableArray rectifyLower(T lower) const;
+    BasicNormalRandomVariableArray rectifyUpper(T upper) const;
+
+    /**
+     * Element-wise truncation with scalar bounds (see NormalRandomVariable::truncate)
+     * Note: Will throw an exception if lower is not less than upper
+     */
+    BasicNormalRandomVariableArray truncate(T lower, T upper) const;
+    BasicNormalRandomVariableArray truncateLower(T lower) const;
+    BasicNormalRandomVariableArray truncateUpper(T upper) const;
+
+    /**
+     * Element-wise truncation where element i is truncated by element i of the bounds
+     * Note: Will throw an exception if the sizes do not match
+     */
+    BasicNormalRandomVariableArray truncate(const BasicNormalRandomVariableArray& lower, const BasicNormalRandomVariableArray& upper) const;
+    BasicNormalRandomVariableArray truncateLower(const BasicNormalRandomVariableArray& lower) const;
+    BasicNormalRandomVariableArray truncateUpper(const BasicNormalRandomVariableArray& upper) const;
+
+    /**
+     * Element-wise maximum and minimum
+     * Note: Will throw an exception if the sizes do not match
+     */
+    BasicNormalRandomVariableArray max(const BasicNormalRandomVariableArray& random_variables) const;
+    BasicNormalRandomVariableArray min(const BasicNormalRandomVariableArray& random_variables) const;
+
+    /**
+     * Element-wise probability queries (see NormalRandomVariable::cdf, quantile and probabilityLessThan), where
+     * probabilityLessThan compares element i with element i of random_variables
+     * Note: Will throw an exception if probability is not between 0 and 1 (exclusive), or the sizes do not match
+     */
+    std::vector<T> cdf(T x) const;
+    std::vector<T> quantile(T probability) const;
+    std::vector<T> probabilityLessThan(const BasicNormalRandomVariableArray& random_variables) const;
+
+    /**
+     * Element-wise versions of inverse, rectify and truncate that report failures in status instead of throwing an
+     * exception or producing invalid elements (see tryInverse etc. in NormalRandomVariable). status is resized to
+     * the size of the array, and the elements that fail are set to a standard normal distribution
+     * Note: Will still throw an exception if the sizes of the arrays do not match
+     */
+    BasicNormalRandomVariableArray tryInverse(std::vector<Status>& status) const;
+    BasicNormalRandomVariableArray tryRectify(T lower, T upper, std::vector<Status>& status) const;
+    BasicNormalRandomVariableArray tryTruncate(T lower, T upper, std::vector<Status>& status) const;
+    BasicNormalRandomVariableArray tryTruncateLower(T lower, std::vector<Status>& status) const;
+    BasicNormalRandomVariableArray tryTruncateUpper(T upper, std::vector<Status>& status) const;
+    BasicNormalRandomVariableArray tryTruncate(const BasicNormalRandomVariableArray& lower, const BasicNormalRandomVariableArray& upper,
+            std::vector<Status>& status) const;
+
+    /**
+     * Versions of the element-wise operations that write to result instead of returning a new array. result is
+     * resized to the size of the array, so reusing a result that has the storage for it does not allocate, and it
+     * may be this array or one of the arguments
+     */
+    void inverse(BasicNormalRandomVariableArray& result) const;
+    void rectify(T lower, T upper, BasicNormalRandomVariableArray& result) const;
+    void rectifyLower(T lower, BasicNormalRandomVariableArray& result) const;
+    void rectifyUpper(T upper, BasicNormalRandomVariableArray& result) const;
+    void truncate(T lower, T upper, BasicNormalRandomVariableArray& result) const;
+    void truncateLower(T lower, BasicNormalRandomVariableArray& result) const;
+    void truncateUpper(T upper, BasicNormalRandomVariableArray& result) const;
+    void truncate(const BasicNormalRandomVariableArray& lower, const BasicNormalRandomVariableArray& upper,
+            BasicNormalRandomVariableArray& result) const;
+    void truncateLower(const BasicNormalRandomVariableArray& lower, BasicNormalRandomVariableArray& result) const;
+    void truncateUpper(const BasicNormalRandomVariableArray& upper, BasicNormalRandomVariableArray& result) const;
+    void max(const BasicNormalRandomVariableArray& random_variables, BasicNormalRandomVariableArray& result) const;
+    void min(const BasicNormalRandomVariableArray& random_variables, BasicNormalRandomVariableArray& result) const;
+    void cdf(T x, std::vector<T>& result) const;
+    void quantile(T probability, std::vector<T>& result) const;
+    void probabilityLessThan(const BasicNormalRandomVariableArray& random_variables, std::vector<T>& result) const;
+    void tryInverse(std::vector<Status>& status, BasicNormalRandomVariableArray& result) const;
+    void tryRectify(T lower, T upper, std::vector<Status>& status, BasicNormalRandomVariableArray& result) const;
+    void tryTruncate(T lower, T upper, std::vector<Status>& status, BasicNormalRandomVariableArray& result) const;
+    void tryTruncateLower(T lower, std::vector<Status>& status, BasicNormalRandomVariableArray& result) const;
+    void tryTruncateUpper(T upper, std::vector<Status>& status, BasicNormalRandomVariableArray& result) const;
+    void tryTruncate(const BasicNormalRandomVariableArray& lower, const BasicNormalRandomVariableArray& upper,
+            std::vector<Status>& status, BasicNormalRandomVariableArray& result) const;
+
+private:
+    std::vector<T, Allocator<T>> means_;
+    std::vector<T, Allocator<T>> variances_;
+};
+
+/**
+ * Element-wise addition of 2 arrays, or an array with a constant
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> operator+(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+template<class T>
+BasicNormalRandomVariableArray<T> operator+(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num);
+template<class T>
+BasicNormalRandomVariableArray<T> operator+(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv);
+
+/**
+ * Element-wise subtraction of 2 arrays, or an array with a constant
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> operator-(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+template<class T>
+BasicNormalRandomVariableArray<T> operator-(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num);
+template<class T>
+BasicNormalRandomVariableArray<T> operator-(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv);
+
+/**
+ * Element-wise negation
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> operator-(const BasicNormalRandomVariableArray<T>& rv);
+
+/**
+ * Element-wise division of an array with a constant
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> operator/(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num);
+template<class T>
+BasicNormalRandomVariableArray<T> operator/(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv);
+
+/**
+ * Element-wise division of 2 arrays (see operator/ for NormalRandomVariable)
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> operator/(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+
+/**
+ * Element-wise multiplication of an array with a constant
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> operator*(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num);
+template<class T>
+BasicNormalRandomVariableArray<T> operator*(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv);
+
+/**
+ * Element-wise multiplication of 2 arrays
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> operator*(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+
+/**
+ * Versions of the arithmetic operators that write to result (see the versions of the element-wise operations that
+ * write to result), where negate is the unary operator-
+ * Note: Will throw an exception if the sizes do not match
+ */
+template<class T>
+void add(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void add(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num,
+        BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void subtract(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void subtract(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num,
+        BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void subtract(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv,
+        BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void negate(const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void multiply(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void multiply(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num,
+        BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void divide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void divide(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num,
+        BasicNormalRandomVariableArray<T>& result);
+template<class T>
+void divide(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv,
+        BasicNormalRandomVariableArray<T>& result);
+
+/**
+ * Element-wise division of 2 arrays that reports failures in status instead of producing invalid elements (see
+ * tryDivide for NormalRandomVariable). Like operator/, elements outside the range of validity of the division
+ * approximation multiply by the inverse, but where the inverse is not valid either, tryDivide reports
+ * InvalidApproximation (and sets the element to a standard normal distribution) instead of producing an invalid element
+ * Note: Will throw an exception if the sizes do not match
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> tryDivide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        std::vector<Status>& status);
+
+template<class T>
+void tryDivide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        std::vector<Status>& status, BasicNormalRandomVariableArray<T>& result);
+
+/**
+ * Probability that each random variable of rv1 is less than each random variable of rv2 (e.g., that each robot
+ * arrives before each other robot), which is written to result[i * rv2.size() + j] for element i of rv1 and element
+ * j of rv2. result must have space for rv1.size() * rv2.size() values. rv2 is processed in tiles that stay in the
+ * cache while they are compared with every element of rv1
+ */
+template<class T>
+void pairwiseProbabilityLessThan(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        T* result);
+
+/**
+ * Maximum and minimum of all of the random variables in the array (see max and min of a vector of
+ * NormalRandomVariable)
+ * Note: Will throw an exception if the array is empty
+ */
+template<class T>
+BasicNormalRandomVariable<T> max(const BasicNormalRandomVariableArray<T>& random_variables);
+
+template<class T>
+BasicNormalRandomVariable<T> min(const BasicNormalRandomVariableArray<T>& random_variables);
+
+/**
+ * Versions of max and min that allocate their storage for the inputs from resource (e.g., an Arena) instead of the
+ * default resource
+ */
+template<class T>
+BasicNormalRandomVariable<T> max(const BasicNormalRandomVariableArray<T>& random_variables, MemoryResource* resource);
+
+template<class T>
+BasicNormalRandomVariable<T> min(const BasicNormalRandomVariableArray<T>& random_variables, MemoryResource* resource);
+
+/**
+ * Array of normal random variables using double precision
+ */
+typedef BasicNormalRandomVariableArray<double> NormalRandomVariableArray;
+
+} // namespace NRV
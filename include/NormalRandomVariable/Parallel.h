@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+
+#include "NormalRandomVariableArray.h"
+
+namespace NRV {
+
+/**
+ * Multi-threaded versions of the element-wise operations of BasicNormalRandomVariableArray, for large arrays (e.g.,
+ * millions of candidates). The arrays are split into chunks of chunk_size elements, which are shared out between
+ * the threads in contiguous ranges, and threads that run out of chunks steal half of the remaining chunks of
+ * another thread. Each element is calculated with the same kernel as the array operation, so the results are
+ * identical to the serial operation whatever the number of threads
+ * Note: As with BasicNormalRandomVariableArray, the results are not checked, and the functions will throw an
+ * exception if the sizes of the arrays do not match or the bounds are invalid
+ */
+namespace parallel {
+
+/**
+ * Number of elements in each chunk. The inputs and results of a chunk of a binary operation fit in the L2 cache
+ */
+constexpr std::size_t chunk_size = 2048;
+
+/**
+ * Get or set the number of threads used by the operations. The default of 0 uses one thread per hardware thread
+ */
+unsigned int threads();
+void setThreads(unsigned int threads);
+
+/**
+ * Element-wise inverse, rectification and truncation with scalar bounds
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> inverse(const BasicNormalRandomVariableArray<T>& rv);
+
+template<class T>
+BasicNormalRandomVariableArray<T> rectify(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, typename BasicNormalRandomVariableArray<T>::value_type upper);
+
+template<class T>
+BasicNormalRandomVariableArray<T> rectifyLower(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower);
+
+template<class T>
+BasicNormalRandomVariableArray<T> rectifyUpper(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type upper);
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncate(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, typename BasicNormalRandomVariableArray<T>::value_type upper);
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncateLower(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower);
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncateUpper(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type upper);
+
+/**
+ * Element-wise truncation where element i is truncated by element i of the bounds
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> truncate(const BasicNormalRandomVariableArray<T>& rv,
+        const BasicNormalRandomVariableArray<T>& lower, const BasicNormalRandomVariableArray<T>& upper);
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncateLower(const BasicNormalRandomVariableArray<T>& rv,
+        const BasicNormalRandomVariableArray<T>& lower);
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncateUpper(const BasicNormalRandomVariableArray<T>& rv,
+        const BasicNormalRandomVariableArray<T>& upper);
+
+/**
+ * Element-wise maximum and minimum
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> max(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+
+template<class T>
+BasicNormalRandomVariableArray<T> min(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+
+/**
+ * Element-wise addition, subtraction, multiplication and division of 2 arrays (see the corresponding operators)
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> add(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+
+template<class T>
+BasicNormalRandomVariableArray<T> subtract(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+
+template<class T>
+BasicNormalRandomVariableArray<T> multiply(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+
+template<class T>
+BasicNormalRandomVariableArray<T> divide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2);
+
+/**
+ * Versions of the operations that write to result (see the versions of the element-wise operations of
+ * BasicNormalRandomVariableArray that write to result). Reusing result does not allocate its storage, although
+ * starting the threads still allocates when more than one thread is used
+ */
+template<class T>
+void inverse(const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void rectify(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type lower,
+        typename BasicNormalRandomVariableArray<T>::value_type upper, BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void rectifyLower(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void rectifyUpper(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type upper, BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void truncate(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type lower,
+        typename BasicNormalRandomVariableArray<T>::value_type upper, BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void truncateLower(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void truncateUpper(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type upper, BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void truncate(const BasicNormalRandomVariableArray<T>& rv, const BasicNormalRandomVariableArray<T>& lower,
+        const BasicNormalRandomVariableArray<T>& upper, BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void truncateLower(const BasicNormalRandomVariableArray<T>& rv, const BasicNormalRandomVariableArray<T>& lower,
+        BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void truncateUpper(const BasicNormalRandomVariableArray<T>& rv, const BasicNormalRandomVariableArray<T>& upper,
+        BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void max(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void min(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void add(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void subtract(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void multiply(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+
+template<class T>
+void divide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result);
+
+/**
+ * Probability that each random variable of rv1 is less than each random variable of rv2 (see
+ * NRV::pairwiseProbabilityLessThan). The matrix is split into chunks of chunk_size consecutive results
+ */
+template<class T>
+void pairwiseProbabilityLessThan(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        T* result);
+
+} // namespace parallel
+} // namespace NRV
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "NormalRandomVariable.h"
+#include "NormalRandomVariableArray.h"
+
+namespace NRV {
+
+/**
+ * Binary format for random variables, which is the same on every platform (little-endian IEEE 754)
+ * - A single random variable is 16 bytes: the mean and then the variance as 64-bit floats
+ * - An array starts with a 64-byte header (the magic bytes "NRVA", the format version as a 16-bit integer, the
+ *   encoding as an 8-bit integer, 1 reserved byte, then the number of random variables and the offsets of the means
+ *   and variances in bytes as 64-bit integers, and zeros). The means and then the variances follow as contiguous
+ *   arrays, each starting at a multiple of 64 bytes, so that they are aligned for the batch operations if the
+ *   buffer is (e.g., a memory-mapped file)
+ */
+constexpr std::uint16_t serialization_version = 1;
+constexpr std::size_t serialization_alignment = 64;
+constexpr std::size_t serialized_random_variable_size = 16;
+
+/**
+ * Encoding of the means and variances of an array. Float32 halves the size, at the cost of rounding to single
+ * precision (and variances below the smallest float become 0)
+ */
+enum class Encoding : std::uint8_t {
+    Float64 = 1,
+    Float32 = 2
+};
+
+/**
+ * Writes random_variable to the 16 bytes at buffer, or reads it back
+ * Note: Reading will throw an exception if the variance is not greater than 0
+ */
+template<class T>
+void serialize(const BasicNormalRandomVariable<T>& random_variable, void* buffer);
+
+template<class T = double>
+BasicNormalRandomVariable<T> deserializeRandomVariable(const void* data);
+
+/**
+ * Get the number of bytes needed to serialize an array of size random variables (a multiple of 64)
+ */
+std::size_t serializedSize(std::size_t size, Encoding encoding = Encoding::Float64);
+
+/**
+ * Writes random_variables to buffer, returning the number of bytes written (see serializedSize)
+ * Note: Will throw an exception if buffer_size is too small
+ */
+template<class T>
+std::size_t serialize(const BasicNormalRandomVariableArray<T>& random_variables, void* buffer, std::size_t buffer_size,
+        Encoding encoding = Encoding::Float64);
+
+/**
+ * Returns random_variables serialized into a new buffer
+ */
+template<class T>
+std::vector<unsigned char> serialize(const BasicNormalRandomVariableArray<T>& random_variables,
+        Encoding encoding = Encoding::Float64);
+
+/**
+ * Read-only view of a serialized array, which reads the random variables from the buffer without copying them
+ * - If the means and variances are stored as Float64 on a little-endian platform at suitably aligned addresses,
+ *   means() and variances() point directly into the buffer, and the batch operations read it directly
+ * - Otherwise, the random variables are decoded as they are used
+ * Note: The buffer must outlive the view, and its contents are not checked (as with BasicNormalRandomVariableArray,
+ * invalid elements produce invalid results)
+ */
+class SerializedArrayView {
+public:
+    /**
+     * Constructor for a view of the size bytes at data
+     * Note: Will throw an exception if the header is not valid, the version is not supported, or the buffer is too
+     * small for the arrays
+     */
+    SerializedArrayView(const void* data, std::size_t size);
+
+    /**
+     * Get the number of random variables, and their encoding
+     */
+    std::size_t size() const;
+    Encoding encoding() const;
+
+    /**
+     * Returns true if means() and variances() can be used (i.e., the data does not need to be decoded)
+     */
+    bool zeroCopy() const;
+
+    /**
+     * Get the contiguous arrays of means and variances in the buffer
+     * Note: Will throw an exception if zeroCopy() is false
+     */
+    const double* means() const;
+    const double* variances() const;
+
+    /**
+     * Get the random variable at index (without bounds checking)
+     */
+    BasicNormalRandomVariable<double> operator[](std::size_t index) const;
+
+    /**
+     * Copies the random variables into an array
+     */
+    template<class T>
+    BasicNormalRandomVariableArray<T> toArray() const;
+
+    /**
+     * Batch operations (see the corresponding operations of BasicNormalRandomVariableArray) that read the buffer
+     * directly if zeroCopy() is true
+     */
+    NormalRandomVariableArray rectify(double lower, double upper) const;
+    NormalRandomVariableArray rectifyLower(double lower) const;
+    NormalRandomVariableArray rectifyUpper(double upper) const;
+    NormalRandomVariableArray truncate(double lower, double upper) const;
+    NormalRandomVariableArray truncateLower(double lower) const;
+    NormalRandomVariableArray truncateUpper(double upper) const;
+    NormalRandomVariableArray max(const SerializedArrayView& random_variables) const;
+    NormalRandomVariableArray min(const SerializedArrayView& random_variables) const;
+
+private:
+    std::size_t size_;
+    Encoding encoding_;
+    const unsigned char* means_;
+    const unsigned char* variances_;
+    bool zero_copy_;
+};
+
+/**
+ * Reads a serialized array into a new array
+ * Note: Will throw an exception if the data is not a valid serialized array
+ */
+template<class T>
+BasicNormalRandomVariableArray<T> deserialize(const void* data, std::size_t size)
+{
+    return SerializedArrayView(data, size).toArray<T>();
+}
+
+} // namespace NRV
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace NRV {
+
+/**
+ * Instruction sets that the batch operations of NormalRandomVariableArray (truncate, truncateLower, truncateUpper,
+ * rectify, rectifyLower, rectifyUpper, max, min, cdf, probabilityLessThan and pairwiseProbabilityLessThan) can use
+ * Scalar: calculates each element with std::erf and std::exp, giving the same result as NormalRandomVariable
+ * SSE2, AVX2, AVX512: calculates 2, 4 or 8 elements at a time using vectorised approximations of exp (within a
+ * few ulp) and erfc (relative error below 1e-14 for |x| < 6). The results typically agree with Scalar to around
+ * 1e-13, but can differ by more far into the tails, where these kernels are more accurate than 1 - std::erf
+ */
+enum class InstructionSet {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+/**
+ * Get the instruction set currently used by the batch operations. By default this is the best instruction set
+ * supported by the processor, which is detected at runtime
+ */
+InstructionSet activeInstructionSet();
+
+/**
+ * Returns true if the library was built with support for the instruction set and the processor supports it
+ */
+bool instructionSetSupported(InstructionSet instruction_set);
+
+/**
+ * Set the instruction set used by the batch operations (e.g., Scalar for results identical to NormalRandomVariable)
+ * Note: Will throw an exception if the instruction set is not supported
+ */
+void setInstructionSet(InstructionSet instruction_set);
+
+} // namespace NRV
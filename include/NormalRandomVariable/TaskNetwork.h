@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "MemoryResource.h"
+#include "NormalRandomVariable.h"
+
+namespace NRV {
+
+namespace detail {
+template<class T>
+struct Moments;
+} // namespace detail
+
+/**
+ * Class that evaluates the completion times of a network of tasks with normally distributed durations (PERT). Each
+ * task starts when all of its predecessors have completed, so its completion time is the maximum of the completion
+ * times of its predecessors (see max of many random variables) plus its duration
+ * - Tasks and dependencies are stored in flat arrays indexed by task, and are converted to compressed rows of
+ *   predecessors sorted into topological levels when the network is evaluated
+ * - The tasks in each level only depend on earlier levels, so large levels are split into chunks that are evaluated
+ *   in parallel. Each task is calculated the same way on any thread, so the results do not depend on the number of
+ *   threads
+ * - Changing the durations does not require the levels to be recalculated
+ * - All of the storage (including the storage used to find the levels and the storage of each thread) is allocated
+ *   from a MemoryResource, and clear keeps it, so rebuilding a network of the same size does not allocate from it
+ *   again. Starting the threads of large levels still allocates the state of each thread (see std::thread)
+ * Note: Completion times are approximated as independent, as with the other operations of BasicNormalRandomVariable
+ */
+template<class T>
+class BasicTaskNetwork {
+public:
+    typedef T value_type;
+
+    /**
+     * Number of tasks in each chunk of a level that is evaluated on one thread. Levels with fewer tasks than this
+     * are evaluated on the calling thread
+     */
+    static constexpr std::size_t chunk_size = 1024;
+
+    /**
+     * Constructor for a network that is evaluated on threads threads (or one per hardware thread if threads is 0)
+     */
+    explicit BasicTaskNetwork(unsigned int threads = 0);
+
+    /**
+     * Constructor for a network that allocates its storage from resource, which must outlive the network
+     */
+    BasicTaskNetwork(unsigned int threads, MemoryResource* resource);
+
+    /**
+     * Copies use the default resource (see Allocator). These are compiled into the library, since the storage uses
+     * types that are only defined there
+     */
+    BasicTaskNetwork(const BasicTaskNetwork& network);
+    BasicTaskNetwork(BasicTaskNetwork&& network) noexcept;
+    ~BasicTaskNetwork();
+    BasicTaskNetwork& operator=(const BasicTaskNetwork& network);
+    BasicTaskNetwork& operator=(BasicTaskNetwork&& network);
+
+    /**
+     * Reserves storage for the specified number of tasks and dependencies
+     */
+    void reserve(std::size_t tasks, std::size_t dependencies);
+
+    /**
+     * Removes all of the tasks and dependencies, keeping the allocated storage
+     */
+    void clear();
+
+    /**
+     * Adds a task with the specified duration, and returns its index
+     * Note: Will throw an exception if the network already has the maximum number of tasks (2^32 - 1)
+     */
+    std::size_t addTask(const BasicNormalRandomVariable<T>& duration);
+
+    /**
+     * Adds a dependency so that successor starts after predecessor has completed. Repeated dependencies are ignored
+     * Note: Will throw an exception if either task does not exist or they are the same task
+     */
+    void addDependency(std::size_t predecessor, std::size_t successor);
+
+    /**
+     * Get or change the duration of a task
+     */
+    BasicNormalRandomVariable<T> duration(std::size_t task) const;
+    void setDuration(std::size_t task, const BasicNormalRandomVariable<T>& duration);
+
+    /**
+     * Calculates the completion times of all of the tasks
+     * Note: Will throw an exception if the dependencies contain a cycle
+     */
+    void evaluate();
+
+    /**
+     * Get the completion time of a task calculated by the last evaluation
+     * Note: Will throw an exception if the network has changed since it was evaluated or the completion time does not
+     * have a valid variance
+     */
+    BasicNormalRandomVariable<T> completion(std::size_t task) const;
+
+    /**
+     * Version of completion that returns a status instead of throwing an exception (OutOfRange if task is not a task
+     * of the network, NotEvaluated if the network has changed since it was evaluated, or InvalidVariance)
+     */
+    TryResult<T> tryCompletion(std::size_t task) const noexcept;
+
+    /**
+     * Get the maximum of the completion times of the tasks without successors (i.e., the completion time of the
+     * project)
+     * Note: Will throw an exception if the network is empty or has changed since it was evaluated
+     */
+    BasicNormalRandomVariable<T> makespan() const;
+
+    /**
+     * Get the number of tasks and (distinct) dependencies
+     */
+    std::size_t size() const;
+    std::size_t dependencies() const;
+
+    /**
+     * Get the number of topological levels (i.e., the largest number of tasks on any path through the network)
+     * Note: Only valid once the network has been evaluated
+     */
+    std::size_t levels() const;
+
+    /**
+     * Get the number of threads that are used
+     */
+    unsigned int threads() const;
+
+private:
+    template<class U>
+    using Vector = std::vector<U, Allocator<U>>;
+
+    /**
+     * Storage for the threads of a level, which are joined before evaluate returns, so copies and moves only keep
+     * the resource
+     */
+    struct Workers : Vector<std::thread> {
+        explicit Workers(MemoryResource* resource) : Vector<std::thread>(resource) {}
+        Workers(const Workers&) : Vector<std::thread>() {}
+        Workers(Workers&& workers) noexcept : Vector<std::thread>(workers.get_allocator()) {}
+        Workers& operator=(const Workers&) { return *this; }
+        Workers& operator=(Workers&&) { return *this; }
+    };
+
+    /**
+     * Converts the dependencies to compressed rows of predecessors, and sorts the tasks into topological levels
+     */
+    void build();
+
+    /**
+     * Calculates the completion times of the tasks at positions first to last of order_, using moments as storage
+     */
+    void calculate(std::size_t first, std::size_t last, Vector<detail::Moments<T>>& moments);
+
+    /**
+     * Calculates the completion times of the tasks in each level, evaluating large levels in parallel
+     */
+    void calculateLevels();
+
+    /**
+     * Throws an exception if task does not exist, or the completion times have not been calculated
+     */
+    void checkTask(std::size_t task) const;
+    void checkEvaluated() const;
+
+    unsigned int threads_;
+
+    // Durations of the tasks
+    Vector<T> means_;
+    Vector<T> variances_;
+
+    // Dependencies in the order they were added
+    Vector<std::uint32_t> edge_predecessors_;
+    Vector<std::uint32_t> edge_successors_;
+
+    // Predecessors of each task, in rows given by predecessor_offsets_
+    Vector<std::uint32_t> predecessor_offsets_;
+    Vector<std::uint32_t> predecessors_;
+
+    // Tasks sorted by level (and by index within each level), in levels given by level_offsets_
+    Vector<std::uint32_t> order_;
+    Vector<std::uint32_t> level_offsets_;
+
+    // Tasks without successors, and the largest number of predecessors of any task
+    Vector<std::uint32_t> sinks_;
+    std::size_t max_predecessors_;
+
+    // Storage for build: rows of successors, the next position in each row or level, the number of predecessors
+    // of each task that have not been levelled, the level of each task, and the queue of levelled tasks
+    Vector<std::uint32_t> successor_offsets_;
+    Vector<std::uint32_t> successors_;
+    Vector<std::uint32_t> positions_;
+    Vector<std::uint32_t> remaining_;
+    Vector<std::uint32_t> task_levels_;
+    Vector<std::uint32_t> queue_;
+
+    // Storage for the completion times of the predecessors of a task on the calling thread and on each other thread,
+    // and for the threads of a level and their exceptions
+    Vector<detail::Moments<T>> moments_;
+    Vector<Vector<detail::Moments<T>>> thread_moments_;
+    Workers workers_;
+    Vector<std::exception_ptr> errors_;
+
+    // Completion times calculated by the last evaluation
+    Vector<T> completion_means_;
+    Vector<T> completion_variances_;
+
+    bool built_;
+    bool evaluated_;
+};
+
+template<class T>
+constexpr std::size_t BasicTaskNetwork<T>::chunk_size;
+
+/**
+ * Task network using double precision
+ */
+typedef BasicTaskNetwork<double> TaskNetwork;
+
+} // namespace NRV
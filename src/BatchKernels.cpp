@@ -0,0 +1,95 @@
+#include <atomic>
+#include <stdexcept>
+
+#include "BatchKernels.h"
+
+
+namespace NRV {
+namespace detail {
+
+namespace {
+
+const BatchKernels& kernelsFor(InstructionSet instruction_set)
+{
+    switch(instruction_set)
+    {
+#if defined(NRV_X86_SIMD)
+    case InstructionSet::SSE2:
+        return sse2Kernels();
+    case InstructionSet::AVX2:
+        return avx2Kernels();
+    case InstructionSet::AVX512:
+        return avx512Kernels();
+#endif
+    default:
+        return scalarKernels<double>();
+    }
+}
+
+InstructionSet bestInstructionSet()
+{
+    if(instructionSetSupported(InstructionSet::AVX512))
+    {
+        return InstructionSet::AVX512;
+    }
+    if(instructionSetSupported(InstructionSet::AVX2))
+    {
+        return InstructionSet::AVX2;
+    }
+    if(instructionSetSupported(InstructionSet::SSE2))
+    {
+        return InstructionSet::SSE2;
+    }
+    return InstructionSet::Scalar;
+}
+
+std::atomic<InstructionSet>& activeInstructionSetStorage()
+{
+    static std::atomic<InstructionSet> active_instruction_set(bestInstructionSet());
+    return active_instruction_set;
+}
+
+} // namespace
+
+const BatchKernels& batchKernels()
+{
+    return kernelsFor(activeInstructionSetStorage().load(std::memory_order_relaxed));
+}
+
+} // namespace detail
+
+InstructionSet activeInstructionSet()
+{
+    return detail::activeInstructionSetStorage().load();
+}
+
+bool instructionSetSupported(InstructionSet instruction_set)
+{
+    switch(instruction_set)
+    {
+    case InstructionSet::Scalar:
+        return true;
+#if defined(NRV_X86_SIMD)
+    case InstructionSet::SSE2:
+        return __builtin_cpu_supports("sse2");
+    case InstructionSet::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case InstructionSet::AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+void setInstructionSet(InstructionSet instruction_set)
+{
+    if(!instructionSetSupported(instruction_set))
+    {
+        throw std::invalid_argument("NormalRandomVariable: Instruction set is not supported");
+    }
+
+    detail::activeInstructionSetStorage().store(instruction_set);
+}
+
+} // namespace NRV
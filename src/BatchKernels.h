@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+
+#include "NormalRandomVariable/Simd.h"
+#include "Kernels.h"
+
+namespace NRV {
+namespace detail {
+
+/**
+ * Batch versions of the operations dominated by erf and exp, which operate on contiguous arrays of means
+ * and variances. sign is 1, or -1 to reflect the inputs and output (i.e., truncateUpper, rectifyUpper and min)
+ */
+template<class T>
+using BoundsKernel = void (*)(const T* mean, const T* variance, T lower, T upper,
+        T* result_mean, T* result_variance, std::size_t size);
+template<class T>
+using BoundKernel = void (*)(const T* mean, const T* variance, T bound, T sign,
+        T* result_mean, T* result_variance, std::size_t size);
+template<class T>
+using PairKernel = void (*)(const T* mean1, const T* variance1, const T* mean2, const T* variance2,
+        T sign, T* result_mean, T* result_variance, std::size_t size);
+
+/**
+ * Batch probability queries: the CDF of each element at x, the probability that each element of the first array is
+ * less than the same element of the second, and the probability for every pair of elements of the first and second
+ * arrays (written to row i * stride of result for element i of the first array)
+ */
+template<class T>
+using CdfKernel = void (*)(const T* mean, const T* variance, T x, T* result, std::size_t size);
+template<class T>
+using LessThanKernel = void (*)(const T* mean1, const T* variance1, const T* mean2, const T* variance2,
+        T* result, std::size_t size);
+template<class T>
+using PairwiseLessThanKernel = void (*)(const T* mean1, const T* variance1, std::size_t size1,
+        const T* mean2, const T* variance2, std::size_t size2, T* result, std::size_t stride);
+
+template<class T>
+struct BasicBatchKernels {
+    BoundsKernel<T> truncate;
+    BoundKernel<T> truncateLower;
+    BoundsKernel<T> rectify;
+    BoundKernel<T> rectifyLower;
+    PairKernel<T> max;
+    CdfKernel<T> cdf;
+    LessThanKernel<T> lessThan;
+    PairwiseLessThanKernel<T> pairwiseLessThan;
+};
+
+typedef BasicBatchKernels<double> BatchKernels;
+
+/**
+ * Scalar implementations, which calculate each element with the same kernels as BasicNormalRandomVariable
+ */
+template<class T>
+void scalarTruncate(const T* mean, const T* variance, T lower, T upper,
+        T* result_mean, T* result_variance, std::size_t size)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        Moments<T> result = truncate(mean[i], variance[i], lower, upper);
+        result_mean[i] = result.mean;
+        result_variance[i] = result.variance;
+    }
+}
+
+template<class T>
+void scalarTruncateLower(const T* mean, const T* variance, T lower, T sign,
+        T* result_mean, T* result_variance, std::size_t size)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        Moments<T> result = truncateLower(sign * mean[i], variance[i], sign * lower);
+        result_mean[i] = sign * result.mean;
+        result_variance[i] = result.variance;
+    }
+}
+
+template<class T>
+void scalarRectify(const T* mean, const T* variance, T lower, T upper,
+        T* result_mean, T* result_variance, std::size_t size)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        Moments<T> result = rectify(mean[i], variance[i], lower, upper);
+        result_mean[i] = result.mean;
+        result_variance[i] = result.variance;
+    }
+}
+
+template<class T>
+void scalarRectifyLower(const T* mean, const T* variance, T lower, T sign,
+        T* result_mean, T* result_variance, std::size_t size)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        Moments<T> result = rectifyLower(sign * mean[i], variance[i], sign * lower);
+        result_mean[i] = sign * result.mean;
+        result_variance[i] = result.variance;
+    }
+}
+
+template<class T>
+void scalarMax(const T* mean1, const T* variance1, const T* mean2, const T* variance2,
+        T sign, T* result_mean, T* result_variance, std::size_t size)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        Moments<T> result = max(sign * mean1[i], variance1[i], sign * mean2[i], variance2[i]);
+        result_mean[i] = sign * result.mean;
+        result_variance[i] = result.variance;
+    }
+}
+
+template<class T>
+void scalarCdf(const T* mean, const T* variance, T x, T* result, std::size_t size)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        result[i] = normalCdf((x - mean[i]) / std::sqrt(variance[i]));
+    }
+}
+
+template<class T>
+void scalarLessThan(const T* mean1, const T* variance1, const T* mean2, const T* variance2,
+        T* result, std::size_t size)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        result[i] = probabilityLessThan(mean1[i], variance1[i], mean2[i], variance2[i]);
+    }
+}
+
+template<class T>
+void scalarPairwiseLessThan(const T* mean1, const T* variance1, std::size_t size1,
+        const T* mean2, const T* variance2, std::size_t size2, T* result, std::size_t stride)
+{
+    for(std::size_t i = 0; i < size1; ++i)
+    {
+        for(std::size_t j = 0; j < size2; ++j)
+        {
+            result[i * stride + j] = probabilityLessThan(mean1[i], variance1[i], mean2[j], variance2[j]);
+        }
+    }
+}
+
+template<class T>
+const BasicBatchKernels<T>& scalarKernels()
+{
+    static const BasicBatchKernels<T> kernels = {
+        scalarTruncate<T>,
+        scalarTruncateLower<T>,
+        scalarRectify<T>,
+        scalarRectifyLower<T>,
+        scalarMax<T>,
+        scalarCdf<T>,
+        scalarLessThan<T>,
+        scalarPairwiseLessThan<T>
+    };
+    return kernels;
+}
+
+/**
+ * Get the kernels for the active instruction set (see setInstructionSet). The vectorised kernels are only
+ * implemented for double
+ */
+const BatchKernels& batchKernels();
+
+/**
+ * Get the kernels used by the batch operations of BasicNormalRandomVariableArray. Only double has vectorised kernels
+ */
+template<class T>
+inline const BasicBatchKernels<T>& arrayKernels()
+{
+    return scalarKernels<T>();
+}
+
+template<>
+inline const BatchKernels& arrayKernels<double>()
+{
+    return batchKernels();
+}
+
+/**
+ * Kernels for each instruction set. Each is implemented in its own translation unit, compiled with the flags
+ * for that instruction set, and must only be called if the processor supports it
+ */
+#if defined(NRV_X86_SIMD)
+const BatchKernels& sse2Kernels();
+const BatchKernels& avx2Kernels();
+const BatchKernels& avx512Kernels();
+#endif
+
+} // namespace detail
+} // namespace NRV
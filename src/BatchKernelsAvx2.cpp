@@ -0,0 +1,56 @@
+#include <immintrin.h>
+
+#include "BatchKernels.h"
+#include "SimdMath.h"
+
+
+namespace NRV {
+namespace detail {
+
+namespace {
+
+struct Avx2 {
+    typedef __m256d Vec;
+    typedef __m256d Mask;
+    static const std::size_t width = 4;
+
+    static Vec set1(double x) { return _mm256_set1_pd(x); }
+    static Vec load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, Vec a) { _mm256_storeu_pd(p, a); }
+    static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm256_div_pd(a, b); }
+    static Vec fmadd(Vec a, Vec b, Vec c) { return _mm256_fmadd_pd(a, b, c); }
+    static Vec sqrt(Vec a) { return _mm256_sqrt_pd(a); }
+    static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+    static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+    static Mask lessEqual(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static Mask greaterEqual(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static Vec select(Mask mask, Vec a, Vec b) { return _mm256_blendv_pd(b, a, mask); }
+    static Vec pow2(Vec t)
+    {
+        return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(t), _mm256_set1_epi64x(1023)), 52));
+    }
+};
+
+const BatchKernels kernels = {
+    simd::truncate<Avx2>,
+    simd::truncateLower<Avx2>,
+    simd::rectify<Avx2>,
+    simd::rectifyLower<Avx2>,
+    simd::max<Avx2>,
+    simd::cdf<Avx2>,
+    simd::lessThan<Avx2>,
+    simd::pairwiseLessThan<Avx2>
+};
+
+} // namespace
+
+const BatchKernels& avx2Kernels()
+{
+    return kernels;
+}
+
+} // namespace detail
+} // namespace NRV
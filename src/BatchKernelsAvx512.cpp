@@ -0,0 +1,61 @@
+// GCC 12 warns about the deliberately undefined values used inside some AVX-512 intrinsics (GCC bug 105593)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+
+#include "BatchKernels.h"
+#include "SimdMath.h"
+
+
+namespace NRV {
+namespace detail {
+
+namespace {
+
+struct Avx512 {
+    typedef __m512d Vec;
+    typedef __mmask8 Mask;
+    static const std::size_t width = 8;
+
+    static Vec set1(double x) { return _mm512_set1_pd(x); }
+    static Vec load(const double* p) { return _mm512_loadu_pd(p); }
+    static void store(double* p, Vec a) { _mm512_storeu_pd(p, a); }
+    static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm512_div_pd(a, b); }
+    static Vec fmadd(Vec a, Vec b, Vec c) { return _mm512_fmadd_pd(a, b, c); }
+    static Vec sqrt(Vec a) { return _mm512_sqrt_pd(a); }
+    static Vec max(Vec a, Vec b) { return _mm512_max_pd(a, b); }
+    static Vec min(Vec a, Vec b) { return _mm512_min_pd(a, b); }
+    static Mask lessEqual(Vec a, Vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+    static Mask greaterEqual(Vec a, Vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+    static Vec select(Mask mask, Vec a, Vec b) { return _mm512_mask_blend_pd(mask, b, a); }
+    static Vec pow2(Vec t)
+    {
+        return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(_mm512_castpd_si512(t), _mm512_set1_epi64(1023)), 52));
+    }
+};
+
+const BatchKernels kernels = {
+    simd::truncate<Avx512>,
+    simd::truncateLower<Avx512>,
+    simd::rectify<Avx512>,
+    simd::rectifyLower<Avx512>,
+    simd::max<Avx512>,
+    simd::cdf<Avx512>,
+    simd::lessThan<Avx512>,
+    simd::pairwiseLessThan<Avx512>
+};
+
+} // namespace
+
+const BatchKernels& avx512Kernels()
+{
+    return kernels;
+}
+
+} // namespace detail
+} // namespace NRV
@@ -0,0 +1,56 @@
+#include <emmintrin.h>
+
+#include "BatchKernels.h"
+#include "SimdMath.h"
+
+
+namespace NRV {
+namespace detail {
+
+namespace {
+
+struct Sse2 {
+    typedef __m128d Vec;
+    typedef __m128d Mask;
+    static const std::size_t width = 2;
+
+    static Vec set1(double x) { return _mm_set1_pd(x); }
+    static Vec load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, Vec a) { _mm_storeu_pd(p, a); }
+    static Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+    static Vec div(Vec a, Vec b) { return _mm_div_pd(a, b); }
+    static Vec fmadd(Vec a, Vec b, Vec c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    static Vec sqrt(Vec a) { return _mm_sqrt_pd(a); }
+    static Vec max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+    static Vec min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+    static Mask lessEqual(Vec a, Vec b) { return _mm_cmple_pd(a, b); }
+    static Mask greaterEqual(Vec a, Vec b) { return _mm_cmpge_pd(a, b); }
+    static Vec select(Mask mask, Vec a, Vec b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+    static Vec pow2(Vec t)
+    {
+        return _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(_mm_castpd_si128(t), _mm_set1_epi64x(1023)), 52));
+    }
+};
+
+const BatchKernels kernels = {
+    simd::truncate<Sse2>,
+    simd::truncateLower<Sse2>,
+    simd::rectify<Sse2>,
+    simd::rectifyLower<Sse2>,
+    simd::max<Sse2>,
+    simd::cdf<Sse2>,
+    simd::lessThan<Sse2>,
+    simd::pairwiseLessThan<Sse2>
+};
+
+} // namespace
+
+const BatchKernels& sse2Kernels()
+{
+    return kernels;
+}
+
+} // namespace detail
+} // namespace NRV
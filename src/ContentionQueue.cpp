@@ -0,0 +1,507 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "NormalRandomVariable/ContentionQueue.h"
+#include "Kernels.h"
+#include "Reduction.h"
+
+
+namespace NRV {
+
+namespace {
+
+constexpr std::size_t max_robots = std::numeric_limits<std::uint32_t>::max();
+
+/**
+ * Whether the moments are finite (e.g., not from a truncation with no mass)
+ */
+template<class T>
+bool finite(const detail::Moments<T>& moments)
+{
+    return std::isfinite(moments.mean) && std::isfinite(moments.variance);
+}
+
+/**
+ * Mixture of 2 distributions with the specified weights, as a single distribution with the same mean and variance. A
+ * distribution with no weight (or moments that are not finite, e.g., from a truncation with no mass) is left out
+ */
+template<class T>
+detail::Moments<T> mix(const detail::Moments<T>& a, T weight_a, const detail::Moments<T>& b, T weight_b)
+{
+    if(!(weight_b > 0) || !finite(b))
+    {
+        return a;
+    }
+    if(!(weight_a > 0) || !finite(a))
+    {
+        return b;
+    }
+
+    T weight = weight_a + weight_b;
+    T mean = (weight_a * a.mean + weight_b * b.mean) / weight;
+    T difference_a = a.mean - mean;
+    T difference_b = b.mean - mean;
+    return {mean, (weight_a * (a.variance + difference_a * difference_a)
+            + weight_b * (b.variance + difference_b * difference_b)) / weight};
+}
+
+/**
+ * Start of the service of a robot, and its wait
+ */
+template<class T>
+struct Service {
+    detail::Moments<T> start;
+    T wait_probability;
+    detail::Moments<T> wait;
+    std::size_t server;
+};
+
+/**
+ * Serves a robot that arrives at arrival, given the departure times of the last robot at each server that has been
+ * used (means and variances), and returns the server it takes. If a server has not been used, the robot starts when
+ * it arrives. Otherwise it waits for the first server to become free, and its start is conditioned on the 2 cases
+ * where it arrives before that time (and starts when the server is free, given that it is after the arrival) and
+ * after it (and starts when it arrives, given that it is after the server is free), weighted by their probabilities
+ */
+template<class T, class Vector, class MomentsVector>
+Service<T> serve(const detail::Moments<T>& arrival, const Vector& means, const Vector& variances, std::size_t servers,
+        MomentsVector& free_times)
+{
+    if(means.size() < servers)
+    {
+        return {arrival, T(0), {T(0), T(0)}, means.size()};
+    }
+
+    detail::Moments<T> free_time = {means[0], variances[0]};
+    if(servers > 1)
+    {
+        free_times.clear();
+        for(std::size_t i = 0; i < servers; ++i)
+        {
+            free_times.push_back({means[i], variances[i]});
+        }
+        free_time = detail::minOf(free_times);
+    }
+
+    // The robot is assumed to take the server with the earliest mean departure time
+    std::size_t server = static_cast<std::size_t>(std::min_element(means.begin(), means.end()) - means.begin());
+
+    T waits = detail::probabilityLessThan(arrival.mean, arrival.variance, free_time.mean, free_time.variance);
+    detail::Moments<T> waiting = detail::truncateLower(free_time.mean, free_time.variance, arrival.mean,
+            arrival.variance);
+    detail::Moments<T> arriving = detail::truncateLower(arrival.mean, arrival.variance, free_time.mean,
+            free_time.variance);
+    detail::Truncation<T> wait = detail::truncateLowerWithMass(free_time.mean - arrival.mean,
+            free_time.variance + arrival.variance, T(0));
+
+    return {mix(waiting, waits, arriving, 1 - waits), wait.mass, wait.moments, server};
+}
+
+/**
+ * Sets the departure time of the last robot at a server, which is a new server if it has not been used
+ */
+template<class T, class Vector>
+void depart(std::size_t server, T mean, T variance, Vector& means, Vector& variances)
+{
+    if(server == means.size())
+    {
+        means.push_back(mean);
+        variances.push_back(variance);
+    }
+    else
+    {
+        means[server] = mean;
+        variances[server] = variance;
+    }
+}
+
+/**
+ * Shifts the departure time of the last robot at a server, if the server has been used
+ */
+template<class T, class Vector>
+void shiftServer(std::size_t server, const detail::Moments<T>& shift, Vector& means, Vector& variances)
+{
+    if(server < means.size())
+    {
+        means[server] += shift.mean;
+        variances[server] = std::max<T>(variances[server] + shift.variance, 0);
+    }
+}
+
+} // namespace
+
+template<class T>
+BasicContentionQueue<T>::BasicContentionQueue(std::size_t servers)
+: BasicContentionQueue(servers, defaultMemoryResource())
+{
+
+}
+
+template<class T>
+BasicContentionQueue<T>::BasicContentionQueue(std::size_t servers, MemoryResource* resource)
+: servers_(servers), arrival_means_(resource), arrival_variances_(resource), service_means_(resource),
+    service_variances_(resource), order_(resource), server_means_(resource), server_variances_(resource),
+    free_times_(resource), before_means_(resource), before_variances_(resource), swapped_means_(resource),
+    swapped_variances_(resource), start_means_(resource), start_variances_(resource), departure_means_(resource),
+    departure_variances_(resource), wait_probabilities_(resource), wait_means_(resource), wait_variances_(resource),
+    evaluated_(false)
+{
+    if(servers == 0)
+    {
+        throw std::invalid_argument("ContentionQueue: Station must have at least one server");
+    }
+}
+
+template<class T>
+BasicContentionQueue<T>::BasicContentionQueue(const BasicContentionQueue& queue) = default;
+
+template<class T>
+BasicContentionQueue<T>::BasicContentionQueue(BasicContentionQueue&& queue) noexcept = default;
+
+template<class T>
+BasicContentionQueue<T>::~BasicContentionQueue() = default;
+
+template<class T>
+BasicContentionQueue<T>& BasicContentionQueue<T>::operator=(const BasicContentionQueue& queue) = default;
+
+template<class T>
+BasicContentionQueue<T>& BasicContentionQueue<T>::operator=(BasicContentionQueue&& queue) = default;
+
+template<class T>
+void BasicContentionQueue<T>::reserve(std::size_t robots)
+{
+    arrival_means_.reserve(robots);
+    arrival_variances_.reserve(robots);
+    service_means_.reserve(robots);
+    service_variances_.reserve(robots);
+}
+
+template<class T>
+void BasicContentionQueue<T>::clear()
+{
+    // Only the inputs need to be cleared, since evaluate resizes the rest of the storage
+    arrival_means_.clear();
+    arrival_variances_.clear();
+    service_means_.clear();
+    service_variances_.clear();
+    evaluated_ = false;
+}
+
+template<class T>
+std::size_t BasicContentionQueue<T>::addRobot(const BasicNormalRandomVariable<T>& arrival, const BasicNormalRandomVariable<T>& service)
+{
+    if(arrival_means_.size() >= max_robots)
+    {
+        throw std::length_error("ContentionQueue: Too many robots");
+    }
+
+    arrival_means_.push_back(arrival.mean());
+    arrival_variances_.push_back(arrival.variance());
+    service_means_.push_back(service.mean());
+    service_variances_.push_back(service.variance());
+    evaluated_ = false;
+    return arrival_means_.size() - 1;
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicContentionQueue<T>::arrival(std::size_t robot) const
+{
+    checkRobot(robot);
+    return BasicNormalRandomVariable<T>(arrival_means_[robot], arrival_variances_[robot]);
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicContentionQueue<T>::service(std::size_t robot) const
+{
+    checkRobot(robot);
+    return BasicNormalRandomVariable<T>(service_means_[robot], service_variances_[robot]);
+}
+
+template<class T>
+void BasicContentionQueue<T>::setArrival(std::size_t robot, const BasicNormalRandomVariable<T>& arrival)
+{
+    checkRobot(robot);
+    arrival_means_[robot] = arrival.mean();
+    arrival_variances_[robot] = arrival.variance();
+    evaluated_ = false;
+}
+
+template<class T>
+void BasicContentionQueue<T>::setService(std::size_t robot, const BasicNormalRandomVariable<T>& service)
+{
+    checkRobot(robot);
+    service_means_[robot] = service.mean();
+    service_variances_[robot] = service.variance();
+    evaluated_ = false;
+}
+
+template<class T>
+void BasicContentionQueue<T>::evaluate()
+{
+    std::size_t robots = arrival_means_.size();
+
+    // Robots are considered in the order of their mean arrival times. Ties are broken by index rather than with a
+    // stable sort, which would allocate
+    order_.resize(robots);
+    std::iota(order_.begin(), order_.end(), 0u);
+    std::sort(order_.begin(), order_.end(), [this](std::uint32_t a, std::uint32_t b) {
+        return arrival_means_[a] < arrival_means_[b] || (arrival_means_[a] == arrival_means_[b] && a < b);
+    });
+
+    start_means_.resize(robots);
+    start_variances_.resize(robots);
+    departure_means_.resize(robots);
+    departure_variances_.resize(robots);
+    wait_probabilities_.resize(robots);
+    wait_means_.resize(robots);
+    wait_variances_.resize(robots);
+    server_means_.clear();
+    server_variances_.clear();
+    before_means_.clear();
+    before_variances_.clear();
+
+    free_times_.reserve(servers_);
+    before_means_.reserve(servers_);
+    before_variances_.reserve(servers_);
+    swapped_means_.reserve(servers_);
+    swapped_variances_.reserve(servers_);
+
+    for(std::size_t position = 0; position < robots; ++position)
+    {
+        std::uint32_t robot = order_[position];
+        detail::Moments<T> arrival = {arrival_means_[robot], arrival_variances_[robot]};
+        detail::Moments<T> service = {service_means_[robot], service_variances_[robot]};
+
+        // The robot either arrives after the robot in front of it (the previous robot by mean arrival time), and is
+        // served after it, or arrives before it and is served first. In each case the arrival times of the 2 robots
+        // are conditioned on their order, and the cases are weighted by their probabilities
+        T overtakes = 0;
+        detail::Moments<T> after = arrival;
+        std::uint32_t previous = 0;
+        Service<T> first = {}, second = {}, kept = {}, unconditioned = {};
+        if(position > 0)
+        {
+            previous = order_[position - 1];
+            detail::Moments<T> previous_arrival = {arrival_means_[previous], arrival_variances_[previous]};
+            overtakes = detail::probabilityLessThan(arrival.mean, arrival.variance, previous_arrival.mean,
+                    previous_arrival.variance);
+            after = detail::truncateLower(arrival.mean, arrival.variance, previous_arrival.mean,
+                    previous_arrival.variance);
+            detail::Moments<T> before = detail::truncateUpper(arrival.mean, arrival.variance, previous_arrival.mean,
+                    previous_arrival.variance);
+            detail::Moments<T> previous_before = detail::truncateUpper(previous_arrival.mean,
+                    previous_arrival.variance, arrival.mean, arrival.variance);
+            detail::Moments<T> previous_after = detail::truncateLower(previous_arrival.mean,
+                    previous_arrival.variance, arrival.mean, arrival.variance);
+            if(!(overtakes > 0 && overtakes < 1) || !finite(after) || !finite(before) || !finite(previous_before)
+                    || !finite(previous_after))
+            {
+                overtakes = 0;
+                after = arrival;
+            }
+            else
+            {
+                // If it does not overtake, the times of the robot in front are shifted by conditioning its arrival on
+                // arriving first, which is calculated from the servers as they were before it
+                kept = serve(previous_before, before_means_, before_variances_, servers_, free_times_);
+                unconditioned = serve(previous_arrival, before_means_, before_variances_, servers_, free_times_);
+
+                // If it overtakes, both robots are served again from the servers as they were before the robot in
+                // front
+                swapped_means_.assign(before_means_.begin(), before_means_.end());
+                swapped_variances_.assign(before_variances_.begin(), before_variances_.end());
+                first = serve(before, swapped_means_, swapped_variances_, servers_, free_times_);
+                depart(first.server, first.start.mean + service.mean, first.start.variance + service.variance,
+                        swapped_means_, swapped_variances_);
+                second = serve(previous_after, swapped_means_, swapped_variances_, servers_, free_times_);
+                depart(second.server, second.start.mean + service_means_[previous],
+                        second.start.variance + service_variances_[previous], swapped_means_, swapped_variances_);
+            }
+        }
+
+        before_means_.assign(server_means_.begin(), server_means_.end());
+        before_variances_.assign(server_variances_.begin(), server_variances_.end());
+
+        detail::Moments<T> shift = {0, 0};
+        if(overtakes > 0)
+        {
+            shift.mean = kept.start.mean - unconditioned.start.mean;
+            shift.variance = kept.start.variance - unconditioned.start.variance;
+            shiftServer(unconditioned.server, shift, server_means_, server_variances_);
+        }
+
+        Service<T> served = serve(after, server_means_, server_variances_, servers_, free_times_);
+        depart(served.server, served.start.mean + service.mean, served.start.variance + service.variance,
+                server_means_, server_variances_);
+
+        if(overtakes > 0)
+        {
+            // The servers are matched by the order in which they were last used by the 2 robots
+            for(std::size_t i = 0; i < server_means_.size(); ++i)
+            {
+                detail::Moments<T> server = mix(detail::Moments<T>{server_means_[i], server_variances_[i]},
+                        1 - overtakes, detail::Moments<T>{swapped_means_[i], swapped_variances_[i]}, overtakes);
+                server_means_[i] = server.mean;
+                server_variances_[i] = server.variance;
+            }
+
+            // The robot in front is served after this robot if it is overtaken
+            detail::Moments<T> start = mix(detail::Moments<T>{start_means_[previous] + shift.mean,
+                    std::max<T>(start_variances_[previous] + shift.variance, 0)}, 1 - overtakes, second.start,
+                    overtakes);
+            T wait_probability = std::min<T>(std::max<T>(wait_probabilities_[previous] + kept.wait_probability
+                    - unconditioned.wait_probability, 0), 1);
+            detail::Moments<T> wait = mix(detail::Moments<T>{wait_means_[previous], wait_variances_[previous]},
+                    (1 - overtakes) * wait_probability, second.wait, overtakes * second.wait_probability);
+            start_means_[previous] = start.mean;
+            start_variances_[previous] = start.variance;
+            departure_means_[previous] = start.mean + service_means_[previous];
+            departure_variances_[previous] = start.variance + service_variances_[previous];
+            wait_probabilities_[previous] = (1 - overtakes) * wait_probability + overtakes * second.wait_probability;
+            wait_means_[previous] = wait.mean;
+            wait_variances_[previous] = wait.variance;
+        }
+        else
+        {
+            first = served;
+        }
+
+        detail::Moments<T> start = mix(served.start, 1 - overtakes, first.start, overtakes);
+        detail::Moments<T> wait = mix(served.wait, (1 - overtakes) * served.wait_probability, first.wait,
+                overtakes * first.wait_probability);
+        start_means_[robot] = start.mean;
+        start_variances_[robot] = start.variance;
+        departure_means_[robot] = start.mean + service.mean;
+        departure_variances_[robot] = start.variance + service.variance;
+        wait_probabilities_[robot] = (1 - overtakes) * served.wait_probability + overtakes * first.wait_probability;
+        wait_means_[robot] = wait.mean;
+        wait_variances_[robot] = wait.variance;
+    }
+
+    evaluated_ = true;
+}
+
+template<class T>
+std::size_t BasicContentionQueue<T>::served(std::size_t position) const
+{
+    checkRobot(position);
+    checkEvaluated();
+    return order_[position];
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicContentionQueue<T>::start(std::size_t robot) const
+{
+    checkRobot(robot);
+    checkEvaluated();
+    return BasicNormalRandomVariable<T>(start_means_[robot], start_variances_[robot]);
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicContentionQueue<T>::departure(std::size_t robot) const
+{
+    checkRobot(robot);
+    checkEvaluated();
+    return BasicNormalRandomVariable<T>(departure_means_[robot], departure_variances_[robot]);
+}
+
+template<class T>
+T BasicContentionQueue<T>::waitProbability(std::size_t robot) const
+{
+    checkRobot(robot);
+    checkEvaluated();
+    return wait_probabilities_[robot];
+}
+
+template<class T>
+T BasicContentionQueue<T>::expectedWait(std::size_t robot) const
+{
+    checkRobot(robot);
+    checkEvaluated();
+
+    // The wait given that the robot waits is not a number if it is too unlikely to wait
+    return wait_probabilities_[robot] > 0 ? wait_probabilities_[robot] * wait_means_[robot] : T(0);
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicContentionQueue<T>::wait(std::size_t robot) const
+{
+    checkRobot(robot);
+    checkEvaluated();
+    if(!(wait_variances_[robot] > 0))
+    {
+        throw std::range_error("ContentionQueue: Wait does not have a valid variance");
+    }
+
+    return BasicNormalRandomVariable<T>(wait_means_[robot], wait_variances_[robot]);
+}
+
+template<class T>
+TryResult<T> BasicContentionQueue<T>::tryWait(std::size_t robot) const noexcept
+{
+    if(robot >= size())
+    {
+        return TryResult<T>{BasicNormalRandomVariable<T>(), Status::OutOfRange};
+    }
+    if(!evaluated_)
+    {
+        return TryResult<T>{BasicNormalRandomVariable<T>(), Status::NotEvaluated};
+    }
+
+    return BasicNormalRandomVariable<T>::tryCreate(wait_means_[robot], wait_variances_[robot]);
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicContentionQueue<T>::makespan() const
+{
+    checkEvaluated();
+
+    // The last departure from each server (the earlier departures are before them)
+    Vector<detail::Moments<T>> moments(server_means_.size(), detail::Moments<T>(), free_times_.get_allocator());
+    for(std::size_t i = 0; i < moments.size(); ++i)
+    {
+        moments[i] = detail::Moments<T>{server_means_[i], server_variances_[i]};
+    }
+
+    detail::Moments<T> result = detail::maxOf(moments);
+    return BasicNormalRandomVariable<T>(result.mean, result.variance);
+}
+
+template<class T>
+std::size_t BasicContentionQueue<T>::size() const
+{
+    return arrival_means_.size();
+}
+
+template<class T>
+std::size_t BasicContentionQueue<T>::servers() const
+{
+    return servers_;
+}
+
+template<class T>
+void BasicContentionQueue<T>::checkRobot(std::size_t robot) const
+{
+    if(robot >= arrival_means_.size())
+    {
+        throw std::invalid_argument("ContentionQueue: Robot does not exist");
+    }
+}
+
+template<class T>
+void BasicContentionQueue<T>::checkEvaluated() const
+{
+    if(!evaluated_)
+    {
+        throw std::logic_error("ContentionQueue: Station has changed since it was evaluated");
+    }
+}
+
+template class BasicContentionQueue<float>;
+template class BasicContentionQueue<double>;
+template class BasicContentionQueue<long double>;
+
+} // namespace NRV
@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "NormalRandomVariable/CorrelatedNormalRandomVariable.h"
+#include "Kernels.h"
+
+
+namespace NRV {
+
+template<class T>
+T BasicCorrelatedNormalRandomVariable<T>::mean() const
+{
+    return store_->means_[index_];
+}
+
+template<class T>
+T BasicCorrelatedNormalRandomVariable<T>::variance() const
+{
+    return store_->variances_[index_];
+}
+
+template<class T>
+T BasicCorrelatedNormalRandomVariable<T>::covariance(const BasicCorrelatedNormalRandomVariable& random_variable) const
+{
+    return store_->covariance(index_, store_->indexOf(random_variable));
+}
+
+template<class T>
+T BasicCorrelatedNormalRandomVariable<T>::correlation(const BasicCorrelatedNormalRandomVariable& random_variable) const
+{
+    return covariance(random_variable) / std::sqrt(variance() * random_variable.variance());
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicCorrelatedNormalRandomVariable<T>::toIndependent() const
+{
+    return BasicNormalRandomVariable<T>(mean(), variance());
+}
+
+namespace {
+
+/**
+ * Clark's approximation of the maximum of 2 correlated normal random variables, as a normal random variable.
+ * phi_alpha is the weight of the covariance of the first random variable in the covariance of the maximum with
+ * any other random variable, and 1 - phi_alpha is the weight of the second
+ */
+template<class T>
+struct ClarkMax {
+    T mean;
+    T variance;
+    T phi_alpha;
+};
+
+template<class T>
+ClarkMax<T> clarkMax(T mean1, T variance1, T mean2, T variance2, T covariance)
+{
+    T theta_squared = variance1 + variance2 - 2 * covariance;
+    if(!(theta_squared > 0))
+    {
+        // The difference is constant, so the maximum is always the same random variable
+        return mean1 >= mean2 ? ClarkMax<T>{mean1, variance1, 1} : ClarkMax<T>{mean2, variance2, 0};
+    }
+
+    T theta = std::sqrt(theta_squared);
+    T alpha = (mean1 - mean2) / theta;
+
+    T phi_alpha = T(0.5) * (1 + std::erf(alpha * detail::Constants<T>::one_on_sqrt_two));
+    T phi_neg_alpha = T(0.5) * (1 + std::erf(-alpha * detail::Constants<T>::one_on_sqrt_two));
+    T theta_pdf_alpha = theta * detail::Constants<T>::one_on_sqrt_two_pi * std::exp(-alpha * alpha / 2);
+
+    T m = mean1 * phi_alpha + mean2 * phi_neg_alpha + theta_pdf_alpha;
+    T v = (mean1 * mean1 + variance1) * phi_alpha
+            + (mean2 * mean2 + variance2) * phi_neg_alpha
+            + (mean1 + mean2) * theta_pdf_alpha - m * m;
+
+    return ClarkMax<T>{m, v, phi_alpha};
+}
+
+} // namespace
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> BasicCorrelatedNormalRandomVariable<T>::max(const BasicCorrelatedNormalRandomVariable& random_variable) const
+{
+    std::size_t other = store_->indexOf(random_variable);
+    ClarkMax<T> result = clarkMax(mean(), variance(), random_variable.mean(), random_variable.variance(),
+            store_->covariance(index_, other));
+    return store_->combine(result.mean, result.variance, index_, result.phi_alpha, other, 1 - result.phi_alpha);
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> BasicCorrelatedNormalRandomVariable<T>::min(const BasicCorrelatedNormalRandomVariable& random_variable) const
+{
+    // min(X, Y) = -max(-X, -Y), which has the same weights for the covariances
+    std::size_t other = store_->indexOf(random_variable);
+    ClarkMax<T> reflected = clarkMax(-mean(), variance(), -random_variable.mean(), random_variable.variance(),
+            store_->covariance(index_, other));
+    return store_->combine(-reflected.mean, reflected.variance, index_, reflected.phi_alpha, other, 1 - reflected.phi_alpha);
+}
+
+template<class T>
+constexpr std::uint32_t BasicCovarianceStore<T>::block_size;
+
+template<class T>
+constexpr std::uint32_t BasicCovarianceStore<T>::no_block;
+
+template<class T>
+BasicCovarianceStore<T>::BasicCovarianceStore()
+: non_zeros_(0), tolerance_(0)
+{
+
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> BasicCovarianceStore<T>::add(const BasicNormalRandomVariable<T>& random_variable)
+{
+    means_.push_back(random_variable.mean());
+    variances_.push_back(random_variable.variance());
+    rows_.push_back(Row{no_block, no_block});
+    return BasicCorrelatedNormalRandomVariable<T>(this, rows_.size() - 1);
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> BasicCovarianceStore<T>::add(const BasicNormalRandomVariable<T>& random_variable,
+        const std::vector<std::pair<BasicCorrelatedNormalRandomVariable<T>, T>>& covariances)
+{
+    std::vector<Entry> entries;
+    for(const auto& covariance : covariances)
+    {
+        entries.push_back(Entry{static_cast<std::uint32_t>(indexOf(covariance.first)), covariance.second});
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {return a.index < b.index;});
+
+    auto result = add(random_variable);
+    std::uint32_t index = static_cast<std::uint32_t>(result.index());
+    for(std::size_t i = 0; i < entries.size(); ++i)
+    {
+        // Combine repeated random variables
+        T covariance = entries[i].covariance;
+        while(i + 1 < entries.size() && entries[i + 1].index == entries[i].index)
+        {
+            covariance += entries[++i].covariance;
+        }
+
+        if(covariance != 0)
+        {
+            append(rows_[index], entries[i].index, covariance);
+            append(rows_[entries[i].index], index, covariance);
+            non_zeros_ += 2;
+        }
+    }
+
+    return result;
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> BasicCovarianceStore<T>::operator[](std::size_t index)
+{
+    return BasicCorrelatedNormalRandomVariable<T>(this, index);
+}
+
+template<class T>
+std::size_t BasicCovarianceStore<T>::size() const
+{
+    return rows_.size();
+}
+
+template<class T>
+std::size_t BasicCovarianceStore<T>::nonZeros() const
+{
+    return non_zeros_;
+}
+
+template<class T>
+void BasicCovarianceStore<T>::setTolerance(T tolerance)
+{
+    tolerance_ = tolerance;
+}
+
+template<class T>
+void BasicCovarianceStore<T>::clear()
+{
+    means_.clear();
+    variances_.clear();
+    rows_.clear();
+    blocks_.clear();
+    non_zeros_ = 0;
+}
+
+template<class T>
+std::size_t BasicCovarianceStore<T>::indexOf(const BasicCorrelatedNormalRandomVariable<T>& random_variable) const
+{
+    if(random_variable.store_ != this)
+    {
+        throw std::invalid_argument("CovarianceStore: Random variable belongs to a different store");
+    }
+
+    return random_variable.index_;
+}
+
+template<class T>
+T BasicCovarianceStore<T>::covariance(std::size_t index1, std::size_t index2) const
+{
+    if(index1 == index2)
+    {
+        return variances_[index1];
+    }
+
+    for(std::uint32_t block = rows_[index1].first; block != no_block; block = blocks_[block].next)
+    {
+        const Block& entries = blocks_[block];
+        if(entries.entries[entries.size - 1].index < index2)
+        {
+            continue;
+        }
+
+        for(std::uint32_t i = 0; i < entries.size; ++i)
+        {
+            if(entries.entries[i].index == index2)
+            {
+                return entries.entries[i].covariance;
+            }
+        }
+
+        break;
+    }
+
+    return 0;
+}
+
+template<class T>
+void BasicCovarianceStore<T>::append(Row& row, std::uint32_t index, T covariance)
+{
+    if(row.last == no_block || blocks_[row.last].size == block_size)
+    {
+        std::uint32_t block = static_cast<std::uint32_t>(blocks_.size());
+        blocks_.push_back(Block());
+        blocks_[block].size = 0;
+        blocks_[block].next = no_block;
+
+        if(row.last == no_block)
+        {
+            row.first = block;
+        }
+        else
+        {
+            blocks_[row.last].next = block;
+        }
+        row.last = block;
+    }
+
+    Block& block = blocks_[row.last];
+    block.entries[block.size++] = Entry{index, covariance};
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> BasicCovarianceStore<T>::combine(T mean, T variance, std::size_t index1, T weight1,
+        std::size_t index2, T weight2)
+{
+    auto result = add(BasicNormalRandomVariable<T>(mean, variance));
+    std::uint32_t index = static_cast<std::uint32_t>(result.index());
+
+    /**
+     * Walks through the covariances of a random variable in order of index, including its variance
+     */
+    struct Cursor {
+        const BasicCovarianceStore* store;
+        std::uint32_t self;
+        std::uint32_t block;
+        std::uint32_t position;
+        bool self_done;
+
+        std::uint32_t index() const
+        {
+            std::uint32_t next = block == no_block ? no_block : store->blocks_[block].entries[position].index;
+            return self_done || next < self ? next : self;
+        }
+
+        T covariance() const
+        {
+            return self_done || index() != self ? store->blocks_[block].entries[position].covariance : store->variances_[self];
+        }
+
+        void advance()
+        {
+            if(!self_done && index() == self)
+            {
+                self_done = true;
+                return;
+            }
+
+            if(++position == store->blocks_[block].size)
+            {
+                block = store->blocks_[block].next;
+                position = 0;
+            }
+        }
+    };
+
+    // Merge the 2 rows, which are sorted by index. Entries for the new random variable are appended to the rows as
+    // they are merged, so the merge stops when it reaches them
+    Cursor cursor1{this, static_cast<std::uint32_t>(index1), rows_[index1].first, 0, false};
+    Cursor cursor2{this, static_cast<std::uint32_t>(index2), rows_[index2].first, 0, false};
+    for(std::uint32_t other = std::min(cursor1.index(), cursor2.index()); other < index;
+            other = std::min(cursor1.index(), cursor2.index()))
+    {
+        T covariance = 0;
+        if(cursor1.index() == other)
+        {
+            covariance += weight1 * cursor1.covariance();
+            cursor1.advance();
+        }
+        if(cursor2.index() == other)
+        {
+            covariance += weight2 * cursor2.covariance();
+            cursor2.advance();
+        }
+
+        if(covariance != 0 && covariance * covariance >= tolerance_ * tolerance_ * variance * variances_[other])
+        {
+            append(rows_[index], other, covariance);
+            append(rows_[other], index, covariance);
+            non_zeros_ += 2;
+        }
+    }
+
+    return result;
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator+(const BasicCorrelatedNormalRandomVariable<T>& rv1, const BasicCorrelatedNormalRandomVariable<T>& rv2)
+{
+    BasicCovarianceStore<T>& store = rv1.store();
+    std::size_t index2 = store.indexOf(rv2);
+    T variance = rv1.variance() + rv2.variance() + 2 * store.covariance(rv1.index(), index2);
+    return store.combine(rv1.mean() + rv2.mean(), variance, rv1.index(), T(1), index2, T(1));
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator-(const BasicCorrelatedNormalRandomVariable<T>& rv1, const BasicCorrelatedNormalRandomVariable<T>& rv2)
+{
+    BasicCovarianceStore<T>& store = rv1.store();
+    std::size_t index2 = store.indexOf(rv2);
+    T variance = rv1.variance() + rv2.variance() - 2 * store.covariance(rv1.index(), index2);
+    return store.combine(rv1.mean() - rv2.mean(), variance, rv1.index(), T(1), index2, T(-1));
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> operator*(const BasicCorrelatedNormalRandomVariable<T>& rv1, const BasicCorrelatedNormalRandomVariable<T>& rv2)
+{
+    // Moments of the product of bivariate normal random variables. The covariance with any other random variable W
+    // that is jointly normal is mean2 * cov(X1, W) + mean1 * cov(X2, W)
+    BasicCovarianceStore<T>& store = rv1.store();
+    std::size_t index2 = store.indexOf(rv2);
+    T mean1 = rv1.mean();
+    T mean2 = rv2.mean();
+    T covariance = store.covariance(rv1.index(), index2);
+    T variance = mean1 * mean1 * rv2.variance() + mean2 * mean2 * rv1.variance() + rv1.variance() * rv2.variance()
+            + covariance * covariance + 2 * mean1 * mean2 * covariance;
+    return store.combine(mean1 * mean2 + covariance, variance, rv1.index(), mean2, index2, mean1);
+}
+
+template<class T>
+BasicCorrelatedNormalRandomVariable<T> affine(const BasicCorrelatedNormalRandomVariable<T>& rv, T scale, T offset)
+{
+    BasicCovarianceStore<T>& store = rv.store();
+    return store.combine(rv.mean() * scale + offset, rv.variance() * (scale * scale), rv.index(), scale, rv.index(), T(0));
+}
+
+template class BasicCorrelatedNormalRandomVariable<float>;
+template class BasicCorrelatedNormalRandomVariable<double>;
+template class BasicCorrelatedNormalRandomVariable<long double>;
+
+template class BasicCovarianceStore<float>;
+template class BasicCovarianceStore<double>;
+template class BasicCovarianceStore<long double>;
+
+#define NRV_INSTANTIATE_CORRELATED_OPERATORS(T) \
+    template BasicCorrelatedNormalRandomVariable<T> operator+(const BasicCorrelatedNormalRandomVariable<T>& rv1, const BasicCorrelatedNormalRandomVariable<T>& rv2); \
+    template BasicCorrelatedNormalRandomVariable<T> operator-(const BasicCorrelatedNormalRandomVariable<T>& rv1, const BasicCorrelatedNormalRandomVariable<T>& rv2); \
+    template BasicCorrelatedNormalRandomVariable<T> operator*(const BasicCorrelatedNormalRandomVariable<T>& rv1, const BasicCorrelatedNormalRandomVariable<T>& rv2); \
+    template BasicCorrelatedNormalRandomVariable<T> affine(const BasicCorrelatedNormalRandomVariable<T>& rv, T scale, T offset);
+
+NRV_INSTANTIATE_CORRELATED_OPERATORS(float)
+NRV_INSTANTIATE_CORRELATED_OPERATORS(double)
+NRV_INSTANTIATE_CORRELATED_OPERATORS(long double)
+
+} // namespace NRV
@@ -0,0 +1,564 @@
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "NormalRandomVariable/ExpressionGraph.h"
+#include "Kernels.h"
+
+
+namespace NRV {
+
+namespace {
+
+/**
+ * Smallest size of the table of recorded operations
+ */
+constexpr std::size_t min_recorded_size = 16;
+
+} // namespace
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::rectify(T lower, T upper) const
+{
+    if(upper <= lower)
+    {
+        throw std::range_error("ExpressionGraph: Rectification lower bound must be less than upper bound");
+    }
+
+    return graph_->record(BasicExpressionGraph<T>::Operation::Rectify, index_, 0, 0, lower, upper);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::rectifyLower(T lower) const
+{
+    return graph_->record(BasicExpressionGraph<T>::Operation::RectifyLower, index_, 0, 0, lower, 0);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::rectifyUpper(T upper) const
+{
+    return graph_->record(BasicExpressionGraph<T>::Operation::RectifyUpper, index_, 0, 0, upper, 0);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::truncate(T lower, T upper) const
+{
+    if(upper <= lower)
+    {
+        throw std::range_error("ExpressionGraph: Truncation lower bound must be less than upper bound");
+    }
+
+    return graph_->record(BasicExpressionGraph<T>::Operation::Truncate, index_, 0, 0, lower, upper);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::truncateLower(T lower) const
+{
+    return graph_->record(BasicExpressionGraph<T>::Operation::TruncateLower, index_, 0, 0, lower, 0);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::truncateUpper(T upper) const
+{
+    return graph_->record(BasicExpressionGraph<T>::Operation::TruncateUpper, index_, 0, 0, upper, 0);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::truncate(const BasicExpression& lower, const BasicExpression& upper) const
+{
+    return graph_->record(BasicExpressionGraph<T>::Operation::TruncateBy, index_, graph_->indexOf(lower),
+            graph_->indexOf(upper), 0, 0);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::truncateLower(const BasicExpression& lower) const
+{
+    return graph_->record(BasicExpressionGraph<T>::Operation::TruncateLowerBy, index_, graph_->indexOf(lower), 0, 0, 0);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::truncateUpper(const BasicExpression& upper) const
+{
+    return graph_->record(BasicExpressionGraph<T>::Operation::TruncateUpperBy, index_, graph_->indexOf(upper), 0, 0, 0);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::max(const BasicExpression& expression) const
+{
+    return graph_->record(BasicExpressionGraph<T>::Operation::Max, index_, graph_->indexOf(expression), 0, 0, 0);
+}
+
+template<class T>
+BasicExpression<T> BasicExpression<T>::min(const BasicExpression& expression) const
+{
+    return graph_->record(BasicExpressionGraph<T>::Operation::Min, index_, graph_->indexOf(expression), 0, 0, 0);
+}
+
+template<class T>
+BasicExpressionGraph<T>::BasicExpressionGraph()
+: BasicExpressionGraph(defaultMemoryResource())
+{
+
+}
+
+template<class T>
+BasicExpressionGraph<T>::BasicExpressionGraph(MemoryResource* resource)
+: nodes_(resource), means_(resource), variances_(resource), recorded_(resource), recorded_size_(0),
+    first_dependents_(resource), dependents_(resource), next_dependents_(resource), dirty_(resource),
+    stack_(resource), pending_(resource), calculations_(0)
+{
+
+}
+
+template<class T>
+BasicExpression<T> BasicExpressionGraph<T>::input(const BasicNormalRandomVariable<T>& random_variable)
+{
+    // Inputs are not shared, so they are not added to recorded_
+    nodes_.push_back(Node{Operation::Input, {0, 0, 0}, {0, 0}});
+    means_.push_back(random_variable.mean());
+    variances_.push_back(random_variable.variance());
+    first_dependents_.push_back(none);
+    dirty_.push_back(false);
+    pending_.reserve(nodes_.capacity());
+    return expression(nodes_.size() - 1);
+}
+
+template<class T>
+void BasicExpressionGraph<T>::set(const BasicExpression<T>& input, const BasicNormalRandomVariable<T>& random_variable)
+{
+    std::size_t index = indexOf(input);
+    if(nodes_[index].operation != Operation::Input)
+    {
+        throw std::invalid_argument("ExpressionGraph: Expression is not an input");
+    }
+
+    if(means_[index] == random_variable.mean() && variances_[index] == random_variable.variance())
+    {
+        return;
+    }
+
+    means_[index] = random_variable.mean();
+    variances_[index] = random_variable.variance();
+
+    // Mark everything downstream as dirty. Nodes that are already dirty have dirty dependents, so are skipped
+    auto pushDependents = [this](std::size_t node) {
+        for(std::size_t link = first_dependents_[node]; link != none; link = next_dependents_[link])
+        {
+            stack_.push_back(dependents_[link]);
+        }
+    };
+
+    stack_.clear();
+    pushDependents(index);
+    while(!stack_.empty())
+    {
+        std::size_t dependent = stack_.back();
+        stack_.pop_back();
+        if(!dirty_[dependent])
+        {
+            dirty_[dependent] = true;
+            pushDependents(dependent);
+        }
+    }
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicExpressionGraph<T>::evaluate(const BasicExpression<T>& expression)
+{
+    std::size_t index = indexOf(expression);
+    calculate(index);
+    return BasicNormalRandomVariable<T>(means_[index], variances_[index]);
+}
+
+template<class T>
+TryResult<T> BasicExpressionGraph<T>::tryEvaluate(const BasicExpression<T>& expression) noexcept
+{
+    calculate(expression.index_);
+    return BasicNormalRandomVariable<T>::tryCreate(means_[expression.index_], variances_[expression.index_]);
+}
+
+template<class T>
+void BasicExpressionGraph<T>::clear()
+{
+    nodes_.clear();
+    means_.clear();
+    variances_.clear();
+    std::fill(recorded_.begin(), recorded_.end(), none);
+    recorded_size_ = 0;
+    first_dependents_.clear();
+    dependents_.clear();
+    next_dependents_.clear();
+    dirty_.clear();
+    stack_.clear();
+    pending_.clear();
+    calculations_ = 0;
+}
+
+template<class T>
+void BasicExpressionGraph<T>::reserve(std::size_t nodes)
+{
+    nodes_.reserve(nodes);
+    means_.reserve(nodes);
+    variances_.reserve(nodes);
+    first_dependents_.reserve(nodes);
+    dirty_.reserve(nodes);
+    pending_.reserve(nodes);
+
+    // Most operations have 1 or 2 operands
+    dependents_.reserve(2 * nodes);
+    next_dependents_.reserve(2 * nodes);
+    stack_.reserve(2 * nodes);
+
+    std::size_t size = min_recorded_size;
+    while(size < 2 * nodes)
+    {
+        size *= 2;
+    }
+    if(size > recorded_.size())
+    {
+        rehash(size);
+    }
+}
+
+template<class T>
+std::size_t BasicExpressionGraph<T>::size() const
+{
+    return nodes_.size();
+}
+
+template<class T>
+std::size_t BasicExpressionGraph<T>::calculations() const
+{
+    return calculations_;
+}
+
+namespace {
+
+/**
+ * Returns the number of operands (i.e., other nodes) used by an operation
+ */
+template<class Operation>
+std::size_t operandCount(Operation operation)
+{
+    switch(operation)
+    {
+    case Operation::Input:
+        return 0;
+    case Operation::Add:
+    case Operation::Subtract:
+    case Operation::Multiply:
+    case Operation::Max:
+    case Operation::Min:
+    case Operation::TruncateLowerBy:
+    case Operation::TruncateUpperBy:
+        return 2;
+    case Operation::TruncateBy:
+        return 3;
+    default:
+        return 1;
+    }
+}
+
+/**
+ * Hash of the operation, operands and parameters of a node. std::hash is equal for parameters that compare equal
+ * (e.g., 0 and -0)
+ */
+template<class T, class Node>
+std::size_t hashNode(const Node& node)
+{
+    const std::size_t multiplier = static_cast<std::size_t>(0x9e3779b97f4a7c15ull);
+    std::size_t hash = static_cast<std::size_t>(node.operation);
+    for(std::size_t operand : node.operands)
+    {
+        hash = (hash ^ operand) * multiplier;
+    }
+    for(T parameter : node.parameters)
+    {
+        hash = (hash ^ std::hash<T>()(parameter)) * multiplier;
+    }
+
+    // The table uses the low bits, so mix the high bits into them
+    return hash ^ (hash >> (sizeof(std::size_t) * 4));
+}
+
+template<class Node>
+bool equalNodes(const Node& node1, const Node& node2)
+{
+    return node1.operation == node2.operation && node1.operands[0] == node2.operands[0]
+            && node1.operands[1] == node2.operands[1] && node1.operands[2] == node2.operands[2]
+            && node1.parameters[0] == node2.parameters[0] && node1.parameters[1] == node2.parameters[1];
+}
+
+} // namespace
+
+template<class T>
+BasicExpression<T> BasicExpressionGraph<T>::record(Operation operation, std::size_t operand1, std::size_t operand2,
+        std::size_t operand3, T parameter1, T parameter2)
+{
+    // The order of the operands does not matter for commutative operations
+    if((operation == Operation::Add || operation == Operation::Multiply || operation == Operation::Max
+            || operation == Operation::Min) && operand2 < operand1)
+    {
+        std::swap(operand1, operand2);
+    }
+
+    Node node{operation, {operand1, operand2, operand3}, {parameter1, parameter2}};
+    if(recorded_.empty())
+    {
+        rehash(min_recorded_size);
+    }
+
+    std::size_t slot = find(node);
+    if(recorded_[slot] != none)
+    {
+        return expression(recorded_[slot]);
+    }
+
+    if(2 * (recorded_size_ + 1) > recorded_.size())
+    {
+        rehash(2 * recorded_.size());
+        slot = find(node);
+    }
+
+    std::size_t index = nodes_.size();
+    nodes_.push_back(node);
+    means_.push_back(0);
+    variances_.push_back(1);
+    first_dependents_.push_back(none);
+    dirty_.push_back(true);
+    recorded_[slot] = index;
+    ++recorded_size_;
+
+    for(std::size_t i = 0; i < operandCount(operation); ++i)
+    {
+        // An operand used twice (e.g., x + x) only needs to be recorded once. Links are added to the front of the
+        // list, so the first link is the latest dependent
+        std::size_t operand = node.operands[i];
+        std::size_t first = first_dependents_[operand];
+        if(first == none || dependents_[first] != index)
+        {
+            dependents_.push_back(index);
+            next_dependents_.push_back(first);
+            first_dependents_[operand] = dependents_.size() - 1;
+        }
+    }
+
+    // Reserving the capacity of the other storage (rather than the size) only allocates when it grows
+    stack_.reserve(std::max(nodes_.capacity(), dependents_.capacity()));
+    pending_.reserve(nodes_.capacity());
+    return expression(index);
+}
+
+template<class T>
+std::size_t BasicExpressionGraph<T>::find(const Node& node) const
+{
+    std::size_t mask = recorded_.size() - 1;
+    for(std::size_t slot = hashNode<T>(node) & mask;; slot = (slot + 1) & mask)
+    {
+        std::size_t index = recorded_[slot];
+        if(index == none || equalNodes(nodes_[index], node))
+        {
+            return slot;
+        }
+    }
+}
+
+template<class T>
+void BasicExpressionGraph<T>::rehash(std::size_t size)
+{
+    recorded_.assign(size, none);
+    for(std::size_t index = 0; index < nodes_.size(); ++index)
+    {
+        if(nodes_[index].operation != Operation::Input)
+        {
+            recorded_[find(nodes_[index])] = index;
+        }
+    }
+}
+
+template<class T>
+BasicExpression<T> BasicExpressionGraph<T>::expression(std::size_t index)
+{
+    return BasicExpression<T>(this, index);
+}
+
+template<class T>
+std::size_t BasicExpressionGraph<T>::indexOf(const BasicExpression<T>& expression) const
+{
+    if(expression.graph_ != this)
+    {
+        throw std::invalid_argument("ExpressionGraph: Expression belongs to a different graph");
+    }
+
+    return expression.index_;
+}
+
+template<class T>
+void BasicExpressionGraph<T>::calculate(std::size_t index) noexcept
+{
+    if(!dirty_[index])
+    {
+        return;
+    }
+
+    // Find the dirty nodes that the node depends on. Clean nodes only depend on clean nodes, so are not searched
+    stack_.assign(1, index);
+    pending_.clear();
+    dirty_[index] = false;
+    while(!stack_.empty())
+    {
+        std::size_t node = stack_.back();
+        stack_.pop_back();
+        pending_.push_back(node);
+
+        for(std::size_t i = 0; i < operandCount(nodes_[node].operation); ++i)
+        {
+            std::size_t operand = nodes_[node].operands[i];
+            if(dirty_[operand])
+            {
+                dirty_[operand] = false;
+                stack_.push_back(operand);
+            }
+        }
+    }
+
+    // Nodes are only recorded after their operands, so calculating them in order respects the dependencies
+    std::sort(pending_.begin(), pending_.end());
+    for(std::size_t node : pending_)
+    {
+        calculateNode(node);
+    }
+}
+
+template<class T>
+void BasicExpressionGraph<T>::calculateNode(std::size_t index) noexcept
+{
+    const Node& node = nodes_[index];
+    const std::size_t a = node.operands[0];
+    const std::size_t b = node.operands[1];
+    const std::size_t c = node.operands[2];
+    const T x = node.parameters[0];
+    const T y = node.parameters[1];
+
+    detail::Moments<T> result;
+    switch(node.operation)
+    {
+    case Operation::Input:
+        return;
+    case Operation::Affine:
+        result = detail::Moments<T>{means_[a] * x + y, variances_[a] * (x * x)};
+        break;
+    case Operation::Add:
+        result = detail::Moments<T>{means_[a] + means_[b], variances_[a] + variances_[b]};
+        break;
+    case Operation::Subtract:
+        result = detail::Moments<T>{means_[a] - means_[b], variances_[a] + variances_[b]};
+        break;
+    case Operation::Multiply:
+        result = detail::multiply(means_[a], variances_[a], means_[b], variances_[b]);
+        break;
+    case Operation::Max:
+        result = detail::max(means_[a], variances_[a], means_[b], variances_[b]);
+        break;
+    case Operation::Min:
+        result = detail::min(means_[a], variances_[a], means_[b], variances_[b]);
+        break;
+    case Operation::Rectify:
+        result = detail::rectify(means_[a], variances_[a], x, y);
+        break;
+    case Operation::RectifyLower:
+        result = detail::rectifyLower(means_[a], variances_[a], x);
+        break;
+    case Operation::RectifyUpper:
+        result = detail::rectifyUpper(means_[a], variances_[a], x);
+        break;
+    case Operation::Truncate:
+        result = detail::truncate(means_[a], variances_[a], x, y);
+        break;
+    case Operation::TruncateLower:
+        result = detail::truncateLower(means_[a], variances_[a], x);
+        break;
+    case Operation::TruncateUpper:
+        result = detail::truncateUpper(means_[a], variances_[a], x);
+        break;
+    case Operation::TruncateBy:
+        result = detail::truncate(means_[a], variances_[a], means_[b], variances_[b], means_[c], variances_[c]);
+        break;
+    case Operation::TruncateLowerBy:
+        result = detail::truncateLower(means_[a], variances_[a], means_[b], variances_[b]);
+        break;
+    case Operation::TruncateUpperBy:
+        result = detail::truncateUpper(means_[a], variances_[a], means_[b], variances_[b]);
+        break;
+    }
+
+    means_[index] = result.mean;
+    variances_[index] = result.variance;
+    ++calculations_;
+}
+
+template<class T>
+BasicExpression<T> operator+(const BasicExpression<T>& expression1, const BasicExpression<T>& expression2)
+{
+    BasicExpressionGraph<T>& graph = expression1.graph();
+    return graph.record(BasicExpressionGraph<T>::Operation::Add, expression1.index(), graph.indexOf(expression2), 0, 0, 0);
+}
+
+template<class T>
+BasicExpression<T> operator-(const BasicExpression<T>& expression1, const BasicExpression<T>& expression2)
+{
+    BasicExpressionGraph<T>& graph = expression1.graph();
+    return graph.record(BasicExpressionGraph<T>::Operation::Subtract, expression1.index(), graph.indexOf(expression2), 0, 0, 0);
+}
+
+template<class T>
+BasicExpression<T> operator*(const BasicExpression<T>& expression1, const BasicExpression<T>& expression2)
+{
+    BasicExpressionGraph<T>& graph = expression1.graph();
+    return graph.record(BasicExpressionGraph<T>::Operation::Multiply, expression1.index(), graph.indexOf(expression2), 0, 0, 0);
+}
+
+template<class T>
+BasicExpression<T> affine(const BasicExpression<T>& expression, T scale, T offset)
+{
+    typedef typename BasicExpressionGraph<T>::Operation Operation;
+    BasicExpressionGraph<T>& graph = expression.graph();
+
+    // Fuse with an existing scale and offset: (x * scale1 + offset1) * scale + offset
+    std::size_t operand = expression.index();
+    const auto& node = graph.nodes_[operand];
+    if(node.operation == Operation::Affine)
+    {
+        operand = node.operands[0];
+        offset = node.parameters[1] * scale + offset;
+        scale = node.parameters[0] * scale;
+    }
+
+    if(scale == 1 && offset == 0)
+    {
+        return graph.expression(operand);
+    }
+
+    return graph.record(Operation::Affine, operand, 0, 0, scale, offset);
+}
+
+template class BasicExpression<float>;
+template class BasicExpression<double>;
+template class BasicExpression<long double>;
+
+template class BasicExpressionGraph<float>;
+template class BasicExpressionGraph<double>;
+template class BasicExpressionGraph<long double>;
+
+#define NRV_INSTANTIATE_EXPRESSION_OPERATORS(T) \
+    template BasicExpression<T> operator+(const BasicExpression<T>& expression1, const BasicExpression<T>& expression2); \
+    template BasicExpression<T> operator-(const BasicExpression<T>& expression1, const BasicExpression<T>& expression2); \
+    template BasicExpression<T> operator*(const BasicExpression<T>& expression1, const BasicExpression<T>& expression2); \
+    template BasicExpression<T> affine(const BasicExpression<T>& expression, T scale, T offset);
+
+NRV_INSTANTIATE_EXPRESSION_OPERATORS(float)
+NRV_INSTANTIATE_EXPRESSION_OPERATORS(double)
+NRV_INSTANTIATE_EXPRESSION_OPERATORS(long double)
+
+} // namespace NRV
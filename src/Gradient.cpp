@@ -0,0 +1,702 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "NormalRandomVariable/Gradient.h"
+#include "Kernels.h"
+
+namespace NRV {
+
+namespace {
+
+/**
+ * Bound of a truncation or rectification, which is a random variable, a scalar (variance of 0) or absent
+ */
+template<class T>
+struct Bound {
+    T mean;
+    T variance;
+    bool present;
+};
+
+template<class T>
+Bound<T> absent()
+{
+    return {0, 0, false};
+}
+
+template<class T>
+Bound<T> scalar(T value)
+{
+    return {value, 0, true};
+}
+
+template<class T>
+Bound<T> randomVariable(const BasicNormalRandomVariable<T>& random_variable)
+{
+    return {random_variable.mean(), random_variable.variance(), true};
+}
+
+/**
+ * Derivatives of cdf(z), pdf(z) / r and z * pdf(z) / w at one bound of a truncation, which is
+ * z = (bound mean - mean) / r standard deviations of the difference from the mean, where r = sqrt(w) and
+ * w = variance + bound variance
+ */
+template<class T>
+struct SideDerivative {
+    T cdf;
+    T g;
+    T h;
+};
+
+/**
+ * Quantities at one bound, with their derivatives with respect to the bound mean minus the mean (by_position) and
+ * with respect to w (by_width). An absent bound has a pdf of 0, so that it does not contribute to the derivatives
+ */
+template<class T>
+struct Side {
+    T cdf;
+    T g;
+    T h;
+    SideDerivative<T> by_position;
+    SideDerivative<T> by_width;
+};
+
+template<class T>
+Side<T> side(T mean, T variance, const Bound<T>& bound, T absent_cdf)
+{
+    if(!bound.present)
+    {
+        return {absent_cdf, 0, 0, {0, 0, 0}, {0, 0, 0}};
+    }
+
+    T inverse_w = 1 / (variance + bound.variance);
+    T inverse_r = std::sqrt(inverse_w);
+    T z = (bound.mean - mean) * inverse_r;
+    detail::Gaussian<T> at_z = detail::gaussian(z);
+    T pdf = detail::Constants<T>::one_on_sqrt_two_pi * at_z.exp;
+    T z_squared = z * z;
+
+    return {(1 + at_z.erf) / 2, pdf * inverse_r, z * pdf * inverse_w,
+            {pdf * inverse_r, -z * pdf * inverse_w, (1 - z_squared) * pdf * inverse_r * inverse_w},
+            {-z * pdf * inverse_w / 2, (z_squared - 1) * pdf * inverse_r * inverse_w / 2,
+             -z * (3 - z_squared) * pdf * inverse_w * inverse_w / 2}};
+}
+
+/**
+ * Partial derivatives of a truncation with respect to the mean, variance, lower mean, lower variance, upper mean and
+ * upper variance. With Z = cdf(z_upper) - cdf(z_lower), g = pdf(z_lower) / r_lower - pdf(z_upper) / r_upper and
+ * h = z_lower * pdf(z_lower) / w_lower - z_upper * pdf(z_upper) / w_upper, the truncation kernels calculate
+ * mean + variance * g / Z and variance - (variance * g / Z)^2 + variance^2 * h / Z (for scalar bounds, and for
+ * random variable bounds that are applied together)
+ */
+template<class T>
+std::array<Partial<T>, 6> truncationPartials(T mean, T variance, const Bound<T>& lower, const Bound<T>& upper)
+{
+    Side<T> c = side(mean, variance, lower, T(0));
+    Side<T> d = side(mean, variance, upper, T(1));
+
+    T inverse_Z = 1 / (d.cdf - c.cdf);
+    T g = (c.g - d.g) * inverse_Z;
+    T h = (c.h - d.h) * inverse_Z;
+    T shift = variance * g;
+
+    // Derivatives of the quantities at the lower and upper bounds with respect to each input
+    const SideDerivative<T> zero = {0, 0, 0};
+    const SideDerivative<T> negative_c = {-c.by_position.cdf, -c.by_position.g, -c.by_position.h};
+    const SideDerivative<T> negative_d = {-d.by_position.cdf, -d.by_position.g, -d.by_position.h};
+    const SideDerivative<T> by_input[6][2] = {
+        {negative_c, negative_d},
+        {c.by_width, d.by_width},
+        {c.by_position, zero},
+        {c.by_width, zero},
+        {zero, d.by_position},
+        {zero, d.by_width}
+    };
+
+    std::array<Partial<T>, 6> partials;
+    for(std::size_t input = 0; input < 6; ++input)
+    {
+        T d_mean = input == 0 ? 1 : 0;
+        T d_variance = input == 1 ? 1 : 0;
+        const SideDerivative<T>& d_c = by_input[input][0];
+        const SideDerivative<T>& d_d = by_input[input][1];
+
+        // Relative derivative of Z, and derivatives of g / Z and h / Z
+        T d_Z = (d_d.cdf - d_c.cdf) * inverse_Z;
+        T d_g = (d_c.g - d_d.g) * inverse_Z - g * d_Z;
+        T d_h = (d_c.h - d_d.h) * inverse_Z - h * d_Z;
+        T d_shift = d_variance * g + variance * d_g;
+
+        partials[input] = {d_mean + d_shift,
+                d_variance - 2 * shift * d_shift + 2 * variance * d_variance * h + variance * variance * d_h};
+    }
+
+    return partials;
+}
+
+/**
+ * Partial derivatives of outer(inner(x)) with respect to x, given the partial derivatives of outer with respect to
+ * the mean and variance of inner, and of inner with respect to x
+ */
+template<class T>
+Partial<T> chain(const Partial<T>& by_mean, const Partial<T>& by_variance, const Partial<T>& inner)
+{
+    return {by_mean.mean * inner.mean + by_variance.mean * inner.variance,
+            by_mean.variance * inner.mean + by_variance.variance * inner.variance};
+}
+
+/**
+ * Partial derivatives of a rectification with respect to the mean, variance, lower bound and upper bound. For the
+ * standard normal distribution rectified between c and d, the derivatives of the mean m are cdf(c) and 1 - cdf(d),
+ * and of the variance are 2 * cdf(c) * (c - m) and 2 * (1 - cdf(d)) * (d - m)
+ */
+template<class T>
+std::array<Partial<T>, 4> rectificationPartials(T mean, T variance, const Bound<T>& lower, const Bound<T>& upper,
+        const BasicNormalRandomVariable<T>& result)
+{
+    T sqrt_variance = std::sqrt(variance);
+    T m = (result.mean() - mean) / sqrt_variance;
+    T v = result.variance() / variance;
+
+    T c = 0;
+    T m_c = 0;
+    T v_c = 0;
+    if(lower.present)
+    {
+        c = (lower.mean - mean) / sqrt_variance;
+        m_c = (1 + detail::gaussian(c).erf) / 2;
+        v_c = 2 * m_c * (c - m);
+    }
+
+    T d = 0;
+    T m_d = 0;
+    T v_d = 0;
+    if(upper.present)
+    {
+        d = (upper.mean - mean) / sqrt_variance;
+        m_d = (1 - detail::gaussian(d).erf) / 2;
+        v_d = 2 * m_d * (d - m);
+    }
+
+    return {{{1 - m_c - m_d, -sqrt_variance * (v_c + v_d)},
+             {(m - c * m_c - d * m_d) / (2 * sqrt_variance), v - (c * v_c + d * v_d) / 2},
+             {m_c, sqrt_variance * v_c},
+             {m_d, sqrt_variance * v_d}}};
+}
+
+/**
+ * Partial derivatives of Clark's maximum, using those of its mean and second moment
+ */
+template<class T>
+std::array<Partial<T>, 4> maxPartials(T mean1, T variance1, T mean2, T variance2, T result_mean)
+{
+    T alpha = std::sqrt(variance1 + variance2);
+    T beta = (mean1 - mean2) / alpha;
+
+    T phi_beta = T(0.5) * (1 + std::erf(beta * detail::Constants<T>::one_on_sqrt_two));
+    T phi_neg_beta = T(0.5) * (1 + std::erf(-beta * detail::Constants<T>::one_on_sqrt_two));
+    T pdf = detail::Constants<T>::one_on_sqrt_two_pi * std::exp(-beta * beta / 2);
+
+    // Both variances change the mean by pdf / (2 * alpha), and share a term of the change in the second moment
+    T mean_by_variance = pdf / (2 * alpha);
+    T second_by_variance = pdf * ((mean1 + mean2) - beta * (variance1 - variance2) / alpha) / (2 * alpha);
+
+    Partial<T> second[4] = {
+        {phi_beta, 2 * mean1 * phi_beta + 2 * variance1 * pdf / alpha},
+        {mean_by_variance, phi_beta + second_by_variance},
+        {phi_neg_beta, 2 * mean2 * phi_neg_beta + 2 * variance2 * pdf / alpha},
+        {mean_by_variance, phi_neg_beta + second_by_variance}
+    };
+
+    std::array<Partial<T>, 4> partials;
+    for(std::size_t input = 0; input < 4; ++input)
+    {
+        partials[input] = {second[input].mean, second[input].variance - 2 * result_mean * second[input].mean};
+    }
+
+    return partials;
+}
+
+} // namespace
+
+template<class T>
+WithGradient<T, 4> maxWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2)
+{
+    BasicNormalRandomVariable<T> value = rv1.max(rv2);
+    return {value, maxPartials(rv1.mean(), rv1.variance(), rv2.mean(), rv2.variance(), value.mean())};
+}
+
+template<class T>
+WithGradient<T, 4> minWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2)
+{
+    // Reflect the maximum, which negates the derivatives of the mean with respect to the variances and of the
+    // variance with respect to the means
+    BasicNormalRandomVariable<T> value = rv1.min(rv2);
+    std::array<Partial<T>, 4> partials = maxPartials(-rv1.mean(), rv1.variance(), -rv2.mean(), rv2.variance(), -value.mean());
+    for(std::size_t input = 0; input < 4; ++input)
+    {
+        if(input % 2 == 0)
+        {
+            partials[input].variance = -partials[input].variance;
+        }
+        else
+        {
+            partials[input].mean = -partials[input].mean;
+        }
+    }
+
+    return {value, partials};
+}
+
+template<class T>
+WithGradient<T, 4> multiplyWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2)
+{
+    // The variance is variance1 * variance2 + mean1^2 * variance2 + mean2^2 * variance1
+    return {rv1 * rv2, {{{rv2.mean(), 2 * rv1.mean() * rv2.variance()},
+                         {0, rv2.variance() + rv2.mean() * rv2.mean()},
+                         {rv1.mean(), 2 * rv2.mean() * rv1.variance()},
+                         {0, rv1.variance() + rv1.mean() * rv1.mean()}}}};
+}
+
+template<class T>
+WithGradient<T, 2> inverseWithGradient(const BasicNormalRandomVariable<T>& rv)
+{
+    // The mean is mean / D and the variance is variance / D^2, where D = mean^2 - variance
+    BasicNormalRandomVariable<T> value = rv.inverse();
+    T mean = rv.mean();
+    T variance = rv.variance();
+    T D = mean * mean - variance;
+    T D_squared = D * D;
+    return {value, {{{-(mean * mean + variance) / D_squared, -4 * mean * variance / (D_squared * D)},
+                     {mean / D_squared, (mean * mean + variance) / (D_squared * D)}}}};
+}
+
+template<class T>
+WithGradient<T, 4> divideWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2)
+{
+    if(!detail::divisionApproximationValid<T>(rv1.mean(), rv1.variance(), rv2.mean(), rv2.variance()))
+    {
+        // Multiply rv1 by the inverse of rv2 (see operator/)
+        WithGradient<T, 2> inverse = inverseWithGradient(rv2);
+        WithGradient<T, 4> product = multiplyWithGradient(rv1, inverse.value);
+        return {product.value, {{product.partials[0], product.partials[1],
+                                 chain(product.partials[2], product.partials[3], inverse.partials[0]),
+                                 chain(product.partials[2], product.partials[3], inverse.partials[1])}}};
+    }
+
+    // The closed-form approximation simplifies to a mean of |mean1| / D1 and a second moment of
+    // (mean1^2 + variance1) / D2
+    T mean1 = rv1.mean();
+    T variance1 = rv1.variance();
+    T mean2 = rv2.mean();
+    T variance2 = rv2.variance();
+    T sign1 = mean1 < 0 ? -1 : 1;
+    T sign2 = mean2 < 0 ? -1 : 1;
+    T sqrt_variance2 = std::sqrt(variance2);
+
+    T D1 = T(1.01) * std::abs(mean2) - T(0.2713) * sqrt_variance2;
+    T D2 = mean2 * mean2 + T(0.108) * std::abs(mean2) * sqrt_variance2 - T(3.795) * variance2;
+    T mean = std::abs(mean1) / D1;
+    T second = (mean1 * mean1 + variance1) / D2;
+
+    Partial<T> moments[4] = {
+        {sign1 / D1, 2 * mean1 / D2},
+        {0, 1 / D2},
+        {-mean * T(1.01) * sign2 / D1, -second * (2 * mean2 + T(0.108) * sign2 * sqrt_variance2) / D2},
+        {mean * T(0.2713) / (2 * sqrt_variance2 * D1), -second * (T(0.108) * std::abs(mean2) / (2 * sqrt_variance2) - T(3.795)) / D2}
+    };
+
+    WithGradient<T, 4> result = {rv1 / rv2, {}};
+    for(std::size_t input = 0; input < 4; ++input)
+    {
+        result.partials[input] = {moments[input].mean, moments[input].variance - 2 * mean * moments[input].mean};
+    }
+
+    return result;
+}
+
+template<class T>
+WithGradient<T, 4> rectifyWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type lower, typename BasicNormalRandomVariable<T>::value_type upper)
+{
+    BasicNormalRandomVariable<T> value = rv.rectify(lower, upper);
+    return {value, rectificationPartials(rv.mean(), rv.variance(), scalar(lower), scalar(upper), value)};
+}
+
+template<class T>
+WithGradient<T, 3> rectifyLowerWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type lower)
+{
+    BasicNormalRandomVariable<T> value = rv.rectifyLower(lower);
+    std::array<Partial<T>, 4> partials = rectificationPartials(rv.mean(), rv.variance(), scalar(lower), absent<T>(), value);
+    return {value, {{partials[0], partials[1], partials[2]}}};
+}
+
+template<class T>
+WithGradient<T, 3> rectifyUpperWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type upper)
+{
+    BasicNormalRandomVariable<T> value = rv.rectifyUpper(upper);
+    std::array<Partial<T>, 4> partials = rectificationPartials(rv.mean(), rv.variance(), absent<T>(), scalar(upper), value);
+    return {value, {{partials[0], partials[1], partials[3]}}};
+}
+
+template<class T>
+WithGradient<T, 4> truncateWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type lower, typename BasicNormalRandomVariable<T>::value_type upper)
+{
+    BasicNormalRandomVariable<T> value = rv.truncate(lower, upper);
+    std::array<Partial<T>, 6> partials = truncationPartials(rv.mean(), rv.variance(), scalar(lower), scalar(upper));
+    return {value, {{partials[0], partials[1], partials[2], partials[4]}}};
+}
+
+template<class T>
+WithGradient<T, 3> truncateLowerWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type lower)
+{
+    BasicNormalRandomVariable<T> value = rv.truncateLower(lower);
+    std::array<Partial<T>, 6> partials = truncationPartials(rv.mean(), rv.variance(), scalar(lower), absent<T>());
+    return {value, {{partials[0], partials[1], partials[2]}}};
+}
+
+template<class T>
+WithGradient<T, 3> truncateUpperWithGradient(const BasicNormalRandomVariable<T>& rv,
+        typename BasicNormalRandomVariable<T>::value_type upper)
+{
+    BasicNormalRandomVariable<T> value = rv.truncateUpper(upper);
+    std::array<Partial<T>, 6> partials = truncationPartials(rv.mean(), rv.variance(), absent<T>(), scalar(upper));
+    return {value, {{partials[0], partials[1], partials[4]}}};
+}
+
+template<class T>
+WithGradient<T, 6> truncateWithGradient(const BasicNormalRandomVariable<T>& rv,
+        const BasicNormalRandomVariable<T>& lower, const BasicNormalRandomVariable<T>& upper)
+{
+    BasicNormalRandomVariable<T> value = rv.truncate(lower, upper);
+    T mean = rv.mean();
+    T variance = rv.variance();
+
+    detail::TruncationMethod method = detail::truncationMethod(lower.mean(), lower.variance(), upper.mean(), upper.variance());
+    if(method == detail::TruncationMethod::Together)
+    {
+        return {value, truncationPartials(mean, variance, randomVariable(lower), randomVariable(upper))};
+    }
+
+    // Chain the derivatives of the 2 truncations, in the same order as the kernel
+    bool lower_first = method == detail::TruncationMethod::LowerFirst;
+    detail::Moments<T> first_applied = lower_first
+            ? detail::truncateLower(mean, variance, lower.mean(), lower.variance())
+            : detail::truncateUpper(mean, variance, upper.mean(), upper.variance());
+    std::array<Partial<T>, 6> first = lower_first
+            ? truncationPartials(mean, variance, randomVariable(lower), absent<T>())
+            : truncationPartials(mean, variance, absent<T>(), randomVariable(upper));
+    std::array<Partial<T>, 6> second = lower_first
+            ? truncationPartials(first_applied.mean, first_applied.variance, absent<T>(), randomVariable(upper))
+            : truncationPartials(first_applied.mean, first_applied.variance, randomVariable(lower), absent<T>());
+
+    WithGradient<T, 6> result = {value, {}};
+    for(std::size_t input = 0; input < 6; ++input)
+    {
+        // The bounds of the second truncation only affect the result through it
+        bool second_bound = lower_first ? input >= 4 : input == 2 || input == 3;
+        result.partials[input] = second_bound ? second[input] : chain(second[0], second[1], first[input]);
+    }
+
+    return result;
+}
+
+template<class T>
+WithGradient<T, 4> truncateLowerWithGradient(const BasicNormalRandomVariable<T>& rv,
+        const BasicNormalRandomVariable<T>& lower)
+{
+    BasicNormalRandomVariable<T> value = rv.truncateLower(lower);
+    std::array<Partial<T>, 6> partials = truncationPartials(rv.mean(), rv.variance(), randomVariable(lower), absent<T>());
+    return {value, {{partials[0], partials[1], partials[2], partials[3]}}};
+}
+
+template<class T>
+WithGradient<T, 4> truncateUpperWithGradient(const BasicNormalRandomVariable<T>& rv,
+        const BasicNormalRandomVariable<T>& upper)
+{
+    BasicNormalRandomVariable<T> value = rv.truncateUpper(upper);
+    std::array<Partial<T>, 6> partials = truncationPartials(rv.mean(), rv.variance(), absent<T>(), randomVariable(upper));
+    return {value, {{partials[0], partials[1], partials[4], partials[5]}}};
+}
+
+template<class T>
+BasicDual<T> BasicDual<T>::parameter(T value, std::size_t index, std::size_t parameters)
+{
+    if(index >= parameters)
+    {
+        throw std::out_of_range("Dual: Parameter index must be less than the number of parameters");
+    }
+
+    std::vector<T> tangents(parameters, T(0));
+    tangents[index] = 1;
+    return BasicDual(value, std::move(tangents));
+}
+
+namespace {
+
+/**
+ * Returns value with the tangents sum(weights[i] * inputs[i]->tangents())
+ */
+template<class T, std::size_t N>
+BasicDual<T> linear(T value, const std::array<T, N>& weights, const std::array<const BasicDual<T>*, N>& inputs)
+{
+    std::size_t size = 0;
+    for(const BasicDual<T>* input : inputs)
+    {
+        size = std::max(size, input->tangents().size());
+    }
+
+    std::vector<T> tangents(size, T(0));
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        const std::vector<T>& input = inputs[i]->tangents();
+        for(std::size_t j = 0; j < input.size(); ++j)
+        {
+            tangents[j] += weights[i] * input[j];
+        }
+    }
+
+    return BasicDual<T>(value, std::move(tangents));
+}
+
+/**
+ * Returns the result of an operation, with the tangents of its inputs propagated through its partial derivatives
+ */
+template<class T, std::size_t N>
+BasicDualNormalRandomVariable<T> propagate(const WithGradient<T, N>& gradient, const std::array<const BasicDual<T>*, N>& inputs)
+{
+    std::array<T, N> mean_weights;
+    std::array<T, N> variance_weights;
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        mean_weights[i] = gradient.partials[i].mean;
+        variance_weights[i] = gradient.partials[i].variance;
+    }
+
+    return BasicDualNormalRandomVariable<T>(linear(gradient.value.mean(), mean_weights, inputs),
+            linear(gradient.value.variance(), variance_weights, inputs));
+}
+
+} // namespace
+
+template<class T>
+BasicDual<T> operator+(const BasicDual<T>& a, const BasicDual<T>& b)
+{
+    return linear<T, 2>(a.value() + b.value(), {{1, 1}}, {{&a, &b}});
+}
+
+template<class T>
+BasicDual<T> operator-(const BasicDual<T>& a, const BasicDual<T>& b)
+{
+    return linear<T, 2>(a.value() - b.value(), {{1, -1}}, {{&a, &b}});
+}
+
+template<class T>
+BasicDual<T> operator*(const BasicDual<T>& a, const BasicDual<T>& b)
+{
+    return linear<T, 2>(a.value() * b.value(), {{b.value(), a.value()}}, {{&a, &b}});
+}
+
+template<class T>
+BasicDual<T> operator/(const BasicDual<T>& a, const BasicDual<T>& b)
+{
+    T quotient = a.value() / b.value();
+    return linear<T, 2>(quotient, {{1 / b.value(), -quotient / b.value()}}, {{&a, &b}});
+}
+
+template<class T>
+BasicDual<T> operator-(const BasicDual<T>& a)
+{
+    return linear<T, 1>(-a.value(), {{-1}}, {{&a}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T>::BasicDualNormalRandomVariable(BasicDual<T> mean, BasicDual<T> variance)
+: mean_(std::move(mean)), variance_(std::move(variance))
+{
+    if(!(variance_.value() > 0))
+    {
+        throw std::range_error("DualNormalRandomVariable: Variance must be greater than 0");
+    }
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::inverse() const
+{
+    return propagate<T, 2>(inverseWithGradient(value()), {{&mean_, &variance_}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::rectify(const BasicDual<T>& lower, const BasicDual<T>& upper) const
+{
+    return propagate<T, 4>(rectifyWithGradient(value(), lower.value(), upper.value()), {{&mean_, &variance_, &lower, &upper}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::rectifyLower(const BasicDual<T>& lower) const
+{
+    return propagate<T, 3>(rectifyLowerWithGradient(value(), lower.value()), {{&mean_, &variance_, &lower}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::rectifyUpper(const BasicDual<T>& upper) const
+{
+    return propagate<T, 3>(rectifyUpperWithGradient(value(), upper.value()), {{&mean_, &variance_, &upper}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::truncate(const BasicDual<T>& lower, const BasicDual<T>& upper) const
+{
+    return propagate<T, 4>(truncateWithGradient(value(), lower.value(), upper.value()), {{&mean_, &variance_, &lower, &upper}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::truncateLower(const BasicDual<T>& lower) const
+{
+    return propagate<T, 3>(truncateLowerWithGradient(value(), lower.value()), {{&mean_, &variance_, &lower}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::truncateUpper(const BasicDual<T>& upper) const
+{
+    return propagate<T, 3>(truncateUpperWithGradient(value(), upper.value()), {{&mean_, &variance_, &upper}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::truncate(const BasicDualNormalRandomVariable& lower,
+        const BasicDualNormalRandomVariable& upper) const
+{
+    return propagate<T, 6>(truncateWithGradient(value(), lower.value(), upper.value()),
+            {{&mean_, &variance_, &lower.mean_, &lower.variance_, &upper.mean_, &upper.variance_}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::truncateLower(const BasicDualNormalRandomVariable& lower) const
+{
+    return propagate<T, 4>(truncateLowerWithGradient(value(), lower.value()), {{&mean_, &variance_, &lower.mean_, &lower.variance_}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::truncateUpper(const BasicDualNormalRandomVariable& upper) const
+{
+    return propagate<T, 4>(truncateUpperWithGradient(value(), upper.value()), {{&mean_, &variance_, &upper.mean_, &upper.variance_}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::max(const BasicDualNormalRandomVariable& random_variable) const
+{
+    return propagate<T, 4>(maxWithGradient(value(), random_variable.value()),
+            {{&mean_, &variance_, &random_variable.mean_, &random_variable.variance_}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> BasicDualNormalRandomVariable<T>::min(const BasicDualNormalRandomVariable& random_variable) const
+{
+    return propagate<T, 4>(minWithGradient(value(), random_variable.value()),
+            {{&mean_, &variance_, &random_variable.mean_, &random_variable.variance_}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator+(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2)
+{
+    return BasicDualNormalRandomVariable<T>(rv1.mean() + rv2.mean(), rv1.variance() + rv2.variance());
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator+(const BasicDualNormalRandomVariable<T>& rv, const typename BasicDualNormalRandomVariable<T>::dual_type& num)
+{
+    return BasicDualNormalRandomVariable<T>(rv.mean() + num, rv.variance());
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator-(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2)
+{
+    return BasicDualNormalRandomVariable<T>(rv1.mean() - rv2.mean(), rv1.variance() + rv2.variance());
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator-(const BasicDualNormalRandomVariable<T>& rv, const typename BasicDualNormalRandomVariable<T>::dual_type& num)
+{
+    return BasicDualNormalRandomVariable<T>(rv.mean() - num, rv.variance());
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator-(const BasicDualNormalRandomVariable<T>& rv)
+{
+    return BasicDualNormalRandomVariable<T>(-rv.mean(), rv.variance());
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator*(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2)
+{
+    return propagate<T, 4>(multiplyWithGradient(rv1.value(), rv2.value()),
+            {{&rv1.mean(), &rv1.variance(), &rv2.mean(), &rv2.variance()}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator*(const BasicDualNormalRandomVariable<T>& rv, const typename BasicDualNormalRandomVariable<T>::dual_type& num)
+{
+    return BasicDualNormalRandomVariable<T>(rv.mean() * num, rv.variance() * (num * num));
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator/(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2)
+{
+    return propagate<T, 4>(divideWithGradient(rv1.value(), rv2.value()),
+            {{&rv1.mean(), &rv1.variance(), &rv2.mean(), &rv2.variance()}});
+}
+
+template<class T>
+BasicDualNormalRandomVariable<T> operator/(const BasicDualNormalRandomVariable<T>& rv, const typename BasicDualNormalRandomVariable<T>::dual_type& num)
+{
+    return BasicDualNormalRandomVariable<T>(rv.mean() / num, rv.variance() / (num * num));
+}
+
+template class BasicDual<float>;
+template class BasicDual<double>;
+template class BasicDual<long double>;
+
+template class BasicDualNormalRandomVariable<float>;
+template class BasicDualNormalRandomVariable<double>;
+template class BasicDualNormalRandomVariable<long double>;
+
+#define NRV_INSTANTIATE_GRADIENT(T) \
+    template WithGradient<T, 4> maxWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2); \
+    template WithGradient<T, 4> minWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2); \
+    template WithGradient<T, 4> multiplyWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2); \
+    template WithGradient<T, 4> divideWithGradient(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2); \
+    template WithGradient<T, 2> inverseWithGradient(const BasicNormalRandomVariable<T>& rv); \
+    template WithGradient<T, 4> rectifyWithGradient(const BasicNormalRandomVariable<T>& rv, T lower, T upper); \
+    template WithGradient<T, 3> rectifyLowerWithGradient(const BasicNormalRandomVariable<T>& rv, T lower); \
+    template WithGradient<T, 3> rectifyUpperWithGradient(const BasicNormalRandomVariable<T>& rv, T upper); \
+    template WithGradient<T, 4> truncateWithGradient(const BasicNormalRandomVariable<T>& rv, T lower, T upper); \
+    template WithGradient<T, 3> truncateLowerWithGradient(const BasicNormalRandomVariable<T>& rv, T lower); \
+    template WithGradient<T, 3> truncateUpperWithGradient(const BasicNormalRandomVariable<T>& rv, T upper); \
+    template WithGradient<T, 6> truncateWithGradient(const BasicNormalRandomVariable<T>& rv, const BasicNormalRandomVariable<T>& lower, const BasicNormalRandomVariable<T>& upper); \
+    template WithGradient<T, 4> truncateLowerWithGradient(const BasicNormalRandomVariable<T>& rv, const BasicNormalRandomVariable<T>& lower); \
+    template WithGradient<T, 4> truncateUpperWithGradient(const BasicNormalRandomVariable<T>& rv, const BasicNormalRandomVariable<T>& upper); \
+    template BasicDual<T> operator+(const BasicDual<T>& a, const BasicDual<T>& b); \
+    template BasicDual<T> operator-(const BasicDual<T>& a, const BasicDual<T>& b); \
+    template BasicDual<T> operator*(const BasicDual<T>& a, const BasicDual<T>& b); \
+    template BasicDual<T> operator/(const BasicDual<T>& a, const BasicDual<T>& b); \
+    template BasicDual<T> operator-(const BasicDual<T>& a); \
+    template BasicDualNormalRandomVariable<T> operator+(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2); \
+    template BasicDualNormalRandomVariable<T> operator+(const BasicDualNormalRandomVariable<T>& rv, const BasicDual<T>& num); \
+    template BasicDualNormalRandomVariable<T> operator-(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2); \
+    template BasicDualNormalRandomVariable<T> operator-(const BasicDualNormalRandomVariable<T>& rv, const BasicDual<T>& num); \
+    template BasicDualNormalRandomVariable<T> operator-(const BasicDualNormalRandomVariable<T>& rv); \
+    template BasicDualNormalRandomVariable<T> operator*(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2); \
+    template BasicDualNormalRandomVariable<T> operator*(const BasicDualNormalRandomVariable<T>& rv, const BasicDual<T>& num); \
+    template BasicDualNormalRandomVariable<T> operator/(const BasicDualNormalRandomVariable<T>& rv1, const BasicDualNormalRandomVariable<T>& rv2); \
+    template BasicDualNormalRandomVariable<T> operator/(const BasicDualNormalRandomVariable<T>& rv, const BasicDual<T>& num);
+
+NRV_INSTANTIATE_GRADIENT(float)
+NRV_INSTANTIATE_GRADIENT(double)
+NRV_INSTANTIATE_GRADIENT(long double)
+
+} // namespace NRV
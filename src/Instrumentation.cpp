@@ -0,0 +1,170 @@
+#include <mutex>
+#include <vector>
+
+#include "NormalRandomVariable/Instrumentation.h"
+#include "Instrumentation.h"
+
+namespace NRV {
+namespace detail {
+
+thread_local InstrumentationBlock* thread_instrumentation_block = nullptr;
+
+namespace {
+
+/**
+ * Sums of counters, in the same layout as a snapshot
+ */
+struct Totals {
+    InstrumentationSnapshot counters;
+
+    void add(const InstrumentationBlock& block)
+    {
+        for(std::size_t i = 0; i < instrumented_operation_count; ++i)
+        {
+            counters.operations[i].calls += block.calls[i].load(std::memory_order_relaxed);
+            counters.operations[i].exceptions += block.exceptions[i].load(std::memory_order_relaxed);
+            counters.operations[i].sampled_calls += block.sampled_calls[i].load(std::memory_order_relaxed);
+            counters.operations[i].sampled_ticks += block.sampled_ticks[i].load(std::memory_order_relaxed);
+        }
+        for(std::size_t i = 0; i < instrumented_branch_count; ++i)
+        {
+            counters.branches[i] += block.branches[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+/**
+ * Blocks of the running threads, the totals of the threads that have exited, and the totals at the last reset (which
+ * are subtracted from snapshots, so that the threads never need to reset their own counters). The mutex is only
+ * locked when a thread starts or exits, and by snapshots and resets
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<InstrumentationBlock*> blocks;
+    Totals retired = {};
+    Totals baseline = {};
+
+    Totals totals()
+    {
+        Totals result = retired;
+        for(InstrumentationBlock* block : blocks)
+        {
+            result.add(*block);
+        }
+
+        return result;
+    }
+};
+
+/**
+ * The registry is never destroyed, so that threads can retire their blocks during static destruction
+ */
+Registry& registry()
+{
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+/**
+ * Owner of the block of a thread, which retires it when the thread exits
+ */
+struct BlockOwner {
+    InstrumentationBlock block;
+
+    BlockOwner()
+    {
+        for(std::size_t i = 0; i < instrumented_operation_count; ++i)
+        {
+            block.calls[i].store(0, std::memory_order_relaxed);
+            block.exceptions[i].store(0, std::memory_order_relaxed);
+            block.sampled_calls[i].store(0, std::memory_order_relaxed);
+            block.sampled_ticks[i].store(0, std::memory_order_relaxed);
+        }
+        for(std::size_t i = 0; i < instrumented_branch_count; ++i)
+        {
+            block.branches[i].store(0, std::memory_order_relaxed);
+        }
+        block.countdown = instrumentation_sample_period;
+
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        registry().blocks.push_back(&block);
+    }
+
+    ~BlockOwner()
+    {
+        thread_instrumentation_block = nullptr;
+
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        std::vector<InstrumentationBlock*>& blocks = registry().blocks;
+        for(std::size_t i = 0; i < blocks.size(); ++i)
+        {
+            if(blocks[i] == &block)
+            {
+                blocks[i] = blocks.back();
+                blocks.pop_back();
+                break;
+            }
+        }
+        registry().retired.add(block);
+    }
+};
+
+} // namespace
+
+InstrumentationBlock* registerInstrumentationBlock()
+{
+    thread_local BlockOwner owner;
+    thread_instrumentation_block = &owner.block;
+    return &owner.block;
+}
+
+} // namespace detail
+
+InstrumentationSnapshot instrumentationSnapshot()
+{
+    detail::Registry& registry = detail::registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    InstrumentationSnapshot snapshot = registry.totals().counters;
+    const InstrumentationSnapshot& baseline = registry.baseline.counters;
+
+    for(std::size_t i = 0; i < instrumented_operation_count; ++i)
+    {
+        snapshot.operations[i].calls -= baseline.operations[i].calls;
+        snapshot.operations[i].exceptions -= baseline.operations[i].exceptions;
+        snapshot.operations[i].sampled_calls -= baseline.operations[i].sampled_calls;
+        snapshot.operations[i].sampled_ticks -= baseline.operations[i].sampled_ticks;
+    }
+    for(std::size_t i = 0; i < instrumented_branch_count; ++i)
+    {
+        snapshot.branches[i] -= baseline.branches[i];
+    }
+
+    return snapshot;
+}
+
+void resetInstrumentation()
+{
+    detail::Registry& registry = detail::registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.baseline = registry.totals();
+}
+
+const char* instrumentationName(InstrumentedOperation operation)
+{
+    static const char* const names[instrumented_operation_count] = {
+        "inverse", "rectify", "rectifyLower", "rectifyUpper", "truncate", "truncateLower", "truncateUpper",
+        "truncateBy", "truncateLowerBy", "truncateUpperBy", "max", "min", "multiply", "divide", "divideConstant"
+    };
+    return names[static_cast<std::size_t>(operation)];
+}
+
+const char* instrumentationName(InstrumentedBranch branch)
+{
+    static const char* const names[instrumented_branch_count] = {
+        "inverseOutOfRange", "divideClosedForm", "divideByInverse", "truncateTogether", "truncateLowerFirst",
+        "truncateUpperFirst"
+    };
+    return names[static_cast<std::size_t>(branch)];
+}
+
+} // namespace NRV
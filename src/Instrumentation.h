@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "NormalRandomVariable/Instrumentation.h"
+#include "Kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * Instrumentation of the operations, which compiles to nothing unless NRV_INSTRUMENTATION is defined
+ * - NRV_COUNT_CALL(Operation) counts a call of the operation, and times it if it is sampled, until the end of the
+ *   enclosing scope
+ * - NRV_TRY and NRV_CATCH(Operation) surround the body of an operation (as a function-try-block) to count the
+ *   exceptions that leave it, without any cost when no exception is thrown
+ * - NRV_COUNT_BRANCH(Branch) counts a branch, and NRV_COUNT_TRUNCATION_METHOD(bounds) counts the method that
+ *   truncation by the bounds uses (which is only calculated if the instrumentation is enabled)
+ */
+#ifdef NRV_INSTRUMENTATION
+#define NRV_COUNT_CALL(operation) \
+    detail::InstrumentationScope nrv_instrumentation_scope(InstrumentedOperation::operation)
+#define NRV_TRY try
+#define NRV_CATCH(operation) \
+    catch(...) \
+    { \
+        detail::countException(InstrumentedOperation::operation); \
+        throw; \
+    }
+#define NRV_COUNT_BRANCH(branch) detail::countBranch(InstrumentedBranch::branch)
+#define NRV_COUNT_TRUNCATION_METHOD(lower_mean, lower_variance, upper_mean, upper_variance) \
+    detail::countTruncationMethod(detail::truncationMethod(lower_mean, lower_variance, upper_mean, upper_variance))
+#else
+#define NRV_COUNT_CALL(operation) static_cast<void>(0)
+#define NRV_TRY
+#define NRV_CATCH(operation)
+#define NRV_COUNT_BRANCH(branch) static_cast<void>(0)
+#define NRV_COUNT_TRUNCATION_METHOD(lower_mean, lower_variance, upper_mean, upper_variance) static_cast<void>(0)
+#endif
+
+namespace NRV {
+namespace detail {
+
+/**
+ * Counters of one thread. Only the owning thread writes them, using a relaxed load and store rather than a locked
+ * increment, so that counting is as cheap as incrementing a local variable. Snapshots read them from other threads
+ */
+struct InstrumentationBlock {
+    std::atomic<std::uint64_t> calls[instrumented_operation_count];
+    std::atomic<std::uint64_t> exceptions[instrumented_operation_count];
+    std::atomic<std::uint64_t> sampled_calls[instrumented_operation_count];
+    std::atomic<std::uint64_t> sampled_ticks[instrumented_operation_count];
+    std::atomic<std::uint64_t> branches[instrumented_branch_count];
+
+    // Number of operations until the next one is timed (only used by the owning thread)
+    std::uint32_t countdown;
+};
+
+/**
+ * The block of the calling thread, or nullptr until the thread is first instrumented
+ */
+extern thread_local InstrumentationBlock* thread_instrumentation_block;
+
+/**
+ * Creates and registers the block of the calling thread, which is retired when the thread exits
+ */
+InstrumentationBlock* registerInstrumentationBlock();
+
+inline InstrumentationBlock& instrumentationBlock()
+{
+    InstrumentationBlock* block = thread_instrumentation_block;
+    return block != nullptr ? *block : *registerInstrumentationBlock();
+}
+
+inline void increment(std::atomic<std::uint64_t>& counter, std::uint64_t value = 1)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline void countBranch(InstrumentedBranch branch)
+{
+    increment(instrumentationBlock().branches[static_cast<std::size_t>(branch)]);
+}
+
+inline void countException(InstrumentedOperation operation)
+{
+    increment(instrumentationBlock().exceptions[static_cast<std::size_t>(operation)]);
+}
+
+inline void countTruncationMethod(TruncationMethod method)
+{
+    countBranch(method == TruncationMethod::Together ? InstrumentedBranch::TruncateTogether
+            : method == TruncationMethod::LowerFirst ? InstrumentedBranch::TruncateLowerFirst
+            : InstrumentedBranch::TruncateUpperFirst);
+}
+
+/**
+ * Time-stamp counter on x86, otherwise nanoseconds of the steady clock
+ */
+inline std::uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * Counts a call of an operation on construction, and its duration on destruction if it is sampled
+ */
+class InstrumentationScope {
+public:
+    explicit InstrumentationScope(InstrumentedOperation operation)
+    : block_(instrumentationBlock()), index_(static_cast<std::size_t>(operation)), sampled_(false), start_(0)
+    {
+        increment(block_.calls[index_]);
+        if(--block_.countdown == 0)
+        {
+            block_.countdown = instrumentation_sample_period;
+            sampled_ = true;
+            start_ = ticks();
+        }
+    }
+
+    ~InstrumentationScope()
+    {
+        if(sampled_)
+        {
+            increment(block_.sampled_ticks[index_], ticks() - start_);
+            increment(block_.sampled_calls[index_]);
+        }
+    }
+
+    InstrumentationScope(const InstrumentationScope&) = delete;
+    InstrumentationScope& operator=(const InstrumentationScope&) = delete;
+
+private:
+    InstrumentationBlock& block_;
+    std::size_t index_;
+    bool sampled_;
+    std::uint64_t start_;
+};
+
+} // namespace detail
+} // namespace NRV
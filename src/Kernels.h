@@ -0,0 +1,856 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "NormalRandomVariable/NormalRandomVariable.h"
+
+namespace NRV {
+namespace detail {
+
+/**
+ * Constants rounded to the precision of T
+ */
+template<class T>
+struct Constants {
+    static constexpr T one_on_sqrt_pi = T(0.564189583547756286948079451560772586L);
+    static constexpr T one_on_sqrt_two_pi = T(0.398942280401432677939946059934381868L);
+    static constexpr T one_on_sqrt_two = T(0.707106781186547524400844362104849039L);
+    static constexpr T sqrt_2 = T(1.41421356237309504880168872420969808L);
+    static constexpr T sqrt_2_pi = T(2.50662827463100050241576528481104525L);
+    static constexpr T two_pi = T(6.28318530717958647692528676655900577L);
+};
+
+template<class T> constexpr T Constants<T>::one_on_sqrt_pi;
+template<class T> constexpr T Constants<T>::one_on_sqrt_two_pi;
+template<class T> constexpr T Constants<T>::one_on_sqrt_two;
+template<class T> constexpr T Constants<T>::sqrt_2;
+template<class T> constexpr T Constants<T>::sqrt_2_pi;
+template<class T> constexpr T Constants<T>::two_pi;
+
+/**
+ * Mean and variance produced by a kernel. The kernels below contain the maths behind each operation
+ * without any validation, so that they can be shared by NormalRandomVariable (which validates the
+ * result in its constructor) and NormalRandomVariableArray (which does not)
+ */
+template<class T>
+struct Moments {
+    T mean;
+    T variance;
+};
+
+/**
+ * Table of erf(z / sqrt(2)) and exp(-z^2 / 2) at evenly spaced z, with their derivatives scaled by the spacing, for
+ * cubic Hermite interpolation (see LookupTable.h). Outside of the table the values are those of the limits
+ */
+struct NormalTable {
+    struct Node {
+        double erf;
+        double erf_slope;
+        double exp;
+        double exp_slope;
+    };
+
+    double first;
+    double last;
+    double inverse_spacing;
+    double max_error;
+    std::vector<Node> nodes;
+};
+
+/**
+ * The table used by the kernels, or nullptr to use std::erf and std::exp. Tables are never freed once they have
+ * been published, so they can be read by any thread
+ */
+extern std::atomic<const NormalTable*> active_normal_table;
+
+/**
+ * erf(z / sqrt(2)) and exp(-z^2 / 2), which give the CDF and PDF of the standard normal distribution at z, with
+ * erfc = 1 - erf and erfc_neg = 1 + erf (twice the probabilities above and below z)
+ */
+template<class T>
+struct Gaussian {
+    T erf;
+    T exp;
+    T erfc;
+    T erfc_neg;
+};
+
+inline Gaussian<double> interpolate(const NormalTable& table, double z)
+{
+    if(!(z > table.first))
+    {
+        return {-1, 0, 2, 0};
+    }
+    if(!(z < table.last))
+    {
+        return {1, 0, 0, 2};
+    }
+
+    double position = (z - table.first) * table.inverse_spacing;
+    std::size_t index = static_cast<std::size_t>(position);
+    double t = position - static_cast<double>(index);
+    const NormalTable::Node& node0 = table.nodes[index];
+    const NormalTable::Node& node1 = table.nodes[index + 1];
+
+    double h00 = (1 + 2 * t) * (1 - t) * (1 - t);
+    double h10 = t * (1 - t) * (1 - t);
+    double h01 = t * t * (3 - 2 * t);
+    double h11 = t * t * (t - 1);
+    double erf = h00 * node0.erf + h10 * node0.erf_slope + h01 * node1.erf + h11 * node1.erf_slope;
+    return {erf, h00 * node0.exp + h10 * node0.exp_slope + h01 * node1.exp + h11 * node1.exp_slope, 1 - erf, 1 + erf};
+}
+
+/**
+ * Polynomial coefficients (lowest order first) of h(t) = erfc(x) * exp(x^2) / t on t in [0, 1], where
+ * t = 2 / (2 + x), as in SimdMath.h but of degree 10 for Accuracy::Fast. Converted from a degree 10 Chebyshev
+ * interpolant computed in long double precision from erfcl, which gives erfc(x) for x >= 0 to a relative error of 2e-8
+ */
+const std::size_t fast_erfc_coefficient_count = 11;
+const double fast_erfc_coefficients[fast_erfc_coefficient_count] = {
+    2.82094799651272987e-01,
+    2.82092867334630737e-01,
+    2.46913561217788985e-01,
+    1.74948596315436466e-01,
+    9.58271993930361332e-02,
+    -6.79582753132210310e-02,
+    1.51885179627908901e-01,
+    -4.82474760513120215e-01,
+    5.16899540101208754e-01,
+    -2.45580036274862579e-01,
+    4.53513366234826812e-02,
+};
+
+/**
+ * erfc(x) for x >= 0, given exp_x = exp(-x^2)
+ */
+template<class T>
+inline T fastErfc(T x, T exp_x)
+{
+    T t = 2 / (2 + x);
+    T h = T(fast_erfc_coefficients[fast_erfc_coefficient_count - 1]);
+    for(std::size_t i = fast_erfc_coefficient_count - 1; i-- > 0;)
+    {
+        h = h * t + T(fast_erfc_coefficients[i]);
+    }
+
+    return t * exp_x * h;
+}
+
+/**
+ * The Gaussian at z with the approximations of accuracy A. Default uses std::erf (or the lookup table), and the
+ * others calculate erfc in the tail that z is in (with std::erfc for Exact, or fastErfc from the same exp for Fast),
+ * so that the probabilities in the tails keep their relative accuracy
+ */
+template<Accuracy A = Accuracy::Default, class T>
+inline Gaussian<T> gaussian(T z)
+{
+    if(A != Accuracy::Default)
+    {
+        T x = std::abs(z) * Constants<T>::one_on_sqrt_two;
+        T exp = std::exp(-z * z / 2);
+        T tail = A == Accuracy::Exact ? std::erfc(x) : fastErfc(x, exp);
+
+        // Selected without branches, as the sign of z is unpredictable
+        bool negative = z < 0;
+        return {std::copysign(1 - tail, z), exp, negative ? 2 - tail : tail, negative ? tail : 2 - tail};
+    }
+
+    const NormalTable* table = active_normal_table.load(std::memory_order_acquire);
+    if(table == nullptr)
+    {
+        T erf = std::erf(z * Constants<T>::one_on_sqrt_two);
+        return {erf, std::exp(-z * z / 2), 1 - erf, 1 + erf};
+    }
+
+    Gaussian<double> result = interpolate(*table, static_cast<double>(z));
+    T erf = static_cast<T>(result.erf);
+    return {erf, static_cast<T>(result.exp), 1 - erf, 1 + erf};
+}
+
+/**
+ * erf(d / sqrt(2)) - erf(c / sqrt(2)) for c < d (twice the probability between them). Except with Default, bounds in
+ * the same tail are subtracted as complements, which keeps the relative accuracy of the difference
+ */
+template<Accuracy A, class T>
+inline T erfDifference(T c, const Gaussian<T>& at_c, T d, const Gaussian<T>& at_d)
+{
+    T difference = at_d.erf - at_c.erf;
+    if(A != Accuracy::Default)
+    {
+        difference = c > 0 ? at_c.erfc - at_d.erfc : difference;
+        difference = d < 0 ? at_d.erfc_neg - at_c.erfc_neg : difference;
+    }
+
+    return difference;
+}
+
+/**
+ * CDF of the standard normal distribution, calculated with erfc so that the probabilities far into the lower tail
+ * keep their relative accuracy (unlike 1 + erf)
+ */
+template<class T>
+inline T normalCdf(T z)
+{
+    return std::erfc(-z * Constants<T>::one_on_sqrt_two) / 2;
+}
+
+/**
+ * Mean and variance of 1 / X from the asymptotic series E[1 / X] = (1 / mean) sum (2k - 1)!! t^k and
+ * E[1 / X^2] = (1 / mean^2) sum (2k + 1)!! t^k, where t = variance / mean^2. The series diverge, so they are summed
+ * until their terms stop decreasing, which for a mean at least 4 standard deviations from 0 leaves an error below
+ * 1% of the variance, falling rapidly as the mean moves away from 0
+ */
+template<class T>
+inline Moments<T> inverseSeries(T mean, T variance)
+{
+    T t = variance / (mean * mean);
+
+    // Sums from k = 1 of (2k - 1)!! t^k, and of (2k - 1) (2k - 1)!! t^k = ((2k + 1)!! - 2 (2k - 1)!!) t^k, so
+    // that the variance is calculated without cancellation. The k = 1 terms are always added, as they are the
+    // leading terms of the variance
+    T first = t;
+    T excess = t;
+    T term = t;
+    T second_term = 3 * t;
+    for(T k = 2;; ++k)
+    {
+        T next_term = term * (2 * k - 1) * t;
+        T next_second_term = next_term * (2 * k + 1);
+        if(!(next_second_term < second_term) || next_second_term <= std::numeric_limits<T>::epsilon() * (1 + first))
+        {
+            break;
+        }
+
+        first += next_term;
+        excess += (2 * k - 1) * next_term;
+        term = next_term;
+        second_term = next_second_term;
+    }
+
+    return {(1 + first) / mean, (excess - first * first) / (mean * mean)};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> inverse(T mean, T variance)
+{
+    if(A == Accuracy::Exact)
+    {
+        return inverseSeries(mean, variance);
+    }
+    if(A == Accuracy::Fast)
+    {
+        // The denominator of the variance is the square of that of the mean, so one division is enough
+        T reciprocal = 1 / (mean * mean - variance);
+        return {mean * reciprocal, variance * reciprocal * reciprocal};
+    }
+
+    T mean_squared = mean * mean;
+    return {mean / (mean_squared - variance),
+            variance / (mean_squared * mean_squared - 2 * mean_squared * variance + variance * variance)};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> rectify(T mean, T variance, T lower, T upper)
+{
+    T sqrt_variance = std::sqrt(variance);
+
+    T c = (lower - mean) / sqrt_variance;
+    T d = (upper - mean) / sqrt_variance;
+
+    Gaussian<T> at_c = gaussian<A>(c);
+    Gaussian<T> at_d = gaussian<A>(d);
+
+    T m = Constants<T>::one_on_sqrt_two_pi * (at_c.exp - at_d.exp)
+            + (c / 2) * at_c.erfc_neg
+            + (d / 2) * at_d.erfc;
+    T v = ((m * m + 1) / 2) * erfDifference<A>(c, at_c, d, at_d)
+            - Constants<T>::one_on_sqrt_two_pi * (at_d.exp * (d - 2 * m) - at_c.exp * (c - 2 * m))
+            + ((c - m) * (c - m) / 2) * at_c.erfc_neg
+            + ((d - m) * (d - m) / 2) * at_d.erfc;
+
+    return {m * sqrt_variance + mean, v * variance};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> rectifyLower(T mean, T variance, T lower)
+{
+    T sqrt_variance = std::sqrt(variance);
+
+    T c = (lower - mean) / sqrt_variance;
+
+    Gaussian<T> at_c = gaussian<A>(c);
+
+    T m = Constants<T>::one_on_sqrt_two_pi * at_c.exp
+            + (c / 2) * at_c.erfc_neg;
+    T v = ((m * m + 1) / 2) * at_c.erfc
+            - Constants<T>::one_on_sqrt_two_pi * -at_c.exp * (c - 2 * m)
+            + ((c - m) * (c - m) / 2) * at_c.erfc_neg;
+
+    return {m * sqrt_variance + mean, v * variance};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> rectifyUpper(T mean, T variance, T upper)
+{
+    // Reflect, rectify from below and reflect back
+    Moments<T> reflected = rectifyLower<A>(-mean, variance, -upper);
+    return {-reflected.mean, reflected.variance};
+}
+
+/**
+ * Mean and variance of a truncation, with the probability mass of the original distribution that is kept (the
+ * normaliser of the truncated distribution), which shares its evaluations of erf and exp
+ */
+template<class T>
+struct Truncation {
+    Moments<T> moments;
+    T mass;
+};
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Truncation<T> truncateWithMass(T mean, T variance, T lower, T upper)
+{
+    T sqrt_variance = std::sqrt(variance);
+
+    // First transform the bounds to be acting on a standard normal distribution
+    T c = (lower - mean) / sqrt_variance;
+    T d = (upper - mean) / sqrt_variance;
+
+    Gaussian<T> at_c = gaussian<A>(c);
+    Gaussian<T> at_d = gaussian<A>(d);
+
+    T erf_difference = erfDifference<A>(c, at_c, d, at_d);
+    T alpha = Constants<T>::sqrt_2 * Constants<T>::one_on_sqrt_pi / erf_difference;
+    T m = alpha * (at_c.exp - at_d.exp);
+    T v = alpha * (at_c.exp * (c - 2 * m) - at_d.exp * (d - 2 * m)) + m * m + 1;
+
+    return {{m * sqrt_variance + mean, v * variance}, erf_difference / 2};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Truncation<T> truncateLowerWithMass(T mean, T variance, T lower)
+{
+    T sqrt_variance = std::sqrt(variance);
+
+    // First transform the bound to be acting on a standard normal distribution
+    T c = (lower - mean) / sqrt_variance;
+
+    Gaussian<T> at_c = gaussian<A>(c);
+
+    T erf_complement = at_c.erfc;
+    T alpha = Constants<T>::sqrt_2 * Constants<T>::one_on_sqrt_pi / erf_complement;
+    T m = alpha * at_c.exp;
+    T v = alpha * at_c.exp * (c - 2 * m) + m * m + 1;
+
+    return {{m * sqrt_variance + mean, v * variance}, erf_complement / 2};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Truncation<T> truncateUpperWithMass(T mean, T variance, T upper)
+{
+    Truncation<T> reflected = truncateLowerWithMass<A>(-mean, variance, -upper);
+    return {{-reflected.moments.mean, reflected.moments.variance}, reflected.mass};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> truncate(T mean, T variance, T lower, T upper)
+{
+    return truncateWithMass<A>(mean, variance, lower, upper).moments;
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> truncateLower(T mean, T variance, T lower)
+{
+    return truncateLowerWithMass<A>(mean, variance, lower).moments;
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> truncateUpper(T mean, T variance, T upper)
+{
+    return truncateUpperWithMass<A>(mean, variance, upper).moments;
+}
+
+/**
+ * Truncation where the bound is itself a normal random variable. The mass is the probability that the random variable
+ * is above the bound
+ */
+template<Accuracy A = Accuracy::Default, class T>
+inline Truncation<T> truncateLowerWithMass(T mean, T variance, T lower_mean, T lower_variance)
+{
+    T sqrt_variance = std::sqrt(variance);
+
+    // First transform the bounds to be acting on a standard normal distribution
+    T m_c = (lower_mean - mean) / sqrt_variance;
+    T v_c = lower_variance / variance;
+
+    T sqrt_v_c = std::sqrt(v_c + 1);
+    Gaussian<T> at_c = gaussian<A>(m_c / sqrt_v_c);
+
+    T erf_complement = at_c.erfc;
+    T exp_c = at_c.exp / sqrt_v_c;
+    T alpha = Constants<T>::one_on_sqrt_two_pi / erf_complement;
+    T m = 2 * alpha * exp_c;
+    T v = alpha * (Constants<T>::sqrt_2_pi * ((1 + m * m) * erf_complement)
+            + 2 * (m_c / (v_c + 1) - 2 * m) * exp_c);
+
+    return {{m * sqrt_variance + mean, v * variance}, erf_complement / 2};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Truncation<T> truncateUpperWithMass(T mean, T variance, T upper_mean, T upper_variance)
+{
+    Truncation<T> reflected = truncateLowerWithMass<A>(-mean, variance, -upper_mean, upper_variance);
+    return {{-reflected.moments.mean, reflected.moments.variance}, reflected.mass};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> truncateLower(T mean, T variance, T lower_mean, T lower_variance)
+{
+    return truncateLowerWithMass<A>(mean, variance, lower_mean, lower_variance).moments;
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> truncateUpper(T mean, T variance, T upper_mean, T upper_variance)
+{
+    return truncateUpperWithMass<A>(mean, variance, upper_mean, upper_variance).moments;
+}
+
+/**
+ * Methods of truncating by 2 random variables: both bounds together if they are far apart, otherwise one bound after
+ * the other
+ */
+enum class TruncationMethod {
+    Together,
+    LowerFirst,
+    UpperFirst
+};
+
+/**
+ * Chooses the method of truncating by 2 random variables. Fast compares the ratio of the standard deviations with
+ * exp(0.316) rather than taking its log, which can only differ from Default by rounding at the threshold
+ */
+template<Accuracy A = Accuracy::Default, class T>
+inline TruncationMethod truncationMethod(T lower_mean, T lower_variance, T upper_mean, T upper_variance)
+{
+    T sqrt_lower_variance = std::sqrt(lower_variance);
+    T sqrt_upper_variance = std::sqrt(upper_variance);
+
+    T gamma = (upper_mean - lower_mean) / (sqrt_upper_variance + sqrt_lower_variance);
+
+    if(gamma > T(1.3))
+    {
+        return TruncationMethod::Together;
+    }
+
+    // Whether the variances are similar (the log of the ratio of the standard deviations is less than 0.316)
+    bool similar;
+    if(A == Accuracy::Fast)
+    {
+        T ratio_limit = T(1.37163025562604274342L);
+        similar = sqrt_lower_variance < ratio_limit * sqrt_upper_variance
+                && sqrt_upper_variance < ratio_limit * sqrt_lower_variance;
+    }
+    else
+    {
+        similar = std::abs(std::log(sqrt_lower_variance / sqrt_upper_variance)) < T(0.316);
+    }
+
+    bool lower_first;
+    if(lower_mean > -upper_mean)
+    {
+        // Method 2 (lower first) if the lower bound is wider and the variances are similar, otherwise method 3
+        lower_first = sqrt_lower_variance > sqrt_upper_variance && similar;
+    }
+    else
+    {
+        // Method 3 (upper first) if the upper bound is wider and the variances are similar, otherwise method 2
+        lower_first = !(sqrt_upper_variance > sqrt_lower_variance && similar);
+    }
+
+    return lower_first ? TruncationMethod::LowerFirst : TruncationMethod::UpperFirst;
+}
+
+/**
+ * Probability that a pair of standard normal random variables with correlation r are above h and k respectively,
+ * given one_minus_r_squared = 1 - r^2 (which can be calculated without cancellation when r is near -1 or 1). Uses
+ * Genz's (2004) method of Gauss-Legendre quadrature over the correlation, which is accurate to around 1e-15
+ */
+template<class T>
+inline T bivariateNormalUpper(T h, T k, T r, T one_minus_r_squared)
+{
+    static const std::size_t counts[3] = {3, 6, 10};
+    static const double weights[3][10] = {
+        {0.1713244923791705, 0.3607615730481384, 0.4679139345726904},
+        {0.04717533638651177, 0.1069393259953183, 0.1600783285433464, 0.2031674267230659, 0.2334925365383547,
+                0.2491470458134029},
+        {0.01761400713915212, 0.04060142980038694, 0.06267204833410906, 0.08327674157670475, 0.1019301198172404,
+                0.1181945319615184, 0.1316886384491766, 0.1420961093183821, 0.1491729864726037, 0.1527533871307259}};
+    static const double points[3][10] = {
+        {0.9324695142031522, 0.6612093864662647, 0.2386191860831970},
+        {0.9815606342467191, 0.9041172563704750, 0.7699026741943050, 0.5873179542866171, 0.3678314989981802,
+                0.1252334085114692},
+        {0.9931285991850949, 0.9639719272779138, 0.9122344282513259, 0.8391169718222188, 0.7463319064601508,
+                0.6360536807265150, 0.5108670019508271, 0.3737060887154196, 0.2277858511416451, 0.07652652113349733}};
+
+    T abs_r = std::abs(r);
+    std::size_t level = abs_r < T(0.3) ? 0 : abs_r < T(0.75) ? 1 : 2;
+    const double* w = weights[level];
+    const double* x = points[level];
+
+    T hk = h * k;
+    T bvn = 0;
+    if(abs_r < T(0.925))
+    {
+        // Integrate the derivative with respect to the correlation from 0 to r, at the points 1 -+ x of [0, 2]
+        T hs = (h * h + k * k) / 2;
+        T asr = std::asin(r) / 2;
+        for(std::size_t i = 0; i < counts[level]; ++i)
+        {
+            for(T sign : {T(-1), T(1)})
+            {
+                T sn = std::sin(asr * (1 + sign * T(x[i])));
+                bvn += T(w[i]) * std::exp((sn * hk - hs) / (1 - sn * sn));
+            }
+        }
+
+        return bvn * asr / Constants<T>::two_pi + normalCdf(-h) * normalCdf(-k);
+    }
+
+    // Otherwise, integrate from r = -1 or 1, after removing the singularity there
+    if(r < 0)
+    {
+        k = -k;
+        hk = -hk;
+    }
+
+    if(abs_r < 1)
+    {
+        T as = one_minus_r_squared;
+        T a = std::sqrt(as);
+        T bs = (h - k) * (h - k);
+        T asr = -(bs / as + hk) / 2;
+        T c = (4 - hk) / 8;
+        T d = (12 - hk) / 80;
+        if(asr > -100)
+        {
+            bvn = a * std::exp(asr) * (1 - c * (bs - as) * (1 - d * bs) / 3 + c * d * as * as);
+        }
+        if(hk > -100)
+        {
+            T b = std::sqrt(bs);
+            T sp = Constants<T>::sqrt_2_pi * normalCdf(-b / a);
+            bvn -= std::exp(-hk / 2) * sp * b * (1 - c * bs * (1 - d * bs) / 3);
+        }
+
+        a /= 2;
+        T sum = 0;
+        for(std::size_t i = 0; i < counts[level]; ++i)
+        {
+            for(T sign : {T(-1), T(1)})
+            {
+                T xs = a * (1 + sign * T(x[i]));
+                xs *= xs;
+                T asr_i = -(bs / xs + hk) / 2;
+                if(asr_i > -100)
+                {
+                    T sp = 1 + c * xs * (1 + 5 * d * xs);
+                    T rs = std::sqrt(1 - xs);
+                    T ep = std::exp(-(hk / 2) * xs / ((1 + rs) * (1 + rs))) / rs;
+                    sum += T(w[i]) * std::exp(asr_i) * (sp - ep);
+                }
+            }
+        }
+        bvn = (a * sum - bvn) / Constants<T>::two_pi;
+    }
+
+    if(r > 0)
+    {
+        bvn += normalCdf(-std::max(h, k));
+    }
+    else if(h >= k)
+    {
+        bvn = -bvn;
+    }
+    else
+    {
+        T between = h < 0 ? normalCdf(k) - normalCdf(h) : normalCdf(-h) - normalCdf(-k);
+        bvn = between - bvn;
+    }
+
+    return std::min(std::max(bvn, T(0)), T(1));
+}
+
+/**
+ * Exact truncation by 2 independent random variables, L < X < U. The differences Y1 = X - L and Y2 = U - X are
+ * jointly normal with X, so the moments of X follow from those of (Y1, Y2) truncated to the positive quadrant, which
+ * are given by Rosenbaum's (1961) formulas in terms of the bivariate normal distribution
+ */
+template<class T>
+inline Truncation<T> truncateBetweenWithMass(T mean, T variance, T lower_mean, T lower_variance,
+        T upper_mean, T upper_variance)
+{
+    T s1 = std::sqrt(variance + lower_variance);
+    T s2 = std::sqrt(variance + upper_variance);
+
+    // Standardise to Z1 > a1 and Z2 > a2 with correlation rho. The determinant of the covariance of (Y1, Y2) is
+    // expanded so that it has no cancellation when the bounds are narrow (and rho is near -1)
+    T a1 = (lower_mean - mean) / s1;
+    T a2 = (mean - upper_mean) / s2;
+    T determinant = variance * lower_variance + variance * upper_variance + lower_variance * upper_variance;
+    T rho = -variance / (s1 * s2);
+    T one_minus_rho_squared = determinant / ((s1 * s1) * (s2 * s2));
+    T q = std::sqrt(one_minus_rho_squared);
+
+    T mass = bivariateNormalUpper(a1, a2, rho, one_minus_rho_squared);
+
+    T a21 = (a2 - rho * a1) / q;
+    T a12 = (a1 - rho * a2) / q;
+    T phi1 = Constants<T>::one_on_sqrt_two_pi * std::exp(-a1 * a1 / 2);
+    T phi2 = Constants<T>::one_on_sqrt_two_pi * std::exp(-a2 * a2 / 2);
+    T u1 = phi1 * normalCdf(-a21);
+    T u2 = phi2 * normalCdf(-a12);
+
+    // (1 - rho^2) times the bivariate density at (a1, a2)
+    T density = q * phi1 * Constants<T>::one_on_sqrt_two_pi * std::exp(-a21 * a21 / 2);
+
+    T e1 = (u1 + rho * u2) / mass;
+    T e2 = (u2 + rho * u1) / mass;
+    T v11 = 1 + (a1 * u1 + rho * rho * a2 * u2 + rho * density) / mass - e1 * e1;
+    T v22 = 1 + (a2 * u2 + rho * rho * a1 * u1 + rho * density) / mass - e2 * e2;
+    T v12 = rho + (rho * a1 * u1 + rho * a2 * u2 + density) / mass - e1 * e2;
+
+    // X = mean + b1 Z1 + b2 Z2 + e, where e is independent of (Z1, Z2)
+    T b1 = variance * upper_variance * s1 / determinant;
+    T b2 = -variance * lower_variance * s2 / determinant;
+    T residual = variance * lower_variance * upper_variance / determinant;
+
+    return {{mean + b1 * e1 + b2 * e2, residual + b1 * b1 * v11 + 2 * b1 * b2 * v12 + b2 * b2 * v22}, mass};
+}
+
+/**
+ * Truncation by 2 random variables. The mass is the probability that the random variable is between the bounds,
+ * which for truncation one bound after the other is the product of the masses of the 2 truncations. Exact uses
+ * truncateBetweenWithMass instead of the approximations
+ */
+template<Accuracy A = Accuracy::Default, class T>
+inline Truncation<T> truncateWithMass(T mean, T variance, T lower_mean, T lower_variance,
+        T upper_mean, T upper_variance)
+{
+    if(A == Accuracy::Exact)
+    {
+        return truncateBetweenWithMass(mean, variance, lower_mean, lower_variance, upper_mean, upper_variance);
+    }
+
+    TruncationMethod method = truncationMethod<A>(lower_mean, lower_variance, upper_mean, upper_variance);
+
+    if(method == TruncationMethod::Together)
+    {
+        // Apply both constraints together
+        T sqrt_variance = std::sqrt(variance);
+
+        // First transform the bounds to be acting on a standard normal distribution
+        T m_c = (lower_mean - mean) / sqrt_variance;
+        T m_d = (upper_mean - mean) / sqrt_variance;
+        T v_c = lower_variance / variance;
+        T v_d = upper_variance / variance;
+
+        T sqrt_v_c = std::sqrt(v_c + 1);
+        T sqrt_v_d = std::sqrt(v_d + 1);
+        T c = m_c / sqrt_v_c;
+        T d = m_d / sqrt_v_d;
+        Gaussian<T> at_c = gaussian<A>(c);
+        Gaussian<T> at_d = gaussian<A>(d);
+
+        T erf_difference = erfDifference<A>(c, at_c, d, at_d);
+        T exp_c = at_c.exp / sqrt_v_c;
+        T exp_d = at_d.exp / sqrt_v_d;
+        T alpha = Constants<T>::one_on_sqrt_two_pi / erf_difference;
+        T m = 2 * alpha * (exp_c - exp_d);
+        T v = alpha * (Constants<T>::sqrt_2_pi * ((1 + m * m) * erf_difference)
+                + 2 * (m_c / (v_c + 1) - 2 * m) * exp_c
+                - 2 * (m_d / (v_d + 1) - 2 * m) * exp_d);
+
+        return {{m * sqrt_variance + mean, v * variance}, erf_difference / 2};
+    }
+
+    if(method == TruncationMethod::LowerFirst)
+    {
+        // Method 2 - lower first, then upper
+        Truncation<T> lower_applied = truncateLowerWithMass<A>(mean, variance, lower_mean, lower_variance);
+        Truncation<T> result = truncateUpperWithMass<A>(lower_applied.moments.mean, lower_applied.moments.variance,
+                upper_mean, upper_variance);
+        return {result.moments, lower_applied.mass * result.mass};
+    }
+    else
+    {
+        // Method 3 - upper first, then lower
+        Truncation<T> upper_applied = truncateUpperWithMass<A>(mean, variance, upper_mean, upper_variance);
+        Truncation<T> result = truncateLowerWithMass<A>(upper_applied.moments.mean, upper_applied.moments.variance,
+                lower_mean, lower_variance);
+        return {result.moments, upper_applied.mass * result.mass};
+    }
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> truncate(T mean, T variance, T lower_mean, T lower_variance,
+        T upper_mean, T upper_variance)
+{
+    return truncateWithMass<A>(mean, variance, lower_mean, lower_variance, upper_mean, upper_variance).moments;
+}
+
+/**
+ * Clark's maximum. Default evaluates erf at beta and -beta, and the others share a single Gaussian between them
+ */
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> max(T mean1, T variance1, T mean2, T variance2)
+{
+    T alpha = std::sqrt(variance1 + variance2);
+    T beta = (mean1 - mean2) / alpha;
+
+    T phi_beta;
+    T phi_neg_beta;
+    T alpha_phi_beta;
+    if(A == Accuracy::Default)
+    {
+        phi_beta = T(0.5) * (1 + std::erf(beta * Constants<T>::one_on_sqrt_two));
+        phi_neg_beta = T(0.5) * (1 + std::erf(-beta * Constants<T>::one_on_sqrt_two));
+        alpha_phi_beta = alpha * Constants<T>::one_on_sqrt_two_pi * std::exp(- beta * beta / 2);
+    }
+    else
+    {
+        Gaussian<T> at_beta = gaussian<A>(beta);
+        phi_beta = at_beta.erfc_neg / 2;
+        phi_neg_beta = at_beta.erfc / 2;
+        alpha_phi_beta = alpha * Constants<T>::one_on_sqrt_two_pi * at_beta.exp;
+    }
+
+    T m = mean1 * phi_beta + mean2 * phi_neg_beta + alpha_phi_beta;
+    T v = (mean1 * mean1 + variance1) * phi_beta
+            + (mean2 * mean2 + variance2) * phi_neg_beta
+            + (mean1 + mean2) * alpha_phi_beta - m * m;
+
+    return {m, v};
+}
+
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> min(T mean1, T variance1, T mean2, T variance2)
+{
+    Moments<T> reflected = max<A>(-mean1, variance1, -mean2, variance2);
+    return {-reflected.mean, reflected.variance};
+}
+
+template<class T>
+inline Moments<T> multiply(T mean1, T variance1, T mean2, T variance2)
+{
+    T delta1 = mean1 * mean1 / variance1;
+    T delta2 = mean2 * mean2 / variance2;
+    return {mean1 * mean2, variance1 * variance2 * (1 + delta1 + delta2)};
+}
+
+/**
+ * Probability that a random variable with the first mean and variance is less than one with the second
+ */
+template<class T>
+inline T probabilityLessThan(T mean1, T variance1, T mean2, T variance2)
+{
+    return normalCdf((mean2 - mean1) / std::sqrt(variance1 + variance2));
+}
+
+/**
+ * Inverse of the CDF of the standard normal distribution for 0 < p < 1. Acklam's rational approximation (relative
+ * error below 1.2e-9) is refined by one step of Halley's method, which gives the full precision of T. Probabilities
+ * above 0.5 are reflected, as 1 - p is exact for them
+ */
+template<class T>
+inline T normalQuantile(T p)
+{
+    static const T a[] = {T(-3.969683028665376e+01L), T(2.209460984245205e+02L), T(-2.759285104469687e+02L),
+            T(1.383577518672690e+02L), T(-3.066479806614716e+01L), T(2.506628277459239e+00L)};
+    static const T b[] = {T(-5.447609879822406e+01L), T(1.615858368580409e+02L), T(-1.556989798598866e+02L),
+            T(6.680131188771972e+01L), T(-1.328068155288572e+01L)};
+    static const T c[] = {T(-7.784894002430293e-03L), T(-3.223964580411365e-01L), T(-2.400758277161838e+00L),
+            T(-2.549732539343734e+00L), T(4.374664141464968e+00L), T(2.938163982698783e+00L)};
+    static const T d[] = {T(7.784695709041462e-03L), T(3.224671290700398e-01L), T(2.445134137142996e+00L),
+            T(3.754408661907416e+00L)};
+
+    T lower = p > T(0.5) ? 1 - p : p;
+    T z;
+    if(lower < T(0.02425))
+    {
+        T q = std::sqrt(-2 * std::log(lower));
+        z = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+                / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    else
+    {
+        T q = lower - T(0.5);
+        T r = q * q;
+        z = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+                / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+    }
+
+    T u = (normalCdf(z) - lower) * Constants<T>::sqrt_2_pi * std::exp(z * z / 2);
+    z -= u / (1 + z * u / 2);
+    return p > T(0.5) ? -z : z;
+}
+
+/**
+ * Returns true if the closed-form approximation of rv1 / rv2 is valid, otherwise the division should
+ * be approximated by multiplying by the inverse
+ */
+template<class T>
+inline bool divisionApproximationValid(T mean1, T variance1, T mean2, T variance2)
+{
+    T a = mean1 * mean1 / variance1;
+    T b = mean2 * mean2 / variance2;
+    return a < T(6.25) && b >= 16;
+}
+
+/**
+ * Division. Default uses the closed form when it is valid, and the others always multiply by the inverse (see
+ * inverse), with the product expanded so that it needs no divisions
+ */
+template<Accuracy A = Accuracy::Default, class T>
+inline Moments<T> divide(T mean1, T variance1, T mean2, T variance2)
+{
+    if(A != Accuracy::Default)
+    {
+        Moments<T> inverse2 = inverse<A>(mean2, variance2);
+        return {mean1 * inverse2.mean,
+                (mean1 * mean1 + variance1) * inverse2.variance + inverse2.mean * inverse2.mean * variance1};
+    }
+
+    T a = mean1 * mean1 / variance1;
+    T b = mean2 * mean2 / variance2;
+
+    if(a < T(6.25) && b >= 16)
+    {
+        T r = variance2 / variance1;
+        T sqrt_b = std::sqrt(b);
+        T mean = std::sqrt(a) / (std::sqrt(r) * (T(1.01) * sqrt_b - T(0.2713)));
+        T variance = (a + 1) / (r * (b + T(0.108) * sqrt_b - T(3.795))) - mean * mean;
+
+        return {mean, variance};
+    }
+
+    // Otherwise, approximate it by multiplying rv1 by the inverse of rv2
+    Moments<T> inverse2 = inverse(mean2, variance2);
+    return multiply(mean1, variance1, inverse2.mean, inverse2.variance);
+}
+
+/**
+ * Returns true if the inverse approximation is valid (i.e., the mean is at least 4 standard deviations from 0)
+ */
+template<class T>
+inline bool inverseApproximationValid(T mean, T variance)
+{
+    return !(mean * mean / variance < 16);
+}
+
+} // namespace detail
+} // namespace NRV
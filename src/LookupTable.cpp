@@ -0,0 +1,116 @@
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "NormalRandomVariable/LookupTable.h"
+#include "Kernels.h"
+#include "MemoCache.h"
+
+namespace NRV {
+namespace detail {
+
+std::atomic<const NormalTable*> active_normal_table(nullptr);
+
+namespace {
+
+/**
+ * The table covers [-table_range, table_range], outside of which erf and exp are within 1e-17 of their limits
+ */
+constexpr double table_range = 9;
+
+/**
+ * The spacing of the coarsest and finest tables, as powers of 2. Each table has 18 / spacing + 1 nodes of 32 bytes,
+ * so the finest table (about 590KB) is larger than the L2 cache of many processors, while the tables with a spacing
+ * of 2^-7 (about 74KB) or coarser fit in it. Each interpolation only reads 2 adjacent nodes
+ */
+constexpr int coarsest_spacing = -2;
+constexpr int finest_spacing = -10;
+
+std::unique_ptr<NormalTable> buildTable(double spacing)
+{
+    std::unique_ptr<NormalTable> table(new NormalTable());
+    table->first = -table_range;
+    table->last = table_range;
+    table->inverse_spacing = 1 / spacing;
+
+    std::size_t size = static_cast<std::size_t>(2 * table_range / spacing) + 1;
+    table->nodes.resize(size);
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        double z = table->first + static_cast<double>(i) * spacing;
+        NormalTable::Node& node = table->nodes[i];
+        node.erf = std::erf(z * Constants<double>::one_on_sqrt_two);
+        node.exp = std::exp(-z * z / 2);
+        node.erf_slope = spacing * Constants<double>::sqrt_2 * Constants<double>::one_on_sqrt_pi * node.exp;
+        node.exp_slope = -spacing * z * node.exp;
+    }
+
+    // Measure the error between the nodes, where it is largest
+    table->max_error = 0;
+    for(std::size_t i = 0; i + 1 < size; ++i)
+    {
+        for(double t : {0.25, 0.5, 0.75})
+        {
+            double z = table->first + (static_cast<double>(i) + t) * spacing;
+            Gaussian<double> result = interpolate(*table, z);
+            table->max_error = std::max(table->max_error, std::abs(result.erf - std::erf(z * Constants<double>::one_on_sqrt_two)));
+            table->max_error = std::max(table->max_error, std::abs(result.exp - std::exp(-z * z / 2)));
+        }
+    }
+
+    return table;
+}
+
+/**
+ * Tables that have been built, indexed by the power of 2 of their spacing
+ */
+std::mutex tables_mutex;
+std::unique_ptr<NormalTable> tables[coarsest_spacing - finest_spacing + 1];
+
+} // namespace
+} // namespace detail
+
+double enableLookupTable(double max_error)
+{
+    if(!(max_error > 0))
+    {
+        throw std::invalid_argument("NormalRandomVariable: Maximum error of the lookup table must be greater than 0");
+    }
+
+    std::lock_guard<std::mutex> lock(detail::tables_mutex);
+    for(int power = detail::coarsest_spacing; power >= detail::finest_spacing; --power)
+    {
+        std::unique_ptr<detail::NormalTable>& table = detail::tables[detail::coarsest_spacing - power];
+        if(!table)
+        {
+            table = detail::buildTable(std::ldexp(1.0, power));
+        }
+
+        if(table->max_error <= max_error)
+        {
+            detail::active_normal_table.store(table.get(), std::memory_order_release);
+
+            // Cached results were calculated with the previous table
+            detail::memo_generation.fetch_add(1, std::memory_order_acq_rel);
+            return table->max_error;
+        }
+    }
+
+    throw std::invalid_argument("NormalRandomVariable: Maximum error of the lookup table is too small");
+}
+
+void disableLookupTable()
+{
+    detail::active_normal_table.store(nullptr, std::memory_order_release);
+    detail::memo_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+double lookupTableError()
+{
+    const detail::NormalTable* table = detail::active_normal_table.load(std::memory_order_acquire);
+    return table == nullptr ? 0 : table->max_error;
+}
+
+} // namespace NRV
@@ -0,0 +1,53 @@
+#include <stdexcept>
+#include <string>
+
+#include "NormalRandomVariable/MemoCache.h"
+#include "MemoCache.h"
+
+namespace NRV {
+namespace detail {
+
+std::atomic<std::size_t> memo_shard_size(0);
+std::atomic<std::size_t> memo_generation(1);
+
+} // namespace detail
+
+void enableMemoCache(std::size_t capacity)
+{
+    if(capacity < detail::memo_shard_count)
+    {
+        throw std::invalid_argument("NormalRandomVariable: Capacity of the memo cache must be at least "
+                + std::to_string(detail::memo_shard_count));
+    }
+
+    // Round the capacity of each shard down to a power of 2
+    std::size_t size = 1;
+    while(size * 2 * detail::memo_shard_count <= capacity)
+    {
+        size *= 2;
+    }
+
+    detail::memo_generation.fetch_add(1, std::memory_order_acq_rel);
+    detail::memo_shard_size.store(size, std::memory_order_relaxed);
+}
+
+void disableMemoCache()
+{
+    detail::memo_shard_size.store(0, std::memory_order_relaxed);
+}
+
+void clearMemoCache()
+{
+    detail::memo_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+MemoCacheStatistics memoCacheStatistics()
+{
+    MemoCacheStatistics statistics = {0, 0};
+    detail::memoCache<float>().statistics(statistics.hits, statistics.misses);
+    detail::memoCache<double>().statistics(statistics.hits, statistics.misses);
+    detail::memoCache<long double>().statistics(statistics.hits, statistics.misses);
+    return statistics;
+}
+
+} // namespace NRV
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "Kernels.h"
+
+namespace NRV {
+namespace detail {
+
+/**
+ * Operations that are cached (None marks an empty slot)
+ */
+enum class MemoOperation : unsigned char {
+    None,
+    Rectify,
+    RectifyLower,
+    RectifyUpper,
+    Truncate,
+    TruncateLower,
+    TruncateUpper,
+    TruncateBy,
+    TruncateLowerBy,
+    TruncateUpperBy,
+    Max,
+    Min
+};
+
+/**
+ * Number of shards in each cache
+ */
+constexpr std::size_t memo_shard_count = 16;
+
+/**
+ * Settings shared by the caches of each type. The number of results in each shard is a power of 2 (so that the slot
+ * can be found without a division), or 0 if the caches are disabled. Incrementing the generation clears the caches
+ * (e.g., when the results would change because the lookup table was enabled)
+ */
+extern std::atomic<std::size_t> memo_shard_size;
+extern std::atomic<std::size_t> memo_generation;
+
+/**
+ * Cache of results of type T, split into shards that each have a lock and a direct-mapped table of results
+ */
+template<class T>
+class MemoCache {
+public:
+    /**
+     * Operands of an operation: the mean and variance of the random variable followed by the bounds or other
+     * random variable, padded with 0
+     */
+    typedef std::array<T, 6> Key;
+
+    /**
+     * Returns the cached result of the operation, or calculates and caches it if there is none. The lock is not held
+     * while calculating, so misses do not block other lookups
+     */
+    template<class Calculate>
+    Moments<T> lookup(MemoOperation operation, const Key& key, Calculate calculate)
+    {
+        std::size_t size = memo_shard_size.load(std::memory_order_relaxed);
+        if(size == 0)
+        {
+            return calculate();
+        }
+
+        std::uint64_t hash = hashOf(operation, key);
+        Shard& shard = shards_[hash % memo_shard_count];
+        std::size_t slot = static_cast<std::size_t>(hash / memo_shard_count) & (size - 1);
+
+        std::size_t generation;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            generation = update(shard, size);
+
+            const Entry& entry = shard.entries[slot];
+            if(entry.operation == operation && entry.key == key)
+            {
+                ++shard.hits;
+                return entry.result;
+            }
+            ++shard.misses;
+        }
+
+        Moments<T> result = calculate();
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if(shard.generation == generation && shard.entries.size() == size)
+        {
+            shard.entries[slot] = Entry{operation, key, result};
+        }
+
+        return result;
+    }
+
+    /**
+     * Adds the number of hits and misses in the current generation to hits and misses
+     */
+    void statistics(std::size_t& hits, std::size_t& misses)
+    {
+        std::size_t generation = memo_generation.load(std::memory_order_acquire);
+        for(Shard& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if(shard.generation == generation)
+            {
+                hits += shard.hits;
+                misses += shard.misses;
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        MemoOperation operation;
+        Key key;
+        Moments<T> result;
+    };
+
+    // Each shard is on its own cache line so that threads using different shards do not interfere
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        std::size_t generation = 0;
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+    };
+
+    /**
+     * Clears the shard if the cache has been cleared or resized since it was last used, and returns the generation
+     */
+    static std::size_t update(Shard& shard, std::size_t size)
+    {
+        std::size_t generation = memo_generation.load(std::memory_order_acquire);
+        if(shard.generation != generation || shard.entries.size() != size)
+        {
+            shard.entries.assign(size, Entry{MemoOperation::None, Key(), Moments<T>()});
+            shard.generation = generation;
+            shard.hits = 0;
+            shard.misses = 0;
+        }
+
+        return generation;
+    }
+
+    /**
+     * Hashes the bit patterns of the operands (as doubles, so that the hash is the same for each type)
+     */
+    static std::uint64_t hashOf(MemoOperation operation, const Key& key)
+    {
+        // Each operand is multiplied by a different odd constant, so the multiplications are independent of each
+        // other, and the sum is then mixed once
+        static constexpr std::uint64_t multipliers[6] = {0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full,
+                0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull, 0xFF51AFD7ED558CCDull, 0xC4CEB9FE1A85EC53ull};
+
+        std::uint64_t hash = static_cast<std::uint64_t>(operation);
+        for(std::size_t i = 0; i < key.size(); ++i)
+        {
+            double as_double = static_cast<double>(key[i]);
+            std::uint64_t bits;
+            std::memcpy(&bits, &as_double, sizeof(bits));
+            hash += bits * multipliers[i];
+        }
+
+        hash ^= hash >> 32;
+        hash *= 0x9E3779B97F4A7C15ull;
+        return hash ^ (hash >> 29);
+    }
+
+    Shard shards_[memo_shard_count];
+};
+
+/**
+ * Get the cache for results of type T
+ */
+template<class T>
+MemoCache<T>& memoCache()
+{
+    static MemoCache<T> cache;
+    return cache;
+}
+
+} // namespace detail
+} // namespace NRV
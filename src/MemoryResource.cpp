@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "NormalRandomVariable/MemoryResource.h"
+
+
+namespace NRV {
+
+namespace {
+
+/**
+ * Size of the header at the start of each block of an arena, which keeps the memory after it aligned
+ */
+template<class Block>
+constexpr std::size_t headerSize()
+{
+    return (sizeof(Block) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+}
+
+/**
+ * Returns pointer rounded up to a multiple of alignment
+ */
+char* align(char* pointer, std::size_t alignment)
+{
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(pointer);
+    return pointer + ((alignment - address % alignment) % alignment);
+}
+
+/**
+ * Resource that uses operator new and delete. Memory with a larger alignment than operator new provides is
+ * over-allocated, and the pointer from operator new is stored before it
+ */
+class NewDeleteResource : public MemoryResource {
+private:
+    void* doAllocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if(alignment <= alignof(std::max_align_t))
+        {
+            return ::operator new(bytes);
+        }
+
+        char* memory = static_cast<char*>(::operator new(bytes + alignment + sizeof(void*)));
+        char* aligned = align(memory + sizeof(void*), alignment);
+        reinterpret_cast<void**>(aligned)[-1] = memory;
+        return aligned;
+    }
+
+    void doDeallocate(void* pointer, std::size_t, std::size_t alignment) noexcept override
+    {
+        if(alignment <= alignof(std::max_align_t))
+        {
+            ::operator delete(pointer);
+        }
+        else
+        {
+            ::operator delete(static_cast<void**>(pointer)[-1]);
+        }
+    }
+};
+
+} // namespace
+
+MemoryResource* defaultMemoryResource() noexcept
+{
+    static NewDeleteResource resource;
+    return &resource;
+}
+
+Arena::Arena(std::size_t block_size, MemoryResource* upstream)
+: upstream_(upstream), block_size_(std::max<std::size_t>(block_size, 256)), first_(nullptr), current_(nullptr),
+    position_(nullptr), used_(0), capacity_(0)
+{
+
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+void Arena::reset() noexcept
+{
+    current_ = first_;
+    position_ = first_ != nullptr ? begin(first_) : nullptr;
+    used_ = 0;
+}
+
+void Arena::release() noexcept
+{
+    for(Block* block = first_; block != nullptr;)
+    {
+        Block* next = block->next;
+        upstream_->deallocate(block, headerSize<Block>() + block->size, alignof(std::max_align_t));
+        block = next;
+    }
+
+    first_ = nullptr;
+    current_ = nullptr;
+    position_ = nullptr;
+    used_ = 0;
+    capacity_ = 0;
+}
+
+std::size_t Arena::used() const
+{
+    return used_ + (current_ != nullptr ? static_cast<std::size_t>(position_ - begin(current_)) : 0);
+}
+
+std::size_t Arena::capacity() const
+{
+    return capacity_;
+}
+
+MemoryResource* Arena::upstream() const
+{
+    return upstream_;
+}
+
+void* Arena::doAllocate(std::size_t bytes, std::size_t alignment)
+{
+    bytes = std::max<std::size_t>(bytes, 1);
+    auto fits = [bytes, alignment](Block* block, char* position) {
+        char* aligned = align(position, alignment);
+        return static_cast<std::size_t>(aligned - begin(block)) <= block->size
+                && bytes <= block->size - static_cast<std::size_t>(aligned - begin(block));
+    };
+
+    // Use the rest of the current block, or the next block if it was kept by reset and is large enough
+    Block* block = nullptr;
+    if(current_ != nullptr && fits(current_, position_))
+    {
+        block = current_;
+    }
+    else if(current_ != nullptr && current_->next != nullptr && fits(current_->next, begin(current_->next)))
+    {
+        block = current_->next;
+    }
+    else
+    {
+        // Add a block after the current block, keeping any later blocks for after it
+        if(bytes > std::numeric_limits<std::size_t>::max() / 2 - alignment)
+        {
+            throw std::bad_alloc();
+        }
+
+        std::size_t size = std::max(std::max(block_size_, capacity_), bytes + alignment);
+        block = static_cast<Block*>(upstream_->allocate(headerSize<Block>() + size, alignof(std::max_align_t)));
+        block->size = size;
+        capacity_ += size;
+        if(current_ != nullptr)
+        {
+            block->next = current_->next;
+            current_->next = block;
+        }
+        else
+        {
+            block->next = nullptr;
+            first_ = block;
+        }
+    }
+
+    if(block != current_)
+    {
+        if(current_ != nullptr)
+        {
+            used_ += static_cast<std::size_t>(position_ - begin(current_));
+        }
+        current_ = block;
+        position_ = begin(block);
+    }
+
+    char* result = align(position_, alignment);
+    position_ = result + bytes;
+    return result;
+}
+
+void Arena::doDeallocate(void*, std::size_t, std::size_t) noexcept
+{
+
+}
+
+char* Arena::begin(Block* block)
+{
+    return reinterpret_cast<char*>(block) + headerSize<Block>();
+}
+
+} // namespace NRV
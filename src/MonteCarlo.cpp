@@ -0,0 +1,126 @@
+#include <cmath>
+#include <thread>
+
+#include "NormalRandomVariable/MonteCarlo.h"
+#include "Kernels.h"
+
+namespace NRV {
+
+namespace {
+
+constexpr std::uint32_t philox_multiplier0 = 0xD2511F53;
+constexpr std::uint32_t philox_multiplier1 = 0xCD9E8D57;
+constexpr std::uint32_t philox_weyl0 = 0x9E3779B9;
+constexpr std::uint32_t philox_weyl1 = 0xBB67AE85;
+constexpr int philox_rounds = 10;
+
+/**
+ * Converts 2 random 32-bit integers to a uniform random number in (0, 1) with 53 bits of precision
+ */
+inline double toUniform(std::uint32_t high, std::uint32_t low)
+{
+    std::uint64_t bits = ((static_cast<std::uint64_t>(high) << 32) | low) >> 11;
+    return (static_cast<double>(bits) + 0.5) / 9007199254740992.0;
+}
+
+} // namespace
+
+Philox4x32::Counter Philox4x32::operator()(Counter counter) const
+{
+    Key key = key_;
+    for(int round = 0; round < philox_rounds; ++round)
+    {
+        std::uint64_t product0 = static_cast<std::uint64_t>(philox_multiplier0) * counter[0];
+        std::uint64_t product1 = static_cast<std::uint64_t>(philox_multiplier1) * counter[2];
+        counter = {{static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(product1),
+                static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(product0)}};
+        key[0] += philox_weyl0;
+        key[1] += philox_weyl1;
+    }
+
+    return counter;
+}
+
+template<class T>
+void BasicWelfordAccumulator<T>::add(const T* samples, std::size_t size)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    T sum = 0;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        sum += samples[i];
+    }
+
+    BasicWelfordAccumulator batch;
+    batch.count_ = size;
+    batch.mean_ = sum / static_cast<T>(size);
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        T delta = samples[i] - batch.mean_;
+        batch.sum_squares_ += delta * delta;
+    }
+
+    merge(batch);
+}
+
+template<class T>
+void BasicWelfordAccumulator<T>::merge(const BasicWelfordAccumulator& accumulator)
+{
+    if(accumulator.count_ == 0)
+    {
+        return;
+    }
+
+    std::size_t count = count_ + accumulator.count_;
+    T delta = accumulator.mean_ - mean_;
+    T weight = static_cast<T>(accumulator.count_) / static_cast<T>(count);
+    mean_ += delta * weight;
+    sum_squares_ += accumulator.sum_squares_ + delta * delta * static_cast<T>(count_) * weight;
+    count_ = count;
+}
+
+template<class T>
+BasicMonteCarlo<T>::BasicMonteCarlo(std::uint64_t seed, unsigned int threads)
+: generator_(seed), threads_(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads)
+{
+
+}
+
+template<class T>
+unsigned int BasicMonteCarlo<T>::threads() const
+{
+    return threads_;
+}
+
+template<class T>
+void BasicMonteCarlo<T>::generate(std::uint64_t batch_index, std::size_t input_index,
+        const BasicNormalRandomVariable<T>& input, std::size_t size, T* output, std::size_t stride) const
+{
+    // Each call to the generator gives 2 uniform random numbers, which the Box-Muller transform turns into 2
+    // independent standard normal random numbers
+    T standard_deviation = std::sqrt(input.variance());
+    for(std::size_t i = 0; i < size; i += 2)
+    {
+        Philox4x32::Counter bits = generator_({{static_cast<std::uint32_t>(i / 2), static_cast<std::uint32_t>(input_index),
+                static_cast<std::uint32_t>(batch_index), static_cast<std::uint32_t>(batch_index >> 32)}});
+
+        double radius = std::sqrt(-2 * std::log(toUniform(bits[0], bits[1])));
+        double angle = detail::Constants<double>::two_pi * toUniform(bits[2], bits[3]);
+        output[i * stride] = input.mean() + standard_deviation * static_cast<T>(radius * std::cos(angle));
+        output[(i + 1) * stride] = input.mean() + standard_deviation * static_cast<T>(radius * std::sin(angle));
+    }
+}
+
+template class BasicWelfordAccumulator<float>;
+template class BasicWelfordAccumulator<double>;
+template class BasicWelfordAccumulator<long double>;
+
+template class BasicMonteCarlo<float>;
+template class BasicMonteCarlo<double>;
+template class BasicMonteCarlo<long double>;
+
+} // namespace NRV
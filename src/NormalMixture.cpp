@@ -0,0 +1,376 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "NormalRandomVariable/NormalMixture.h"
+#include "Kernels.h"
+
+
+namespace NRV {
+namespace detail {
+
+namespace {
+
+/**
+ * CDF of the standard normal distribution
+ */
+template<class T>
+T phi(T z)
+{
+    return (1 + gaussian(z).erf) / 2;
+}
+
+/**
+ * Adds a component to result, unless it has no weight or the truncation that produced it was too far into the tail
+ * to have a valid variance
+ */
+template<class T>
+void append(MixtureComponent<T>* result, std::size_t& size, T weight, Moments<T> moments)
+{
+    if(weight > 0 && moments.variance >= 0)
+    {
+        result[size++] = {weight, moments.mean, moments.variance};
+    }
+}
+
+template<class T>
+void appendTruncated(MixtureComponent<T>* result, std::size_t& size, T weight, Truncation<T> truncation)
+{
+    append(result, size, weight * truncation.mass, truncation.moments);
+}
+
+/**
+ * Scales the weights of the components to sum to 1
+ * Note: Will throw an exception if no probability mass is left
+ */
+template<class T>
+void normalise(MixtureComponent<T>* components, std::size_t size)
+{
+    T total = 0;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        total += components[i].weight;
+    }
+
+    if(!(total > 0))
+    {
+        throw std::range_error("NormalMixture: Truncation leaves no probability mass");
+    }
+
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        components[i].weight /= total;
+    }
+}
+
+/**
+ * Truncation of a component by random variables. A component with a variance of 0 is kept with the probability that
+ * it is within the bounds
+ */
+template<class T>
+void truncateBy(MixtureOperation operation, const std::array<T, 4>& bounds, const MixtureComponent<T>& component,
+        MixtureComponent<T>* result, std::size_t& size)
+{
+    bool lower = operation != MixtureOperation::TruncateUpperBy;
+    bool upper = operation != MixtureOperation::TruncateLowerBy;
+
+    if(component.variance == 0)
+    {
+        T mass = 1;
+        if(lower)
+        {
+            mass *= phi((component.mean - bounds[0]) / std::sqrt(bounds[1]));
+        }
+        if(upper)
+        {
+            mass *= phi((bounds[2] - component.mean) / std::sqrt(bounds[3]));
+        }
+
+        append(result, size, component.weight * mass, Moments<T>{component.mean, 0});
+    }
+    else if(lower && upper)
+    {
+        appendTruncated(result, size, component.weight,
+                truncateWithMass(component.mean, component.variance, bounds[0], bounds[1], bounds[2], bounds[3]));
+    }
+    else if(lower)
+    {
+        appendTruncated(result, size, component.weight,
+                truncateLowerWithMass(component.mean, component.variance, bounds[0], bounds[1]));
+    }
+    else
+    {
+        appendTruncated(result, size, component.weight,
+                truncateUpperWithMass(component.mean, component.variance, bounds[2], bounds[3]));
+    }
+}
+
+/**
+ * Truncation or rectification of a component by scalar bounds. A component with a variance of 0 is kept if it is
+ * within the bounds (truncation) or moved to the nearest bound (rectification)
+ */
+template<class T>
+void transformComponent(MixtureOperation operation, T lower, T upper, const MixtureComponent<T>& component,
+        MixtureComponent<T>* result, std::size_t& size)
+{
+    T weight = component.weight;
+    T mean = component.mean;
+    T variance = component.variance;
+
+    switch(operation)
+    {
+    case MixtureOperation::Rectify:
+        if(variance == 0)
+        {
+            append(result, size, weight, Moments<T>{std::min(std::max(mean, lower), upper), 0});
+        }
+        else
+        {
+            // The mass below the bounds, the truncated distribution between them, and the rest above them
+            T below = phi((lower - mean) / std::sqrt(variance));
+            Truncation<T> between = truncateWithMass(mean, variance, lower, upper);
+            append(result, size, weight * below, Moments<T>{lower, 0});
+            appendTruncated(result, size, weight, between);
+            append(result, size, weight * std::max(T(0), 1 - below - between.mass), Moments<T>{upper, 0});
+        }
+        break;
+    case MixtureOperation::RectifyLower:
+        if(variance == 0)
+        {
+            append(result, size, weight, Moments<T>{std::max(mean, lower), 0});
+        }
+        else
+        {
+            Truncation<T> above = truncateLowerWithMass(mean, variance, lower);
+            append(result, size, weight * (1 - above.mass), Moments<T>{lower, 0});
+            appendTruncated(result, size, weight, above);
+        }
+        break;
+    case MixtureOperation::RectifyUpper:
+        if(variance == 0)
+        {
+            append(result, size, weight, Moments<T>{std::min(mean, upper), 0});
+        }
+        else
+        {
+            Truncation<T> below = truncateUpperWithMass(mean, variance, upper);
+            appendTruncated(result, size, weight, below);
+            append(result, size, weight * (1 - below.mass), Moments<T>{upper, 0});
+        }
+        break;
+    case MixtureOperation::Truncate:
+        if(variance == 0)
+        {
+            append(result, size, lower < mean && mean < upper ? weight : T(0), Moments<T>{mean, 0});
+        }
+        else
+        {
+            appendTruncated(result, size, weight, truncateWithMass(mean, variance, lower, upper));
+        }
+        break;
+    case MixtureOperation::TruncateLower:
+        if(variance == 0)
+        {
+            append(result, size, lower < mean ? weight : T(0), Moments<T>{mean, 0});
+        }
+        else
+        {
+            appendTruncated(result, size, weight, truncateLowerWithMass(mean, variance, lower));
+        }
+        break;
+    default:
+        if(variance == 0)
+        {
+            append(result, size, mean < upper ? weight : T(0), Moments<T>{mean, 0});
+        }
+        else
+        {
+            appendTruncated(result, size, weight, truncateUpperWithMass(mean, variance, upper));
+        }
+        break;
+    }
+}
+
+/**
+ * Component of the maximum of 2 components, where component1 is greater than component2, weighted by the
+ * probability of that case
+ */
+template<class T>
+void appendGreater(const MixtureComponent<T>& component1, const MixtureComponent<T>& component2, T weight,
+        MixtureComponent<T>* result, std::size_t& size)
+{
+    if(component1.variance == 0)
+    {
+        T probability = phi((component1.mean - component2.mean) / std::sqrt(component2.variance));
+        append(result, size, weight * probability, Moments<T>{component1.mean, 0});
+    }
+    else
+    {
+        appendTruncated(result, size, weight, truncateLowerWithMass(component1.mean, component1.variance,
+                component2.mean, component2.variance));
+    }
+}
+
+} // namespace
+
+template<class T>
+std::size_t transformMixture(MixtureOperation operation, const std::array<T, 4>& parameters,
+        const MixtureComponent<T>* components, std::size_t size, MixtureComponent<T>* result)
+{
+    bool by_random_variables = operation == MixtureOperation::TruncateBy || operation == MixtureOperation::TruncateLowerBy
+            || operation == MixtureOperation::TruncateUpperBy;
+    if((operation == MixtureOperation::Rectify || operation == MixtureOperation::Truncate) && parameters[1] <= parameters[0])
+    {
+        throw std::range_error(operation == MixtureOperation::Rectify
+                ? "NormalMixture: Rectification lower bound must be less than upper bound"
+                : "NormalMixture: Truncation lower bound must be less than upper bound");
+    }
+
+    std::size_t result_size = 0;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        if(by_random_variables)
+        {
+            truncateBy(operation, parameters, components[i], result, result_size);
+        }
+        else
+        {
+            transformComponent(operation, parameters[0], parameters[1], components[i], result, result_size);
+        }
+    }
+
+    normalise(result, result_size);
+    return result_size;
+}
+
+template<class T>
+std::size_t maxOfMixtures(const MixtureComponent<T>* components1, std::size_t size1,
+        const MixtureComponent<T>* components2, std::size_t size2, MixtureComponent<T>* result)
+{
+    std::size_t size = 0;
+    for(std::size_t i = 0; i < size1; ++i)
+    {
+        for(std::size_t j = 0; j < size2; ++j)
+        {
+            const MixtureComponent<T>& component1 = components1[i];
+            const MixtureComponent<T>& component2 = components2[j];
+            T weight = component1.weight * component2.weight;
+
+            if(component1.variance + component2.variance == 0)
+            {
+                append(result, size, weight, Moments<T>{std::max(component1.mean, component2.mean), 0});
+                continue;
+            }
+
+            appendGreater(component1, component2, weight, result, size);
+            appendGreater(component2, component1, weight, result, size);
+        }
+    }
+
+    normalise(result, size);
+    return size;
+}
+
+template<class T>
+std::size_t mergeMixture(MixtureComponent<T>* components, std::size_t size, std::size_t capacity, T* costs)
+{
+    // Means that are not numbers are sorted after the others, to keep the ordering strict
+    std::sort(components, components + size, [](const MixtureComponent<T>& a, const MixtureComponent<T>& b) {
+        return a.mean < b.mean || (a.mean == a.mean && b.mean != b.mean);
+    });
+
+    // Increase in the variance of the components (weighted by their weights) from merging a pair of them. Pairs with
+    // a cost that is not a number (e.g., from a component with a mean that is not finite) are merged last, so that
+    // every pass still merges at least one pair
+    auto cost = [](const MixtureComponent<T>& a, const MixtureComponent<T>& b) {
+        T weight = a.weight + b.weight;
+        T difference = a.mean - b.mean;
+        T cost = weight > 0 ? a.weight * b.weight / weight * difference * difference : T(0);
+        return cost == cost ? cost : std::numeric_limits<T>::infinity();
+    };
+
+    while(size > capacity)
+    {
+        // Each pass merges the cheapest pairs that do not overlap, up to half of the components that need to be
+        // removed, so that the number of passes only grows with the logarithm of the number of components
+        std::size_t pairs = size - 1;
+        std::size_t merges = std::max<std::size_t>(1, (size - capacity) / 2);
+        for(std::size_t i = 0; i < pairs; ++i)
+        {
+            costs[i] = cost(components[i], components[i + 1]);
+            costs[pairs + i] = costs[i];
+        }
+        std::nth_element(costs + pairs, costs + pairs + merges - 1, costs + 2 * pairs);
+        T threshold = costs[pairs + merges - 1];
+
+        std::size_t result_size = 0;
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            MixtureComponent<T> a = components[i];
+            if(merges > 0 && i < pairs && costs[i] <= threshold)
+            {
+                const MixtureComponent<T>& b = components[i + 1];
+                T weight = a.weight + b.weight;
+                if(weight > 0)
+                {
+                    T difference = a.mean - b.mean;
+                    T mean = (a.weight * a.mean + b.weight * b.mean) / weight;
+                    a.variance = (a.weight * a.variance + b.weight * b.variance) / weight
+                            + a.weight * b.weight * difference * difference / (weight * weight);
+                    a.mean = mean;
+                    a.weight = weight;
+                }
+
+                --merges;
+                ++i;
+            }
+
+            components[result_size++] = a;
+        }
+
+        size = result_size;
+    }
+
+    return size;
+}
+
+template<class T>
+std::size_t pruneMixture(MixtureComponent<T>* components, std::size_t size, T min_weight)
+{
+    MixtureComponent<T>* heaviest = std::max_element(components, components + size,
+            [](const MixtureComponent<T>& a, const MixtureComponent<T>& b) { return a.weight < b.weight; });
+    if(heaviest == components + size || !(heaviest->weight >= min_weight))
+    {
+        // Keep the heaviest component
+        if(size > 0)
+        {
+            components[0] = *heaviest;
+            components[0].weight = 1;
+            return 1;
+        }
+        return 0;
+    }
+
+    MixtureComponent<T>* end = std::remove_if(components, components + size,
+            [min_weight](const MixtureComponent<T>& component) { return component.weight < min_weight; });
+    std::size_t result_size = static_cast<std::size_t>(end - components);
+    normalise(components, result_size);
+    return result_size;
+}
+
+#define NRV_INSTANTIATE_MIXTURE(T) \
+    template std::size_t transformMixture(MixtureOperation operation, const std::array<T, 4>& parameters, \
+            const MixtureComponent<T>* components, std::size_t size, MixtureComponent<T>* result); \
+    template std::size_t maxOfMixtures(const MixtureComponent<T>* components1, std::size_t size1, \
+            const MixtureComponent<T>* components2, std::size_t size2, MixtureComponent<T>* result); \
+    template std::size_t mergeMixture(MixtureComponent<T>* components, std::size_t size, std::size_t capacity, \
+            T* costs); \
+    template std::size_t pruneMixture(MixtureComponent<T>* components, std::size_t size, T min_weight);
+
+NRV_INSTANTIATE_MIXTURE(float)
+NRV_INSTANTIATE_MIXTURE(double)
+NRV_INSTANTIATE_MIXTURE(long double)
+
+} // namespace detail
+} // namespace NRV
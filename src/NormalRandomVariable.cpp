@@ -3,326 +3,549 @@
 #include <limits>
 
 #include "NormalRandomVariable/NormalRandomVariable.h"
+#include "NormalRandomVariable/MemoryResource.h"
+#include "Instrumentation.h"
+#include "Kernels.h"
+#include "MemoCache.h"
+#include "Reduction.h"
 
 
-namespace NRV {
+/**
+ * Calls a kernel with the approximations of accuracy, which are a template argument of the kernels, e.g.
+ * NRV_WITH_ACCURACY(accuracy, detail::truncateLower, (mean_, variance_, lower))
+ */
+#define NRV_WITH_ACCURACY(accuracy, kernel, arguments) \
+    ((accuracy) == Accuracy::Exact ? kernel<Accuracy::Exact> arguments \
+            : (accuracy) == Accuracy::Fast ? kernel<Accuracy::Fast> arguments : kernel<Accuracy::Default> arguments)
 
-const double one_on_sqrt_pi = 1 / std::sqrt(3.14159265358979323846);
-const double one_on_sqrt_two_pi = 1 / std::sqrt(2 * 3.14159265358979323846);
-const double one_on_sqrt_two = 1 / std::sqrt(2);
-const double sqrt_2 = std::sqrt(2);
-const double sqrt_2_pi = std::sqrt(2 * 3.14159265358979323846);
+namespace NRV {
 
-NormalRandomVariable::NormalRandomVariable()
-: mean_(0), variance_(1)
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::inverse(Accuracy accuracy) const NRV_TRY
 {
+    NRV_COUNT_CALL(Inverse);
+
+    // This approximation is breaks down if the distribution is too close to 0. Set an arbitrary limit of 4 sigma. 
+    if(!detail::inverseApproximationValid(mean_, variance_))
+    {
+        NRV_COUNT_BRANCH(InverseOutOfRange);
+        throw std::range_error("NormalRandomVariable: Variance of denominator is too large to allow approximation of division operator");
+    }
 
+    detail::Moments<T> result = NRV_WITH_ACCURACY(accuracy, detail::inverse, (mean_, variance_));
+    return BasicNormalRandomVariable(result.mean, result.variance);
 }
+NRV_CATCH(Inverse)
 
-NormalRandomVariable::NormalRandomVariable(double mean, double variance)
-: mean_(mean), variance_(variance)
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::rectify(T lower, T upper, Accuracy accuracy) const NRV_TRY
 {
-    if(variance_ <= 0){
-        throw std::range_error("NormalRandomVariable: Variance must be greater than 0");
+    NRV_COUNT_CALL(Rectify);
+
+   if(upper <= lower)
+    {
+        throw std::range_error("NormalRandomVariable: Rectification lower bound must be less than upper bound");
     }
+
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::Rectify, {{mean_, variance_, lower, upper, 0, 0}}, [&] {
+                return detail::rectify(mean_, variance_, lower, upper);
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::rectify, (mean_, variance_, lower, upper));
+    return BasicNormalRandomVariable(result.mean, result.variance);
 }
+NRV_CATCH(Rectify)
 
-double NormalRandomVariable::mean() const
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::rectifyLower(T lower, Accuracy accuracy) const NRV_TRY
 {
-    return mean_;
+    NRV_COUNT_CALL(RectifyLower);
+
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::RectifyLower, {{mean_, variance_, lower, 0, 0, 0}}, [&] {
+                return detail::rectifyLower(mean_, variance_, lower);
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::rectifyLower, (mean_, variance_, lower));
+    return BasicNormalRandomVariable(result.mean, result.variance);
 }
+NRV_CATCH(RectifyLower)
 
-double NormalRandomVariable::variance() const
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::rectifyUpper(T upper, Accuracy accuracy) const NRV_TRY
 {
-    return variance_;
+    NRV_COUNT_CALL(RectifyUpper);
+
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::RectifyUpper, {{mean_, variance_, upper, 0, 0, 0}}, [&] {
+                return detail::rectifyUpper(mean_, variance_, upper);
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::rectifyUpper, (mean_, variance_, upper));
+    return BasicNormalRandomVariable(result.mean, result.variance);
 }
+NRV_CATCH(RectifyUpper)
 
-NormalRandomVariable NormalRandomVariable::inverse() const
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::truncate(T lower, T upper, Accuracy accuracy) const NRV_TRY
 {
-    // This approximation is breaks down if the distribution is too close to 0. Set an arbitrary limit of 4 sigma. 
-    if(mean_ * mean_ / variance_ < 16)
+    NRV_COUNT_CALL(Truncate);
+
+    if(upper <= lower)
     {
-        throw std::range_error("NormalRandomVariable: Variance of denominator is too large to allow approximation of division operator");
+        throw std::range_error("NormalRandomVariable: Truncation lower bound must be less than upper bound");
     }
 
-    double mean_squared = mean_ * mean_;
-    double mean = mean_ / (mean_squared - variance_);
-    double variance = variance_ / (mean_squared * mean_squared - 2 * mean_squared * variance_ + variance_ * variance_);
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::Truncate, {{mean_, variance_, lower, upper, 0, 0}}, [&] {
+                return detail::truncate(mean_, variance_, lower, upper);
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::truncate, (mean_, variance_, lower, upper));
+    return BasicNormalRandomVariable(result.mean, result.variance);
+}
+NRV_CATCH(Truncate)
 
-    return NormalRandomVariable(mean, variance);
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::truncateLower(T lower, Accuracy accuracy) const NRV_TRY
+{
+    NRV_COUNT_CALL(TruncateLower);
+
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::TruncateLower, {{mean_, variance_, lower, 0, 0, 0}}, [&] {
+                return detail::truncateLower(mean_, variance_, lower);
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::truncateLower, (mean_, variance_, lower));
+    return BasicNormalRandomVariable(result.mean, result.variance);
 }
+NRV_CATCH(TruncateLower)
 
-NormalRandomVariable NormalRandomVariable::rectify(double lower, double upper) const
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::truncateUpper(T upper, Accuracy accuracy) const NRV_TRY
 {
-   if(upper <= lower)
+    NRV_COUNT_CALL(TruncateUpper);
+
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::TruncateUpper, {{mean_, variance_, upper, 0, 0, 0}}, [&] {
+                return detail::truncateUpper(mean_, variance_, upper);
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::truncateUpper, (mean_, variance_, upper));
+    return BasicNormalRandomVariable(result.mean, result.variance);
+}
+NRV_CATCH(TruncateUpper)
+
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::truncate(BasicNormalRandomVariable lower, BasicNormalRandomVariable upper, Accuracy accuracy) const NRV_TRY
+{
+    NRV_COUNT_CALL(TruncateBy);
+    if(accuracy != Accuracy::Exact)
     {
-        throw std::range_error("NormalRandomVariable: Rectification lower bound must be less than upper bound");
+        NRV_COUNT_TRUNCATION_METHOD(lower.mean(), lower.variance(), upper.mean(), upper.variance());
     }
 
-    double sqrt_variance = std::sqrt(variance_);
-
-    double c = (lower - mean_) / sqrt_variance;
-    double d = (upper - mean_) / sqrt_variance;
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::TruncateBy, {{mean_, variance_, lower.mean(), lower.variance(), upper.mean(), upper.variance()}}, [&] {
+                return detail::truncate(mean_, variance_, lower.mean(), lower.variance(), upper.mean(), upper.variance());
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::truncate, (mean_, variance_, lower.mean(), lower.variance(), upper.mean(), upper.variance()));
+    return BasicNormalRandomVariable(result.mean, result.variance);
+}
+NRV_CATCH(TruncateBy)
 
-    double m = one_on_sqrt_two_pi * (std::exp(-c * c / 2) - std::exp(-d * d / 2)) 
-            + (c / 2) * (1 + std::erf(c * one_on_sqrt_two)) 
-            + (d / 2) * (1 - std::erf(d * one_on_sqrt_two));
-    double v = ((m * m + 1) / 2) * (std::erf(d * one_on_sqrt_two) - std::erf(c * one_on_sqrt_two))
-            - one_on_sqrt_two_pi * (std::exp(-d * d / 2) * (d - 2 * m) - std::exp(-c * c / 2) * (c - 2 * m))
-            + ((c - m) * (c - m) / 2) * (1 + std::erf(c * one_on_sqrt_two))
-            + ((d - m) * (d - m) / 2) * (1 - std::erf(d * one_on_sqrt_two));
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::truncateLower(BasicNormalRandomVariable lower, Accuracy accuracy) const NRV_TRY
+{
+    NRV_COUNT_CALL(TruncateLowerBy);
+
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::TruncateLowerBy, {{mean_, variance_, lower.mean(), lower.variance(), 0, 0}}, [&] {
+                return detail::truncateLower(mean_, variance_, lower.mean(), lower.variance());
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::truncateLower, (mean_, variance_, lower.mean(), lower.variance()));
+    return BasicNormalRandomVariable(result.mean, result.variance);
+}
+NRV_CATCH(TruncateLowerBy)
 
-    return NormalRandomVariable(m * sqrt_variance + mean_, v * variance_);
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::truncateUpper(BasicNormalRandomVariable upper, Accuracy accuracy) const NRV_TRY
+{
+    NRV_COUNT_CALL(TruncateUpperBy);
+
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::TruncateUpperBy, {{mean_, variance_, upper.mean(), upper.variance(), 0, 0}}, [&] {
+                return detail::truncateUpper(mean_, variance_, upper.mean(), upper.variance());
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::truncateUpper, (mean_, variance_, upper.mean(), upper.variance()));
+    return BasicNormalRandomVariable(result.mean, result.variance);
 }
+NRV_CATCH(TruncateUpperBy)
 
-NormalRandomVariable NormalRandomVariable::rectifyLower(double lower) const
+template<class T>
+TruncationResult<T> BasicNormalRandomVariable<T>::truncateWithMass(T lower, T upper, Accuracy accuracy) const NRV_TRY
 {
-    double sqrt_variance = std::sqrt(variance_);
+    NRV_COUNT_CALL(Truncate);
 
-    double c = (lower - mean_) / sqrt_variance;
+    if(upper <= lower)
+    {
+        throw std::range_error("NormalRandomVariable: Truncation lower bound must be less than upper bound");
+    }
+
+    detail::Truncation<T> result = NRV_WITH_ACCURACY(accuracy, detail::truncateWithMass, (mean_, variance_, lower, upper));
+    return {BasicNormalRandomVariable(result.moments.mean, result.moments.variance), result.mass};
+}
+NRV_CATCH(Truncate)
 
-    double m = one_on_sqrt_two_pi * std::exp(-c * c / 2) 
-            + (c / 2) * (1 + std::erf(c * one_on_sqrt_two));
-    double v = ((m * m + 1) / 2) * (1 - std::erf(c * one_on_sqrt_two))
-            - one_on_sqrt_two_pi * -std::exp(-c * c / 2) * (c - 2 * m)
-            + ((c - m) * (c - m) / 2) * (1 + std::erf(c * one_on_sqrt_two));
+template<class T>
+TruncationResult<T> BasicNormalRandomVariable<T>::truncateLowerWithMass(T lower, Accuracy accuracy) const NRV_TRY
+{
+    NRV_COUNT_CALL(TruncateLower);
 
-    return NormalRandomVariable(m * sqrt_variance + mean_, v * variance_);
+    detail::Truncation<T> result = NRV_WITH_ACCURACY(accuracy, detail::truncateLowerWithMass, (mean_, variance_, lower));
+    return {BasicNormalRandomVariable(result.moments.mean, result.moments.variance), result.mass};
 }
+NRV_CATCH(TruncateLower)
 
-NormalRandomVariable NormalRandomVariable::rectifyUpper(double upper) const
+template<class T>
+TruncationResult<T> BasicNormalRandomVariable<T>::truncateUpperWithMass(T upper, Accuracy accuracy) const NRV_TRY
 {
-    return -(-(*this)).rectifyLower(-upper);
+    NRV_COUNT_CALL(TruncateUpper);
+
+    detail::Truncation<T> result = NRV_WITH_ACCURACY(accuracy, detail::truncateUpperWithMass, (mean_, variance_, upper));
+    return {BasicNormalRandomVariable(result.moments.mean, result.moments.variance), result.mass};
 }
+NRV_CATCH(TruncateUpper)
 
-NormalRandomVariable NormalRandomVariable::truncate(double lower, double upper) const
+template<class T>
+TruncationResult<T> BasicNormalRandomVariable<T>::truncateWithMass(BasicNormalRandomVariable lower, BasicNormalRandomVariable upper, Accuracy accuracy) const NRV_TRY
 {
-    if(upper <= lower)
+    NRV_COUNT_CALL(TruncateBy);
+    if(accuracy != Accuracy::Exact)
     {
-        throw std::range_error("NormalRandomVariable: Truncation lower bound must be less than upper bound");
+        NRV_COUNT_TRUNCATION_METHOD(lower.mean(), lower.variance(), upper.mean(), upper.variance());
     }
 
-    double sqrt_variance = std::sqrt(variance_);
-
-    // First transform the bounds to be acting on a standard normal distribution
-    double c = (lower - mean_) / sqrt_variance;
-    double d = (upper - mean_) / sqrt_variance;
+    detail::Truncation<T> result = NRV_WITH_ACCURACY(accuracy, detail::truncateWithMass, (mean_, variance_, lower.mean(), lower.variance(), upper.mean(), upper.variance()));
+    return {BasicNormalRandomVariable(result.moments.mean, result.moments.variance), result.mass};
+}
+NRV_CATCH(TruncateBy)
 
-    double alpha = sqrt_2 * one_on_sqrt_pi / (std::erf(d * one_on_sqrt_two) - std::erf(c * one_on_sqrt_two));
-    double m = alpha * (std::exp(-c * c / 2) - std::exp(-d * d / 2));
-    double v = alpha * (std::exp(-c * c / 2) * (c - 2 * m) - std::exp(-d * d / 2) * (d - 2 * m)) + m * m + 1;
+template<class T>
+TruncationResult<T> BasicNormalRandomVariable<T>::truncateLowerWithMass(BasicNormalRandomVariable lower, Accuracy accuracy) const NRV_TRY
+{
+    NRV_COUNT_CALL(TruncateLowerBy);
 
-    return NormalRandomVariable(m * sqrt_variance + mean_, v * variance_);
+    detail::Truncation<T> result = NRV_WITH_ACCURACY(accuracy, detail::truncateLowerWithMass, (mean_, variance_, lower.mean(), lower.variance()));
+    return {BasicNormalRandomVariable(result.moments.mean, result.moments.variance), result.mass};
 }
+NRV_CATCH(TruncateLowerBy)
 
-NormalRandomVariable NormalRandomVariable::truncateLower(double lower) const
+template<class T>
+TruncationResult<T> BasicNormalRandomVariable<T>::truncateUpperWithMass(BasicNormalRandomVariable upper, Accuracy accuracy) const NRV_TRY
 {
-    double sqrt_variance = std::sqrt(variance_);
+    NRV_COUNT_CALL(TruncateUpperBy);
 
-    // First transform the bound to be acting on a standard normal distribution
-    double c = (lower - mean_) / sqrt_variance;
+    detail::Truncation<T> result = NRV_WITH_ACCURACY(accuracy, detail::truncateUpperWithMass, (mean_, variance_, upper.mean(), upper.variance()));
+    return {BasicNormalRandomVariable(result.moments.mean, result.moments.variance), result.mass};
+}
+NRV_CATCH(TruncateUpperBy)
 
-    double alpha = sqrt_2 * one_on_sqrt_pi / (1 - std::erf(c * one_on_sqrt_two));
-    double m = alpha * std::exp(-c * c / 2);
-    double v = alpha * std::exp(-c * c / 2) * (c - 2 * m) + m * m + 1;
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::max(BasicNormalRandomVariable random_variable, Accuracy accuracy) const NRV_TRY
+{
+    NRV_COUNT_CALL(Max);
+
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::Max, {{mean_, variance_, random_variable.mean(), random_variable.variance(), 0, 0}}, [&] {
+                return detail::max(mean_, variance_, random_variable.mean(), random_variable.variance());
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::max, (mean_, variance_, random_variable.mean(), random_variable.variance()));
+    return BasicNormalRandomVariable(result.mean, result.variance);
+}
+NRV_CATCH(Max)
 
-    return NormalRandomVariable(m * sqrt_variance + mean_, v * variance_);
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariable<T>::min(BasicNormalRandomVariable random_variable, Accuracy accuracy) const NRV_TRY
+{
+    NRV_COUNT_CALL(Min);
+
+    detail::Moments<T> result = accuracy == Accuracy::Default
+            ? detail::memoCache<T>().lookup(detail::MemoOperation::Min, {{mean_, variance_, random_variable.mean(), random_variable.variance(), 0, 0}}, [&] {
+                return detail::min(mean_, variance_, random_variable.mean(), random_variable.variance());
+            })
+            : NRV_WITH_ACCURACY(accuracy, detail::min, (mean_, variance_, random_variable.mean(), random_variable.variance()));
+    return BasicNormalRandomVariable(result.mean, result.variance);
 }
+NRV_CATCH(Min)
 
-NormalRandomVariable NormalRandomVariable::truncateUpper(double upper) const
+template<class T>
+T BasicNormalRandomVariable<T>::pdf(T x) const
 {
-    return -(-(*this)).truncateLower(-upper);
+    T difference = x - mean_;
+    return detail::Constants<T>::one_on_sqrt_two_pi / std::sqrt(variance_) * std::exp(-difference * difference / (2 * variance_));
 }
 
-NormalRandomVariable NormalRandomVariable::truncate(NormalRandomVariable lower, NormalRandomVariable upper) const
+template<class T>
+T BasicNormalRandomVariable<T>::cdf(T x) const
 {
-    double sqrt_lower_variance = std::sqrt(lower.variance());
-    double sqrt_upper_variance = std::sqrt(upper.variance());
-    
-    double gamma = (upper.mean() - lower.mean()) / (sqrt_upper_variance + sqrt_lower_variance);
-    double delta = std::abs(std::log(sqrt_lower_variance / sqrt_upper_variance));
+    return detail::normalCdf((x - mean_) / std::sqrt(variance_));
+}
 
-    if(gamma > 1.3)
-    {
-        // Apply both constraints together
-        double sqrt_variance = std::sqrt(variance_);
-
-        // First transform the bounds to be acting on a standard normal distribution
-        double m_c = (lower.mean() - mean_) / sqrt_variance;
-        double m_d = (upper.mean() - mean_) / sqrt_variance;
-        double v_c = lower.variance() / variance_;
-        double v_d = upper.variance() / variance_;
-
-        double alpha = one_on_sqrt_two_pi / (std::erf(m_d * one_on_sqrt_two / std::sqrt(v_d + 1)) 
-                - std::erf(m_c * one_on_sqrt_two / std::sqrt(v_c + 1)));
-        double m = 2 * alpha * (std::exp(- m_c * m_c / (2 * (v_c + 1))) / std::sqrt(v_c + 1)
-                - std::exp(- m_d * m_d / (2 * (v_d + 1))) / std::sqrt(v_d + 1));
-        double v = alpha * (sqrt_2_pi * ((1 + m * m) * (std::erf(m_d * one_on_sqrt_two / std::sqrt(v_d + 1)) 
-                - std::erf(m_c * one_on_sqrt_two / std::sqrt(v_c + 1))))
-                + 2 * (m_c / (v_c + 1) - 2 * m) * std::exp(-m_c * m_c / (2 * (v_c + 1))) / std::sqrt(v_c + 1)
-                - 2 * (m_d / (v_d + 1) - 2 * m) * std::exp(-m_d * m_d / (2 * (v_d + 1))) / std::sqrt(v_d + 1));
-
-        return NormalRandomVariable(m * sqrt_variance + mean_, v * variance_);
-    }
-    else if(lower.mean() > -upper.mean())
-    {
-        if(sqrt_lower_variance > sqrt_upper_variance && delta < 0.316)
-        {
-            // Method 2 - lower first, then upper
-            NormalRandomVariable lower_applied = this->truncateLower(lower);
-            return lower_applied.truncateUpper(upper);
-        }
-        else
-        {
-            // Method 3 - upper first, then lower
-            NormalRandomVariable upper_applied = this->truncateUpper(upper);
-            return upper_applied.truncateLower(lower);
-        }
-    }
-    else if(sqrt_upper_variance > sqrt_lower_variance && delta < 0.316)
-    {
-        // Method 3 - upper first, then lower
-        NormalRandomVariable upper_applied = this->truncateUpper(upper);
-        return upper_applied.truncateLower(lower);
-    }
-    else
+template<class T>
+T BasicNormalRandomVariable<T>::quantile(T probability) const
+{
+    if(!(probability > 0 && probability < 1))
     {
-        // Method 2 - lower first, then upper
-        NormalRandomVariable lower_applied = this->truncateLower(lower);
-            return lower_applied.truncateUpper(upper);
+        throw std::range_error("NormalRandomVariable: Probability must be between 0 and 1");
     }
+
+    return mean_ + std::sqrt(variance_) * detail::normalQuantile(probability);
 }
 
-NormalRandomVariable NormalRandomVariable::truncateLower(NormalRandomVariable lower) const
+template<class T>
+T BasicNormalRandomVariable<T>::probabilityLessThan(BasicNormalRandomVariable random_variable) const
 {
-    double sqrt_variance = std::sqrt(variance_);
-
-    // First transform the bounds to be acting on a standard normal distribution
-    double m_c = (lower.mean() - mean_) / sqrt_variance;
-    double v_c = lower.variance() / variance_;
+    return detail::probabilityLessThan(mean_, variance_, random_variable.mean(), random_variable.variance());
+}
 
-    double alpha = one_on_sqrt_two_pi / (1 - std::erf(m_c * one_on_sqrt_two / std::sqrt(v_c + 1)));
-    double m = 2 * alpha * (std::exp(- m_c * m_c / (2 * (v_c + 1))) / std::sqrt(v_c + 1));
-    double v = alpha * (sqrt_2_pi * ((1 + m * m) * (1 - std::erf(m_c * one_on_sqrt_two / std::sqrt(v_c + 1))))
-            + 2 * (m_c / (v_c + 1) - 2 * m) * std::exp(-m_c * m_c / (2 * (v_c + 1))) / std::sqrt(v_c + 1));
+namespace {
 
-    return NormalRandomVariable(m * sqrt_variance + mean_, v * variance_);
+template<class T>
+TryResult<T> tryResult(detail::Moments<T> moments) noexcept
+{
+    return BasicNormalRandomVariable<T>::tryCreate(moments.mean, moments.variance);
 }
 
-NormalRandomVariable NormalRandomVariable::truncateUpper(NormalRandomVariable upper) const
+template<class T>
+TryResult<T> failure(Status status) noexcept
 {
-    return -(-(*this)).truncateLower(-upper);
+    return TryResult<T>{BasicNormalRandomVariable<T>(), status};
 }
 
-NormalRandomVariable NormalRandomVariable::max(NormalRandomVariable random_variable) const
+} // namespace
+
+template<class T>
+TryResult<T> BasicNormalRandomVariable<T>::tryInverse(Accuracy accuracy) const noexcept
 {
-    double alpha = std::sqrt(variance_ + random_variable.variance());
-    double beta = (mean_ - random_variable.mean()) / alpha;
+    if(!detail::inverseApproximationValid(mean_, variance_))
+    {
+        return failure<T>(Status::InvalidApproximation);
+    }
 
-    double phi_beta = 0.5 * (1 + std::erf(beta * one_on_sqrt_two));
-    double phi_neg_beta = 0.5 * (1 + std::erf(-beta * one_on_sqrt_two));
-    double alpha_phi_beta = alpha * one_on_sqrt_two_pi * std::exp(- beta * beta / 2);
+    return tryResult(NRV_WITH_ACCURACY(accuracy, detail::inverse, (mean_, variance_)));
+}
 
-    double m = mean_ * phi_beta + random_variable.mean() * phi_neg_beta + alpha_phi_beta;
-    double v = (mean_ * mean_ + variance_) * phi_beta 
-            + (random_variable.mean() * random_variable.mean() + random_variable.variance()) * phi_neg_beta
-            + (mean_ + random_variable.mean()) * alpha_phi_beta - m * m;
+template<class T>
+TryResult<T> BasicNormalRandomVariable<T>::tryRectify(T lower, T upper, Accuracy accuracy) const noexcept
+{
+    if(!(lower < upper))
+    {
+        return failure<T>(Status::InvalidBounds);
+    }
 
-    return NormalRandomVariable(m, v);
+    return tryResult(NRV_WITH_ACCURACY(accuracy, detail::rectify, (mean_, variance_, lower, upper)));
 }
 
-NormalRandomVariable NormalRandomVariable::min(NormalRandomVariable random_variable) const
+template<class T>
+TryResult<T> BasicNormalRandomVariable<T>::tryTruncate(T lower, T upper, Accuracy accuracy) const noexcept
 {
-    return -((-(*this)).max(-random_variable));
+    if(!(lower < upper))
+    {
+        return failure<T>(Status::InvalidBounds);
+    }
+
+    return tryResult(NRV_WITH_ACCURACY(accuracy, detail::truncate, (mean_, variance_, lower, upper)));
 }
 
-NormalRandomVariable operator+(const NormalRandomVariable& rv1, const NormalRandomVariable& rv2)
+template<class T>
+TryResult<T> BasicNormalRandomVariable<T>::tryTruncateLower(T lower, Accuracy accuracy) const noexcept
 {
-    return NormalRandomVariable(rv1.mean() + rv2.mean(), rv1.variance() + rv2.variance());
+    return tryResult(NRV_WITH_ACCURACY(accuracy, detail::truncateLower, (mean_, variance_, lower)));
 }
 
-NormalRandomVariable operator+(const NormalRandomVariable& rv, double num)
+template<class T>
+TryResult<T> BasicNormalRandomVariable<T>::tryTruncateUpper(T upper, Accuracy accuracy) const noexcept
 {
-    return NormalRandomVariable(rv.mean() + num, rv.variance());
+    return tryResult(NRV_WITH_ACCURACY(accuracy, detail::truncateUpper, (mean_, variance_, upper)));
 }
 
-NormalRandomVariable operator+(double num, const NormalRandomVariable& rv)
+template<class T>
+TryResult<T> BasicNormalRandomVariable<T>::tryTruncate(BasicNormalRandomVariable lower, BasicNormalRandomVariable upper, Accuracy accuracy) const noexcept
 {
-    return rv + num;
+    return tryResult(NRV_WITH_ACCURACY(accuracy, detail::truncate, (mean_, variance_, lower.mean(), lower.variance(), upper.mean(), upper.variance())));
 }
 
-NormalRandomVariable operator-(const NormalRandomVariable& rv1, const NormalRandomVariable& rv2)
+template<class T>
+BasicNormalRandomVariable<T> operator/(typename BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv) NRV_TRY
 {
-    return NormalRandomVariable(rv1.mean() - rv2.mean(), rv1.variance() + rv2.variance());
+    NRV_COUNT_CALL(DivideConstant);
+
+    auto inverse = rv.inverse();
+    return BasicNormalRandomVariable<T>(inverse.mean() * num, inverse.variance() * std::pow(num, 2));
 }
+NRV_CATCH(DivideConstant)
 
-NormalRandomVariable operator-(const NormalRandomVariable& rv, double num)
+template<class T>
+BasicNormalRandomVariable<T> operator/(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2) NRV_TRY
 {
-    return NormalRandomVariable(rv.mean() - num, rv.variance());
+    NRV_COUNT_CALL(Divide);
+
+    // Check that the conditions for the approximation are met
+    if(detail::divisionApproximationValid<T>(rv1.mean(), rv1.variance(), rv2.mean(), rv2.variance()))
+    {
+        NRV_COUNT_BRANCH(DivideClosedForm);
+        detail::Moments<T> result = detail::divide(rv1.mean(), rv1.variance(), rv2.mean(), rv2.variance());
+        return BasicNormalRandomVariable(result.mean, result.variance);
+    }
+    else
+    {
+        // Otherwise, approximate it by multiplying rv1 by the inverse of rv2
+        NRV_COUNT_BRANCH(DivideByInverse);
+        return rv1 * rv2.inverse();
+    }
 }
+NRV_CATCH(Divide)
 
-NormalRandomVariable operator-(double num, const NormalRandomVariable& rv)
+template<class T>
+BasicNormalRandomVariable<T> divide(typename BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv, Accuracy accuracy)
 {
-    return NormalRandomVariable(num - rv.mean(), rv.variance());
+    return accuracy == Accuracy::Default ? num / rv : num * rv.inverse(accuracy);
 }
 
-NormalRandomVariable operator-(const NormalRandomVariable& rv)
+template<class T>
+BasicNormalRandomVariable<T> divide(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2, Accuracy accuracy) NRV_TRY
 {
-    return NormalRandomVariable(-rv.mean(), rv.variance());
+    if(accuracy == Accuracy::Default)
+    {
+        return rv1 / rv2;
+    }
+
+    NRV_COUNT_CALL(Divide);
+    NRV_COUNT_BRANCH(DivideByInverse);
+
+    if(!detail::inverseApproximationValid(rv2.mean(), rv2.variance()))
+    {
+        NRV_COUNT_BRANCH(InverseOutOfRange);
+        throw std::range_error("NormalRandomVariable: Variance of denominator is too large to allow approximation of division operator");
+    }
+
+    detail::Moments<T> result = NRV_WITH_ACCURACY(accuracy, detail::divide, (rv1.mean(), rv1.variance(), rv2.mean(), rv2.variance()));
+    return BasicNormalRandomVariable<T>(result.mean, result.variance);
 }
+NRV_CATCH(Divide)
 
-NormalRandomVariable operator/(const NormalRandomVariable& rv, double num)
+template<class T>
+BasicNormalRandomVariable<T> operator*(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2) NRV_TRY
 {
-    return NormalRandomVariable(rv.mean() / num, rv.variance() / std::pow(num, 2));
+    NRV_COUNT_CALL(Multiply);
+
+    detail::Moments<T> result = detail::multiply(rv1.mean(), rv1.variance(), rv2.mean(), rv2.variance());
+    return BasicNormalRandomVariable(result.mean, result.variance);
 }
+NRV_CATCH(Multiply)
 
-NormalRandomVariable operator/(double num, const NormalRandomVariable& rv)
+template<class T>
+TryResult<T> tryDivide(typename BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv,
+        Accuracy accuracy) noexcept
 {
-    auto inverse = rv.inverse();
-    return NormalRandomVariable(inverse.mean() * num, inverse.variance() * std::pow(num, 2));
+    if(!detail::inverseApproximationValid(rv.mean(), rv.variance()))
+    {
+        return failure<T>(Status::InvalidApproximation);
+    }
+
+    detail::Moments<T> inverse = NRV_WITH_ACCURACY(accuracy, detail::inverse, (rv.mean(), rv.variance()));
+    return BasicNormalRandomVariable<T>::tryCreate(inverse.mean * num, inverse.variance * (num * num));
 }
 
-NormalRandomVariable operator/(const NormalRandomVariable& rv1, const NormalRandomVariable& rv2)
+template<class T>
+TryResult<T> tryDivide(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2,
+        Accuracy accuracy) noexcept
 {
-    double a = rv1.mean() * rv1.mean() / rv1.variance();
-    double b = rv2.mean() * rv2.mean() / rv2.variance();
+    if(accuracy == Accuracy::Default && detail::divisionApproximationValid<T>(rv1.mean(), rv1.variance(), rv2.mean(), rv2.variance()))
+    {
+        return tryResult(detail::divide(rv1.mean(), rv1.variance(), rv2.mean(), rv2.variance()));
+    }
 
-    // Check that the conditions for the approximation are met
-    if(a < 6.25 && b >= 16)
+    // Otherwise, approximate it by multiplying rv1 by the inverse of rv2 (see operator/)
+    if(!detail::inverseApproximationValid(rv2.mean(), rv2.variance()))
     {
-        double r = rv2.variance() / rv1.variance();
-        double sqrt_b = std::sqrt(b);
-        double mean = std::sqrt(a) / (std::sqrt(r) * (1.01 * sqrt_b - 0.2713));
-        double variance = (a + 1) / (r * (b + 0.108 * sqrt_b - 3.795)) - mean * mean;
+        return failure<T>(Status::InvalidApproximation);
+    }
 
-        return NormalRandomVariable(mean, variance);
+    if(accuracy != Accuracy::Default)
+    {
+        return tryResult(NRV_WITH_ACCURACY(accuracy, detail::divide, (rv1.mean(), rv1.variance(), rv2.mean(), rv2.variance())));
     }
-    else
+
+    detail::Moments<T> inverse = detail::inverse(rv2.mean(), rv2.variance());
+    return tryResult(detail::multiply(rv1.mean(), rv1.variance(), inverse.mean, inverse.variance));
+}
+
+namespace {
+
+template<class T>
+std::vector<detail::Moments<T>, Allocator<detail::Moments<T>>> toMoments(const BasicNormalRandomVariable<T>* random_variables,
+        std::size_t size, MemoryResource* resource)
+{
+    std::vector<detail::Moments<T>, Allocator<detail::Moments<T>>> moments(size, resource);
+    for(std::size_t i = 0; i < size; ++i)
     {
-        // Otherwise, approximate it by multiplying rv1 by the inverse of rv2
-        return rv1 * rv2.inverse();
+        moments[i] = detail::Moments<T>{random_variables[i].mean(), random_variables[i].variance()};
     }
+
+    return moments;
 }
 
-NormalRandomVariable operator*(const NormalRandomVariable& rv, double num)
+} // namespace
+
+template<class T>
+BasicNormalRandomVariable<T> max(const BasicNormalRandomVariable<T>* random_variables, std::size_t size)
 {
-    return NormalRandomVariable(rv.mean() * num, rv.variance() * std::pow(num, 2));
+    return max(random_variables, size, defaultMemoryResource());
 }
 
-NormalRandomVariable operator*(double num, const NormalRandomVariable& rv)
+template<class T>
+BasicNormalRandomVariable<T> min(const BasicNormalRandomVariable<T>* random_variables, std::size_t size)
 {
-    return NormalRandomVariable(rv.mean() * num, rv.variance() * std::pow(num, 2));
+    return min(random_variables, size, defaultMemoryResource());
 }
 
-NormalRandomVariable operator*(const NormalRandomVariable& rv1, const NormalRandomVariable& rv2)
+template<class T>
+BasicNormalRandomVariable<T> max(const BasicNormalRandomVariable<T>* random_variables, std::size_t size,
+        MemoryResource* resource)
 {
-    double mean = rv1.mean() * rv2.mean();
-    double delta1 = rv1.mean() * rv1.mean() / rv1.variance();
-    double delta2 = rv2.mean() * rv2.mean() / rv2.variance();
-    double variance = rv1.variance() * rv2.variance() * (1 + delta1 + delta2);
+    std::vector<detail::Moments<T>, Allocator<detail::Moments<T>>> moments = toMoments(random_variables, size, resource);
+    detail::Moments<T> result = detail::maxOf(moments);
+    return BasicNormalRandomVariable<T>(result.mean, result.variance);
+}
 
-    return NormalRandomVariable(mean, variance);
+template<class T>
+BasicNormalRandomVariable<T> min(const BasicNormalRandomVariable<T>* random_variables, std::size_t size,
+        MemoryResource* resource)
+{
+    std::vector<detail::Moments<T>, Allocator<detail::Moments<T>>> moments = toMoments(random_variables, size, resource);
+    detail::Moments<T> result = detail::minOf(moments);
+    return BasicNormalRandomVariable<T>(result.mean, result.variance);
 }
+
+template class BasicNormalRandomVariable<float>;
+template class BasicNormalRandomVariable<double>;
+template class BasicNormalRandomVariable<long double>;
+
+#define NRV_INSTANTIATE_OPERATORS(T) \
+    template BasicNormalRandomVariable<T> operator/(BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv); \
+    template BasicNormalRandomVariable<T> operator/(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2); \
+    template BasicNormalRandomVariable<T> divide(BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv, Accuracy accuracy); \
+    template BasicNormalRandomVariable<T> divide(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2, Accuracy accuracy); \
+    template BasicNormalRandomVariable<T> operator*(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2); \
+    template TryResult<T> tryDivide(BasicNormalRandomVariable<T>::value_type num, const BasicNormalRandomVariable<T>& rv, Accuracy accuracy) noexcept; \
+    template TryResult<T> tryDivide(const BasicNormalRandomVariable<T>& rv1, const BasicNormalRandomVariable<T>& rv2, Accuracy accuracy) noexcept; \
+    template BasicNormalRandomVariable<T> max(const BasicNormalRandomVariable<T>* random_variables, std::size_t size); \
+    template BasicNormalRandomVariable<T> min(const BasicNormalRandomVariable<T>* random_variables, std::size_t size); \
+    template BasicNormalRandomVariable<T> max(const BasicNormalRandomVariable<T>* random_variables, std::size_t size, \
+            MemoryResource* resource); \
+    template BasicNormalRandomVariable<T> min(const BasicNormalRandomVariable<T>* random_variables, std::size_t size, \
+            MemoryResource* resource);
+
+NRV_INSTANTIATE_OPERATORS(float)
+NRV_INSTANTIATE_OPERATORS(double)
+NRV_INSTANTIATE_OPERATORS(long double)
     
 } // namespace NRV
 
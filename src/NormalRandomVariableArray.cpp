@@ -0,0 +1,987 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "NormalRandomVariable/NormalRandomVariableArray.h"
+#include "BatchKernels.h"
+#include "Reduction.h"
+
+
+namespace NRV {
+
+namespace {
+
+template<class T>
+void checkSizes(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    if(rv1.size() != rv2.size())
+    {
+        throw std::length_error("NormalRandomVariableArray: Arrays must be the same size");
+    }
+}
+
+/**
+ * Applies kernel(mean, variance) to every element of rv
+ */
+template<class T, class Kernel>
+void applyElementWise(const BasicNormalRandomVariableArray<T>& rv, Kernel kernel, BasicNormalRandomVariableArray<T>& result)
+{
+    result.resize(rv.size());
+    const T* mean = rv.means();
+    const T* variance = rv.variances();
+    T* result_mean = result.means();
+    T* result_variance = result.variances();
+
+    for(std::size_t i = 0; i < rv.size(); ++i)
+    {
+        detail::Moments<T> moments = kernel(mean[i], variance[i]);
+        result_mean[i] = moments.mean;
+        result_variance[i] = moments.variance;
+    }
+}
+
+/**
+ * Applies kernel(mean1, variance1, mean2, variance2) to every pair of elements of rv1 and rv2
+ */
+template<class T, class Kernel>
+void applyElementWise(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, Kernel kernel,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    checkSizes(rv1, rv2);
+
+    result.resize(rv1.size());
+    const T* mean1 = rv1.means();
+    const T* variance1 = rv1.variances();
+    const T* mean2 = rv2.means();
+    const T* variance2 = rv2.variances();
+    T* result_mean = result.means();
+    T* result_variance = result.variances();
+
+    for(std::size_t i = 0; i < rv1.size(); ++i)
+    {
+        detail::Moments<T> moments = kernel(mean1[i], variance1[i], mean2[i], variance2[i]);
+        result_mean[i] = moments.mean;
+        result_variance[i] = moments.variance;
+    }
+}
+
+/**
+ * Sets every element of result to a standard normal distribution
+ */
+template<class T>
+void setStandardNormal(std::size_t size, BasicNormalRandomVariableArray<T>& result)
+{
+    result.resize(size);
+    std::fill(result.means(), result.means() + size, T(0));
+    std::fill(result.variances(), result.variances() + size, T(1));
+}
+
+/**
+ * Marks the elements of result that do not have a valid variance as failed, and sets the failed elements to a
+ * standard normal distribution
+ */
+template<class T>
+void checkResult(BasicNormalRandomVariableArray<T>& result, std::vector<Status>& status)
+{
+    T* mean = result.means();
+    T* variance = result.variances();
+
+    for(std::size_t i = 0; i < result.size(); ++i)
+    {
+        if(status[i] == Status::Ok && !(variance[i] > 0))
+        {
+            status[i] = Status::InvalidVariance;
+        }
+
+        if(status[i] != Status::Ok)
+        {
+            mean[i] = 0;
+            variance[i] = 1;
+        }
+    }
+}
+
+template<class T>
+std::vector<detail::Moments<T>, Allocator<detail::Moments<T>>> toMoments(const BasicNormalRandomVariableArray<T>& random_variables,
+        MemoryResource* resource)
+{
+    std::vector<detail::Moments<T>, Allocator<detail::Moments<T>>> moments(random_variables.size(), resource);
+    for(std::size_t i = 0; i < random_variables.size(); ++i)
+    {
+        moments[i] = detail::Moments<T>{random_variables.means()[i], random_variables.variances()[i]};
+    }
+
+    return moments;
+}
+
+} // namespace
+
+template<class T>
+BasicNormalRandomVariableArray<T>::BasicNormalRandomVariableArray()
+{
+
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T>::BasicNormalRandomVariableArray(std::size_t size)
+: means_(size, 0), variances_(size, 1)
+{
+
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T>::BasicNormalRandomVariableArray(MemoryResource* resource)
+: means_(resource), variances_(resource)
+{
+
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T>::BasicNormalRandomVariableArray(std::size_t size, MemoryResource* resource)
+: means_(size, 0, resource), variances_(size, 1, resource)
+{
+
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T>::BasicNormalRandomVariableArray(std::vector<T> means, std::vector<T> variances)
+: means_(means.begin(), means.end()), variances_(variances.begin(), variances.end())
+{
+    if(means_.size() != variances_.size())
+    {
+        throw std::length_error("NormalRandomVariableArray: Number of means and variances must be the same");
+    }
+
+    for(T variance : variances_)
+    {
+        if(variance <= 0)
+        {
+            throw std::range_error("NormalRandomVariableArray: Variance must be greater than 0");
+        }
+    }
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T>::BasicNormalRandomVariableArray(const std::vector<BasicNormalRandomVariable<T>>& random_variables)
+{
+    reserve(random_variables.size());
+    for(const auto& random_variable : random_variables)
+    {
+        push_back(random_variable);
+    }
+}
+
+template<class T>
+MemoryResource* BasicNormalRandomVariableArray<T>::resource() const
+{
+    return means_.get_allocator().resource();
+}
+
+template<class T>
+std::size_t BasicNormalRandomVariableArray<T>::size() const
+{
+    return means_.size();
+}
+
+template<class T>
+bool BasicNormalRandomVariableArray<T>::empty() const
+{
+    return means_.empty();
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::resize(std::size_t size)
+{
+    means_.resize(size, 0);
+    variances_.resize(size, 1);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::reserve(std::size_t size)
+{
+    means_.reserve(size);
+    variances_.reserve(size);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::push_back(const BasicNormalRandomVariable<T>& random_variable)
+{
+    means_.push_back(random_variable.mean());
+    variances_.push_back(random_variable.variance());
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariableArray<T>::at(std::size_t index) const
+{
+    return BasicNormalRandomVariable<T>(means_.at(index), variances_.at(index));
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicNormalRandomVariableArray<T>::operator[](std::size_t index) const
+{
+    return BasicNormalRandomVariable<T>(means_[index], variances_[index]);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::set(std::size_t index, const BasicNormalRandomVariable<T>& random_variable)
+{
+    means_[index] = random_variable.mean();
+    variances_[index] = random_variable.variance();
+}
+
+template<class T>
+const T* BasicNormalRandomVariableArray<T>::means() const
+{
+    return means_.data();
+}
+
+template<class T>
+T* BasicNormalRandomVariableArray<T>::means()
+{
+    return means_.data();
+}
+
+template<class T>
+const T* BasicNormalRandomVariableArray<T>::variances() const
+{
+    return variances_.data();
+}
+
+template<class T>
+T* BasicNormalRandomVariableArray<T>::variances()
+{
+    return variances_.data();
+}
+
+template<class T>
+std::vector<BasicNormalRandomVariable<T>> BasicNormalRandomVariableArray<T>::toVector() const
+{
+    std::vector<BasicNormalRandomVariable<T>> random_variables;
+    random_variables.reserve(size());
+    for(std::size_t i = 0; i < size(); ++i)
+    {
+        random_variables.push_back((*this)[i]);
+    }
+
+    return random_variables;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::inverse() const
+{
+    BasicNormalRandomVariableArray result;
+    inverse(result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::rectify(T lower, T upper) const
+{
+    BasicNormalRandomVariableArray result;
+    rectify(lower, upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::rectifyLower(T lower) const
+{
+    BasicNormalRandomVariableArray result;
+    rectifyLower(lower, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::rectifyUpper(T upper) const
+{
+    BasicNormalRandomVariableArray result;
+    rectifyUpper(upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::truncate(T lower, T upper) const
+{
+    BasicNormalRandomVariableArray result;
+    truncate(lower, upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::truncateLower(T lower) const
+{
+    BasicNormalRandomVariableArray result;
+    truncateLower(lower, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::truncateUpper(T upper) const
+{
+    BasicNormalRandomVariableArray result;
+    truncateUpper(upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::truncate(const BasicNormalRandomVariableArray<T>& lower, const BasicNormalRandomVariableArray<T>& upper) const
+{
+    BasicNormalRandomVariableArray result;
+    truncate(lower, upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::truncateLower(const BasicNormalRandomVariableArray<T>& lower) const
+{
+    BasicNormalRandomVariableArray result;
+    truncateLower(lower, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::truncateUpper(const BasicNormalRandomVariableArray<T>& upper) const
+{
+    BasicNormalRandomVariableArray result;
+    truncateUpper(upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::max(const BasicNormalRandomVariableArray<T>& random_variables) const
+{
+    BasicNormalRandomVariableArray result;
+    max(random_variables, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::min(const BasicNormalRandomVariableArray<T>& random_variables) const
+{
+    BasicNormalRandomVariableArray result;
+    min(random_variables, result);
+    return result;
+}
+
+template<class T>
+std::vector<T> BasicNormalRandomVariableArray<T>::cdf(T x) const
+{
+    std::vector<T> result;
+    cdf(x, result);
+    return result;
+}
+
+template<class T>
+std::vector<T> BasicNormalRandomVariableArray<T>::quantile(T probability) const
+{
+    std::vector<T> result;
+    quantile(probability, result);
+    return result;
+}
+
+template<class T>
+std::vector<T> BasicNormalRandomVariableArray<T>::probabilityLessThan(const BasicNormalRandomVariableArray<T>& random_variables) const
+{
+    std::vector<T> result;
+    probabilityLessThan(random_variables, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::tryInverse(std::vector<Status>& status) const
+{
+    BasicNormalRandomVariableArray result;
+    tryInverse(status, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::tryRectify(T lower, T upper, std::vector<Status>& status) const
+{
+    BasicNormalRandomVariableArray result;
+    tryRectify(lower, upper, status, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::tryTruncate(T lower, T upper, std::vector<Status>& status) const
+{
+    BasicNormalRandomVariableArray result;
+    tryTruncate(lower, upper, status, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::tryTruncateLower(T lower, std::vector<Status>& status) const
+{
+    BasicNormalRandomVariableArray result;
+    tryTruncateLower(lower, status, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::tryTruncateUpper(T upper, std::vector<Status>& status) const
+{
+    BasicNormalRandomVariableArray result;
+    tryTruncateUpper(upper, status, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> BasicNormalRandomVariableArray<T>::tryTruncate(const BasicNormalRandomVariableArray& lower,
+        const BasicNormalRandomVariableArray& upper, std::vector<Status>& status) const
+{
+    BasicNormalRandomVariableArray result;
+    tryTruncate(lower, upper, status, result);
+    return result;
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::inverse(BasicNormalRandomVariableArray& result) const
+{
+    applyElementWise(*this, [](T mean, T variance) {
+        return detail::inverse(mean, variance);
+    }, result);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::rectify(T lower, T upper, BasicNormalRandomVariableArray& result) const
+{
+    if(upper <= lower)
+    {
+        throw std::range_error("NormalRandomVariableArray: Rectification lower bound must be less than upper bound");
+    }
+
+    result.resize(size());
+    detail::arrayKernels<T>().rectify(means(), variances(), lower, upper, result.means(), result.variances(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::rectifyLower(T lower, BasicNormalRandomVariableArray& result) const
+{
+    result.resize(size());
+    detail::arrayKernels<T>().rectifyLower(means(), variances(), lower, T(1), result.means(), result.variances(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::rectifyUpper(T upper, BasicNormalRandomVariableArray& result) const
+{
+    result.resize(size());
+    detail::arrayKernels<T>().rectifyLower(means(), variances(), upper, T(-1), result.means(), result.variances(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::truncate(T lower, T upper, BasicNormalRandomVariableArray& result) const
+{
+    if(upper <= lower)
+    {
+        throw std::range_error("NormalRandomVariableArray: Truncation lower bound must be less than upper bound");
+    }
+
+    result.resize(size());
+    detail::arrayKernels<T>().truncate(means(), variances(), lower, upper, result.means(), result.variances(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::truncateLower(T lower, BasicNormalRandomVariableArray& result) const
+{
+    result.resize(size());
+    detail::arrayKernels<T>().truncateLower(means(), variances(), lower, T(1), result.means(), result.variances(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::truncateUpper(T upper, BasicNormalRandomVariableArray& result) const
+{
+    result.resize(size());
+    detail::arrayKernels<T>().truncateLower(means(), variances(), upper, T(-1), result.means(), result.variances(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::truncate(const BasicNormalRandomVariableArray& lower, const BasicNormalRandomVariableArray& upper,
+        BasicNormalRandomVariableArray& result) const
+{
+    checkSizes(*this, lower);
+    checkSizes(*this, upper);
+
+    result.resize(size());
+    for(std::size_t i = 0; i < size(); ++i)
+    {
+        detail::Moments<T> moments = detail::truncate(means_[i], variances_[i], lower.means_[i], lower.variances_[i],
+                upper.means_[i], upper.variances_[i]);
+        result.means_[i] = moments.mean;
+        result.variances_[i] = moments.variance;
+    }
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::truncateLower(const BasicNormalRandomVariableArray& lower, BasicNormalRandomVariableArray& result) const
+{
+    applyElementWise(*this, lower, [](T mean, T variance, T lower_mean, T lower_variance) {
+        return detail::truncateLower(mean, variance, lower_mean, lower_variance);
+    }, result);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::truncateUpper(const BasicNormalRandomVariableArray& upper, BasicNormalRandomVariableArray& result) const
+{
+    applyElementWise(*this, upper, [](T mean, T variance, T upper_mean, T upper_variance) {
+        return detail::truncateUpper(mean, variance, upper_mean, upper_variance);
+    }, result);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::max(const BasicNormalRandomVariableArray& random_variables, BasicNormalRandomVariableArray& result) const
+{
+    checkSizes(*this, random_variables);
+
+    result.resize(size());
+    detail::arrayKernels<T>().max(means(), variances(), random_variables.means(), random_variables.variances(), T(1),
+            result.means(), result.variances(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::min(const BasicNormalRandomVariableArray& random_variables, BasicNormalRandomVariableArray& result) const
+{
+    checkSizes(*this, random_variables);
+
+    result.resize(size());
+    detail::arrayKernels<T>().max(means(), variances(), random_variables.means(), random_variables.variances(), T(-1),
+            result.means(), result.variances(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::cdf(T x, std::vector<T>& result) const
+{
+    result.resize(size());
+    detail::arrayKernels<T>().cdf(means(), variances(), x, result.data(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::quantile(T probability, std::vector<T>& result) const
+{
+    if(!(probability > 0 && probability < 1))
+    {
+        throw std::range_error("NormalRandomVariableArray: Probability must be between 0 and 1");
+    }
+
+    T z = detail::normalQuantile(probability);
+    result.resize(size());
+    for(std::size_t i = 0; i < size(); ++i)
+    {
+        result[i] = means_[i] + std::sqrt(variances_[i]) * z;
+    }
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::probabilityLessThan(const BasicNormalRandomVariableArray& random_variables,
+        std::vector<T>& result) const
+{
+    checkSizes(*this, random_variables);
+
+    result.resize(size());
+    detail::arrayKernels<T>().lessThan(means(), variances(), random_variables.means(), random_variables.variances(),
+            result.data(), size());
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::tryInverse(std::vector<Status>& status, BasicNormalRandomVariableArray& result) const
+{
+    result.resize(size());
+    status.assign(size(), Status::Ok);
+
+    for(std::size_t i = 0; i < size(); ++i)
+    {
+        if(!detail::inverseApproximationValid(means_[i], variances_[i]))
+        {
+            status[i] = Status::InvalidApproximation;
+            continue;
+        }
+
+        detail::Moments<T> moments = detail::inverse(means_[i], variances_[i]);
+        result.means_[i] = moments.mean;
+        result.variances_[i] = moments.variance;
+    }
+
+    checkResult(result, status);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::tryRectify(T lower, T upper, std::vector<Status>& status,
+        BasicNormalRandomVariableArray& result) const
+{
+    if(!(lower < upper))
+    {
+        status.assign(size(), Status::InvalidBounds);
+        setStandardNormal(size(), result);
+        return;
+    }
+
+    rectify(lower, upper, result);
+    status.assign(size(), Status::Ok);
+    checkResult(result, status);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::tryTruncate(T lower, T upper, std::vector<Status>& status,
+        BasicNormalRandomVariableArray& result) const
+{
+    if(!(lower < upper))
+    {
+        status.assign(size(), Status::InvalidBounds);
+        setStandardNormal(size(), result);
+        return;
+    }
+
+    truncate(lower, upper, result);
+    status.assign(size(), Status::Ok);
+    checkResult(result, status);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::tryTruncateLower(T lower, std::vector<Status>& status,
+        BasicNormalRandomVariableArray& result) const
+{
+    truncateLower(lower, result);
+    status.assign(size(), Status::Ok);
+    checkResult(result, status);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::tryTruncateUpper(T upper, std::vector<Status>& status,
+        BasicNormalRandomVariableArray& result) const
+{
+    truncateUpper(upper, result);
+    status.assign(size(), Status::Ok);
+    checkResult(result, status);
+}
+
+template<class T>
+void BasicNormalRandomVariableArray<T>::tryTruncate(const BasicNormalRandomVariableArray& lower,
+        const BasicNormalRandomVariableArray& upper, std::vector<Status>& status, BasicNormalRandomVariableArray& result) const
+{
+    truncate(lower, upper, result);
+    status.assign(size(), Status::Ok);
+    checkResult(result, status);
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator+(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    add(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator+(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num)
+{
+    BasicNormalRandomVariableArray<T> result;
+    add(rv, num, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator+(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv)
+{
+    return rv + num;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator-(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    subtract(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator-(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num)
+{
+    BasicNormalRandomVariableArray<T> result;
+    subtract(rv, num, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator-(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv)
+{
+    BasicNormalRandomVariableArray<T> result;
+    subtract(num, rv, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator-(const BasicNormalRandomVariableArray<T>& rv)
+{
+    BasicNormalRandomVariableArray<T> result;
+    negate(rv, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator/(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num)
+{
+    BasicNormalRandomVariableArray<T> result;
+    divide(rv, num, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator/(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv)
+{
+    BasicNormalRandomVariableArray<T> result;
+    divide(num, rv, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator/(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    divide(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator*(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num)
+{
+    BasicNormalRandomVariableArray<T> result;
+    multiply(rv, num, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator*(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv)
+{
+    return rv * num;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> operator*(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    multiply(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> tryDivide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        std::vector<Status>& status)
+{
+    BasicNormalRandomVariableArray<T> result;
+    tryDivide(rv1, rv2, status, result);
+    return result;
+}
+
+template<class T>
+void add(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv1, rv2, [](T mean1, T variance1, T mean2, T variance2) {
+        return detail::Moments<T>{mean1 + mean2, variance1 + variance2};
+    }, result);
+}
+
+template<class T>
+void add(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv, [=](T mean, T variance) {
+        return detail::Moments<T>{mean + num, variance};
+    }, result);
+}
+
+template<class T>
+void subtract(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv1, rv2, [](T mean1, T variance1, T mean2, T variance2) {
+        return detail::Moments<T>{mean1 - mean2, variance1 + variance2};
+    }, result);
+}
+
+template<class T>
+void subtract(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv, [=](T mean, T variance) {
+        return detail::Moments<T>{mean - num, variance};
+    }, result);
+}
+
+template<class T>
+void subtract(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv, [=](T mean, T variance) {
+        return detail::Moments<T>{num - mean, variance};
+    }, result);
+}
+
+template<class T>
+void negate(const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv, [](T mean, T variance) {
+        return detail::Moments<T>{-mean, variance};
+    }, result);
+}
+
+template<class T>
+void multiply(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv1, rv2, [](T mean1, T variance1, T mean2, T variance2) {
+        return detail::multiply(mean1, variance1, mean2, variance2);
+    }, result);
+}
+
+template<class T>
+void multiply(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num, BasicNormalRandomVariableArray<T>& result)
+{
+    T num_squared = num * num;
+    applyElementWise(rv, [=](T mean, T variance) {
+        return detail::Moments<T>{mean * num, variance * num_squared};
+    }, result);
+}
+
+template<class T>
+void divide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv1, rv2, [](T mean1, T variance1, T mean2, T variance2) {
+        return detail::divide(mean1, variance1, mean2, variance2);
+    }, result);
+}
+
+template<class T>
+void divide(const BasicNormalRandomVariableArray<T>& rv, typename BasicNormalRandomVariableArray<T>::value_type num, BasicNormalRandomVariableArray<T>& result)
+{
+    T num_squared = num * num;
+    applyElementWise(rv, [=](T mean, T variance) {
+        return detail::Moments<T>{mean / num, variance / num_squared};
+    }, result);
+}
+
+template<class T>
+void divide(typename BasicNormalRandomVariableArray<T>::value_type num, const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result)
+{
+    T num_squared = num * num;
+    applyElementWise(rv, [=](T mean, T variance) {
+        detail::Moments<T> inverse = detail::inverse(mean, variance);
+        return detail::Moments<T>{inverse.mean * num, inverse.variance * num_squared};
+    }, result);
+}
+
+template<class T>
+void tryDivide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, std::vector<Status>& status,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    checkSizes(rv1, rv2);
+
+    result.resize(rv1.size());
+    status.assign(rv1.size(), Status::Ok);
+
+    const T* mean1 = rv1.means();
+    const T* variance1 = rv1.variances();
+    const T* mean2 = rv2.means();
+    const T* variance2 = rv2.variances();
+    T* result_mean = result.means();
+    T* result_variance = result.variances();
+
+    for(std::size_t i = 0; i < rv1.size(); ++i)
+    {
+        detail::Moments<T> moments;
+        if(detail::divisionApproximationValid(mean1[i], variance1[i], mean2[i], variance2[i]))
+        {
+            moments = detail::divide(mean1[i], variance1[i], mean2[i], variance2[i]);
+        }
+        else if(detail::inverseApproximationValid(mean2[i], variance2[i]))
+        {
+            detail::Moments<T> inverse = detail::inverse(mean2[i], variance2[i]);
+            moments = detail::multiply(mean1[i], variance1[i], inverse.mean, inverse.variance);
+        }
+        else
+        {
+            status[i] = Status::InvalidApproximation;
+            continue;
+        }
+
+        result_mean[i] = moments.mean;
+        result_variance[i] = moments.variance;
+    }
+
+    checkResult(result, status);
+}
+
+template<class T>
+void pairwiseProbabilityLessThan(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        T* result)
+{
+    detail::arrayKernels<T>().pairwiseLessThan(rv1.means(), rv1.variances(), rv1.size(), rv2.means(), rv2.variances(),
+            rv2.size(), result, rv2.size());
+}
+
+template<class T>
+BasicNormalRandomVariable<T> max(const BasicNormalRandomVariableArray<T>& random_variables)
+{
+    return max(random_variables, defaultMemoryResource());
+}
+
+template<class T>
+BasicNormalRandomVariable<T> min(const BasicNormalRandomVariableArray<T>& random_variables)
+{
+    return min(random_variables, defaultMemoryResource());
+}
+
+template<class T>
+BasicNormalRandomVariable<T> max(const BasicNormalRandomVariableArray<T>& random_variables, MemoryResource* resource)
+{
+    std::vector<detail::Moments<T>, Allocator<detail::Moments<T>>> moments = toMoments(random_variables, resource);
+    detail::Moments<T> result = detail::maxOf(moments);
+    return BasicNormalRandomVariable<T>(result.mean, result.variance);
+}
+
+template<class T>
+BasicNormalRandomVariable<T> min(const BasicNormalRandomVariableArray<T>& random_variables, MemoryResource* resource)
+{
+    std::vector<detail::Moments<T>, Allocator<detail::Moments<T>>> moments = toMoments(random_variables, resource);
+    detail::Moments<T> result = detail::minOf(moments);
+    return BasicNormalRandomVariable<T>(result.mean, result.variance);
+}
+
+template class BasicNormalRandomVariableArray<float>;
+template class BasicNormalRandomVariableArray<double>;
+template class BasicNormalRandomVariableArray<long double>;
+
+#define NRV_INSTANTIATE_ARRAY_OPERATORS(T) \
+    template BasicNormalRandomVariableArray<T> operator+(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template BasicNormalRandomVariableArray<T> operator+(const BasicNormalRandomVariableArray<T>& rv, T num); \
+    template BasicNormalRandomVariableArray<T> operator+(T num, const BasicNormalRandomVariableArray<T>& rv); \
+    template BasicNormalRandomVariableArray<T> operator-(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template BasicNormalRandomVariableArray<T> operator-(const BasicNormalRandomVariableArray<T>& rv, T num); \
+    template BasicNormalRandomVariableArray<T> operator-(T num, const BasicNormalRandomVariableArray<T>& rv); \
+    template BasicNormalRandomVariableArray<T> operator-(const BasicNormalRandomVariableArray<T>& rv); \
+    template BasicNormalRandomVariableArray<T> operator/(const BasicNormalRandomVariableArray<T>& rv, T num); \
+    template BasicNormalRandomVariableArray<T> operator/(T num, const BasicNormalRandomVariableArray<T>& rv); \
+    template BasicNormalRandomVariableArray<T> operator/(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template BasicNormalRandomVariableArray<T> operator*(const BasicNormalRandomVariableArray<T>& rv, T num); \
+    template BasicNormalRandomVariableArray<T> operator*(T num, const BasicNormalRandomVariableArray<T>& rv); \
+    template BasicNormalRandomVariableArray<T> operator*(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template BasicNormalRandomVariableArray<T> tryDivide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, \
+            std::vector<Status>& status); \
+    template void pairwiseProbabilityLessThan(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, \
+            T* result); \
+    template BasicNormalRandomVariable<T> max(const BasicNormalRandomVariableArray<T>& random_variables); \
+    template BasicNormalRandomVariable<T> min(const BasicNormalRandomVariableArray<T>& random_variables); \
+    template BasicNormalRandomVariable<T> max(const BasicNormalRandomVariableArray<T>& random_variables, MemoryResource* resource); \
+    template BasicNormalRandomVariable<T> min(const BasicNormalRandomVariableArray<T>& random_variables, MemoryResource* resource); \
+    template void add(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void add(const BasicNormalRandomVariableArray<T>& rv, T num, BasicNormalRandomVariableArray<T>& result); \
+    template void subtract(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void subtract(const BasicNormalRandomVariableArray<T>& rv, T num, BasicNormalRandomVariableArray<T>& result); \
+    template void subtract(T num, const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result); \
+    template void negate(const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result); \
+    template void multiply(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void multiply(const BasicNormalRandomVariableArray<T>& rv, T num, BasicNormalRandomVariableArray<T>& result); \
+    template void divide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void divide(const BasicNormalRandomVariableArray<T>& rv, T num, BasicNormalRandomVariableArray<T>& result); \
+    template void divide(T num, const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result); \
+    template void tryDivide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, \
+            std::vector<Status>& status, BasicNormalRandomVariableArray<T>& result);
+
+NRV_INSTANTIATE_ARRAY_OPERATORS(float)
+NRV_INSTANTIATE_ARRAY_OPERATORS(double)
+NRV_INSTANTIATE_ARRAY_OPERATORS(long double)
+
+} // namespace NRV
@@ -0,0 +1,607 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "NormalRandomVariable/Parallel.h"
+#include "BatchKernels.h"
+
+
+namespace NRV {
+namespace parallel {
+
+namespace {
+
+std::atomic<unsigned int> thread_count(0);
+
+/**
+ * Range of chunks [first, last) that remain to be calculated by a thread, packed into one word so that the owner
+ * and thieves can update it atomically. Each range is on its own cache line
+ */
+struct alignas(64) ChunkRange {
+    std::atomic<std::uint64_t> range;
+};
+
+constexpr std::uint64_t pack(std::uint64_t first, std::uint64_t last)
+{
+    return first << 32 | last;
+}
+
+/**
+ * Takes the first chunk of range, returning false if it is empty
+ */
+bool pop(ChunkRange& range, std::uint64_t& chunk)
+{
+    std::uint64_t current = range.range.load(std::memory_order_relaxed);
+    while(true)
+    {
+        std::uint64_t first = current >> 32, last = current & 0xffffffff;
+        if(first >= last)
+        {
+            return false;
+        }
+        if(range.range.compare_exchange_weak(current, pack(first + 1, last), std::memory_order_relaxed))
+        {
+            chunk = first;
+            return true;
+        }
+    }
+}
+
+/**
+ * Takes the second half of the chunks of victim (rounded up), returning false if it is empty
+ */
+bool steal(ChunkRange& victim, std::uint64_t& first_stolen, std::uint64_t& last_stolen)
+{
+    std::uint64_t current = victim.range.load(std::memory_order_relaxed);
+    while(true)
+    {
+        std::uint64_t first = current >> 32, last = current & 0xffffffff;
+        if(first >= last)
+        {
+            return false;
+        }
+        std::uint64_t middle = last - (last - first + 1) / 2;
+        if(victim.range.compare_exchange_weak(current, pack(first, middle), std::memory_order_relaxed))
+        {
+            first_stolen = middle;
+            last_stolen = last;
+            return true;
+        }
+    }
+}
+
+/**
+ * Calls function(first, size) for each chunk of the elements [0, size). The chunks are initially divided evenly
+ * between the threads, and threads that run out steal from the others until every chunk has been calculated
+ */
+template<class Function>
+void forEachChunk(std::size_t size, Function function)
+{
+    std::uint64_t chunks = (size + chunk_size - 1) / chunk_size;
+    std::size_t threads = static_cast<std::size_t>(std::min<std::uint64_t>(parallel::threads(), chunks));
+    if(threads <= 1 || chunks > 0xffffffff)
+    {
+        function(0, size);
+        return;
+    }
+
+    std::vector<ChunkRange> ranges(threads);
+    for(std::size_t thread = 0; thread < threads; ++thread)
+    {
+        ranges[thread].range.store(pack(chunks * thread / threads, chunks * (thread + 1) / threads));
+    }
+
+    auto work = [&](std::size_t thread) {
+        std::uint64_t chunk, first_stolen, last_stolen;
+        while(true)
+        {
+            while(pop(ranges[thread], chunk))
+            {
+                std::size_t first = static_cast<std::size_t>(chunk) * chunk_size;
+                function(first, std::min(chunk_size, size - first));
+            }
+
+            // Look for another thread with chunks left, starting with the next thread
+            bool stolen = false;
+            for(std::size_t i = 1; i < threads && !stolen; ++i)
+            {
+                stolen = steal(ranges[(thread + i) % threads], first_stolen, last_stolen);
+            }
+            if(!stolen)
+            {
+                return;
+            }
+            ranges[thread].range.store(pack(first_stolen, last_stolen), std::memory_order_relaxed);
+        }
+    };
+
+    // If a thread can not be started, its chunks are stolen by the threads that are running
+    std::vector<std::thread> workers;
+    for(std::size_t thread = 1; thread < threads; ++thread)
+    {
+        try
+        {
+            workers.emplace_back(work, thread);
+        }
+        catch(const std::system_error&)
+        {
+            break;
+        }
+    }
+    work(0);
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+template<class T>
+void checkSizes(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    if(rv1.size() != rv2.size())
+    {
+        throw std::length_error("NormalRandomVariableArray: Arrays must be the same size");
+    }
+}
+
+/**
+ * Applies kernel(mean, variance) to every element of rv
+ */
+template<class T, class Kernel>
+void applyElementWise(const BasicNormalRandomVariableArray<T>& rv, Kernel kernel, BasicNormalRandomVariableArray<T>& result)
+{
+    result.resize(rv.size());
+    const T* mean = rv.means();
+    const T* variance = rv.variances();
+    T* result_mean = result.means();
+    T* result_variance = result.variances();
+
+    forEachChunk(rv.size(), [&](std::size_t first, std::size_t size) {
+        for(std::size_t i = first; i < first + size; ++i)
+        {
+            detail::Moments<T> moments = kernel(mean[i], variance[i]);
+            result_mean[i] = moments.mean;
+            result_variance[i] = moments.variance;
+        }
+    });
+}
+
+/**
+ * Applies kernel(mean1, variance1, mean2, variance2) to every pair of elements of rv1 and rv2
+ */
+template<class T, class Kernel>
+void applyElementWise(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, Kernel kernel,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    checkSizes(rv1, rv2);
+
+    result.resize(rv1.size());
+    const T* mean1 = rv1.means();
+    const T* variance1 = rv1.variances();
+    const T* mean2 = rv2.means();
+    const T* variance2 = rv2.variances();
+    T* result_mean = result.means();
+    T* result_variance = result.variances();
+
+    forEachChunk(rv1.size(), [&](std::size_t first, std::size_t size) {
+        for(std::size_t i = first; i < first + size; ++i)
+        {
+            detail::Moments<T> moments = kernel(mean1[i], variance1[i], mean2[i], variance2[i]);
+            result_mean[i] = moments.mean;
+            result_variance[i] = moments.variance;
+        }
+    });
+}
+
+/**
+ * Applies a bounds kernel (see BatchKernels.h) to each chunk of rv
+ */
+template<class T>
+void applyBounds(const BasicNormalRandomVariableArray<T>& rv, detail::BoundsKernel<T> kernel, T lower, T upper,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    result.resize(rv.size());
+    forEachChunk(rv.size(), [&](std::size_t first, std::size_t size) {
+        kernel(rv.means() + first, rv.variances() + first, lower, upper, result.means() + first,
+                result.variances() + first, size);
+    });
+}
+
+/**
+ * Applies a bound kernel (see BatchKernels.h) to each chunk of rv
+ */
+template<class T>
+void applyBound(const BasicNormalRandomVariableArray<T>& rv, detail::BoundKernel<T> kernel, T bound, T sign,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    result.resize(rv.size());
+    forEachChunk(rv.size(), [&](std::size_t first, std::size_t size) {
+        kernel(rv.means() + first, rv.variances() + first, bound, sign, result.means() + first,
+                result.variances() + first, size);
+    });
+}
+
+/**
+ * Applies a pair kernel (see BatchKernels.h) to each chunk of rv1 and rv2
+ */
+template<class T>
+void applyPair(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        detail::PairKernel<T> kernel, T sign, BasicNormalRandomVariableArray<T>& result)
+{
+    checkSizes(rv1, rv2);
+
+    result.resize(rv1.size());
+    forEachChunk(rv1.size(), [&](std::size_t first, std::size_t size) {
+        kernel(rv1.means() + first, rv1.variances() + first, rv2.means() + first, rv2.variances() + first, sign,
+                result.means() + first, result.variances() + first, size);
+    });
+}
+
+} // namespace
+
+unsigned int threads()
+{
+    unsigned int threads = thread_count.load(std::memory_order_relaxed);
+    return threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+}
+
+void setThreads(unsigned int threads)
+{
+    thread_count.store(threads, std::memory_order_relaxed);
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> inverse(const BasicNormalRandomVariableArray<T>& rv)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::inverse(rv, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> rectify(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, typename BasicNormalRandomVariableArray<T>::value_type upper)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::rectify(rv, lower, upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> rectifyLower(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::rectifyLower(rv, lower, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> rectifyUpper(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type upper)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::rectifyUpper(rv, upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncate(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, typename BasicNormalRandomVariableArray<T>::value_type upper)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::truncate(rv, lower, upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncateLower(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::truncateLower(rv, lower, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncateUpper(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type upper)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::truncateUpper(rv, upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncate(const BasicNormalRandomVariableArray<T>& rv,
+        const BasicNormalRandomVariableArray<T>& lower, const BasicNormalRandomVariableArray<T>& upper)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::truncate(rv, lower, upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncateLower(const BasicNormalRandomVariableArray<T>& rv,
+        const BasicNormalRandomVariableArray<T>& lower)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::truncateLower(rv, lower, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> truncateUpper(const BasicNormalRandomVariableArray<T>& rv,
+        const BasicNormalRandomVariableArray<T>& upper)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::truncateUpper(rv, upper, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> max(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::max(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> min(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::min(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> add(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::add(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> subtract(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::subtract(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> multiply(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::multiply(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> divide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2)
+{
+    BasicNormalRandomVariableArray<T> result;
+    parallel::divide(rv1, rv2, result);
+    return result;
+}
+
+template<class T>
+void inverse(const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv, [](T mean, T variance) {
+        return detail::inverse(mean, variance);
+    }, result);
+}
+
+template<class T>
+void rectify(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, typename BasicNormalRandomVariableArray<T>::value_type upper,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    if(upper <= lower)
+    {
+        throw std::range_error("NormalRandomVariableArray: Rectification lower bound must be less than upper bound");
+    }
+
+    applyBounds(rv, detail::arrayKernels<T>().rectify, lower, upper, result);
+}
+
+template<class T>
+void rectifyLower(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, BasicNormalRandomVariableArray<T>& result)
+{
+    applyBound(rv, detail::arrayKernels<T>().rectifyLower, lower, T(1), result);
+}
+
+template<class T>
+void rectifyUpper(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type upper, BasicNormalRandomVariableArray<T>& result)
+{
+    applyBound(rv, detail::arrayKernels<T>().rectifyLower, upper, T(-1), result);
+}
+
+template<class T>
+void truncate(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, typename BasicNormalRandomVariableArray<T>::value_type upper,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    if(upper <= lower)
+    {
+        throw std::range_error("NormalRandomVariableArray: Truncation lower bound must be less than upper bound");
+    }
+
+    applyBounds(rv, detail::arrayKernels<T>().truncate, lower, upper, result);
+}
+
+template<class T>
+void truncateLower(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type lower, BasicNormalRandomVariableArray<T>& result)
+{
+    applyBound(rv, detail::arrayKernels<T>().truncateLower, lower, T(1), result);
+}
+
+template<class T>
+void truncateUpper(const BasicNormalRandomVariableArray<T>& rv,
+        typename BasicNormalRandomVariableArray<T>::value_type upper, BasicNormalRandomVariableArray<T>& result)
+{
+    applyBound(rv, detail::arrayKernels<T>().truncateLower, upper, T(-1), result);
+}
+
+template<class T>
+void truncate(const BasicNormalRandomVariableArray<T>& rv,
+        const BasicNormalRandomVariableArray<T>& lower, const BasicNormalRandomVariableArray<T>& upper,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    checkSizes(rv, lower);
+    checkSizes(rv, upper);
+
+    result.resize(rv.size());
+    forEachChunk(rv.size(), [&](std::size_t first, std::size_t size) {
+        for(std::size_t i = first; i < first + size; ++i)
+        {
+            detail::Moments<T> moments = detail::truncate(rv.means()[i], rv.variances()[i], lower.means()[i],
+                    lower.variances()[i], upper.means()[i], upper.variances()[i]);
+            result.means()[i] = moments.mean;
+            result.variances()[i] = moments.variance;
+        }
+    });
+}
+
+template<class T>
+void truncateLower(const BasicNormalRandomVariableArray<T>& rv,
+        const BasicNormalRandomVariableArray<T>& lower, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv, lower, [](T mean, T variance, T lower_mean, T lower_variance) {
+        return detail::truncateLower(mean, variance, lower_mean, lower_variance);
+    }, result);
+}
+
+template<class T>
+void truncateUpper(const BasicNormalRandomVariableArray<T>& rv,
+        const BasicNormalRandomVariableArray<T>& upper, BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv, upper, [](T mean, T variance, T upper_mean, T upper_variance) {
+        return detail::truncateUpper(mean, variance, upper_mean, upper_variance);
+    }, result);
+}
+
+template<class T>
+void max(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    applyPair(rv1, rv2, detail::arrayKernels<T>().max, T(1), result);
+}
+
+template<class T>
+void min(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    applyPair(rv1, rv2, detail::arrayKernels<T>().max, T(-1), result);
+}
+
+template<class T>
+void add(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv1, rv2, [](T mean1, T variance1, T mean2, T variance2) {
+        return detail::Moments<T>{mean1 + mean2, variance1 + variance2};
+    }, result);
+}
+
+template<class T>
+void subtract(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv1, rv2, [](T mean1, T variance1, T mean2, T variance2) {
+        return detail::Moments<T>{mean1 - mean2, variance1 + variance2};
+    }, result);
+}
+
+template<class T>
+void multiply(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv1, rv2, [](T mean1, T variance1, T mean2, T variance2) {
+        return detail::multiply(mean1, variance1, mean2, variance2);
+    }, result);
+}
+
+template<class T>
+void divide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        BasicNormalRandomVariableArray<T>& result)
+{
+    applyElementWise(rv1, rv2, [](T mean1, T variance1, T mean2, T variance2) {
+        return detail::divide(mean1, variance1, mean2, variance2);
+    }, result);
+}
+
+template<class T>
+void pairwiseProbabilityLessThan(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2,
+        T* result)
+{
+    std::size_t columns = rv2.size();
+    detail::PairwiseLessThanKernel<T> kernel = detail::arrayKernels<T>().pairwiseLessThan;
+
+    // Each chunk is a range of consecutive results, which is calculated as the parts of the rows that it covers
+    forEachChunk(rv1.size() * columns, [&](std::size_t first, std::size_t size) {
+        while(size > 0)
+        {
+            std::size_t row = first / columns;
+            std::size_t column = first % columns;
+            std::size_t count = std::min(size, columns - column);
+            kernel(rv1.means() + row, rv1.variances() + row, 1, rv2.means() + column, rv2.variances() + column,
+                    count, result + first, columns);
+            first += count;
+            size -= count;
+        }
+    });
+}
+
+#define NRV_INSTANTIATE_PARALLEL_OPERATIONS(T) \
+    template BasicNormalRandomVariableArray<T> inverse(const BasicNormalRandomVariableArray<T>& rv); \
+    template BasicNormalRandomVariableArray<T> rectify(const BasicNormalRandomVariableArray<T>& rv, T lower, T upper); \
+    template BasicNormalRandomVariableArray<T> rectifyLower(const BasicNormalRandomVariableArray<T>& rv, T lower); \
+    template BasicNormalRandomVariableArray<T> rectifyUpper(const BasicNormalRandomVariableArray<T>& rv, T upper); \
+    template BasicNormalRandomVariableArray<T> truncate(const BasicNormalRandomVariableArray<T>& rv, T lower, T upper); \
+    template BasicNormalRandomVariableArray<T> truncateLower(const BasicNormalRandomVariableArray<T>& rv, T lower); \
+    template BasicNormalRandomVariableArray<T> truncateUpper(const BasicNormalRandomVariableArray<T>& rv, T upper); \
+    template BasicNormalRandomVariableArray<T> truncate(const BasicNormalRandomVariableArray<T>& rv, const BasicNormalRandomVariableArray<T>& lower, const BasicNormalRandomVariableArray<T>& upper); \
+    template BasicNormalRandomVariableArray<T> truncateLower(const BasicNormalRandomVariableArray<T>& rv, const BasicNormalRandomVariableArray<T>& lower); \
+    template BasicNormalRandomVariableArray<T> truncateUpper(const BasicNormalRandomVariableArray<T>& rv, const BasicNormalRandomVariableArray<T>& upper); \
+    template BasicNormalRandomVariableArray<T> max(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template BasicNormalRandomVariableArray<T> min(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template BasicNormalRandomVariableArray<T> add(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template BasicNormalRandomVariableArray<T> subtract(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template BasicNormalRandomVariableArray<T> multiply(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template BasicNormalRandomVariableArray<T> divide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2); \
+    template void inverse(const BasicNormalRandomVariableArray<T>& rv, BasicNormalRandomVariableArray<T>& result); \
+    template void rectify(const BasicNormalRandomVariableArray<T>& rv, T lower, T upper, BasicNormalRandomVariableArray<T>& result); \
+    template void rectifyLower(const BasicNormalRandomVariableArray<T>& rv, T lower, BasicNormalRandomVariableArray<T>& result); \
+    template void rectifyUpper(const BasicNormalRandomVariableArray<T>& rv, T upper, BasicNormalRandomVariableArray<T>& result); \
+    template void truncate(const BasicNormalRandomVariableArray<T>& rv, T lower, T upper, BasicNormalRandomVariableArray<T>& result); \
+    template void truncateLower(const BasicNormalRandomVariableArray<T>& rv, T lower, BasicNormalRandomVariableArray<T>& result); \
+    template void truncateUpper(const BasicNormalRandomVariableArray<T>& rv, T upper, BasicNormalRandomVariableArray<T>& result); \
+    template void truncate(const BasicNormalRandomVariableArray<T>& rv, const BasicNormalRandomVariableArray<T>& lower, const BasicNormalRandomVariableArray<T>& upper, BasicNormalRandomVariableArray<T>& result); \
+    template void truncateLower(const BasicNormalRandomVariableArray<T>& rv, const BasicNormalRandomVariableArray<T>& lower, BasicNormalRandomVariableArray<T>& result); \
+    template void truncateUpper(const BasicNormalRandomVariableArray<T>& rv, const BasicNormalRandomVariableArray<T>& upper, BasicNormalRandomVariableArray<T>& result); \
+    template void max(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void min(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void add(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void subtract(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void multiply(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void divide(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, BasicNormalRandomVariableArray<T>& result); \
+    template void pairwiseProbabilityLessThan(const BasicNormalRandomVariableArray<T>& rv1, const BasicNormalRandomVariableArray<T>& rv2, \
+            T* result);
+
+NRV_INSTANTIATE_PARALLEL_OPERATIONS(float)
+NRV_INSTANTIATE_PARALLEL_OPERATIONS(double)
+NRV_INSTANTIATE_PARALLEL_OPERATIONS(long double)
+
+} // namespace parallel
+} // namespace NRV
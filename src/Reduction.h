@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "Kernels.h"
+
+namespace NRV {
+namespace detail {
+
+/**
+ * Inputs are reduced in chunks of this size, and the chunks are reduced in parallel if there is more than one.
+ * The chunks only depend on the number of inputs, so the result does not depend on the number of threads
+ */
+constexpr std::size_t reduction_chunk_size = 4096;
+
+/**
+ * Sorts the random variables by variance and reduces them with max, in the order of increasing variance. Each step
+ * approximates the maximum as normally distributed, and comparisons against Monte Carlo sampling show that this
+ * order gives smaller errors than the order of increasing or decreasing mean, or a pairwise tree
+ */
+template<class T>
+Moments<T> sortedMax(Moments<T>* first, Moments<T>* last)
+{
+    std::sort(first, last, [](const Moments<T>& a, const Moments<T>& b) {
+        return a.variance < b.variance || (a.variance == b.variance && a.mean < b.mean);
+    });
+
+    Moments<T> result = *first;
+    for(Moments<T>* moments = first + 1; moments != last; ++moments)
+    {
+        result = max(result.mean, result.variance, moments->mean, moments->variance);
+    }
+
+    return result;
+}
+
+/**
+ * Calculates the maximum of the random variables. For large inputs, each chunk is reduced on its own thread and
+ * the results of the chunks are then reduced in turn. The result of each chunk is stored in its first element, so
+ * the reduction only uses the storage of moments (apart from the state of the threads)
+ * Note: moments is reordered and overwritten, and will throw an exception if it is empty
+ */
+template<class T, class Allocator>
+Moments<T> maxOf(std::vector<Moments<T>, Allocator>& moments)
+{
+    if(moments.empty())
+    {
+        throw std::length_error("NormalRandomVariable: Can not calculate the maximum of no random variables");
+    }
+
+    std::size_t chunks = (moments.size() + reduction_chunk_size - 1) / reduction_chunk_size;
+    if(chunks == 1)
+    {
+        return sortedMax(moments.data(), moments.data() + moments.size());
+    }
+
+    auto reduceChunks = [&](std::size_t first_chunk, std::size_t step) {
+        for(std::size_t chunk = first_chunk; chunk < chunks; chunk += step)
+        {
+            Moments<T>* first = moments.data() + chunk * reduction_chunk_size;
+            Moments<T>* last = moments.data() + std::min(moments.size(), (chunk + 1) * reduction_chunk_size);
+            *first = sortedMax(first, last);
+        }
+    };
+
+    std::size_t threads = std::min<std::size_t>(chunks, std::max(1u, std::thread::hardware_concurrency()));
+    // If a thread can not be started, the calling thread reduces its chunks and those of the later threads. The
+    // threads are stored with the allocator of moments
+    std::vector<std::thread, typename std::allocator_traits<Allocator>::template rebind_alloc<std::thread>> workers(
+            moments.get_allocator());
+    std::size_t started = 1;
+    for(; started < threads; ++started)
+    {
+        try
+        {
+            workers.emplace_back(reduceChunks, started, threads);
+        }
+        catch(const std::system_error&)
+        {
+            break;
+        }
+    }
+    reduceChunks(0, threads);
+    for(std::size_t thread = started; thread < threads; ++thread)
+    {
+        reduceChunks(thread, threads);
+    }
+    for(auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    // Chunk i is moved to element i, which is before the first element of every later chunk
+    for(std::size_t chunk = 1; chunk < chunks; ++chunk)
+    {
+        moments[chunk] = moments[chunk * reduction_chunk_size];
+    }
+
+    return sortedMax(moments.data(), moments.data() + chunks);
+}
+
+/**
+ * Calculates the minimum of the random variables by reflecting them
+ * Note: moments is reordered and reflected, and will throw an exception if it is empty
+ */
+template<class T, class Allocator>
+Moments<T> minOf(std::vector<Moments<T>, Allocator>& moments)
+{
+    for(auto& m : moments)
+    {
+        m.mean = -m.mean;
+    }
+
+    Moments<T> reflected = maxOf(moments);
+    return {-reflected.mean, reflected.variance};
+}
+
+} // namespace detail
+} // namespace NRV
@@ -0,0 +1,384 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "NormalRandomVariable/Serialization.h"
+#include "BatchKernels.h"
+
+
+namespace NRV {
+
+namespace {
+
+constexpr std::size_t header_size = 64;
+constexpr unsigned char magic[4] = {'N', 'R', 'V', 'A'};
+
+bool littleEndian()
+{
+    std::uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+/**
+ * Little-endian stores and loads of integers of size bytes, which use memcpy on little-endian platforms
+ */
+template<class Integer>
+void store(unsigned char* data, Integer value)
+{
+    if(littleEndian())
+    {
+        std::memcpy(data, &value, sizeof(value));
+        return;
+    }
+
+    for(std::size_t i = 0; i < sizeof(value); ++i)
+    {
+        data[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+template<class Integer>
+Integer load(const unsigned char* data)
+{
+    Integer value = 0;
+    if(littleEndian())
+    {
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    for(std::size_t i = 0; i < sizeof(value); ++i)
+    {
+        value |= static_cast<Integer>(static_cast<Integer>(data[i]) << (8 * i));
+    }
+    return value;
+}
+
+/**
+ * Stores and loads IEEE 754 values through the integer with the same bits
+ */
+template<class Float, class Integer>
+void storeFloat(unsigned char* data, Float value)
+{
+    Integer bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    store(data, bits);
+}
+
+template<class Float, class Integer>
+Float loadFloat(const unsigned char* data)
+{
+    Integer bits = load<Integer>(data);
+    Float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::size_t elementSize(Encoding encoding)
+{
+    return encoding == Encoding::Float32 ? sizeof(float) : sizeof(double);
+}
+
+std::size_t alignedSize(std::size_t size)
+{
+    return (size + serialization_alignment - 1) / serialization_alignment * serialization_alignment;
+}
+
+/**
+ * Writes size values converted to the encoding
+ */
+template<class T>
+void storeArray(unsigned char* data, const T* values, std::size_t size, Encoding encoding)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        if(encoding == Encoding::Float32)
+        {
+            storeFloat<float, std::uint32_t>(data + i * sizeof(float), static_cast<float>(values[i]));
+        }
+        else
+        {
+            storeFloat<double, std::uint64_t>(data + i * sizeof(double), static_cast<double>(values[i]));
+        }
+    }
+}
+
+template<class T>
+void loadArray(const unsigned char* data, T* values, std::size_t size, Encoding encoding)
+{
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        if(encoding == Encoding::Float32)
+        {
+            values[i] = static_cast<T>(loadFloat<float, std::uint32_t>(data + i * sizeof(float)));
+        }
+        else
+        {
+            values[i] = static_cast<T>(loadFloat<double, std::uint64_t>(data + i * sizeof(double)));
+        }
+    }
+}
+
+} // namespace
+
+template<class T>
+void serialize(const BasicNormalRandomVariable<T>& random_variable, void* buffer)
+{
+    unsigned char* data = static_cast<unsigned char*>(buffer);
+    storeFloat<double, std::uint64_t>(data, static_cast<double>(random_variable.mean()));
+    storeFloat<double, std::uint64_t>(data + sizeof(double), static_cast<double>(random_variable.variance()));
+}
+
+template<class T>
+BasicNormalRandomVariable<T> deserializeRandomVariable(const void* data)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    return BasicNormalRandomVariable<T>(static_cast<T>(loadFloat<double, std::uint64_t>(bytes)),
+            static_cast<T>(loadFloat<double, std::uint64_t>(bytes + sizeof(double))));
+}
+
+std::size_t serializedSize(std::size_t size, Encoding encoding)
+{
+    return header_size + 2 * alignedSize(size * elementSize(encoding));
+}
+
+template<class T>
+std::size_t serialize(const BasicNormalRandomVariableArray<T>& random_variables, void* buffer, std::size_t buffer_size,
+        Encoding encoding)
+{
+    std::size_t size = serializedSize(random_variables.size(), encoding);
+    if(buffer_size < size)
+    {
+        throw std::length_error("SerializedArray: Buffer is too small");
+    }
+
+    std::size_t means_offset = header_size;
+    std::size_t variances_offset = means_offset + alignedSize(random_variables.size() * elementSize(encoding));
+
+    // The padding is zeroed so that the output only depends on the random variables
+    unsigned char* data = static_cast<unsigned char*>(buffer);
+    std::memset(data, 0, size);
+    std::memcpy(data, magic, sizeof(magic));
+    store<std::uint16_t>(data + 4, serialization_version);
+    data[6] = static_cast<unsigned char>(encoding);
+    store<std::uint64_t>(data + 8, random_variables.size());
+    store<std::uint64_t>(data + 16, means_offset);
+    store<std::uint64_t>(data + 24, variances_offset);
+
+    storeArray(data + means_offset, random_variables.means(), random_variables.size(), encoding);
+    storeArray(data + variances_offset, random_variables.variances(), random_variables.size(), encoding);
+    return size;
+}
+
+template<class T>
+std::vector<unsigned char> serialize(const BasicNormalRandomVariableArray<T>& random_variables, Encoding encoding)
+{
+    std::vector<unsigned char> buffer(serializedSize(random_variables.size(), encoding));
+    serialize(random_variables, buffer.data(), buffer.size(), encoding);
+    return buffer;
+}
+
+SerializedArrayView::SerializedArrayView(const void* data, std::size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    if(size < header_size || std::memcmp(bytes, magic, sizeof(magic)) != 0)
+    {
+        throw std::invalid_argument("SerializedArray: Data is not a serialized array");
+    }
+
+    std::uint16_t version = load<std::uint16_t>(bytes + 4);
+    if(version == 0 || version > serialization_version)
+    {
+        throw std::invalid_argument("SerializedArray: Version is not supported");
+    }
+
+    if(bytes[6] != static_cast<unsigned char>(Encoding::Float64) && bytes[6] != static_cast<unsigned char>(Encoding::Float32))
+    {
+        throw std::invalid_argument("SerializedArray: Encoding is not supported");
+    }
+    encoding_ = static_cast<Encoding>(bytes[6]);
+
+    // Check the offsets without overflowing
+    std::uint64_t count = load<std::uint64_t>(bytes + 8);
+    std::uint64_t means_offset = load<std::uint64_t>(bytes + 16);
+    std::uint64_t variances_offset = load<std::uint64_t>(bytes + 24);
+    std::uint64_t element_size = elementSize(encoding_);
+    if(count > size / element_size || means_offset < header_size || variances_offset < means_offset
+            || variances_offset - means_offset < count * element_size || variances_offset > size
+            || size - variances_offset < count * element_size || means_offset % element_size != 0
+            || variances_offset % element_size != 0)
+    {
+        throw std::invalid_argument("SerializedArray: Data is truncated or the offsets are not valid");
+    }
+
+    size_ = static_cast<std::size_t>(count);
+    means_ = bytes + means_offset;
+    variances_ = bytes + variances_offset;
+    zero_copy_ = encoding_ == Encoding::Float64 && littleEndian()
+            && reinterpret_cast<std::uintptr_t>(means_) % alignof(double) == 0
+            && reinterpret_cast<std::uintptr_t>(variances_) % alignof(double) == 0;
+}
+
+std::size_t SerializedArrayView::size() const
+{
+    return size_;
+}
+
+Encoding SerializedArrayView::encoding() const
+{
+    return encoding_;
+}
+
+bool SerializedArrayView::zeroCopy() const
+{
+    return zero_copy_;
+}
+
+const double* SerializedArrayView::means() const
+{
+    if(!zero_copy_)
+    {
+        throw std::logic_error("SerializedArray: Data must be decoded");
+    }
+
+    return reinterpret_cast<const double*>(means_);
+}
+
+const double* SerializedArrayView::variances() const
+{
+    if(!zero_copy_)
+    {
+        throw std::logic_error("SerializedArray: Data must be decoded");
+    }
+
+    return reinterpret_cast<const double*>(variances_);
+}
+
+BasicNormalRandomVariable<double> SerializedArrayView::operator[](std::size_t index) const
+{
+    double mean, variance;
+    loadArray(means_ + index * elementSize(encoding_), &mean, 1, encoding_);
+    loadArray(variances_ + index * elementSize(encoding_), &variance, 1, encoding_);
+    return BasicNormalRandomVariable<double>(mean, variance);
+}
+
+template<class T>
+BasicNormalRandomVariableArray<T> SerializedArrayView::toArray() const
+{
+    BasicNormalRandomVariableArray<T> result(size_);
+    loadArray(means_, result.means(), size_, encoding_);
+    loadArray(variances_, result.variances(), size_, encoding_);
+    return result;
+}
+
+NormalRandomVariableArray SerializedArrayView::rectify(double lower, double upper) const
+{
+    if(!zero_copy_ || upper <= lower)
+    {
+        return toArray<double>().rectify(lower, upper);
+    }
+
+    NormalRandomVariableArray result(size_);
+    detail::arrayKernels<double>().rectify(means(), variances(), lower, upper, result.means(), result.variances(), size_);
+    return result;
+}
+
+NormalRandomVariableArray SerializedArrayView::rectifyLower(double lower) const
+{
+    if(!zero_copy_)
+    {
+        return toArray<double>().rectifyLower(lower);
+    }
+
+    NormalRandomVariableArray result(size_);
+    detail::arrayKernels<double>().rectifyLower(means(), variances(), lower, 1, result.means(), result.variances(), size_);
+    return result;
+}
+
+NormalRandomVariableArray SerializedArrayView::rectifyUpper(double upper) const
+{
+    if(!zero_copy_)
+    {
+        return toArray<double>().rectifyUpper(upper);
+    }
+
+    NormalRandomVariableArray result(size_);
+    detail::arrayKernels<double>().rectifyLower(means(), variances(), upper, -1, result.means(), result.variances(), size_);
+    return result;
+}
+
+NormalRandomVariableArray SerializedArrayView::truncate(double lower, double upper) const
+{
+    if(!zero_copy_ || upper <= lower)
+    {
+        return toArray<double>().truncate(lower, upper);
+    }
+
+    NormalRandomVariableArray result(size_);
+    detail::arrayKernels<double>().truncate(means(), variances(), lower, upper, result.means(), result.variances(), size_);
+    return result;
+}
+
+NormalRandomVariableArray SerializedArrayView::truncateLower(double lower) const
+{
+    if(!zero_copy_)
+    {
+        return toArray<double>().truncateLower(lower);
+    }
+
+    NormalRandomVariableArray result(size_);
+    detail::arrayKernels<double>().truncateLower(means(), variances(), lower, 1, result.means(), result.variances(), size_);
+    return result;
+}
+
+NormalRandomVariableArray SerializedArrayView::truncateUpper(double upper) const
+{
+    if(!zero_copy_)
+    {
+        return toArray<double>().truncateUpper(upper);
+    }
+
+    NormalRandomVariableArray result(size_);
+    detail::arrayKernels<double>().truncateLower(means(), variances(), upper, -1, result.means(), result.variances(), size_);
+    return result;
+}
+
+NormalRandomVariableArray SerializedArrayView::max(const SerializedArrayView& random_variables) const
+{
+    if(!zero_copy_ || !random_variables.zero_copy_ || size_ != random_variables.size_)
+    {
+        return toArray<double>().max(random_variables.toArray<double>());
+    }
+
+    NormalRandomVariableArray result(size_);
+    detail::arrayKernels<double>().max(means(), variances(), random_variables.means(), random_variables.variances(), 1,
+            result.means(), result.variances(), size_);
+    return result;
+}
+
+NormalRandomVariableArray SerializedArrayView::min(const SerializedArrayView& random_variables) const
+{
+    if(!zero_copy_ || !random_variables.zero_copy_ || size_ != random_variables.size_)
+    {
+        return toArray<double>().min(random_variables.toArray<double>());
+    }
+
+    NormalRandomVariableArray result(size_);
+    detail::arrayKernels<double>().max(means(), variances(), random_variables.means(), random_variables.variances(), -1,
+            result.means(), result.variances(), size_);
+    return result;
+}
+
+#define NRV_INSTANTIATE_SERIALIZATION(T) \
+    template void serialize(const BasicNormalRandomVariable<T>& random_variable, void* buffer); \
+    template BasicNormalRandomVariable<T> deserializeRandomVariable(const void* data); \
+    template std::size_t serialize(const BasicNormalRandomVariableArray<T>& random_variables, void* buffer, std::size_t buffer_size, Encoding encoding); \
+    template std::vector<unsigned char> serialize(const BasicNormalRandomVariableArray<T>& random_variables, Encoding encoding); \
+    template BasicNormalRandomVariableArray<T> SerializedArrayView::toArray() const;
+
+NRV_INSTANTIATE_SERIALIZATION(float)
+NRV_INSTANTIATE_SERIALIZATION(double)
+NRV_INSTANTIATE_SERIALIZATION(long double)
+
+} // namespace NRV
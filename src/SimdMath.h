@@ -0,0 +1,514 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * Vectorised implementations of truncation, rectification, maximum and the normal CDF, written once against a small
+ * vector abstraction V and instantiated for each instruction set in its own translation unit.
+ *
+ * V must provide:
+ *     typedef ... Vec, Mask;  static const std::size_t width;
+ *     set1, load, store, add, sub, mul, div, fmadd (a * b + c), sqrt, max, min,
+ *     lessEqual, greaterEqual (returning Mask), select (mask ? a : b),
+ *     pow2 (2^n given n + 0x1.8p52, see exp below)
+ *
+ * Note: This header must only contain templates that are instantiated with a V that is local to the
+ * including translation unit, so that code compiled for one instruction set is never shared with another.
+ */
+
+namespace NRV {
+namespace detail {
+namespace simd {
+
+const double one_on_sqrt_two = 0.70710678118654752440;
+const double one_on_sqrt_two_pi = 0.39894228040143267794;
+const double sqrt_2_on_sqrt_pi = 0.79788456080286535588;
+
+/**
+ * Polynomial coefficients (lowest order first) of h(t) = erfc(z) * exp(z^2) / t on t in [0, 1], where
+ * t = 2 / (2 + z). Converted from a degree 23 Chebyshev interpolant computed in long double precision from erfcl
+ */
+const std::size_t erfc_coefficient_count = 24;
+const double erfc_coefficients[erfc_coefficient_count] = {
+    2.82094791773878195e-01,
+    2.82094791773849773e-01,
+    2.46832942806759326e-01,
+    1.76309244616494221e-01,
+    8.37468946498273886e-02,
+    -4.40760067319855443e-03,
+    -5.67562119419880648e-02,
+    -5.32995370818449901e-02,
+    -5.73227684319979613e-03,
+    6.79336274609058655e-02,
+    -7.23986786989502668e-02,
+    6.53350050979335961e-01,
+    -2.75422140898354906e+00,
+    8.32831712223988596e+00,
+    -2.05062635199496235e+01,
+    3.92060705991571012e+01,
+    -5.64620396131655653e+01,
+    6.09503470017698419e+01,
+    -4.92366179935537147e+01,
+    2.94613778880642094e+01,
+    -1.27225734984191750e+01,
+    3.76127891708165407e+00,
+    -6.83003544807434082e-01,
+    5.75600117444992065e-02,
+};
+
+/**
+ * exp(x) for x in [-708, 709]. Smaller values return 0.
+ * Uses x = n * ln(2) + r with |r| <= ln(2) / 2 and a degree 13 Taylor polynomial for exp(r), which has a
+ * truncation error below 1e-17, so the result is within a few ulp of std::exp
+ */
+template<class V>
+typename V::Vec exp(typename V::Vec x)
+{
+    typedef typename V::Vec Vec;
+
+    const double log2e = 1.44269504088896340736;
+    const double ln2_hi = 6.93147180369123816490e-01;
+    const double ln2_lo = 1.90821492927058770002e-10;
+    const double round_magic = 6755399441055744.0; // 0x1.8p52
+
+    Vec clamped = V::min(V::max(x, V::set1(-708)), V::set1(709));
+
+    // Round x / ln(2) to the nearest integer n, which is stored in the low bits of t
+    Vec t = V::fmadd(clamped, V::set1(log2e), V::set1(round_magic));
+    Vec n = V::sub(t, V::set1(round_magic));
+    Vec r = V::fmadd(n, V::set1(-ln2_hi), clamped);
+    r = V::fmadd(n, V::set1(-ln2_lo), r);
+
+    Vec p = V::set1(1.0 / 6227020800.0);
+    p = V::fmadd(p, r, V::set1(1.0 / 479001600.0));
+    p = V::fmadd(p, r, V::set1(1.0 / 39916800.0));
+    p = V::fmadd(p, r, V::set1(1.0 / 3628800.0));
+    p = V::fmadd(p, r, V::set1(1.0 / 362880.0));
+    p = V::fmadd(p, r, V::set1(1.0 / 40320.0));
+    p = V::fmadd(p, r, V::set1(1.0 / 5040.0));
+    p = V::fmadd(p, r, V::set1(1.0 / 720.0));
+    p = V::fmadd(p, r, V::set1(1.0 / 120.0));
+    p = V::fmadd(p, r, V::set1(1.0 / 24.0));
+    p = V::fmadd(p, r, V::set1(1.0 / 6.0));
+    p = V::fmadd(p, r, V::set1(0.5));
+    p = V::fmadd(p, r, V::set1(1));
+    p = V::fmadd(p, r, V::set1(1));
+
+    Vec result = V::mul(p, V::pow2(t));
+    return V::select(V::lessEqual(x, V::set1(-708)), V::set1(0), result);
+}
+
+/**
+ * Calculates erfc(x) and erfc(-x), given g = exp(-x^2) (which the callers also need for the normal density).
+ * erfc(|x|) = t * g * h(t) is evaluated with the polynomial above; the other value is 2 - erfc(|x|).
+ * The relative error of both values is below 1e-14 for |x| < 6 and below 1e-13 for |x| < 26 (beyond which
+ * erfc(|x|) underflows), so tail probabilities keep their relative accuracy instead of being computed as 1 - erf
+ */
+template<class V>
+void erfc(typename V::Vec x, typename V::Vec g, typename V::Vec& erfc_x, typename V::Vec& erfc_neg_x)
+{
+    typedef typename V::Vec Vec;
+
+    Vec z = V::max(x, V::sub(V::set1(0), x));
+    Vec t = V::div(V::set1(2), V::add(V::set1(2), z));
+
+    Vec h = V::set1(erfc_coefficients[erfc_coefficient_count - 1]);
+    for(std::size_t j = erfc_coefficient_count - 1; j >= 1; --j)
+    {
+        h = V::fmadd(h, t, V::set1(erfc_coefficients[j - 1]));
+    }
+
+    Vec tail = V::mul(V::mul(t, g), h);
+    Vec body = V::sub(V::set1(2), tail);
+
+    auto positive = V::greaterEqual(x, V::set1(0));
+    erfc_x = V::select(positive, tail, body);
+    erfc_neg_x = V::select(positive, body, tail);
+}
+
+/**
+ * Calculates erf(d) - erf(c) for c < d without cancellation when both are in the same tail
+ */
+template<class V>
+typename V::Vec erfDifference(typename V::Vec d, typename V::Vec erfc_c, typename V::Vec erfc_neg_c,
+        typename V::Vec erfc_d, typename V::Vec erfc_neg_d)
+{
+    return V::select(V::lessEqual(d, V::set1(0)), V::sub(erfc_neg_d, erfc_neg_c), V::sub(erfc_c, erfc_d));
+}
+
+/**
+ * The kernels below mirror those in Kernels.h, operating on V::width random variables at a time.
+ * sign is 1, or -1 to reflect the inputs and output (e.g., to calculate truncateUpper from truncateLower)
+ */
+template<class V>
+void truncateLowerBlock(const double* mean, const double* variance, double lower, double sign, double* result_mean, double* result_variance)
+{
+    typedef typename V::Vec Vec;
+
+    Vec m_in = V::mul(V::load(mean), V::set1(sign));
+    Vec v_in = V::load(variance);
+    Vec sqrt_variance = V::sqrt(v_in);
+
+    Vec c = V::div(V::sub(V::set1(sign * lower), m_in), sqrt_variance);
+    Vec g_c = exp<V>(V::mul(V::mul(c, c), V::set1(-0.5)));
+    Vec erfc_c, erfc_neg_c;
+    erfc<V>(V::mul(c, V::set1(one_on_sqrt_two)), g_c, erfc_c, erfc_neg_c);
+
+    Vec m = V::div(V::mul(V::set1(sqrt_2_on_sqrt_pi), g_c), erfc_c);
+    Vec v = V::fmadd(m, V::sub(c, m), V::set1(1));
+
+    V::store(result_mean, V::mul(V::fmadd(m, sqrt_variance, m_in), V::set1(sign)));
+    V::store(result_variance, V::mul(v, v_in));
+}
+
+template<class V>
+void truncateBlock(const double* mean, const double* variance, double lower, double upper, double* result_mean, double* result_variance)
+{
+    typedef typename V::Vec Vec;
+
+    Vec m_in = V::load(mean);
+    Vec v_in = V::load(variance);
+    Vec sqrt_variance = V::sqrt(v_in);
+
+    Vec c = V::div(V::sub(V::set1(lower), m_in), sqrt_variance);
+    Vec d = V::div(V::sub(V::set1(upper), m_in), sqrt_variance);
+    Vec g_c = exp<V>(V::mul(V::mul(c, c), V::set1(-0.5)));
+    Vec g_d = exp<V>(V::mul(V::mul(d, d), V::set1(-0.5)));
+    Vec erfc_c, erfc_neg_c, erfc_d, erfc_neg_d;
+    erfc<V>(V::mul(c, V::set1(one_on_sqrt_two)), g_c, erfc_c, erfc_neg_c);
+    erfc<V>(V::mul(d, V::set1(one_on_sqrt_two)), g_d, erfc_d, erfc_neg_d);
+
+    Vec alpha = V::div(V::set1(sqrt_2_on_sqrt_pi), erfDifference<V>(d, erfc_c, erfc_neg_c, erfc_d, erfc_neg_d));
+    Vec m = V::mul(alpha, V::sub(g_c, g_d));
+    Vec v = V::sub(V::fmadd(alpha, V::sub(V::mul(g_c, c), V::mul(g_d, d)), V::set1(1)), V::mul(m, m));
+
+    V::store(result_mean, V::fmadd(m, sqrt_variance, m_in));
+    V::store(result_variance, V::mul(v, v_in));
+}
+
+template<class V>
+void rectifyLowerBlock(const double* mean, const double* variance, double lower, double sign, double* result_mean, double* result_variance)
+{
+    typedef typename V::Vec Vec;
+
+    Vec m_in = V::mul(V::load(mean), V::set1(sign));
+    Vec v_in = V::load(variance);
+    Vec sqrt_variance = V::sqrt(v_in);
+
+    Vec c = V::div(V::sub(V::set1(sign * lower), m_in), sqrt_variance);
+    Vec g_c = exp<V>(V::mul(V::mul(c, c), V::set1(-0.5)));
+    Vec erfc_c, erfc_neg_c;
+    erfc<V>(V::mul(c, V::set1(one_on_sqrt_two)), g_c, erfc_c, erfc_neg_c);
+
+    Vec half = V::set1(0.5);
+    Vec density_c = V::mul(V::set1(one_on_sqrt_two_pi), g_c);
+    Vec m = V::fmadd(V::mul(c, half), erfc_neg_c, density_c);
+    Vec c_minus_m = V::sub(c, m);
+    Vec v = V::mul(V::mul(V::fmadd(m, m, V::set1(1)), half), erfc_c);
+    v = V::fmadd(density_c, V::sub(c, V::add(m, m)), v);
+    v = V::fmadd(V::mul(V::mul(c_minus_m, c_minus_m), half), erfc_neg_c, v);
+
+    V::store(result_mean, V::mul(V::fmadd(m, sqrt_variance, m_in), V::set1(sign)));
+    V::store(result_variance, V::mul(v, v_in));
+}
+
+template<class V>
+void rectifyBlock(const double* mean, const double* variance, double lower, double upper, double* result_mean, double* result_variance)
+{
+    typedef typename V::Vec Vec;
+
+    Vec m_in = V::load(mean);
+    Vec v_in = V::load(variance);
+    Vec sqrt_variance = V::sqrt(v_in);
+
+    Vec c = V::div(V::sub(V::set1(lower), m_in), sqrt_variance);
+    Vec d = V::div(V::sub(V::set1(upper), m_in), sqrt_variance);
+    Vec g_c = exp<V>(V::mul(V::mul(c, c), V::set1(-0.5)));
+    Vec g_d = exp<V>(V::mul(V::mul(d, d), V::set1(-0.5)));
+    Vec erfc_c, erfc_neg_c, erfc_d, erfc_neg_d;
+    erfc<V>(V::mul(c, V::set1(one_on_sqrt_two)), g_c, erfc_c, erfc_neg_c);
+    erfc<V>(V::mul(d, V::set1(one_on_sqrt_two)), g_d, erfc_d, erfc_neg_d);
+
+    Vec half = V::set1(0.5);
+    Vec density_c = V::mul(V::set1(one_on_sqrt_two_pi), g_c);
+    Vec density_d = V::mul(V::set1(one_on_sqrt_two_pi), g_d);
+    Vec m = V::sub(density_c, density_d);
+    m = V::fmadd(V::mul(c, half), erfc_neg_c, m);
+    m = V::fmadd(V::mul(d, half), erfc_d, m);
+
+    Vec two_m = V::add(m, m);
+    Vec c_minus_m = V::sub(c, m);
+    Vec d_minus_m = V::sub(d, m);
+    Vec v = V::mul(V::mul(V::fmadd(m, m, V::set1(1)), half), erfDifference<V>(d, erfc_c, erfc_neg_c, erfc_d, erfc_neg_d));
+    v = V::sub(v, V::sub(V::mul(density_d, V::sub(d, two_m)), V::mul(density_c, V::sub(c, two_m))));
+    v = V::fmadd(V::mul(V::mul(c_minus_m, c_minus_m), half), erfc_neg_c, v);
+    v = V::fmadd(V::mul(V::mul(d_minus_m, d_minus_m), half), erfc_d, v);
+
+    V::store(result_mean, V::fmadd(m, sqrt_variance, m_in));
+    V::store(result_variance, V::mul(v, v_in));
+}
+
+template<class V>
+void maxBlock(const double* mean1, const double* variance1, const double* mean2, const double* variance2, double sign,
+        double* result_mean, double* result_variance)
+{
+    typedef typename V::Vec Vec;
+
+    Vec m1 = V::mul(V::load(mean1), V::set1(sign));
+    Vec v1 = V::load(variance1);
+    Vec m2 = V::mul(V::load(mean2), V::set1(sign));
+    Vec v2 = V::load(variance2);
+
+    Vec alpha = V::sqrt(V::add(v1, v2));
+    Vec beta = V::div(V::sub(m1, m2), alpha);
+    Vec g = exp<V>(V::mul(V::mul(beta, beta), V::set1(-0.5)));
+    Vec erfc_beta, erfc_neg_beta;
+    erfc<V>(V::mul(beta, V::set1(one_on_sqrt_two)), g, erfc_beta, erfc_neg_beta);
+
+    Vec phi_beta = V::mul(V::set1(0.5), erfc_neg_beta);
+    Vec phi_neg_beta = V::mul(V::set1(0.5), erfc_beta);
+    Vec alpha_phi_beta = V::mul(V::mul(alpha, V::set1(one_on_sqrt_two_pi)), g);
+
+    Vec m = V::fmadd(m1, phi_beta, V::fmadd(m2, phi_neg_beta, alpha_phi_beta));
+    Vec v = V::mul(V::fmadd(m1, m1, v1), phi_beta);
+    v = V::fmadd(V::fmadd(m2, m2, v2), phi_neg_beta, v);
+    v = V::fmadd(V::add(m1, m2), alpha_phi_beta, v);
+    v = V::sub(v, V::mul(m, m));
+
+    V::store(result_mean, V::mul(m, V::set1(sign)));
+    V::store(result_variance, v);
+}
+
+/**
+ * Probability that a normal random variable with the variance is less than the difference (i.e., the CDF of the
+ * standard normal distribution at difference / sqrt(variance)), calculated as erfc so that the lower tail keeps
+ * its relative accuracy
+ */
+template<class V>
+typename V::Vec normalCdf(typename V::Vec difference, typename V::Vec variance)
+{
+    typedef typename V::Vec Vec;
+
+    Vec z = V::div(difference, V::sqrt(variance));
+    Vec g = exp<V>(V::mul(V::mul(z, z), V::set1(-0.5)));
+    Vec erfc_z, erfc_neg_z;
+    erfc<V>(V::mul(z, V::set1(one_on_sqrt_two)), g, erfc_z, erfc_neg_z);
+    return V::mul(V::set1(0.5), erfc_neg_z);
+}
+
+/**
+ * Drivers that apply a block kernel to whole arrays. The remainder that does not fill a whole block is
+ * copied into padded buffers so that every element is calculated with the same approximation
+ */
+template<class V, class Block>
+void applyBlocks(const double* mean, const double* variance, double* result_mean, double* result_variance, std::size_t size, Block block)
+{
+    std::size_t i = 0;
+    for(; i + V::width <= size; i += V::width)
+    {
+        block(mean + i, variance + i, result_mean + i, result_variance + i);
+    }
+
+    if(i < size)
+    {
+        double padded_mean[V::width] = {};
+        double padded_variance[V::width];
+        for(std::size_t j = 0; j < V::width; ++j)
+        {
+            padded_variance[j] = 1;
+        }
+        for(std::size_t j = 0; i + j < size; ++j)
+        {
+            padded_mean[j] = mean[i + j];
+            padded_variance[j] = variance[i + j];
+        }
+
+        block(padded_mean, padded_variance, padded_mean, padded_variance);
+
+        for(std::size_t j = 0; i + j < size; ++j)
+        {
+            result_mean[i + j] = padded_mean[j];
+            result_variance[i + j] = padded_variance[j];
+        }
+    }
+}
+
+template<class V>
+void truncate(const double* mean, const double* variance, double lower, double upper, double* result_mean, double* result_variance, std::size_t size)
+{
+    applyBlocks<V>(mean, variance, result_mean, result_variance, size, [=](const double* m, const double* v, double* rm, double* rv) {
+        truncateBlock<V>(m, v, lower, upper, rm, rv);
+    });
+}
+
+template<class V>
+void truncateLower(const double* mean, const double* variance, double lower, double sign, double* result_mean, double* result_variance, std::size_t size)
+{
+    applyBlocks<V>(mean, variance, result_mean, result_variance, size, [=](const double* m, const double* v, double* rm, double* rv) {
+        truncateLowerBlock<V>(m, v, lower, sign, rm, rv);
+    });
+}
+
+template<class V>
+void rectify(const double* mean, const double* variance, double lower, double upper, double* result_mean, double* result_variance, std::size_t size)
+{
+    applyBlocks<V>(mean, variance, result_mean, result_variance, size, [=](const double* m, const double* v, double* rm, double* rv) {
+        rectifyBlock<V>(m, v, lower, upper, rm, rv);
+    });
+}
+
+template<class V>
+void rectifyLower(const double* mean, const double* variance, double lower, double sign, double* result_mean, double* result_variance, std::size_t size)
+{
+    applyBlocks<V>(mean, variance, result_mean, result_variance, size, [=](const double* m, const double* v, double* rm, double* rv) {
+        rectifyLowerBlock<V>(m, v, lower, sign, rm, rv);
+    });
+}
+
+template<class V>
+void max(const double* mean1, const double* variance1, const double* mean2, const double* variance2, double sign,
+        double* result_mean, double* result_variance, std::size_t size)
+{
+    std::size_t i = 0;
+    for(; i + V::width <= size; i += V::width)
+    {
+        maxBlock<V>(mean1 + i, variance1 + i, mean2 + i, variance2 + i, sign, result_mean + i, result_variance + i);
+    }
+
+    if(i < size)
+    {
+        double padded[4][V::width];
+        for(std::size_t j = 0; j < V::width; ++j)
+        {
+            bool valid = i + j < size;
+            padded[0][j] = valid ? mean1[i + j] : 0;
+            padded[1][j] = valid ? variance1[i + j] : 1;
+            padded[2][j] = valid ? mean2[i + j] : 0;
+            padded[3][j] = valid ? variance2[i + j] : 1;
+        }
+
+        maxBlock<V>(padded[0], padded[1], padded[2], padded[3], sign, padded[0], padded[1]);
+
+        for(std::size_t j = 0; i + j < size; ++j)
+        {
+            result_mean[i + j] = padded[0][j];
+            result_variance[i + j] = padded[1][j];
+        }
+    }
+}
+
+template<class V>
+void cdf(const double* mean, const double* variance, double x, double* result, std::size_t size)
+{
+    std::size_t i = 0;
+    for(; i + V::width <= size; i += V::width)
+    {
+        V::store(result + i, normalCdf<V>(V::sub(V::set1(x), V::load(mean + i)), V::load(variance + i)));
+    }
+
+    if(i < size)
+    {
+        double padded[2][V::width];
+        for(std::size_t j = 0; j < V::width; ++j)
+        {
+            bool valid = i + j < size;
+            padded[0][j] = valid ? mean[i + j] : 0;
+            padded[1][j] = valid ? variance[i + j] : 1;
+        }
+
+        V::store(padded[0], normalCdf<V>(V::sub(V::set1(x), V::load(padded[0])), V::load(padded[1])));
+
+        for(std::size_t j = 0; i + j < size; ++j)
+        {
+            result[i + j] = padded[0][j];
+        }
+    }
+}
+
+template<class V>
+void lessThan(const double* mean1, const double* variance1, const double* mean2, const double* variance2,
+        double* result, std::size_t size)
+{
+    std::size_t i = 0;
+    for(; i + V::width <= size; i += V::width)
+    {
+        V::store(result + i, normalCdf<V>(V::sub(V::load(mean2 + i), V::load(mean1 + i)),
+                V::add(V::load(variance1 + i), V::load(variance2 + i))));
+    }
+
+    if(i < size)
+    {
+        double padded[4][V::width];
+        for(std::size_t j = 0; j < V::width; ++j)
+        {
+            bool valid = i + j < size;
+            padded[0][j] = valid ? mean1[i + j] : 0;
+            padded[1][j] = valid ? variance1[i + j] : 1;
+            padded[2][j] = valid ? mean2[i + j] : 0;
+            padded[3][j] = valid ? variance2[i + j] : 1;
+        }
+
+        V::store(padded[0], normalCdf<V>(V::sub(V::load(padded[2]), V::load(padded[0])),
+                V::add(V::load(padded[1]), V::load(padded[3]))));
+
+        for(std::size_t j = 0; i + j < size; ++j)
+        {
+            result[i + j] = padded[0][j];
+        }
+    }
+}
+
+/**
+ * Number of elements of the second array in each tile of the pairwise kernel. The means and variances of a tile
+ * stay in the L1 cache while every element of the first array is compared with them
+ */
+const std::size_t pairwise_tile_size = 512;
+
+template<class V>
+void pairwiseLessThan(const double* mean1, const double* variance1, std::size_t size1,
+        const double* mean2, const double* variance2, std::size_t size2, double* result, std::size_t stride)
+{
+    typedef typename V::Vec Vec;
+
+    for(std::size_t first = 0; first < size2; first += pairwise_tile_size)
+    {
+        std::size_t last = std::min(first + pairwise_tile_size, size2);
+        std::size_t last_block = first + (last - first) / V::width * V::width;
+
+        // The remainder of the tile that does not fill a whole block, padded as in the other drivers
+        double padded_mean[V::width] = {};
+        double padded_variance[V::width];
+        for(std::size_t j = 0; j < V::width; ++j)
+        {
+            padded_variance[j] = last_block + j < last ? variance2[last_block + j] : 1;
+            padded_mean[j] = last_block + j < last ? mean2[last_block + j] : 0;
+        }
+
+        for(std::size_t i = 0; i < size1; ++i)
+        {
+            Vec m1 = V::set1(mean1[i]);
+            Vec v1 = V::set1(variance1[i]);
+            double* row = result + i * stride;
+
+            for(std::size_t j = first; j < last_block; j += V::width)
+            {
+                V::store(row + j, normalCdf<V>(V::sub(V::load(mean2 + j), m1), V::add(V::load(variance2 + j), v1)));
+            }
+
+            if(last_block < last)
+            {
+                double block[V::width];
+                V::store(block, normalCdf<V>(V::sub(V::load(padded_mean), m1), V::add(V::load(padded_variance), v1)));
+                for(std::size_t j = last_block; j < last; ++j)
+                {
+                    row[j] = block[j - last_block];
+                }
+            }
+        }
+    }
+}
+
+} // namespace simd
+} // namespace detail
+} // namespace NRV
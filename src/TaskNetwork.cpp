@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include "NormalRandomVariable/TaskNetwork.h"
+#include "Kernels.h"
+#include "Reduction.h"
+
+
+namespace NRV {
+
+namespace {
+
+constexpr std::size_t max_tasks = std::numeric_limits<std::uint32_t>::max();
+
+} // namespace
+
+template<class T>
+BasicTaskNetwork<T>::BasicTaskNetwork(unsigned int threads)
+: BasicTaskNetwork(threads, defaultMemoryResource())
+{
+
+}
+
+template<class T>
+BasicTaskNetwork<T>::BasicTaskNetwork(unsigned int threads, MemoryResource* resource)
+: threads_(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads), means_(resource),
+    variances_(resource), edge_predecessors_(resource), edge_successors_(resource), predecessor_offsets_(resource),
+    predecessors_(resource), order_(resource), level_offsets_(resource), sinks_(resource), max_predecessors_(0),
+    successor_offsets_(resource), successors_(resource), positions_(resource), remaining_(resource),
+    task_levels_(resource), queue_(resource), moments_(resource), thread_moments_(resource), workers_(resource),
+    errors_(resource), completion_means_(resource), completion_variances_(resource), built_(false), evaluated_(false)
+{
+
+}
+
+template<class T>
+BasicTaskNetwork<T>::BasicTaskNetwork(const BasicTaskNetwork& network) = default;
+
+template<class T>
+BasicTaskNetwork<T>::BasicTaskNetwork(BasicTaskNetwork&& network) noexcept = default;
+
+template<class T>
+BasicTaskNetwork<T>::~BasicTaskNetwork() = default;
+
+template<class T>
+BasicTaskNetwork<T>& BasicTaskNetwork<T>::operator=(const BasicTaskNetwork& network) = default;
+
+template<class T>
+BasicTaskNetwork<T>& BasicTaskNetwork<T>::operator=(BasicTaskNetwork&& network) = default;
+
+template<class T>
+void BasicTaskNetwork<T>::reserve(std::size_t tasks, std::size_t dependencies)
+{
+    means_.reserve(tasks);
+    variances_.reserve(tasks);
+    edge_predecessors_.reserve(dependencies);
+    edge_successors_.reserve(dependencies);
+}
+
+template<class T>
+void BasicTaskNetwork<T>::clear()
+{
+    // Only the inputs need to be cleared, since build and evaluate resize the rest of the storage
+    means_.clear();
+    variances_.clear();
+    edge_predecessors_.clear();
+    edge_successors_.clear();
+    built_ = false;
+    evaluated_ = false;
+}
+
+template<class T>
+std::size_t BasicTaskNetwork<T>::addTask(const BasicNormalRandomVariable<T>& duration)
+{
+    if(means_.size() >= max_tasks)
+    {
+        throw std::length_error("TaskNetwork: Too many tasks");
+    }
+
+    means_.push_back(duration.mean());
+    variances_.push_back(duration.variance());
+    built_ = false;
+    evaluated_ = false;
+    return means_.size() - 1;
+}
+
+template<class T>
+void BasicTaskNetwork<T>::addDependency(std::size_t predecessor, std::size_t successor)
+{
+    checkTask(predecessor);
+    checkTask(successor);
+    if(predecessor == successor)
+    {
+        throw std::invalid_argument("TaskNetwork: Task can not depend on itself");
+    }
+
+    if(edge_predecessors_.size() >= max_tasks)
+    {
+        throw std::length_error("TaskNetwork: Too many dependencies");
+    }
+
+    edge_predecessors_.push_back(static_cast<std::uint32_t>(predecessor));
+    edge_successors_.push_back(static_cast<std::uint32_t>(successor));
+    built_ = false;
+    evaluated_ = false;
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicTaskNetwork<T>::duration(std::size_t task) const
+{
+    checkTask(task);
+    return BasicNormalRandomVariable<T>(means_[task], variances_[task]);
+}
+
+template<class T>
+void BasicTaskNetwork<T>::setDuration(std::size_t task, const BasicNormalRandomVariable<T>& duration)
+{
+    checkTask(task);
+    means_[task] = duration.mean();
+    variances_[task] = duration.variance();
+    evaluated_ = false;
+}
+
+template<class T>
+void BasicTaskNetwork<T>::evaluate()
+{
+    if(!built_)
+    {
+        build();
+    }
+
+    completion_means_.resize(means_.size());
+    completion_variances_.resize(means_.size());
+    calculateLevels();
+    evaluated_ = true;
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicTaskNetwork<T>::completion(std::size_t task) const
+{
+    checkTask(task);
+    checkEvaluated();
+    return BasicNormalRandomVariable<T>(completion_means_[task], completion_variances_[task]);
+}
+
+template<class T>
+TryResult<T> BasicTaskNetwork<T>::tryCompletion(std::size_t task) const noexcept
+{
+    if(task >= size())
+    {
+        return TryResult<T>{BasicNormalRandomVariable<T>(), Status::OutOfRange};
+    }
+    if(!evaluated_)
+    {
+        return TryResult<T>{BasicNormalRandomVariable<T>(), Status::NotEvaluated};
+    }
+
+    return BasicNormalRandomVariable<T>::tryCreate(completion_means_[task], completion_variances_[task]);
+}
+
+template<class T>
+BasicNormalRandomVariable<T> BasicTaskNetwork<T>::makespan() const
+{
+    checkEvaluated();
+
+    Vector<detail::Moments<T>> moments(sinks_.size(), detail::Moments<T>(), moments_.get_allocator());
+    for(std::size_t i = 0; i < sinks_.size(); ++i)
+    {
+        moments[i] = detail::Moments<T>{completion_means_[sinks_[i]], completion_variances_[sinks_[i]]};
+    }
+
+    detail::Moments<T> result = detail::maxOf(moments);
+    return BasicNormalRandomVariable<T>(result.mean, result.variance);
+}
+
+template<class T>
+std::size_t BasicTaskNetwork<T>::size() const
+{
+    return means_.size();
+}
+
+template<class T>
+std::size_t BasicTaskNetwork<T>::dependencies() const
+{
+    if(built_)
+    {
+        return predecessors_.size();
+    }
+
+    // Count the distinct dependencies without building the levels
+    Vector<std::uint64_t> edges(edge_predecessors_.size(), 0, edge_predecessors_.get_allocator());
+    for(std::size_t i = 0; i < edges.size(); ++i)
+    {
+        edges[i] = (static_cast<std::uint64_t>(edge_successors_[i]) << 32) | edge_predecessors_[i];
+    }
+    std::sort(edges.begin(), edges.end());
+    return static_cast<std::size_t>(std::unique(edges.begin(), edges.end()) - edges.begin());
+}
+
+template<class T>
+std::size_t BasicTaskNetwork<T>::levels() const
+{
+    return level_offsets_.empty() ? 0 : level_offsets_.size() - 1;
+}
+
+template<class T>
+unsigned int BasicTaskNetwork<T>::threads() const
+{
+    return threads_;
+}
+
+template<class T>
+void BasicTaskNetwork<T>::build()
+{
+    std::size_t size = means_.size();
+
+    // Sort the dependencies into rows of predecessors by counting the predecessors of each task
+    predecessor_offsets_.assign(size + 1, 0);
+    for(std::uint32_t successor : edge_successors_)
+    {
+        ++predecessor_offsets_[successor + 1];
+    }
+    for(std::size_t task = 0; task < size; ++task)
+    {
+        predecessor_offsets_[task + 1] += predecessor_offsets_[task];
+    }
+
+    predecessors_.resize(edge_predecessors_.size());
+    positions_.assign(predecessor_offsets_.begin(), predecessor_offsets_.end() - 1);
+    for(std::size_t i = 0; i < edge_predecessors_.size(); ++i)
+    {
+        predecessors_[positions_[edge_successors_[i]]++] = edge_predecessors_[i];
+    }
+
+    // Remove repeated dependencies, compacting the rows in place. Including a completion time more than once would
+    // change the result, since the maximum treats its operands as independent
+    std::uint32_t compacted = 0;
+    max_predecessors_ = 0;
+    for(std::size_t task = 0; task < size; ++task)
+    {
+        auto first = predecessors_.begin() + predecessor_offsets_[task];
+        auto last = predecessors_.begin() + predecessor_offsets_[task + 1];
+        std::sort(first, last);
+        last = std::unique(first, last);
+
+        predecessor_offsets_[task] = compacted;
+        auto output = predecessors_.begin() + compacted;
+        if(output != first)
+        {
+            std::copy(first, last, output);
+        }
+        compacted += static_cast<std::uint32_t>(last - first);
+        max_predecessors_ = std::max<std::size_t>(max_predecessors_, last - first);
+    }
+    predecessor_offsets_[size] = compacted;
+    predecessors_.resize(compacted);
+
+    // Rows of successors, which are only needed to find the levels
+    successor_offsets_.assign(size + 1, 0);
+    for(std::uint32_t predecessor : predecessors_)
+    {
+        ++successor_offsets_[predecessor + 1];
+    }
+    for(std::size_t task = 0; task < size; ++task)
+    {
+        successor_offsets_[task + 1] += successor_offsets_[task];
+    }
+
+    successors_.resize(predecessors_.size());
+    positions_.assign(successor_offsets_.begin(), successor_offsets_.end() - 1);
+    for(std::size_t task = 0; task < size; ++task)
+    {
+        for(std::uint32_t i = predecessor_offsets_[task]; i < predecessor_offsets_[task + 1]; ++i)
+        {
+            successors_[positions_[predecessors_[i]]++] = static_cast<std::uint32_t>(task);
+        }
+    }
+
+    // The level of a task is one more than the highest level of its predecessors (Kahn's algorithm)
+    remaining_.resize(size);
+    task_levels_.assign(size, 0);
+    queue_.clear();
+    queue_.reserve(size);
+    sinks_.clear();
+    for(std::size_t task = 0; task < size; ++task)
+    {
+        remaining_[task] = predecessor_offsets_[task + 1] - predecessor_offsets_[task];
+        if(remaining_[task] == 0)
+        {
+            queue_.push_back(static_cast<std::uint32_t>(task));
+        }
+        if(successor_offsets_[task + 1] == successor_offsets_[task])
+        {
+            sinks_.push_back(static_cast<std::uint32_t>(task));
+        }
+    }
+
+    std::uint32_t levels = size == 0 ? 0 : 1;
+    for(std::size_t head = 0; head < queue_.size(); ++head)
+    {
+        std::uint32_t task = queue_[head];
+        for(std::uint32_t i = successor_offsets_[task]; i < successor_offsets_[task + 1]; ++i)
+        {
+            std::uint32_t successor = successors_[i];
+            task_levels_[successor] = std::max(task_levels_[successor], task_levels_[task] + 1);
+            if(--remaining_[successor] == 0)
+            {
+                queue_.push_back(successor);
+                levels = std::max(levels, task_levels_[successor] + 1);
+            }
+        }
+    }
+
+    if(queue_.size() != size)
+    {
+        throw std::invalid_argument("TaskNetwork: Dependencies contain a cycle");
+    }
+
+    // Sort the tasks by level, keeping them in order of index within each level
+    level_offsets_.assign(levels + 1, 0);
+    for(std::size_t task = 0; task < size; ++task)
+    {
+        ++level_offsets_[task_levels_[task] + 1];
+    }
+    for(std::size_t i = 0; i < levels; ++i)
+    {
+        level_offsets_[i + 1] += level_offsets_[i];
+    }
+
+    order_.resize(size);
+    positions_.assign(level_offsets_.begin(), level_offsets_.end() - 1);
+    for(std::size_t task = 0; task < size; ++task)
+    {
+        order_[positions_[task_levels_[task]]++] = static_cast<std::uint32_t>(task);
+    }
+
+    built_ = true;
+}
+
+template<class T>
+void BasicTaskNetwork<T>::calculate(std::size_t first, std::size_t last, Vector<detail::Moments<T>>& moments)
+{
+    for(std::size_t position = first; position < last; ++position)
+    {
+        std::uint32_t task = order_[position];
+        std::uint32_t row_first = predecessor_offsets_[task];
+        std::uint32_t row_last = predecessor_offsets_[task + 1];
+
+        // The start time is the maximum of the completion times of the predecessors, in the same order as max
+        detail::Moments<T> start = {0, 0};
+        if(row_last - row_first == 1)
+        {
+            start = {completion_means_[predecessors_[row_first]], completion_variances_[predecessors_[row_first]]};
+        }
+        else if(row_last > row_first)
+        {
+            moments.resize(row_last - row_first);
+            for(std::uint32_t i = row_first; i < row_last; ++i)
+            {
+                moments[i - row_first] = {completion_means_[predecessors_[i]], completion_variances_[predecessors_[i]]};
+            }
+            start = detail::maxOf(moments);
+        }
+
+        completion_means_[task] = start.mean + means_[task];
+        completion_variances_[task] = start.variance + variances_[task];
+    }
+}
+
+template<class T>
+void BasicTaskNetwork<T>::calculateLevels()
+{
+    std::size_t largest = 0;
+    for(std::size_t level = 0; level + 1 < level_offsets_.size(); ++level)
+    {
+        largest = std::max<std::size_t>(largest, level_offsets_[level + 1] - level_offsets_[level]);
+    }
+
+    Vector<detail::Moments<T>>& moments = moments_;
+    moments.reserve(max_predecessors_);
+
+    // The tasks are sorted by level, so they can be calculated in order if no level is split into chunks
+    std::size_t threads = std::min<std::size_t>(threads_, (largest + chunk_size - 1) / chunk_size);
+    if(threads <= 1)
+    {
+        calculate(0, order_.size(), moments);
+        return;
+    }
+
+    // Large levels are split into chunks, which the threads take in turn until there are none left. The storage of
+    // each thread is kept for the next evaluation
+    while(thread_moments_.size() < threads - 1)
+    {
+        thread_moments_.emplace_back(moments.get_allocator());
+    }
+    for(auto& thread_moments : thread_moments_)
+    {
+        thread_moments.reserve(max_predecessors_);
+    }
+    workers_.reserve(threads - 1);
+    errors_.reserve(threads);
+    for(std::size_t level = 0; level + 1 < level_offsets_.size(); ++level)
+    {
+        std::size_t first = level_offsets_[level], last = level_offsets_[level + 1];
+        std::size_t level_threads = std::min<std::size_t>(threads, (last - first + chunk_size - 1) / chunk_size);
+        if(level_threads <= 1)
+        {
+            calculate(first, last, moments);
+            continue;
+        }
+
+        std::atomic<std::size_t> next_chunk(first);
+        errors_.assign(level_threads, std::exception_ptr());
+        auto calculateChunks = [&](std::size_t thread, Vector<detail::Moments<T>>& thread_moments) {
+            try
+            {
+                for(std::size_t chunk = next_chunk.fetch_add(chunk_size); chunk < last;
+                        chunk = next_chunk.fetch_add(chunk_size))
+                {
+                    calculate(chunk, std::min(chunk + chunk_size, last), thread_moments);
+                }
+            }
+            catch(...)
+            {
+                errors_[thread] = std::current_exception();
+            }
+        };
+
+        // If a thread can not be started, the threads that are running take its chunks
+        for(std::size_t thread = 1; thread < level_threads; ++thread)
+        {
+            try
+            {
+                workers_.emplace_back(calculateChunks, thread, std::ref(thread_moments_[thread - 1]));
+            }
+            catch(const std::system_error&)
+            {
+                break;
+            }
+        }
+        calculateChunks(0, moments);
+        for(auto& worker : workers_)
+        {
+            worker.join();
+        }
+        workers_.clear();
+
+        for(const auto& error : errors_)
+        {
+            if(error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+}
+
+template<class T>
+void BasicTaskNetwork<T>::checkTask(std::size_t task) const
+{
+    if(task >= means_.size())
+    {
+        throw std::invalid_argument("TaskNetwork: Task does not exist");
+    }
+}
+
+template<class T>
+void BasicTaskNetwork<T>::checkEvaluated() const
+{
+    if(!evaluated_)
+    {
+        throw std::logic_error("TaskNetwork: Network has changed since it was evaluated");
+    }
+}
+
+template class BasicTaskNetwork<float>;
+template class BasicTaskNetwork<double>;
+template class BasicTaskNetwork<long double>;
+
+} // namespace NRV
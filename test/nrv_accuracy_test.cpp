@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+#include "NormalRandomVariable/NormalRandomVariable.h"
+#include "NormalRandomVariable/MemoCache.h"
+#include "NormalRandomVariable/MonteCarlo.h"
+
+typedef NRV::NormalRandomVariable RV;
+typedef NRV::BasicNormalRandomVariable<long double> LongRV;
+
+const NRV::Accuracy accuracies[] = {NRV::Accuracy::Exact, NRV::Accuracy::Default, NRV::Accuracy::Fast};
+
+/**
+ * Mean and variance of a standard normal distribution truncated below c, calculated in long double precision
+ */
+LongRV standardTruncatedLower(long double c)
+{
+    long double lambda = std::exp(-c * c / 2) / std::sqrt(2 * 3.14159265358979323846L) / (std::erfc(c / std::sqrt(2.0L)) / 2);
+    return LongRV(lambda, 1 + c * lambda - lambda * lambda);
+}
+
+/**
+ * E[1 / Y] and E[1 / Y^2] for Y ~ N(mean, 1), by Simpson's rule over 10 standard deviations either side of the mean
+ */
+void inverseMoments(double mean, double& first, double& second)
+{
+    const int intervals = 200000;
+    double lower = mean - 10;
+    double step = 20.0 / intervals;
+    double mass = 0;
+    first = 0;
+    second = 0;
+    for(int i = 0; i <= intervals; ++i)
+    {
+        double y = lower + i * step;
+        double weight = (i == 0 || i == intervals) ? 1 : (i % 2 == 1 ? 4 : 2);
+        double density = weight * std::exp(-(y - mean) * (y - mean) / 2);
+        mass += density;
+        first += density / y;
+        second += density / (y * y);
+    }
+    first /= mass;
+    second /= mass;
+}
+
+TEST(Accuracy, DefaultIsTheDefault)
+{
+    RV rv(1, 2);
+    RV lower(-1, 0.5), upper(2, 1);
+
+    EXPECT_EQ(rv.truncate(-1, 2, NRV::Accuracy::Default).variance(), rv.truncate(-1, 2).variance());
+    EXPECT_EQ(rv.rectify(-1, 2, NRV::Accuracy::Default).variance(), rv.rectify(-1, 2).variance());
+    EXPECT_EQ(rv.truncate(lower, upper, NRV::Accuracy::Default).variance(), rv.truncate(lower, upper).variance());
+    EXPECT_EQ(rv.max(upper, NRV::Accuracy::Default).variance(), rv.max(upper).variance());
+    EXPECT_EQ(NRV::divide(rv, RV(10, 1), NRV::Accuracy::Default).variance(), (rv / RV(10, 1)).variance());
+    EXPECT_EQ(NRV::divide(2.0, RV(10, 1), NRV::Accuracy::Default).variance(), (2.0 / RV(10, 1)).variance());
+}
+
+TEST(Accuracy, ExactTails)
+{
+    for(double c : {5.0, 10.0, 20.0, 30.0})
+    {
+        LongRV expected = standardTruncatedLower(c);
+        RV lower = RV(0, 1).truncateLower(c, NRV::Accuracy::Exact);
+        RV upper = RV(0, 1).truncateUpper(-c, NRV::Accuracy::Exact);
+        EXPECT_NEAR(lower.mean(), static_cast<double>(expected.mean()), 1e-12 * c);
+        EXPECT_NEAR(lower.variance(), static_cast<double>(expected.variance()), 1e-7 * static_cast<double>(expected.variance()));
+        EXPECT_EQ(upper.mean(), -lower.mean());
+        EXPECT_EQ(upper.variance(), lower.variance());
+
+        // Both bounds in the same tail, with the upper bound far enough away to have no effect
+        RV between = RV(0, 1).truncate(c, c + 40, NRV::Accuracy::Exact);
+        EXPECT_NEAR(between.mean(), lower.mean(), 1e-12 * c);
+        EXPECT_NEAR(between.variance(), lower.variance(), 1e-7 * lower.variance());
+    }
+
+    // The mass keeps its relative accuracy, where 1 - erf has none left
+    EXPECT_NEAR(RV(0, 1).truncateLowerWithMass(10, NRV::Accuracy::Exact).mass, 7.6198530241604696e-24, 1e-35);
+    EXPECT_FALSE(RV(0, 1).tryTruncateLower(10).ok());
+    EXPECT_TRUE(RV(0, 1).tryTruncateLower(10, NRV::Accuracy::Exact).ok());
+    EXPECT_TRUE(RV(0, 1).tryTruncateLower(10, NRV::Accuracy::Fast).ok());
+}
+
+TEST(Accuracy, ExactTruncateByRandomVariables)
+{
+    struct Case {
+        RV rv;
+        RV lower;
+        RV upper;
+    };
+    const Case cases[] = {
+        {RV(0, 1), RV(-1, 1), RV(1, 1)},
+        {RV(2, 1), RV(0, 4), RV(3, 0.25)},
+        {RV(0, 4), RV(-3, 1), RV(-1, 2)},
+        {RV(0, 1), RV(-2, 0.5), RV(2, 3)},
+    };
+
+    for(const Case& test : cases)
+    {
+        auto inside = [](NRV::SampleView x) {
+            return x[0] > x[1] && x[0] < x[2] ? x[0] : std::numeric_limits<double>::quiet_NaN();
+        };
+        const std::size_t samples = 2000000;
+        NRV::WelfordAccumulator expected = NRV::MonteCarlo(1).sample(inside, {test.rv, test.lower, test.upper}, samples);
+        double mass = static_cast<double>(expected.count()) / samples;
+
+        NRV::TruncationResult<double> result = test.rv.truncateWithMass(test.lower, test.upper, NRV::Accuracy::Exact);
+        // Within 5 standard errors of the estimates
+        double count = static_cast<double>(expected.count());
+        EXPECT_NEAR(result.value.mean(), expected.mean(), 5 * std::sqrt(expected.variance() / count));
+        EXPECT_NEAR(result.value.variance(), expected.variance(), 5 * expected.variance() * std::sqrt(2 / count));
+        EXPECT_NEAR(result.mass, mass, 5 * std::sqrt(mass * (1 - mass) / samples));
+    }
+
+    // Where the approximations are furthest off, in this case the variance by 5%
+    RV rv(0, 1), lower(-1, 1), upper(1, 1);
+    EXPECT_GT(std::abs(rv.truncate(lower, upper).variance() - rv.truncate(lower, upper, NRV::Accuracy::Exact).variance()), 0.02);
+
+    // Bounds with a tiny variance give the truncation by constants (with the correlation of the differences near -1)
+    RV narrow = rv.truncate(RV(-0.5, 1e-12), RV(1.5, 1e-12), NRV::Accuracy::Exact);
+    RV constants = rv.truncate(-0.5, 1.5, NRV::Accuracy::Exact);
+    EXPECT_NEAR(narrow.mean(), constants.mean(), 1e-5);
+    EXPECT_NEAR(narrow.variance(), constants.variance(), 1e-5);
+}
+
+TEST(Accuracy, ExactInverseAndDivision)
+{
+    for(double mean : {20.0, 64.0})
+    {
+        double first, second;
+        inverseMoments(mean, first, second);
+
+        double variance = second - first * first;
+        RV inverse = RV(mean, 1).inverse(NRV::Accuracy::Exact);
+        EXPECT_NEAR(inverse.mean(), first, 1e-9 * first);
+        EXPECT_NEAR(inverse.variance(), variance, 1e-7 * variance);
+
+        // The series is more accurate than the approximation of the inverse
+        EXPECT_GT(std::abs(RV(mean, 1).inverse().variance() - variance), 100 * std::abs(inverse.variance() - variance));
+
+        // Division by a random variable multiplies by its inverse
+        RV rv(-2, 3);
+        RV ratio = NRV::divide(rv, RV(mean, 1), NRV::Accuracy::Exact);
+        EXPECT_NEAR(ratio.mean(), -2 * first, 1e-9 * first);
+        EXPECT_NEAR(ratio.variance(), (3 + 4) * second - 4 * first * first, 1e-7 * ratio.variance());
+
+        NRV::TryResult<double> try_ratio = NRV::tryDivide(rv, RV(mean, 1), NRV::Accuracy::Exact);
+        ASSERT_TRUE(try_ratio.ok());
+        EXPECT_EQ(try_ratio.value.mean(), ratio.mean());
+        EXPECT_EQ(try_ratio.value.variance(), ratio.variance());
+
+        RV scaled = NRV::divide(3.0, RV(mean, 1), NRV::Accuracy::Exact);
+        EXPECT_DOUBLE_EQ(scaled.mean(), 3 * inverse.mean());
+        EXPECT_DOUBLE_EQ(scaled.variance(), 9 * inverse.variance());
+    }
+
+    // Means so far from 0 that the terms after the first are below the precision
+    for(double mean : {1e9, -1e12})
+    {
+        RV inverse = RV(mean, 1).inverse(NRV::Accuracy::Exact);
+        EXPECT_DOUBLE_EQ(inverse.mean(), 1 / mean);
+        EXPECT_DOUBLE_EQ(inverse.variance(), 1 / (mean * mean * mean * mean));
+        EXPECT_TRUE(RV(mean, 1).tryInverse(NRV::Accuracy::Exact).ok());
+
+        RV ratio = NRV::divide(RV(2, 1), RV(mean, 1), NRV::Accuracy::Exact);
+        EXPECT_DOUBLE_EQ(ratio.mean(), 2 / mean);
+        EXPECT_GT(ratio.variance(), 0);
+    }
+
+    for(NRV::Accuracy accuracy : accuracies)
+    {
+        EXPECT_THROW(RV(2, 1).inverse(accuracy), std::range_error);
+        EXPECT_THROW(NRV::divide(RV(1, 1), RV(2, 1), accuracy), std::range_error);
+        EXPECT_EQ(NRV::tryDivide(RV(1, 1), RV(2, 1), accuracy).status, NRV::Status::InvalidApproximation);
+        EXPECT_EQ(RV(2, 1).tryInverse(accuracy).status, NRV::Status::InvalidApproximation);
+    }
+}
+
+TEST(Accuracy, FastMatchesExact)
+{
+    const RV rv(0.5, 2);
+    for(double lower = -8; lower <= 8; lower += 0.1)
+    {
+        for(double width : {0.1, 1.0, 4.0})
+        {
+            RV exact = rv.truncate(lower, lower + width, NRV::Accuracy::Exact);
+            RV fast = rv.truncate(lower, lower + width, NRV::Accuracy::Fast);
+            EXPECT_NEAR(fast.mean(), exact.mean(), 2e-6 * std::sqrt(exact.variance()));
+            EXPECT_NEAR(fast.variance(), exact.variance(), 1e-3 * exact.variance());
+
+            exact = rv.rectify(lower, lower + width, NRV::Accuracy::Exact);
+            fast = rv.rectify(lower, lower + width, NRV::Accuracy::Fast);
+            EXPECT_NEAR(fast.mean(), exact.mean(), 1e-6 * std::sqrt(exact.variance()));
+            EXPECT_NEAR(fast.variance(), exact.variance(), 1e-5 * exact.variance());
+        }
+
+        RV exact = rv.max(RV(lower, 1), NRV::Accuracy::Exact);
+        RV fast = rv.max(RV(lower, 1), NRV::Accuracy::Fast);
+        EXPECT_NEAR(fast.mean(), exact.mean(), 1e-7 * std::sqrt(exact.variance()));
+        EXPECT_NEAR(fast.variance(), exact.variance(), 1e-7 * exact.variance());
+
+        // Truncation by random variables uses the same approximations as Default
+        RV lower_bound(lower, 0.5), upper_bound(lower + 2, 1.5);
+        RV expected = rv.truncate(lower_bound, upper_bound);
+        RV result = rv.truncate(lower_bound, upper_bound, NRV::Accuracy::Fast);
+        EXPECT_NEAR(result.mean(), expected.mean(), 1e-6 * std::sqrt(expected.variance()));
+        EXPECT_NEAR(result.variance(), expected.variance(), 1e-4 * expected.variance());
+    }
+
+    // The inverse and division multiply by the same approximation of the inverse as Default
+    RV inverse = RV(10, 1).inverse();
+    RV fast = RV(10, 1).inverse(NRV::Accuracy::Fast);
+    EXPECT_DOUBLE_EQ(fast.mean(), inverse.mean());
+    EXPECT_DOUBLE_EQ(fast.variance(), inverse.variance());
+
+    RV product = RV(3, 1) * inverse;
+    RV ratio = NRV::divide(RV(3, 1), RV(10, 1), NRV::Accuracy::Fast);
+    EXPECT_DOUBLE_EQ(ratio.mean(), product.mean());
+    EXPECT_DOUBLE_EQ(ratio.variance(), product.variance());
+}
+
+TEST(Accuracy, LongDouble)
+{
+    LongRV rv(0, 1);
+    LongRV truncated = rv.truncateLower(20, NRV::Accuracy::Exact);
+    LongRV expected = standardTruncatedLower(20);
+    EXPECT_NEAR(static_cast<double>(truncated.mean()), static_cast<double>(expected.mean()), 1e-14);
+
+    RV between = RV(0, 1).truncate(RV(-1, 1), RV(1, 1), NRV::Accuracy::Exact);
+    LongRV long_between = rv.truncate(LongRV(-1, 1), LongRV(1, 1), NRV::Accuracy::Exact);
+    EXPECT_NEAR(static_cast<double>(long_between.mean()), between.mean(), 1e-14);
+    EXPECT_NEAR(static_cast<double>(long_between.variance()), between.variance(), 1e-14);
+}
+
+TEST(Accuracy, OnlyDefaultIsCached)
+{
+    RV rv(0, 1);
+    RV fast = rv.truncateLower(3, NRV::Accuracy::Fast);
+    NRV::enableMemoCache(64);
+    for(int i = 0; i < 2; ++i)
+    {
+        rv.truncate(-1, 1, NRV::Accuracy::Exact);
+        rv.max(RV(1, 1), NRV::Accuracy::Fast);
+    }
+    NRV::MemoCacheStatistics statistics = NRV::memoCacheStatistics();
+    EXPECT_EQ(statistics.hits + statistics.misses, 0u);
+
+    // A cached Default result is not returned for the other accuracies
+    rv.truncateLower(3);
+    rv.truncateLower(3);
+    EXPECT_EQ(NRV::memoCacheStatistics().hits, 1u);
+    EXPECT_EQ(rv.truncateLower(3, NRV::Accuracy::Fast).variance(), fast.variance());
+    NRV::disableMemoCache();
+}
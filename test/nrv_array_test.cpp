@@ -0,0 +1,322 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+#include "NormalRandomVariable/NormalRandomVariableArray.h"
+#include "NormalRandomVariable/Simd.h"
+
+/**
+ * Builds an array from pairs of means and variances that cover the interesting regions of each operation
+ */
+NRV::NormalRandomVariableArray testArray()
+{
+    return NRV::NormalRandomVariableArray({10, 0, 5, -2, 8, 12}, {0.5, 0.5, 10, 1, 1, 4});
+}
+
+NRV::NormalRandomVariableArray testBounds()
+{
+    return NRV::NormalRandomVariableArray({5, 10, 4, 0, 7, 11}, {2, 1, 2, 1, 4, 2});
+}
+
+/**
+ * Checks that every element of the array matches the result of the scalar operation
+ */
+template<class ScalarOperation>
+void expectMatchesScalar(const NRV::NormalRandomVariableArray& result, const NRV::NormalRandomVariableArray& inputs, ScalarOperation operation)
+{
+    ASSERT_EQ(result.size(), inputs.size());
+    for(std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        auto expected = operation(i);
+        EXPECT_DOUBLE_EQ(result.means()[i], expected.mean());
+        EXPECT_DOUBLE_EQ(result.variances()[i], expected.variance());
+    }
+}
+
+TEST(Instantiation, Sizes)
+{
+    EXPECT_EQ(NRV::NormalRandomVariableArray().size(), 0u);
+    EXPECT_TRUE(NRV::NormalRandomVariableArray().empty());
+
+    NRV::NormalRandomVariableArray rvs(3);
+    EXPECT_EQ(rvs.size(), 3u);
+    EXPECT_DOUBLE_EQ(rvs[2].mean(), 0);
+    EXPECT_DOUBLE_EQ(rvs[2].variance(), 1);
+}
+
+TEST(Instantiation, InvalidInputs)
+{
+    EXPECT_ANY_THROW(NRV::NormalRandomVariableArray({1, 2}, {1}));
+    EXPECT_ANY_THROW(NRV::NormalRandomVariableArray({1, 2}, {1, 0}));
+}
+
+TEST(Access, FromAndToVector)
+{
+    std::vector<NRV::NormalRandomVariable> rvs = {NRV::NormalRandomVariable(1, 2), NRV::NormalRandomVariable(3, 4)};
+    NRV::NormalRandomVariableArray array(rvs);
+    array.push_back(NRV::NormalRandomVariable(5, 6));
+    array.set(0, NRV::NormalRandomVariable(7, 8));
+
+    auto vec = array.toVector();
+    ASSERT_EQ(vec.size(), 3u);
+    EXPECT_DOUBLE_EQ(vec[0].mean(), 7);
+    EXPECT_DOUBLE_EQ(vec[1].variance(), 4);
+    EXPECT_DOUBLE_EQ(vec[2].mean(), 5);
+    EXPECT_ANY_THROW(array.at(3));
+}
+
+TEST(Arithmetic, MatchesScalar)
+{
+    auto rvs = testArray();
+    auto bounds = testBounds();
+
+    expectMatchesScalar(rvs + bounds, rvs, [&](std::size_t i) {return rvs[i] + bounds[i];});
+    expectMatchesScalar(rvs + 2.5, rvs, [&](std::size_t i) {return rvs[i] + 2.5;});
+    expectMatchesScalar(2.5 + rvs, rvs, [&](std::size_t i) {return 2.5 + rvs[i];});
+    expectMatchesScalar(rvs - bounds, rvs, [&](std::size_t i) {return rvs[i] - bounds[i];});
+    expectMatchesScalar(rvs - 2.5, rvs, [&](std::size_t i) {return rvs[i] - 2.5;});
+    expectMatchesScalar(2.5 - rvs, rvs, [&](std::size_t i) {return 2.5 - rvs[i];});
+    expectMatchesScalar(-rvs, rvs, [&](std::size_t i) {return -rvs[i];});
+    expectMatchesScalar(rvs * 0.2, rvs, [&](std::size_t i) {return rvs[i] * 0.2;});
+    expectMatchesScalar(0.2 * rvs, rvs, [&](std::size_t i) {return 0.2 * rvs[i];});
+    expectMatchesScalar(rvs * bounds, rvs, [&](std::size_t i) {return rvs[i] * bounds[i];});
+    expectMatchesScalar(rvs / 5, rvs, [&](std::size_t i) {return rvs[i] / 5;});
+}
+
+TEST(Division, MatchesScalar)
+{
+    // Both branches of the division approximation
+    NRV::NormalRandomVariableArray numerators({10, 10}, {25, 1});
+    NRV::NormalRandomVariableArray denominators({5, 5}, {1, 1});
+
+    expectMatchesScalar(numerators / denominators, numerators, [&](std::size_t i) {return numerators[i] / denominators[i];});
+    expectMatchesScalar(5 / denominators, denominators, [&](std::size_t i) {return 5 / denominators[i];});
+    expectMatchesScalar(denominators.inverse(), denominators, [&](std::size_t i) {return denominators[i].inverse();});
+}
+
+TEST(Rectification, MatchesScalar)
+{
+    // Use the scalar batch kernels so that the results are identical (see nrv_simd_test for the vectorised kernels)
+    NRV::setInstructionSet(NRV::InstructionSet::Scalar);
+
+    auto rvs = testArray();
+
+    expectMatchesScalar(rvs.rectify(0, 10), rvs, [&](std::size_t i) {return rvs[i].rectify(0, 10);});
+    expectMatchesScalar(rvs.rectifyLower(0), rvs, [&](std::size_t i) {return rvs[i].rectifyLower(0);});
+    expectMatchesScalar(rvs.rectifyUpper(10), rvs, [&](std::size_t i) {return rvs[i].rectifyUpper(10);});
+    EXPECT_ANY_THROW(rvs.rectify(10, 0));
+}
+
+TEST(Truncation, MatchesScalar)
+{
+    // Use the scalar batch kernels so that the results are identical (see nrv_simd_test for the vectorised kernels)
+    NRV::setInstructionSet(NRV::InstructionSet::Scalar);
+
+    auto rvs = testArray();
+    auto lower = testBounds() - 5;
+    auto upper = testBounds() + 5;
+
+    expectMatchesScalar(rvs.truncate(0, 10), rvs, [&](std::size_t i) {return rvs[i].truncate(0, 10);});
+    expectMatchesScalar(rvs.truncateLower(0), rvs, [&](std::size_t i) {return rvs[i].truncateLower(0);});
+    expectMatchesScalar(rvs.truncateUpper(10), rvs, [&](std::size_t i) {return rvs[i].truncateUpper(10);});
+    expectMatchesScalar(rvs.truncate(lower, upper), rvs, [&](std::size_t i) {return rvs[i].truncate(lower[i], upper[i]);});
+    expectMatchesScalar(rvs.truncateLower(lower), rvs, [&](std::size_t i) {return rvs[i].truncateLower(lower[i]);});
+    expectMatchesScalar(rvs.truncateUpper(upper), rvs, [&](std::size_t i) {return rvs[i].truncateUpper(upper[i]);});
+    EXPECT_ANY_THROW(rvs.truncate(10, 0));
+}
+
+TEST(Truncation, SoftBoundMethods)
+{
+    // Bounds that select each of the three methods of truncation with normally distributed bounds
+    NRV::NormalRandomVariableArray rvs({5, 5, 5, 5}, {1, 10, 1, 1});
+    NRV::NormalRandomVariableArray lower({0, 6, 4, -4}, {1, 2, 3, 2});
+    NRV::NormalRandomVariableArray upper({10, 4, 6, -2}, {1, 2, 2, 3});
+
+    expectMatchesScalar(rvs.truncate(lower, upper), rvs, [&](std::size_t i) {return rvs[i].truncate(lower[i], upper[i]);});
+}
+
+TEST(MaxMin, MatchesScalar)
+{
+    // Use the scalar batch kernels so that the results are identical (see nrv_simd_test for the vectorised kernels)
+    NRV::setInstructionSet(NRV::InstructionSet::Scalar);
+
+    auto rvs = testArray();
+    auto others = testBounds();
+
+    expectMatchesScalar(rvs.max(others), rvs, [&](std::size_t i) {return rvs[i].max(others[i]);});
+    expectMatchesScalar(rvs.min(others), rvs, [&](std::size_t i) {return rvs[i].min(others[i]);});
+}
+
+TEST(MaxMin, MismatchedSizes)
+{
+    EXPECT_ANY_THROW(testArray().max(NRV::NormalRandomVariableArray(2)));
+    EXPECT_ANY_THROW(testArray() + NRV::NormalRandomVariableArray(2));
+}
+
+TEST(Probability, MatchesScalar)
+{
+    NRV::setInstructionSet(NRV::InstructionSet::Scalar);
+
+    auto rvs = testArray();
+    auto others = testBounds();
+
+    std::vector<double> cdf = rvs.cdf(6), quantile = rvs.quantile(0.9), less_than = rvs.probabilityLessThan(others);
+    std::vector<double> pairwise(rvs.size() * others.size());
+    NRV::pairwiseProbabilityLessThan(rvs, others, pairwise.data());
+    ASSERT_EQ(cdf.size(), rvs.size());
+    for(std::size_t i = 0; i < rvs.size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(cdf[i], rvs[i].cdf(6));
+        EXPECT_DOUBLE_EQ(quantile[i], rvs[i].quantile(0.9));
+        EXPECT_DOUBLE_EQ(less_than[i], rvs[i].probabilityLessThan(others[i]));
+        for(std::size_t j = 0; j < others.size(); ++j)
+        {
+            EXPECT_DOUBLE_EQ(pairwise[i * others.size() + j], rvs[i].probabilityLessThan(others[j]));
+        }
+    }
+
+    EXPECT_THROW(rvs.probabilityLessThan(NRV::NormalRandomVariableArray(2)), std::length_error);
+    EXPECT_THROW(rvs.quantile(1), std::range_error);
+}
+
+TEST(TryOperations, StatusMask)
+{
+    NRV::setInstructionSet(NRV::InstructionSet::Scalar);
+
+    // The second element is too close to 0 to invert, and the third is too far below the lower bound
+    NRV::NormalRandomVariableArray rvs({100, 1, -40}, {1, 1, 1});
+    std::vector<NRV::Status> status;
+
+    auto inverse = rvs.tryInverse(status);
+    ASSERT_EQ(status.size(), rvs.size());
+    EXPECT_EQ(status[0], NRV::Status::Ok);
+    EXPECT_EQ(status[1], NRV::Status::InvalidApproximation);
+    EXPECT_DOUBLE_EQ(inverse.means()[0], rvs[0].inverse().mean());
+    EXPECT_EQ(inverse.means()[1], 0);
+    EXPECT_EQ(inverse.variances()[1], 1);
+
+    auto truncated = rvs.tryTruncateLower(0, status);
+    EXPECT_EQ(status[0], NRV::Status::Ok);
+    EXPECT_EQ(status[1], NRV::Status::Ok);
+    EXPECT_EQ(status[2], NRV::Status::InvalidVariance);
+    EXPECT_DOUBLE_EQ(truncated.means()[1], rvs[1].truncateLower(0).mean());
+    EXPECT_EQ(truncated.variances()[2], 1);
+
+    rvs.tryTruncate(1, 0, status);
+    EXPECT_EQ(status, std::vector<NRV::Status>(3, NRV::Status::InvalidBounds));
+
+    auto divided = NRV::tryDivide(NRV::NormalRandomVariableArray({5, 5, 5}, {1, 1, 1}), rvs, status);
+    EXPECT_EQ(status[0], NRV::Status::Ok);
+    EXPECT_EQ(status[1], NRV::Status::InvalidApproximation);
+    EXPECT_DOUBLE_EQ(divided.means()[0], (NRV::NormalRandomVariable(5, 1) / rvs[0]).mean());
+}
+
+TEST(MaxMin, Reduction)
+{
+    // Large enough to be reduced in several chunks
+    NRV::NormalRandomVariableArray rvs;
+    for(int i = 0; i < 10000; ++i)
+    {
+        rvs.push_back(NRV::NormalRandomVariable(0.001 * (i % 997), 1 + 0.0001 * (i % 101)));
+    }
+
+    auto maximum = NRV::max(rvs);
+    EXPECT_DOUBLE_EQ(maximum.mean(), NRV::max(rvs.toVector()).mean());
+    EXPECT_DOUBLE_EQ(maximum.variance(), NRV::max(rvs.toVector()).variance());
+    EXPECT_GT(maximum.mean(), 3);
+
+    auto minimum = NRV::min(-rvs);
+    EXPECT_DOUBLE_EQ(minimum.mean(), -maximum.mean());
+    EXPECT_DOUBLE_EQ(minimum.variance(), maximum.variance());
+
+    EXPECT_ANY_THROW(NRV::max(NRV::NormalRandomVariableArray()));
+}
+
+TEST(OutputVersions, MatchReturnedArrays)
+{
+    NRV::NormalRandomVariableArray rvs = testArray();
+    NRV::NormalRandomVariableArray bounds = testBounds();
+    NRV::NormalRandomVariableArray upper = bounds + 5;
+    NRV::NormalRandomVariableArray result;
+    std::vector<NRV::Status> status;
+
+    auto expectEqual = [](const NRV::NormalRandomVariableArray& actual, const NRV::NormalRandomVariableArray& expected) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for(std::size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(actual.means()[i], expected.means()[i]);
+            EXPECT_EQ(actual.variances()[i], expected.variances()[i]);
+        }
+    };
+
+    rvs.inverse(result);
+    expectEqual(result, rvs.inverse());
+    rvs.rectify(0, 9, result);
+    expectEqual(result, rvs.rectify(0, 9));
+    rvs.rectifyLower(1, result);
+    expectEqual(result, rvs.rectifyLower(1));
+    rvs.rectifyUpper(9, result);
+    expectEqual(result, rvs.rectifyUpper(9));
+    rvs.truncate(0, 9, result);
+    expectEqual(result, rvs.truncate(0, 9));
+    rvs.truncateLower(1, result);
+    expectEqual(result, rvs.truncateLower(1));
+    rvs.truncateUpper(9, result);
+    expectEqual(result, rvs.truncateUpper(9));
+    rvs.truncate(bounds - 5, upper, result);
+    expectEqual(result, rvs.truncate(bounds - 5, upper));
+    rvs.truncateLower(bounds, result);
+    expectEqual(result, rvs.truncateLower(bounds));
+    rvs.truncateUpper(bounds, result);
+    expectEqual(result, rvs.truncateUpper(bounds));
+    rvs.max(bounds, result);
+    expectEqual(result, rvs.max(bounds));
+    rvs.min(bounds, result);
+    expectEqual(result, rvs.min(bounds));
+    rvs.tryTruncateLower(0, status, result);
+    expectEqual(result, rvs.tryTruncateLower(0, status));
+    rvs.tryRectify(1, 0, status, result);
+    expectEqual(result, NRV::NormalRandomVariableArray(rvs.size()));
+
+    NRV::add(rvs, bounds, result);
+    expectEqual(result, rvs + bounds);
+    NRV::add(rvs, 2.0, result);
+    expectEqual(result, rvs + 2.0);
+    NRV::subtract(rvs, bounds, result);
+    expectEqual(result, rvs - bounds);
+    NRV::subtract(rvs, 2.0, result);
+    expectEqual(result, rvs - 2.0);
+    NRV::subtract(2.0, rvs, result);
+    expectEqual(result, 2.0 - rvs);
+    NRV::negate(rvs, result);
+    expectEqual(result, -rvs);
+    NRV::multiply(rvs, bounds, result);
+    expectEqual(result, rvs * bounds);
+    NRV::multiply(rvs, 2.0, result);
+    expectEqual(result, rvs * 2.0);
+    NRV::divide(rvs, bounds, result);
+    expectEqual(result, rvs / bounds);
+    NRV::divide(rvs, 2.0, result);
+    expectEqual(result, rvs / 2.0);
+    NRV::divide(2.0, bounds, result);
+    expectEqual(result, 2.0 / bounds);
+    NRV::tryDivide(rvs, bounds, status, result);
+    expectEqual(result, NRV::tryDivide(rvs, bounds, status));
+
+    std::vector<double> probabilities;
+    rvs.cdf(5, probabilities);
+    EXPECT_EQ(probabilities, rvs.cdf(5));
+    rvs.quantile(0.9, probabilities);
+    EXPECT_EQ(probabilities, rvs.quantile(0.9));
+    rvs.probabilityLessThan(bounds, probabilities);
+    EXPECT_EQ(probabilities, rvs.probabilityLessThan(bounds));
+
+    // The result can be one of the inputs
+    NRV::NormalRandomVariableArray in_place = rvs;
+    in_place.max(bounds, in_place);
+    expectEqual(in_place, rvs.max(bounds));
+    NRV::add(in_place, in_place, in_place);
+    expectEqual(in_place, rvs.max(bounds) + rvs.max(bounds));
+
+    EXPECT_THROW(rvs.max(NRV::NormalRandomVariableArray(2), result), std::length_error);
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "NormalRandomVariable/ContentionQueue.h"
+#include "NormalRandomVariable/MonteCarlo.h"
+
+/**
+ * Simulates a station with the specified number of servers, where the samples are the arrival times of the robots
+ * followed by their service times, and returns the departure time of robot (or of the last robot if robot is
+ * negative). Robots are served in the order they arrive, by the first server to become free
+ */
+double simulate(NRV::SampleView samples, std::size_t servers, int robot)
+{
+    std::size_t robots = samples.size() / 2;
+    std::vector<std::size_t> order(robots);
+    for(std::size_t i = 0; i < robots; ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return samples[a] < samples[b]; });
+
+    std::vector<double> free_times(servers, -1e300);
+    double last = -1e300;
+    double departure = 0;
+    for(std::size_t i : order)
+    {
+        auto server = std::min_element(free_times.begin(), free_times.end());
+        *server = std::max(samples[i], *server) + samples[robots + i];
+        last = std::max(last, *server);
+        if(static_cast<int>(i) == robot)
+        {
+            departure = *server;
+        }
+    }
+
+    return robot < 0 ? last : departure;
+}
+
+TEST(ContentionQueue, MatchesRandomVariable)
+{
+    // The arrivals are far enough apart that the robots can not overtake each other
+    NRV::NormalRandomVariable a0(0, 0.25), a1(63, 0.5), a2(28, 0.25);
+    NRV::NormalRandomVariable s0(30, 1), s1(2, 0.25), s2(32, 1);
+
+    NRV::ContentionQueue queue;
+    queue.addRobot(a0, s0);
+    queue.addRobot(a1, s1);
+    queue.addRobot(a2, s2);
+    queue.evaluate();
+
+    // Served in the order of the mean arrival times
+    EXPECT_EQ(queue.served(0), 0u);
+    EXPECT_EQ(queue.served(1), 2u);
+    EXPECT_EQ(queue.served(2), 1u);
+
+    NRV::NormalRandomVariable d0 = a0 + s0;
+    NRV::NormalRandomVariable d2 = a2.max(d0) + s2;
+    NRV::NormalRandomVariable d1 = a1.max(d2) + s1;
+    EXPECT_NEAR(queue.departure(0).mean(), d0.mean(), 1e-9);
+    EXPECT_NEAR(queue.start(2).mean(), a2.max(d0).mean(), 1e-9);
+    EXPECT_NEAR(queue.departure(2).variance(), d2.variance(), 1e-9);
+    EXPECT_NEAR(queue.departure(1).mean(), d1.mean(), 1e-9);
+    EXPECT_NEAR(queue.departure(1).variance(), d1.variance(), 1e-9);
+    EXPECT_NEAR(queue.makespan().mean(), d1.mean(), 1e-9);
+
+    // The first robot never waits, and the others wait if the server is free after they arrive
+    EXPECT_EQ(queue.waitProbability(0), 0);
+    EXPECT_EQ(queue.expectedWait(0), 0);
+    EXPECT_FALSE(queue.tryWait(0).ok());
+    EXPECT_THROW(queue.wait(0), std::range_error);
+
+    auto waiting = (d0 - a2).truncateLowerWithMass(0);
+    EXPECT_NEAR(queue.waitProbability(2), waiting.mass, 1e-9);
+    EXPECT_NEAR(queue.wait(2).mean(), waiting.value.mean(), 1e-9);
+    EXPECT_NEAR(queue.expectedWait(2), (d0 - a2).rectifyLower(0).mean(), 1e-9);
+}
+
+TEST(ContentionQueue, MonteCarlo)
+{
+    // Robots whose arrivals overlap with the service of the robot in front of them, but rarely with its arrival
+    std::vector<NRV::NormalRandomVariable> inputs = {
+        NRV::NormalRandomVariable(0, 1), NRV::NormalRandomVariable(5, 1), NRV::NormalRandomVariable(11, 1),
+        NRV::NormalRandomVariable(16, 1), NRV::NormalRandomVariable(4.5, 0.5), NRV::NormalRandomVariable(4, 0.5),
+        NRV::NormalRandomVariable(5, 1), NRV::NormalRandomVariable(2, 0.25)
+    };
+
+    for(std::size_t servers : {1u, 2u})
+    {
+        NRV::ContentionQueue queue(servers);
+        for(std::size_t i = 0; i < 4; ++i)
+        {
+            queue.addRobot(inputs[i], inputs[4 + i]);
+        }
+        queue.evaluate();
+
+        for(int robot = -1; robot < 4; ++robot)
+        {
+            auto sample_output = NRV::MonteCarlo().estimate([&](NRV::SampleView samples) {
+                return simulate(samples, servers, robot);
+            }, inputs, 200000);
+            auto calc_output = robot < 0 ? queue.makespan() : queue.departure(static_cast<std::size_t>(robot));
+
+            EXPECT_NEAR(calc_output.mean(), sample_output.mean(), 0.05) << servers << " servers, robot " << robot;
+            EXPECT_NEAR(calc_output.variance(), sample_output.variance(), 0.1) << servers << " servers, robot " << robot;
+        }
+    }
+}
+
+TEST(ContentionQueue, Overtaking)
+{
+    // Pairs of robots whose arrivals overlap, so either robot of a pair may be served first
+    std::vector<std::vector<NRV::NormalRandomVariable>> stations = {
+        {NRV::NormalRandomVariable(0, 1), NRV::NormalRandomVariable(1, 1), NRV::NormalRandomVariable(6, 1),
+            NRV::NormalRandomVariable(7, 1), NRV::NormalRandomVariable(2, 0.25), NRV::NormalRandomVariable(3, 0.25),
+            NRV::NormalRandomVariable(2, 0.25), NRV::NormalRandomVariable(1, 0.25)},
+        {NRV::NormalRandomVariable(0, 1), NRV::NormalRandomVariable(0.5, 1), NRV::NormalRandomVariable(5, 2),
+            NRV::NormalRandomVariable(5.5, 1), NRV::NormalRandomVariable(2, 0.25), NRV::NormalRandomVariable(3, 0.5),
+            NRV::NormalRandomVariable(2, 0.25), NRV::NormalRandomVariable(1, 0.25)}
+    };
+
+    for(const auto& inputs : stations)
+    {
+        for(std::size_t servers : {1u, 2u})
+        {
+            NRV::ContentionQueue queue(servers);
+            for(std::size_t i = 0; i < 4; ++i)
+            {
+                queue.addRobot(inputs[i], inputs[4 + i]);
+            }
+            queue.evaluate();
+
+            for(int robot = -1; robot < 4; ++robot)
+            {
+                auto sample_output = NRV::MonteCarlo().estimate([&](NRV::SampleView samples) {
+                    return simulate(samples, servers, robot);
+                }, inputs, 200000);
+                auto calc_output = robot < 0 ? queue.makespan() : queue.departure(static_cast<std::size_t>(robot));
+
+                EXPECT_NEAR(calc_output.mean(), sample_output.mean(), 0.1) << servers << " servers, robot " << robot;
+                EXPECT_NEAR(calc_output.variance(), sample_output.variance(), 0.2)
+                        << servers << " servers, robot " << robot;
+            }
+        }
+    }
+}
+
+TEST(ContentionQueue, ManyRobots)
+{
+    // Robots arriving faster than they can be served build up a queue, so the waits grow along it
+    NRV::ContentionQueue queue;
+    queue.reserve(200);
+    for(int i = 0; i < 200; ++i)
+    {
+        queue.addRobot(NRV::NormalRandomVariable(i, 1), NRV::NormalRandomVariable(1.1, 0.01));
+    }
+    queue.evaluate();
+
+    EXPECT_EQ(queue.size(), 200u);
+    for(std::size_t i = 1; i < queue.size(); ++i)
+    {
+        EXPECT_GT(queue.departure(i).mean(), queue.departure(i - 1).mean());
+    }
+    EXPECT_GT(queue.expectedWait(199), queue.expectedWait(100));
+    EXPECT_GT(queue.waitProbability(199), 0.99);
+    EXPECT_NEAR(queue.makespan().mean(), 220, 2);
+
+    // Adding a server removes most of the contention
+    NRV::ContentionQueue two_servers(2);
+    for(int i = 0; i < 200; ++i)
+    {
+        two_servers.addRobot(queue.arrival(static_cast<std::size_t>(i)), queue.service(static_cast<std::size_t>(i)));
+    }
+    two_servers.evaluate();
+    EXPECT_LT(two_servers.expectedWait(199), 0.5);
+    EXPECT_GT(queue.expectedWait(199), 10);
+}
+
+TEST(ContentionQueue, Errors)
+{
+    EXPECT_THROW(NRV::ContentionQueue(0), std::invalid_argument);
+
+    NRV::ContentionQueue queue;
+    EXPECT_THROW(queue.makespan(), std::logic_error);
+    queue.evaluate();
+    EXPECT_THROW(queue.makespan(), std::length_error);
+
+    std::size_t robot = queue.addRobot(NRV::NormalRandomVariable(1, 1), NRV::NormalRandomVariable(2, 1));
+    EXPECT_THROW(queue.departure(robot), std::logic_error);
+    EXPECT_THROW(queue.arrival(1), std::invalid_argument);
+    EXPECT_EQ(queue.tryWait(robot).status, NRV::Status::NotEvaluated);
+    EXPECT_EQ(queue.tryWait(1).status, NRV::Status::OutOfRange);
+
+    queue.evaluate();
+    EXPECT_NO_THROW(queue.departure(robot));
+    EXPECT_NE(queue.tryWait(robot).status, NRV::Status::NotEvaluated);
+    queue.addRobot(NRV::NormalRandomVariable(1, 1), NRV::NormalRandomVariable(2, 1));
+    EXPECT_EQ(queue.tryWait(robot + 1).status, NRV::Status::NotEvaluated);
+    queue.evaluate();
+    queue.setService(robot, NRV::NormalRandomVariable(3, 1));
+    EXPECT_THROW(queue.start(robot), std::logic_error);
+}
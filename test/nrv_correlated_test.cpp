@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "NormalRandomVariable/CorrelatedNormalRandomVariable.h"
+
+/**
+ * Two paths that share their first leg: path1 = leg1 + leg2, path2 = leg1 + leg3
+ */
+struct SharedLegs {
+    NRV::CovarianceStore store;
+    NRV::NormalRandomVariable legs[3] = {NRV::NormalRandomVariable(10, 4), NRV::NormalRandomVariable(5, 1), NRV::NormalRandomVariable(6, 2)};
+};
+
+TEST(Covariance, SharedLegs)
+{
+    SharedLegs paths;
+    auto leg1 = paths.store.add(paths.legs[0]);
+    auto leg2 = paths.store.add(paths.legs[1]);
+    auto leg3 = paths.store.add(paths.legs[2]);
+    auto path1 = leg1 + leg2;
+    auto path2 = leg1 + leg3;
+
+    EXPECT_DOUBLE_EQ(path1.mean(), 15);
+    EXPECT_DOUBLE_EQ(path1.variance(), 5);
+    EXPECT_DOUBLE_EQ(path1.covariance(path2), 4);
+    EXPECT_DOUBLE_EQ(path2.covariance(path1), 4);
+    EXPECT_DOUBLE_EQ(leg2.covariance(leg3), 0);
+    EXPECT_DOUBLE_EQ(path1.correlation(path2), 4 / std::sqrt(5.0 * 6.0));
+
+    // The shared leg cancels out of the difference
+    auto difference = path2 - path1;
+    EXPECT_DOUBLE_EQ(difference.mean(), 1);
+    EXPECT_DOUBLE_EQ(difference.variance(), 3);
+
+    auto scaled = 2 * path1 - 1;
+    EXPECT_DOUBLE_EQ(scaled.mean(), 29);
+    EXPECT_DOUBLE_EQ(scaled.variance(), 20);
+    EXPECT_DOUBLE_EQ(scaled.covariance(path2), 8);
+
+    EXPECT_ANY_THROW(path1 - path1);
+}
+
+TEST(Covariance, MaxMinMatchSampling)
+{
+    SharedLegs paths;
+    auto leg1 = paths.store.add(paths.legs[0]);
+    auto leg2 = paths.store.add(paths.legs[1]);
+    auto leg3 = paths.store.add(paths.legs[2]);
+    auto path1 = leg1 + leg2;
+    auto path2 = leg1 + leg3;
+    auto latest = path1.max(path2);
+    auto earliest = path1.min(path2);
+    auto product = path1 * leg2;
+
+    std::default_random_engine generator;
+    std::vector<std::normal_distribution<double>> distributions;
+    for(const auto& leg : paths.legs)
+    {
+        distributions.push_back(std::normal_distribution<double>(leg.mean(), std::sqrt(leg.variance())));
+    }
+
+    // Sample the mean and variance of each result, and the covariance of the maximum with leg1
+    const int samples = 1000000;
+    double sum[3] = {0, 0, 0}, sum_squared[3] = {0, 0, 0}, sum_max_leg1 = 0, sum_leg1 = 0;
+    for(int i = 0; i < samples; ++i)
+    {
+        double l1 = distributions[0](generator), l2 = distributions[1](generator), l3 = distributions[2](generator);
+        double results[3] = {std::max(l1 + l2, l1 + l3), std::min(l1 + l2, l1 + l3), (l1 + l2) * l2};
+        for(int j = 0; j < 3; ++j)
+        {
+            sum[j] += results[j];
+            sum_squared[j] += results[j] * results[j];
+        }
+        sum_max_leg1 += results[0] * l1;
+        sum_leg1 += l1;
+    }
+
+    NRV::CorrelatedNormalRandomVariable calculated[3] = {latest, earliest, product};
+    for(int j = 0; j < 3; ++j)
+    {
+        double mean = sum[j] / samples;
+        double variance = sum_squared[j] / samples - mean * mean;
+        EXPECT_NEAR(calculated[j].mean(), mean, 0.02 * std::max(1.0, std::abs(mean)));
+        EXPECT_NEAR(calculated[j].variance(), variance, 0.02 * std::max(1.0, variance));
+    }
+
+    double covariance = sum_max_leg1 / samples - (sum[0] / samples) * (sum_leg1 / samples);
+    EXPECT_NEAR(latest.covariance(leg1), covariance, 0.02);
+
+    // Ignoring the correlation overestimates the maximum
+    auto independent = path1.toIndependent().max(path2.toIndependent());
+    EXPECT_GT(independent.mean() - sum[0] / samples, 0.1);
+}
+
+TEST(Covariance, SpecifiedCovariance)
+{
+    NRV::CovarianceStore store;
+    auto x = store.add(NRV::NormalRandomVariable(0, 1));
+    auto y = store.add(NRV::NormalRandomVariable(1, 2), {{x, 0.5}});
+
+    EXPECT_DOUBLE_EQ(y.covariance(x), 0.5);
+    EXPECT_DOUBLE_EQ((x + y).variance(), 4);
+    EXPECT_EQ(store.nonZeros(), 6u);
+
+    NRV::CovarianceStore other;
+    EXPECT_ANY_THROW(x + other.add(NRV::NormalRandomVariable()));
+}
+
+TEST(Covariance, SparseStorage)
+{
+    // Many independent chains of tasks, where each task is only correlated with the earlier tasks in its chain
+    NRV::CovarianceStore store;
+    const int chains = 2000, tasks = 10;
+    std::vector<NRV::CorrelatedNormalRandomVariable> ends;
+    for(int chain = 0; chain < chains; ++chain)
+    {
+        auto time = store.add(NRV::NormalRandomVariable(0, 1));
+        for(int task = 0; task < tasks; ++task)
+        {
+            time = (time + store.add(NRV::NormalRandomVariable(2, 0.5))).max(store.add(NRV::NormalRandomVariable(3 * task, 1)));
+        }
+        ends.push_back(time);
+    }
+
+    EXPECT_EQ(store.size(), static_cast<std::size_t>(chains * (1 + 4 * tasks)));
+    EXPECT_DOUBLE_EQ(ends[0].covariance(ends[1]), 0);
+    EXPECT_GT(ends[0].covariance(store[0]), 0);
+
+    // Each random variable is only correlated with the others in its chain, so the storage grows linearly
+    EXPECT_LT(store.nonZeros(), static_cast<std::size_t>(chains) * (1 + 4 * tasks) * (1 + 4 * tasks));
+
+    // Discarding weak correlations reduces the storage further
+    NRV::CovarianceStore pruned;
+    pruned.setTolerance(0.01);
+    auto time = pruned.add(NRV::NormalRandomVariable(0, 1));
+    for(int task = 0; task < tasks; ++task)
+    {
+        time = (time + pruned.add(NRV::NormalRandomVariable(2, 0.5))).max(pruned.add(NRV::NormalRandomVariable(3 * task, 1)));
+    }
+    EXPECT_LT(pruned.nonZeros(), store.nonZeros() / chains);
+    EXPECT_NEAR(time.mean(), ends[0].mean(), 1e-9);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "NormalRandomVariable/ExpressionGraph.h"
+
+/**
+ * Checks that the random variables are equal to within rounding error
+ */
+void expectNear(const NRV::NormalRandomVariable& result, const NRV::NormalRandomVariable& expected)
+{
+    EXPECT_NEAR(result.mean(), expected.mean(), 1e-12 * std::max(1.0, std::abs(expected.mean())));
+    EXPECT_NEAR(result.variance(), expected.variance(), 1e-12 * std::max(1.0, expected.variance()));
+}
+
+TEST(Evaluation, MatchesRandomVariable)
+{
+    NRV::NormalRandomVariable a(1, 2), b(3, 1), c(2, 0.5), d(8, 4), e(10, 3);
+
+    NRV::ExpressionGraph graph;
+    auto x = graph.input(a), y = graph.input(b), z = graph.input(c), w = graph.input(d), v = graph.input(e);
+
+    expectNear(graph.evaluate(((x + y) * z).max(w).truncateUpper(v)), ((a + b) * c).max(d).truncateUpper(e));
+    expectNear(graph.evaluate((x - y).min(z).rectify(-1, 1)), (a - b).min(c).rectify(-1, 1));
+    expectNear(graph.evaluate(w.truncate(x, v)), d.truncate(a, e));
+    expectNear(graph.evaluate(w.truncateLower(x).rectifyUpper(9)), d.truncateLower(a).rectifyUpper(9));
+    expectNear(graph.evaluate(w.truncate(5, 9).truncateLower(6).rectifyLower(6.5)), d.truncate(5, 9).truncateLower(6).rectifyLower(6.5));
+    expectNear(graph.evaluate(2 * (3 - x * 0.5) + 1), 2 * (3 - a * 0.5) + 1);
+}
+
+TEST(Evaluation, CommonSubexpressions)
+{
+    NRV::ExpressionGraph graph;
+    auto x = graph.input(NRV::NormalRandomVariable(1, 2));
+    auto y = graph.input(NRV::NormalRandomVariable(3, 1));
+
+    auto sum = x + y;
+    EXPECT_EQ((y + x).index(), sum.index());
+    EXPECT_EQ(x.max(y).index(), y.max(x).index());
+    EXPECT_NE((x - y).index(), (y - x).index());
+    EXPECT_EQ(sum.truncateLower(2).index(), sum.truncateLower(2).index());
+
+    EXPECT_EQ(graph.size(), 7u);
+
+    // Scales and offsets are fused with the previous one, so cancel out completely
+    auto scaled = (sum * 2 + 1) * 3 - 4;
+    EXPECT_EQ(((sum * 2) * 0.5).index(), sum.index());
+    EXPECT_EQ((-(-sum)).index(), sum.index());
+    expectNear(graph.evaluate(scaled), (NRV::NormalRandomVariable(1, 2) + NRV::NormalRandomVariable(3, 1)) * 6 - 1);
+}
+
+TEST(Evaluation, ChangeInput)
+{
+    NRV::NormalRandomVariable a(1, 2), b(3, 1);
+
+    NRV::ExpressionGraph graph;
+    auto x = graph.input(a), y = graph.input(b);
+    auto result = (x * y).max(y).truncateLower(0);
+    expectNear(graph.evaluate(result), (a * b).max(b).truncateLower(0));
+
+    a = NRV::NormalRandomVariable(5, 1);
+    graph.set(x, a);
+    expectNear(graph.evaluate(result), (a * b).max(b).truncateLower(0));
+    EXPECT_ANY_THROW(graph.set(result, a));
+}
+
+TEST(Evaluation, Invalid)
+{
+    NRV::ExpressionGraph graph, other;
+    auto x = graph.input(NRV::NormalRandomVariable());
+
+    EXPECT_ANY_THROW(x.truncate(1, 0));
+    EXPECT_ANY_THROW(x + other.input(NRV::NormalRandomVariable()));
+
+    auto zero = x * 0;
+    EXPECT_ANY_THROW(graph.evaluate(zero));
+    EXPECT_EQ(graph.tryEvaluate(zero).status, NRV::Status::InvalidVariance);
+    EXPECT_TRUE(graph.tryEvaluate(x).ok());
+}
+
+TEST(Incremental, OnlyRecalculatesAffectedNodes)
+{
+    // Two independent chains of tasks, where the arrival time at each task is the maximum of the arrival time at the
+    // previous task and the time the task becomes available, plus the duration of the task
+    NRV::ExpressionGraph graph;
+    std::vector<NRV::Expression> available, arrival;
+    for(int chain = 0; chain < 2; ++chain)
+    {
+        auto time = graph.input(NRV::NormalRandomVariable(0, 1));
+        for(int task = 0; task < 10; ++task)
+        {
+            available.push_back(graph.input(NRV::NormalRandomVariable(5 * task, 1 + task)));
+            time = time.max(available.back()) + 3;
+            arrival.push_back(time);
+        }
+    }
+
+    // Evaluating everything calculates each max and addition once
+    for(const auto& time : arrival)
+    {
+        graph.evaluate(time);
+    }
+    EXPECT_EQ(graph.calculations(), 40u);
+
+    // Changing the 8th task of the first chain only recalculates the last 3 tasks of that chain
+    graph.set(available[7], NRV::NormalRandomVariable(40, 2));
+    for(const auto& time : arrival)
+    {
+        graph.evaluate(time);
+    }
+    EXPECT_EQ(graph.calculations(), 46u);
+
+    // Setting the same value does not recalculate anything, and only the requested result is calculated
+    graph.set(available[7], NRV::NormalRandomVariable(40, 2));
+    graph.set(available[2], NRV::NormalRandomVariable(12, 2));
+    graph.evaluate(arrival[3]);
+    EXPECT_EQ(graph.calculations(), 50u);
+
+    // The result matches calculating the whole chain from scratch
+    NRV::NormalRandomVariable expected(0, 1);
+    for(int task = 0; task < 10; ++task)
+    {
+        NRV::NormalRandomVariable task_available = task == 7 ? NRV::NormalRandomVariable(40, 2) :
+                (task == 2 ? NRV::NormalRandomVariable(12, 2) : NRV::NormalRandomVariable(5 * task, 1 + task));
+        expected = expected.max(task_available) + 3;
+    }
+    expectNear(graph.evaluate(arrival[9]), expected);
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "NormalRandomVariable/NormalRandomVariable.h"
+#include "NormalRandomVariable/Gradient.h"
+
+namespace {
+
+typedef std::function<NRV::NormalRandomVariable(const std::vector<double>&)> Operation;
+
+/**
+ * Checks the partial derivatives against central finite differences of operation at inputs
+ */
+template<std::size_t N>
+void expectPartials(const NRV::WithGradient<double, N>& gradient, const Operation& operation, const std::vector<double>& inputs)
+{
+    NRV::NormalRandomVariable value = operation(inputs);
+    EXPECT_EQ(gradient.value.mean(), value.mean());
+    EXPECT_EQ(gradient.value.variance(), value.variance());
+
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        double step = 1e-6 * std::max(1.0, std::abs(inputs[i]));
+        std::vector<double> above = inputs;
+        std::vector<double> below = inputs;
+        above[i] += step;
+        below[i] -= step;
+        NRV::NormalRandomVariable upper = operation(above);
+        NRV::NormalRandomVariable lower = operation(below);
+
+        double mean = (upper.mean() - lower.mean()) / (2 * step);
+        double variance = (upper.variance() - lower.variance()) / (2 * step);
+        EXPECT_NEAR(gradient.partials[i].mean, mean, 1e-6 * std::max(1.0, std::abs(mean))) << "input " << i;
+        EXPECT_NEAR(gradient.partials[i].variance, variance, 1e-6 * std::max(1.0, std::abs(variance))) << "input " << i;
+    }
+}
+
+NRV::NormalRandomVariable rv(const std::vector<double>& inputs, std::size_t index)
+{
+    return NRV::NormalRandomVariable(inputs[index], inputs[index + 1]);
+}
+
+} // namespace
+
+TEST(Gradient, MaxAndMin)
+{
+    Operation max = [](const std::vector<double>& x) { return rv(x, 0).max(rv(x, 2)); };
+    Operation min = [](const std::vector<double>& x) { return rv(x, 0).min(rv(x, 2)); };
+
+    for(const std::vector<double>& inputs : {std::vector<double>{1, 2, 1.5, 0.5}, std::vector<double>{-3, 4, 2, 9}})
+    {
+        NRV::NormalRandomVariable a(inputs[0], inputs[1]), b(inputs[2], inputs[3]);
+        expectPartials(NRV::maxWithGradient(a, b), max, inputs);
+        expectPartials(NRV::minWithGradient(a, b), min, inputs);
+    }
+}
+
+TEST(Gradient, Arithmetic)
+{
+    Operation multiply = [](const std::vector<double>& x) { return rv(x, 0) * rv(x, 2); };
+    Operation divide = [](const std::vector<double>& x) { return rv(x, 0) / rv(x, 2); };
+    Operation inverse = [](const std::vector<double>& x) { return rv(x, 0).inverse(); };
+
+    NRV::NormalRandomVariable a(2, 3), b(-5, 0.5);
+    expectPartials(NRV::multiplyWithGradient(a, b), multiply, {2, 3, -5, 0.5});
+    expectPartials(NRV::inverseWithGradient(b), inverse, {-5, 0.5});
+
+    // Both approximations of division
+    expectPartials(NRV::divideWithGradient(a, b), divide, {2, 3, -5, 0.5});
+    expectPartials(NRV::divideWithGradient(NRV::NormalRandomVariable(20, 1), b), divide, {20, 1, -5, 0.5});
+
+    EXPECT_THROW(NRV::inverseWithGradient(a), std::range_error);
+}
+
+TEST(Gradient, Rectify)
+{
+    Operation rectify = [](const std::vector<double>& x) { return rv(x, 0).rectify(x[2], x[3]); };
+    Operation rectify_lower = [](const std::vector<double>& x) { return rv(x, 0).rectifyLower(x[2]); };
+    Operation rectify_upper = [](const std::vector<double>& x) { return rv(x, 0).rectifyUpper(x[2]); };
+
+    NRV::NormalRandomVariable a(1, 4);
+    expectPartials(NRV::rectifyWithGradient(a, -0.5, 3), rectify, {1, 4, -0.5, 3});
+    expectPartials(NRV::rectifyLowerWithGradient(a, 0.5), rectify_lower, {1, 4, 0.5});
+    expectPartials(NRV::rectifyUpperWithGradient(a, 2), rectify_upper, {1, 4, 2});
+
+    EXPECT_THROW(NRV::rectifyWithGradient(a, 3, 1), std::range_error);
+}
+
+TEST(Gradient, Truncate)
+{
+    Operation truncate = [](const std::vector<double>& x) { return rv(x, 0).truncate(x[2], x[3]); };
+    Operation truncate_lower = [](const std::vector<double>& x) { return rv(x, 0).truncateLower(x[2]); };
+    Operation truncate_upper = [](const std::vector<double>& x) { return rv(x, 0).truncateUpper(x[2]); };
+
+    NRV::NormalRandomVariable a(1, 4);
+    expectPartials(NRV::truncateWithGradient(a, -0.5, 3), truncate, {1, 4, -0.5, 3});
+    expectPartials(NRV::truncateLowerWithGradient(a, 2), truncate_lower, {1, 4, 2});
+    expectPartials(NRV::truncateUpperWithGradient(a, 0), truncate_upper, {1, 4, 0});
+
+    EXPECT_THROW(NRV::truncateWithGradient(a, 3, 1), std::range_error);
+}
+
+TEST(Gradient, TruncateByRandomVariables)
+{
+    Operation truncate = [](const std::vector<double>& x) { return rv(x, 0).truncate(rv(x, 2), rv(x, 4)); };
+    Operation truncate_lower = [](const std::vector<double>& x) { return rv(x, 0).truncateLower(rv(x, 2)); };
+    Operation truncate_upper = [](const std::vector<double>& x) { return rv(x, 0).truncateUpper(rv(x, 2)); };
+
+    NRV::NormalRandomVariable a(1, 4);
+    expectPartials(NRV::truncateLowerWithGradient(a, NRV::NormalRandomVariable(2, 0.5)), truncate_lower, {1, 4, 2, 0.5});
+    expectPartials(NRV::truncateUpperWithGradient(a, NRV::NormalRandomVariable(0, 1)), truncate_upper, {1, 4, 0, 1});
+
+    // Bounds that are applied together, lower first and upper first
+    for(const std::vector<double>& inputs : {std::vector<double>{1, 4, -2, 0.5, 5, 1},
+                                             std::vector<double>{1, 4, 0.5, 2, 1.5, 1.5},
+                                             std::vector<double>{1, 4, -1.5, 1.5, -0.5, 2}})
+    {
+        NRV::NormalRandomVariable lower(inputs[2], inputs[3]), upper(inputs[4], inputs[5]);
+        expectPartials(NRV::truncateWithGradient(a, lower, upper), truncate, inputs);
+    }
+}
+
+TEST(Gradient, Dual)
+{
+    NRV::Dual x = NRV::Dual::parameter(3, 0, 2);
+    NRV::Dual y = NRV::Dual::parameter(2, 1, 2);
+
+    NRV::Dual z = x * y - x / y + NRV::Dual(1);
+    EXPECT_EQ(z.value(), 3 * 2 - 1.5 + 1);
+    EXPECT_DOUBLE_EQ(z.tangent(0), 2 - 0.5);
+    EXPECT_DOUBLE_EQ(z.tangent(1), 3 + 3.0 / 4);
+    EXPECT_EQ(NRV::Dual(5).tangent(1), 0);
+    EXPECT_THROW(NRV::Dual::parameter(1, 2, 2), std::out_of_range);
+}
+
+TEST(Gradient, DualNormalRandomVariable)
+{
+    // Makespan of 2 parallel tasks that depart at times that are parameters 0 and 1, truncated by a deadline that is
+    // parameter 2, with the derivatives of the whole calculation in one pass
+    auto makespan = [](const NRV::Dual& departure1, const NRV::Dual& departure2, const NRV::Dual& deadline) {
+        NRV::DualNormalRandomVariable task1 = NRV::DualNormalRandomVariable(NRV::NormalRandomVariable(4, 1)) + departure1;
+        NRV::DualNormalRandomVariable task2 = NRV::DualNormalRandomVariable(NRV::NormalRandomVariable(3, 2)) + departure2;
+        return (task1.max(task2) * 2.0).truncateUpper(deadline);
+    };
+
+    std::vector<double> parameters = {1, 2, 14};
+    NRV::DualNormalRandomVariable result = makespan(NRV::Dual::parameter(parameters[0], 0, 3),
+            NRV::Dual::parameter(parameters[1], 1, 3), NRV::Dual::parameter(parameters[2], 2, 3));
+
+    for(std::size_t i = 0; i < parameters.size(); ++i)
+    {
+        std::vector<double> above = parameters;
+        std::vector<double> below = parameters;
+        above[i] += 1e-6;
+        below[i] -= 1e-6;
+        NRV::NormalRandomVariable upper = makespan(above[0], above[1], above[2]).value();
+        NRV::NormalRandomVariable lower = makespan(below[0], below[1], below[2]).value();
+
+        EXPECT_NEAR(result.mean().tangent(i), (upper.mean() - lower.mean()) / 2e-6, 1e-6);
+        EXPECT_NEAR(result.variance().tangent(i), (upper.variance() - lower.variance()) / 2e-6, 1e-6);
+    }
+
+    EXPECT_THROW(NRV::DualNormalRandomVariable(NRV::Dual(1), NRV::Dual(0)), std::range_error);
+}
+
+TEST(Gradient, Precision)
+{
+    NRV::BasicNormalRandomVariable<float> a(1, 4), b(1.5f, 0.5f);
+    auto gradient = NRV::maxWithGradient(a, b);
+    auto expected = NRV::maxWithGradient(NRV::NormalRandomVariable(1, 4), NRV::NormalRandomVariable(1.5, 0.5));
+    for(std::size_t i = 0; i < 4; ++i)
+    {
+        EXPECT_NEAR(gradient.partials[i].mean, expected.partials[i].mean, 1e-5);
+        EXPECT_NEAR(gradient.partials[i].variance, expected.partials[i].variance, 1e-5);
+    }
+}
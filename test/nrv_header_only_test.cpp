@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include "NormalRandomVariable/NormalRandomVariable.h"
+
+// Note: This test only links against the header-only target, so it can only use the operations defined in the header
+
+TEST(ConstantExpression, Instantiation)
+{
+    constexpr NRV::NormalRandomVariable standard;
+    static_assert(standard.mean() == 0, "Standard normal distribution should have a mean of 0");
+    static_assert(standard.variance() == 1, "Standard normal distribution should have a variance of 1");
+
+    constexpr NRV::NormalRandomVariable rv(1, 2);
+    static_assert(rv.mean() == 1, "Mean should be available at compile time");
+    static_assert(rv.variance() == 2, "Variance should be available at compile time");
+}
+
+TEST(ConstantExpression, Arithmetic)
+{
+    constexpr NRV::NormalRandomVariable rv1(1, 2);
+    constexpr NRV::NormalRandomVariable rv2(3, 4);
+    constexpr auto result = -(2 * (rv1 + 3) - 1) / 2 + (rv2 - rv1) * 0.5 - (1 - rv2);
+    static_assert(result.mean() == -3.5 + 1 + 2, "Arithmetic should be evaluated at compile time");
+    static_assert(result.variance() == 2 + 1.5 + 4, "Arithmetic should be evaluated at compile time");
+
+    EXPECT_DOUBLE_EQ(result.mean(), -0.5);
+    EXPECT_DOUBLE_EQ(result.variance(), 7.5);
+}
+
+TEST(RuntimeValidation, InvalidVariance)
+{
+    // Outside of a constant expression, an invalid variance still throws an exception
+    double variance = 0;
+    EXPECT_ANY_THROW(NRV::NormalRandomVariable(1, variance));
+    EXPECT_ANY_THROW(NRV::NormalRandomVariable(1, 1) * 0);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "NormalRandomVariable/NormalRandomVariable.h"
+#include "NormalRandomVariable/Instrumentation.h"
+
+TEST(Instrumentation, CallsBranchesAndExceptions)
+{
+    NRV::resetInstrumentation();
+
+    NRV::NormalRandomVariable rv(1, 2), other(2, 0.5), far_from_zero(20, 1);
+    for(int i = 0; i < 100; ++i)
+    {
+        rv.max(other);
+    }
+    rv.truncate(NRV::NormalRandomVariable(-5, 1), NRV::NormalRandomVariable(5, 1));
+    rv.truncate(NRV::NormalRandomVariable(0, 1.2), NRV::NormalRandomVariable(1, 1));
+    NRV::NormalRandomVariable(1, 3) / far_from_zero;
+    NRV::NormalRandomVariable(30, 1) / far_from_zero;
+    EXPECT_THROW(rv.inverse(), std::range_error);
+    EXPECT_THROW(rv.truncate(2, 1), std::range_error);
+
+    NRV::InstrumentationSnapshot snapshot = NRV::instrumentationSnapshot();
+    if(!NRV::instrumentationEnabled())
+    {
+        // Nothing is counted
+        for(const NRV::OperationCounters& counters : snapshot.operations)
+        {
+            EXPECT_EQ(counters.calls, 0u);
+            EXPECT_EQ(counters.sampled_calls, 0u);
+        }
+        for(std::uint64_t count : snapshot.branches)
+        {
+            EXPECT_EQ(count, 0u);
+        }
+        return;
+    }
+
+    EXPECT_EQ(snapshot[NRV::InstrumentedOperation::Max].calls, 100u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedOperation::Max].exceptions, 0u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedOperation::TruncateBy].calls, 2u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedBranch::TruncateTogether], 1u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedBranch::TruncateLowerFirst], 1u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedBranch::TruncateUpperFirst], 0u);
+
+    // The second division multiplies by the inverse, which counts both of those operations
+    EXPECT_EQ(snapshot[NRV::InstrumentedOperation::Divide].calls, 2u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedBranch::DivideClosedForm], 1u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedBranch::DivideByInverse], 1u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedOperation::Multiply].calls, 1u);
+
+    EXPECT_EQ(snapshot[NRV::InstrumentedOperation::Inverse].calls, 2u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedOperation::Inverse].exceptions, 1u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedBranch::InverseOutOfRange], 1u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedOperation::Truncate].exceptions, 1u);
+
+    // One in every sample period operations is timed
+    std::uint64_t calls = 0;
+    std::uint64_t sampled_calls = 0;
+    for(const NRV::OperationCounters& counters : snapshot.operations)
+    {
+        calls += counters.calls;
+        sampled_calls += counters.sampled_calls;
+        EXPECT_LE(counters.sampled_calls, counters.calls);
+        EXPECT_EQ(counters.sampled_calls == 0, counters.sampled_ticks == 0);
+    }
+    EXPECT_EQ(sampled_calls, calls / NRV::instrumentation_sample_period);
+
+    NRV::resetInstrumentation();
+    snapshot = NRV::instrumentationSnapshot();
+    EXPECT_EQ(snapshot[NRV::InstrumentedOperation::Max].calls, 0u);
+    EXPECT_EQ(snapshot[NRV::InstrumentedBranch::TruncateTogether], 0u);
+}
+
+TEST(Instrumentation, Threads)
+{
+    NRV::resetInstrumentation();
+
+    // Counts of threads that have exited are kept
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([] {
+            NRV::NormalRandomVariable rv(1, 2);
+            for(int i = 0; i < 1000; ++i)
+            {
+                rv.truncateUpper(3);
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::uint64_t expected = NRV::instrumentationEnabled() ? 4000 : 0;
+    EXPECT_EQ(NRV::instrumentationSnapshot()[NRV::InstrumentedOperation::TruncateUpper].calls, expected);
+
+    NRV::resetInstrumentation();
+    EXPECT_EQ(NRV::instrumentationSnapshot()[NRV::InstrumentedOperation::TruncateUpper].calls, 0u);
+}
+
+TEST(Instrumentation, Names)
+{
+    EXPECT_STREQ(NRV::instrumentationName(NRV::InstrumentedOperation::TruncateLowerBy), "truncateLowerBy");
+    EXPECT_STREQ(NRV::instrumentationName(NRV::InstrumentedOperation::DivideConstant), "divideConstant");
+    EXPECT_STREQ(NRV::instrumentationName(NRV::InstrumentedBranch::TruncateUpperFirst), "truncateUpperFirst");
+}
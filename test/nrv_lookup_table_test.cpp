@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "NormalRandomVariable/NormalRandomVariable.h"
+#include "NormalRandomVariable/NormalRandomVariableArray.h"
+#include "NormalRandomVariable/LookupTable.h"
+
+/**
+ * Results of the operations that use the lookup table for a range of inputs
+ */
+std::vector<NRV::NormalRandomVariable> results()
+{
+    std::vector<NRV::NormalRandomVariable> results;
+    for(double mean = -2; mean <= 2; mean += 0.37)
+    {
+        for(double variance : {0.5, 1.0, 5.0})
+        {
+            NRV::NormalRandomVariable rv(mean, variance);
+            results.push_back(rv.truncate(-1, 2));
+            results.push_back(rv.truncateLower(-1));
+            results.push_back(rv.truncateUpper(2));
+            results.push_back(rv.rectify(-1, 2));
+            results.push_back(rv.rectifyLower(-1));
+            results.push_back(rv.rectifyUpper(2));
+            results.push_back(rv.truncateLower(NRV::NormalRandomVariable(-1, 0.5)));
+            results.push_back(rv.truncate(NRV::NormalRandomVariable(-3, 0.5), NRV::NormalRandomVariable(3, 0.5)));
+            results.push_back(rv.truncate(NRV::NormalRandomVariable(0, 1.2), NRV::NormalRandomVariable(1, 1)));
+        }
+    }
+
+    return results;
+}
+
+TEST(LookupTable, Accuracy)
+{
+    auto exact = results();
+
+    for(double max_error : {1e-4, 1e-7, 1e-10})
+    {
+        double error = NRV::enableLookupTable(max_error);
+        EXPECT_GT(error, 0);
+        EXPECT_LE(error, max_error);
+        EXPECT_EQ(NRV::lookupTableError(), error);
+
+        auto tabulated = results();
+        NRV::disableLookupTable();
+
+        // The error in the results is magnified by the division in truncation, so allow for that
+        for(std::size_t i = 0; i < exact.size(); ++i)
+        {
+            EXPECT_NEAR(tabulated[i].mean(), exact[i].mean(), 1000 * max_error * std::max(1.0, std::abs(exact[i].mean())));
+            EXPECT_NEAR(tabulated[i].variance(), exact[i].variance(), 1000 * max_error * std::max(1.0, exact[i].variance()));
+        }
+    }
+
+    EXPECT_EQ(NRV::lookupTableError(), 0);
+
+    // Switching back gives the exact results again
+    auto again = results();
+    for(std::size_t i = 0; i < exact.size(); ++i)
+    {
+        EXPECT_EQ(again[i].mean(), exact[i].mean());
+        EXPECT_EQ(again[i].variance(), exact[i].variance());
+    }
+}
+
+TEST(LookupTable, Coarser)
+{
+    // A larger error allows a coarser table
+    double fine = NRV::enableLookupTable(1e-12);
+    double coarse = NRV::enableLookupTable(1e-3);
+    NRV::disableLookupTable();
+
+    EXPECT_LT(fine, coarse);
+}
+
+TEST(LookupTable, InvalidError)
+{
+    EXPECT_ANY_THROW(NRV::enableLookupTable(0));
+    EXPECT_ANY_THROW(NRV::enableLookupTable(-1));
+    EXPECT_ANY_THROW(NRV::enableLookupTable(1e-20));
+    EXPECT_EQ(NRV::lookupTableError(), 0);
+}
+
+TEST(LookupTable, Arrays)
+{
+    // Arrays of float are not vectorised, so use the table
+    NRV::BasicNormalRandomVariableArray<float> rv({-1.0f, 0.0f, 3.0f}, {1.0f, 2.0f, 0.5f});
+    auto exact = rv.truncate(-0.5f, 1.5f);
+
+    NRV::enableLookupTable(1e-6);
+    auto tabulated = rv.truncate(-0.5f, 1.5f);
+    NRV::disableLookupTable();
+
+    for(std::size_t i = 0; i < rv.size(); ++i)
+    {
+        EXPECT_NEAR(tabulated[i].mean(), exact[i].mean(), 1e-4);
+        EXPECT_NEAR(tabulated[i].variance(), exact[i].variance(), 1e-4);
+    }
+}
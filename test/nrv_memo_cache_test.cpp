@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "NormalRandomVariable/NormalRandomVariable.h"
+#include "NormalRandomVariable/MemoCache.h"
+#include "NormalRandomVariable/LookupTable.h"
+
+TEST(MemoCache, HitsAndMisses)
+{
+    NRV::NormalRandomVariable rv(1, 2), deadline(3, 0.5);
+    auto expected_max = rv.max(deadline);
+    auto expected_truncation = rv.truncateUpper(deadline);
+
+    NRV::enableMemoCache(1024);
+    for(int i = 0; i < 10; ++i)
+    {
+        auto latest = rv.max(deadline);
+        auto truncated = rv.truncateUpper(deadline);
+        EXPECT_EQ(latest.mean(), expected_max.mean());
+        EXPECT_EQ(latest.variance(), expected_max.variance());
+        EXPECT_EQ(truncated.mean(), expected_truncation.mean());
+        EXPECT_EQ(truncated.variance(), expected_truncation.variance());
+    }
+
+    auto statistics = NRV::memoCacheStatistics();
+    EXPECT_EQ(statistics.misses, 2u);
+    EXPECT_EQ(statistics.hits, 18u);
+
+    // The same operands with a different operation, or different operands, are separate results
+    EXPECT_EQ(rv.min(deadline).mean(), NRV::NormalRandomVariable(1, 2).min(deadline).mean());
+    EXPECT_NE(rv.truncateLower(deadline).mean(), expected_truncation.mean());
+    EXPECT_NE(rv.truncateUpper(NRV::NormalRandomVariable(3, 0.6)).mean(), expected_truncation.mean());
+    statistics = NRV::memoCacheStatistics();
+    EXPECT_EQ(statistics.misses, 5u);
+    EXPECT_EQ(statistics.hits, 19u);
+
+    NRV::clearMemoCache();
+    statistics = NRV::memoCacheStatistics();
+    EXPECT_EQ(statistics.hits, 0u);
+    EXPECT_EQ(statistics.misses, 0u);
+    rv.max(deadline);
+    EXPECT_EQ(NRV::memoCacheStatistics().misses, 1u);
+
+    NRV::disableMemoCache();
+    rv.max(deadline);
+    EXPECT_EQ(NRV::memoCacheStatistics().misses, 1u);
+}
+
+TEST(MemoCache, Bounded)
+{
+    // Many more distinct operations than the capacity still give the correct results (compared to the try
+    // versions, which are not cached), with older results being replaced
+    NRV::enableMemoCache(64);
+    for(int repeat = 0; repeat < 2; ++repeat)
+    {
+        for(int i = 0; i < 1000; ++i)
+        {
+            NRV::NormalRandomVariable rv(i * 0.001, 1);
+            EXPECT_EQ(rv.truncate(-1, 1).mean(), rv.tryTruncate(-1, 1).value.mean());
+        }
+    }
+
+    auto statistics = NRV::memoCacheStatistics();
+    EXPECT_EQ(statistics.hits + statistics.misses, 2000u);
+    EXPECT_GT(statistics.misses, 1000u);
+    NRV::disableMemoCache();
+
+    EXPECT_ANY_THROW(NRV::enableMemoCache(0));
+    EXPECT_THROW(NRV::enableMemoCache(15), std::invalid_argument);
+    EXPECT_NO_THROW(NRV::enableMemoCache(16));
+    NRV::disableMemoCache();
+}
+
+TEST(MemoCache, LookupTableClears)
+{
+    NRV::NormalRandomVariable rv(0, 1);
+    NRV::enableMemoCache();
+    auto exact = rv.truncate(-1.1, 1.3);
+
+    // Cached exact results are not returned once the lookup table is enabled
+    NRV::enableLookupTable(1e-4);
+    auto tabulated = rv.truncate(-1.1, 1.3);
+    NRV::disableLookupTable();
+    EXPECT_NE(exact.variance(), tabulated.variance());
+    EXPECT_EQ(NRV::memoCacheStatistics().hits, 0u);
+
+    NRV::disableMemoCache();
+}
+
+TEST(MemoCache, Threads)
+{
+    NRV::enableMemoCache(4096);
+
+    // Threads repeatedly calculate an overlapping set of operations
+    std::vector<std::thread> threads;
+    std::vector<int> errors(4, 0);
+    for(int thread = 0; thread < 4; ++thread)
+    {
+        threads.emplace_back([thread, &errors] {
+            for(int repeat = 0; repeat < 100; ++repeat)
+            {
+                for(int i = 0; i < 50; ++i)
+                {
+                    NRV::NormalRandomVariable rv((i + thread) * 0.1, 1);
+                    auto result = rv.max(NRV::NormalRandomVariable(2, 0.5));
+                    auto expected = NRV::NormalRandomVariable((i + thread) * 0.1, 1).tryTruncate(NRV::NormalRandomVariable(2, 0.5), NRV::NormalRandomVariable(2.5, 0.5));
+                    auto truncated = rv.truncate(NRV::NormalRandomVariable(2, 0.5), NRV::NormalRandomVariable(2.5, 0.5));
+                    if(result.mean() < 2 || truncated.mean() != expected.value.mean())
+                    {
+                        ++errors[thread];
+                    }
+                }
+            }
+        });
+    }
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for(int error : errors)
+    {
+        EXPECT_EQ(error, 0);
+    }
+
+    auto statistics = NRV::memoCacheStatistics();
+    EXPECT_EQ(statistics.hits + statistics.misses, 4u * 100 * 50 * 2);
+    EXPECT_GT(statistics.hits, statistics.misses);
+    NRV::disableMemoCache();
+}
@@ -0,0 +1,336 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+#endif
+
+#include "NormalRandomVariable/ContentionQueue.h"
+#include "NormalRandomVariable/ExpressionGraph.h"
+#include "NormalRandomVariable/MemoryResource.h"
+#include "NormalRandomVariable/Parallel.h"
+#include "NormalRandomVariable/TaskNetwork.h"
+
+/**
+ * Resource that counts the allocations and deallocations made through it
+ */
+class CountingResource : public NRV::MemoryResource {
+public:
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+
+private:
+    void* doAllocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocations;
+        return NRV::defaultMemoryResource()->allocate(bytes, alignment);
+    }
+
+    void doDeallocate(void* pointer, std::size_t bytes, std::size_t alignment) noexcept override
+    {
+        ++deallocations;
+        NRV::defaultMemoryResource()->deallocate(pointer, bytes, alignment);
+    }
+};
+
+/**
+ * Records a graph with inputs, shared subexpressions and each kind of operation, and returns its result
+ */
+NRV::NormalRandomVariable evaluateGraph(NRV::ExpressionGraph& graph, std::size_t size)
+{
+    auto result = graph.input(NRV::NormalRandomVariable(0, 1));
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        auto x = graph.input(NRV::NormalRandomVariable(double(i % 7), 1 + double(i % 3)));
+        auto y = (x + result) * 0.5;
+        result = y.max(x + result * 0.5).truncateLower(-10.0 - double(i)).rectify(-100, 100) + y;
+    }
+
+    return graph.evaluate(result);
+}
+
+TEST(Arena, AllocatesAligned)
+{
+    CountingResource upstream;
+    NRV::Arena arena(1024, &upstream);
+
+    std::vector<void*> pointers;
+    for(std::size_t i = 0; i < 100; ++i)
+    {
+        std::size_t alignment = std::size_t(1) << (i % 8);
+        void* pointer = arena.allocate(1 + i % 37, alignment);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(pointer) % alignment, 0u);
+        pointers.push_back(pointer);
+    }
+    std::size_t allocations = upstream.allocations;
+    EXPECT_GT(arena.used(), 0u);
+    EXPECT_GE(arena.capacity(), arena.used());
+
+    // Reset reuses the blocks, so the same allocations give the same memory
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    for(std::size_t i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(arena.allocate(1 + i % 37, std::size_t(1) << (i % 8)), pointers[i]);
+    }
+    EXPECT_EQ(upstream.allocations, allocations);
+
+    // Allocations larger than a block get their own block
+    void* large = arena.allocate(100000, 64);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large) % 64, 0u);
+    EXPECT_GE(arena.capacity(), 100000u);
+
+    arena.release();
+    EXPECT_EQ(arena.capacity(), 0u);
+    EXPECT_EQ(upstream.deallocations, upstream.allocations);
+}
+
+TEST(Arena, DefaultResourceAligned)
+{
+    NRV::MemoryResource* resource = NRV::defaultMemoryResource();
+    for(std::size_t alignment : {std::size_t(8), std::size_t(64), std::size_t(4096)})
+    {
+        void* pointer = resource->allocate(100, alignment);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(pointer) % alignment, 0u);
+        resource->deallocate(pointer, 100, alignment);
+    }
+}
+
+TEST(ExpressionGraph, ArenaMatchesDefault)
+{
+    NRV::ExpressionGraph expected;
+    NRV::NormalRandomVariable expected_result = evaluateGraph(expected, 500);
+
+    NRV::Arena arena;
+    for(int cycle = 0; cycle < 3; ++cycle)
+    {
+        NRV::ExpressionGraph graph(&arena);
+        NRV::NormalRandomVariable result = evaluateGraph(graph, 500);
+        EXPECT_EQ(result.mean(), expected_result.mean());
+        EXPECT_EQ(result.variance(), expected_result.variance());
+        EXPECT_EQ(graph.size(), expected.size());
+        EXPECT_EQ(graph.calculations(), expected.calculations());
+        arena.reset();
+    }
+}
+
+TEST(ExpressionGraph, ClearDoesNotAllocate)
+{
+    CountingResource resource;
+    NRV::ExpressionGraph graph(&resource);
+    NRV::NormalRandomVariable expected = evaluateGraph(graph, 1000);
+    std::size_t size = graph.size();
+
+    std::size_t allocations = resource.allocations;
+    for(int cycle = 0; cycle < 3; ++cycle)
+    {
+        graph.clear();
+        EXPECT_EQ(graph.size(), 0u);
+        EXPECT_EQ(graph.calculations(), 0u);
+
+        NRV::NormalRandomVariable result = evaluateGraph(graph, 1000);
+        EXPECT_EQ(result.mean(), expected.mean());
+        EXPECT_EQ(result.variance(), expected.variance());
+        EXPECT_EQ(graph.size(), size);
+    }
+    EXPECT_EQ(resource.allocations, allocations);
+
+    // Reserving the storage up front avoids allocating while recording
+    CountingResource reserved_resource;
+    NRV::ExpressionGraph reserved(&reserved_resource);
+    reserved.reserve(size);
+    allocations = reserved_resource.allocations;
+    evaluateGraph(reserved, 1000);
+    EXPECT_EQ(reserved_resource.allocations, allocations);
+}
+
+TEST(TaskNetwork, ClearDoesNotAllocate)
+{
+    CountingResource resource;
+    NRV::TaskNetwork network(1, &resource);
+    NRV::TaskNetwork expected(1);
+
+    std::size_t allocations = 0;
+    for(int cycle = 0; cycle < 4; ++cycle)
+    {
+        network.clear();
+        for(NRV::TaskNetwork* n : {&network, &expected})
+        {
+            if(n == &expected && cycle > 0)
+            {
+                continue;
+            }
+
+            for(std::size_t task = 0; task < 500; ++task)
+            {
+                n->addTask(NRV::NormalRandomVariable(1 + double(task % 5), 0.5));
+                if(task >= 3)
+                {
+                    n->addDependency(task - 3, task);
+                    n->addDependency(task / 2, task);
+                }
+            }
+            n->evaluate();
+        }
+
+        EXPECT_EQ(network.levels(), expected.levels());
+        EXPECT_EQ(network.completion(499).mean(), expected.completion(499).mean());
+        EXPECT_EQ(network.completion(499).variance(), expected.completion(499).variance());
+        if(cycle == 0)
+        {
+            allocations = resource.allocations;
+        }
+    }
+    EXPECT_EQ(resource.allocations, allocations);
+}
+
+TEST(TaskNetwork, ParallelLevelsReuseStorage)
+{
+    CountingResource resource;
+    NRV::TaskNetwork network(3, &resource);
+    NRV::TaskNetwork expected(1);
+    for(NRV::TaskNetwork* n : {&network, &expected})
+    {
+        // 2 levels of 3000 tasks, which are split into chunks on 3 threads
+        for(std::size_t task = 0; task < 6000; ++task)
+        {
+            n->addTask(NRV::NormalRandomVariable(1 + double(task % 7), 0.5));
+            if(task >= 3000)
+            {
+                for(std::size_t predecessor : {task - 3000, (task * 7) % 3000, (task * 13) % 3000})
+                {
+                    n->addDependency(predecessor, task);
+                }
+            }
+        }
+    }
+    expected.evaluate();
+
+    std::size_t allocations = 0;
+    for(int cycle = 0; cycle < 3; ++cycle)
+    {
+        network.setDuration(cycle, NRV::NormalRandomVariable(2, 0.5));
+        expected.setDuration(cycle, NRV::NormalRandomVariable(2, 0.5));
+        network.evaluate();
+        expected.evaluate();
+        EXPECT_EQ(network.completion(5999).mean(), expected.completion(5999).mean());
+        EXPECT_EQ(network.completion(5999).variance(), expected.completion(5999).variance());
+        if(cycle == 0)
+        {
+            allocations = resource.allocations;
+        }
+    }
+    EXPECT_EQ(resource.allocations, allocations);
+}
+
+TEST(ContentionQueue, ClearDoesNotAllocate)
+{
+    CountingResource resource;
+    NRV::ContentionQueue queue(3, &resource);
+
+    std::size_t allocations = 0;
+    double departure = 0;
+    for(int cycle = 0; cycle < 4; ++cycle)
+    {
+        queue.clear();
+        for(std::size_t robot = 0; robot < 200; ++robot)
+        {
+            queue.addRobot(NRV::NormalRandomVariable(double(robot % 50), 4), NRV::NormalRandomVariable(2, 0.25));
+        }
+        queue.evaluate();
+
+        if(cycle == 0)
+        {
+            allocations = resource.allocations;
+            departure = queue.departure(199).mean();
+        }
+        EXPECT_EQ(queue.departure(199).mean(), departure);
+    }
+    EXPECT_EQ(resource.allocations, allocations);
+}
+
+TEST(NormalRandomVariableArray, ReusedResultDoesNotAllocate)
+{
+    CountingResource resource;
+    NRV::NormalRandomVariableArray rv(1000, &resource), other(1000, &resource), result(&resource);
+    EXPECT_EQ(rv.resource(), &resource);
+    for(std::size_t i = 0; i < rv.size(); ++i)
+    {
+        rv.set(i, NRV::NormalRandomVariable(double(i % 13), 1 + double(i % 3)));
+        other.set(i, NRV::NormalRandomVariable(double(i % 7), 2));
+    }
+
+    NRV::parallel::setThreads(1);
+    std::size_t allocations = 0;
+    for(int cycle = 0; cycle < 3; ++cycle)
+    {
+        rv.max(other, result);
+        result.truncateLower(0, result);
+        NRV::add(result, rv, result);
+        NRV::parallel::min(result, other, result);
+        NRV::parallel::rectify(result, -5, 20, result);
+        if(cycle == 0)
+        {
+            allocations = resource.allocations;
+        }
+    }
+    EXPECT_EQ(resource.allocations, allocations);
+    NRV::parallel::setThreads(0);
+
+    NRV::NormalRandomVariableArray expected = NRV::parallel::rectify(NRV::parallel::min(
+            rv.max(other).truncateLower(0) + rv, other), -5, 20);
+    EXPECT_EQ(result.resource(), &resource);
+    for(std::size_t i = 0; i < rv.size(); ++i)
+    {
+        EXPECT_EQ(result.means()[i], expected.means()[i]);
+        EXPECT_EQ(result.variances()[i], expected.variances()[i]);
+    }
+
+    // Copies use the default resource
+    NRV::NormalRandomVariableArray copy = result;
+    EXPECT_EQ(copy.resource(), NRV::defaultMemoryResource());
+}
+
+TEST(Reduction, AllocatesFromResource)
+{
+    // Large enough to be reduced in several chunks
+    std::vector<NRV::NormalRandomVariable> rvs;
+    for(int i = 0; i < 10000; ++i)
+    {
+        rvs.push_back(NRV::NormalRandomVariable(0.001 * (i % 997), 1 + 0.0001 * (i % 101)));
+    }
+    NRV::NormalRandomVariableArray array(rvs);
+
+    CountingResource resource;
+    NRV::NormalRandomVariable maximum = NRV::max(rvs, &resource);
+    EXPECT_EQ(resource.allocations, 1u);
+    EXPECT_EQ(maximum.mean(), NRV::max(rvs).mean());
+    EXPECT_EQ(maximum.variance(), NRV::max(rvs).variance());
+    EXPECT_EQ(NRV::min(rvs, &resource).mean(), NRV::min(rvs).mean());
+    EXPECT_EQ(NRV::max(array, &resource).mean(), maximum.mean());
+    EXPECT_EQ(NRV::min(array, &resource).variance(), NRV::min(array).variance());
+    EXPECT_EQ(resource.allocations, 4u);
+    EXPECT_EQ(resource.deallocations, resource.allocations);
+}
+
+#if defined(__cpp_lib_memory_resource)
+
+TEST(PmrMemoryResource, MonotonicBuffer)
+{
+    NRV::ExpressionGraph expected;
+    NRV::NormalRandomVariable expected_result = evaluateGraph(expected, 100);
+
+    std::vector<unsigned char> buffer(1 << 20);
+    std::pmr::monotonic_buffer_resource monotonic(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    NRV::PmrMemoryResource resource(&monotonic);
+
+    NRV::ExpressionGraph graph(&resource);
+    NRV::NormalRandomVariable result = evaluateGraph(graph, 100);
+    EXPECT_EQ(result.mean(), expected_result.mean());
+    EXPECT_EQ(result.variance(), expected_result.variance());
+}
+
+#endif
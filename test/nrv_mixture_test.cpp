@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "NormalRandomVariable/NormalMixture.h"
+#include "NormalRandomVariable/MonteCarlo.h"
+
+TEST(NormalMixture, SingleComponentMatchesRandomVariable)
+{
+    NRV::NormalRandomVariable rv(1, 2), other(2, 0.5), lower(0, 1), upper(3, 1);
+    NRV::NormalMixture mixture(rv);
+
+    EXPECT_EQ(mixture.size(), 1u);
+    EXPECT_DOUBLE_EQ(mixture.mean(), 1);
+    EXPECT_DOUBLE_EQ(mixture.variance(), 2);
+
+    // The maximum splits into 2 components, with the same mean and variance as the approximation by one
+    NRV::NormalMixture maximum = mixture.max(other);
+    EXPECT_EQ(maximum.size(), 2u);
+    EXPECT_NEAR(maximum.mean(), rv.max(other).mean(), 1e-12);
+    EXPECT_NEAR(maximum.variance(), rv.max(other).variance(), 1e-12);
+    EXPECT_NEAR(mixture.min(other).mean(), rv.min(other).mean(), 1e-12);
+    EXPECT_NEAR(mixture.min(other).variance(), rv.min(other).variance(), 1e-12);
+
+    // Rectification moves the mass outside of the bounds to components at the bounds
+    NRV::NormalMixture rectified = mixture.rectify(0, 3);
+    EXPECT_EQ(rectified.size(), 3u);
+    EXPECT_EQ(rectified[0].mean, 0);
+    EXPECT_EQ(rectified[0].variance, 0);
+    EXPECT_NEAR(rectified.mean(), rv.rectify(0, 3).mean(), 1e-12);
+    EXPECT_NEAR(rectified.variance(), rv.rectify(0, 3).variance(), 1e-12);
+    EXPECT_NEAR(mixture.rectifyLower(0).collapse().variance(), rv.rectifyLower(0).variance(), 1e-12);
+    EXPECT_NEAR(mixture.rectifyUpper(3).collapse().mean(), rv.rectifyUpper(3).mean(), 1e-12);
+
+    EXPECT_NEAR(mixture.truncate(0, 3).mean(), rv.truncate(0, 3).mean(), 1e-12);
+    EXPECT_NEAR(mixture.truncateLower(0).variance(), rv.truncateLower(0).variance(), 1e-12);
+    EXPECT_NEAR(mixture.truncateUpper(3).mean(), rv.truncateUpper(3).mean(), 1e-12);
+    EXPECT_NEAR(mixture.truncate(lower, upper).mean(), rv.truncate(lower, upper).mean(), 1e-12);
+    EXPECT_NEAR(mixture.truncateLower(lower).variance(), rv.truncateLower(lower).variance(), 1e-12);
+    EXPECT_NEAR(mixture.truncateUpper(upper).variance(), rv.truncateUpper(upper).variance(), 1e-12);
+
+    NRV::NormalMixture sum = (mixture + other) * 2.0 - 1.0;
+    EXPECT_DOUBLE_EQ(sum.mean(), ((rv + other) * 2.0 - 1.0).mean());
+    EXPECT_DOUBLE_EQ(sum.variance(), ((rv + other) * 2.0 - 1.0).variance());
+}
+
+template<class T>
+T maxChain(NRV::BasicSampleView<T> inputs)
+{
+    // Each stage starts when the previous stage and its own input are ready
+    T time = inputs[0];
+    for(std::size_t i = 1; i < inputs.size(); ++i)
+    {
+        time = std::max(time, inputs[i]) + 1;
+    }
+
+    return time;
+}
+
+template<class T>
+T rectifiedChain(NRV::BasicSampleView<T> inputs)
+{
+    // A tank that is filled and drained, and can not hold less than 0 or more than 4
+    T level = 2;
+    for(T input : inputs)
+    {
+        level = std::min(std::max(level + input, T(0)), T(4));
+    }
+
+    return level;
+}
+
+TEST(NormalMixture, ChainsAreMoreAccurate)
+{
+    std::vector<NRV::NormalRandomVariable> inputs;
+    for(int i = 0; i < 8; ++i)
+    {
+        inputs.push_back(NRV::NormalRandomVariable(i, 1 + 0.5 * (i % 3)));
+    }
+
+    NRV::NormalRandomVariable single = inputs[0];
+    NRV::NormalMixture mixture = inputs[0];
+    for(std::size_t i = 1; i < inputs.size(); ++i)
+    {
+        single = single.max(inputs[i]) + 1.0;
+        mixture = mixture.max(inputs[i]) + 1.0;
+        EXPECT_LE(mixture.size(), NRV::NormalMixture::capacity);
+    }
+
+    NRV::NormalRandomVariable sample_output = NRV::MonteCarlo().estimate(maxChain<double>, inputs, 1000000);
+    // Each case of a maximum is still approximated by a normal distribution, so some of the error remains
+    EXPECT_NEAR(mixture.mean(), sample_output.mean(), 0.01);
+    EXPECT_NEAR(mixture.variance(), sample_output.variance(), 0.1);
+    EXPECT_LT(std::abs(mixture.mean() - sample_output.mean()), std::abs(single.mean() - sample_output.mean()));
+    EXPECT_LT(std::abs(mixture.variance() - sample_output.variance()),
+            std::abs(single.variance() - sample_output.variance()));
+
+    std::vector<NRV::NormalRandomVariable> flows(6, NRV::NormalRandomVariable(0.5, 2));
+    single = NRV::NormalRandomVariable(2, 1e-9);
+    mixture = single;
+    for(const NRV::NormalRandomVariable& flow : flows)
+    {
+        single = (single + flow).rectify(0, 4);
+        mixture = (mixture + flow).rectify(0, 4);
+    }
+
+    sample_output = NRV::MonteCarlo().estimate(rectifiedChain<double>, flows, 1000000);
+    EXPECT_NEAR(mixture.mean(), sample_output.mean(), 0.01);
+    EXPECT_NEAR(mixture.variance(), sample_output.variance(), 0.04);
+    EXPECT_LT(std::abs(mixture.mean() - sample_output.mean()), std::abs(single.mean() - sample_output.mean()));
+    EXPECT_LT(std::abs(mixture.variance() - sample_output.variance()),
+            std::abs(single.variance() - sample_output.variance()));
+}
+
+TEST(NormalMixture, MergeAndPrune)
+{
+    NRV::BasicNormalMixture<double, 16> mixture = NRV::NormalRandomVariable(0, 1);
+    for(int i = 1; i < 4; ++i)
+    {
+        mixture = mixture.max(NRV::NormalRandomVariable(i, 0.5));
+    }
+    mixture = mixture + NRV::BasicNormalMixture<double, 16>(NRV::NormalRandomVariable(0, 1)).rectify(-1, 1);
+    ASSERT_EQ(mixture.size(), 16u);
+
+    // Merging keeps the mean and variance, and sorts the components by mean
+    double mean = mixture.mean(), variance = mixture.variance();
+    mixture.merge(3);
+    EXPECT_EQ(mixture.size(), 3u);
+    EXPECT_NEAR(mixture.mean(), mean, 1e-12);
+    EXPECT_NEAR(mixture.variance(), variance, 1e-12);
+    EXPECT_LT(mixture[0].mean, mixture[1].mean);
+    EXPECT_LT(mixture[1].mean, mixture[2].mean);
+
+    mixture.prune(0.2);
+    double total = 0;
+    for(const auto& component : mixture)
+    {
+        EXPECT_GE(component.weight, 0.2);
+        total += component.weight;
+    }
+    EXPECT_NEAR(total, 1, 1e-12);
+
+    // At least one component is kept
+    mixture.prune(2);
+    EXPECT_EQ(mixture.size(), 1u);
+    EXPECT_EQ(mixture[0].weight, 1);
+
+    // Components with means that are not numbers are still merged
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    NRV::MixtureComponent<double> components[4] = {{0.25, nan, 1}, {0.25, nan, 1}, {0.25, 1, 1}, {0.25, nan, 1}};
+    double costs[8];
+    EXPECT_EQ(NRV::detail::mergeMixture(components, 4, 1, costs), 1u);
+}
+
+TEST(NormalMixture, Errors)
+{
+    NRV::NormalMixture mixture = NRV::NormalRandomVariable(0, 1);
+    EXPECT_THROW(mixture.truncate(1, 0), std::range_error);
+    EXPECT_THROW(mixture.rectify(1, 1), std::range_error);
+    EXPECT_THROW(mixture.truncateLower(50), std::range_error);
+
+    // Mass at the bounds is removed by truncating at them
+    NRV::NormalMixture rectified = mixture.rectify(-1, 1);
+    EXPECT_EQ(rectified.size(), 3u);
+    EXPECT_EQ(rectified.truncate(-1, 1).size(), 1u);
+    EXPECT_EQ(rectified.truncate(-1, 1)[0].weight, 1);
+
+    // A mixture of point masses does not have a valid variance as a random variable
+    NRV::NormalMixture point = mixture.rectifyUpper(-50);
+    ASSERT_EQ(point.size(), 1u);
+    EXPECT_EQ(point[0].variance, 0);
+    EXPECT_THROW(point.collapse(), std::range_error);
+    EXPECT_THROW(point.truncateLower(-49), std::range_error);
+    EXPECT_EQ(point.max(NRV::NormalRandomVariable(-50, 1)).size(), 2u);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "NormalRandomVariable/MonteCarlo.h"
+
+TEST(Philox, KnownAnswers)
+{
+    // Known answer tests for Philox4x32-10 from the Random123 library
+    NRV::Philox4x32::Counter expected = {{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}};
+    EXPECT_EQ(NRV::Philox4x32(NRV::Philox4x32::Key{{0, 0}})({{0, 0, 0, 0}}), expected);
+
+    expected = {{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}};
+    EXPECT_EQ(NRV::Philox4x32(NRV::Philox4x32::Key{{0xffffffff, 0xffffffff}})({{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}}), expected);
+
+    expected = {{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+    EXPECT_EQ(NRV::Philox4x32(NRV::Philox4x32::Key{{0xa4093822, 0x299f31d0}})({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}}), expected);
+}
+
+TEST(Welford, MatchesTwoPass)
+{
+    std::vector<double> samples;
+    for(int i = 0; i < 1000; ++i)
+    {
+        samples.push_back(1e6 + std::sin(i) * 3);
+    }
+
+    double mean = 0;
+    for(double sample : samples)
+    {
+        mean += sample;
+    }
+    mean /= samples.size();
+
+    double variance = 0;
+    for(double sample : samples)
+    {
+        variance += (sample - mean) * (sample - mean);
+    }
+    variance /= samples.size();
+
+    // One at a time, as a batch, and merging uneven parts
+    NRV::WelfordAccumulator single, batch, merged, part;
+    for(double sample : samples)
+    {
+        single.add(sample);
+    }
+    batch.add(samples.data(), samples.size());
+    merged.add(samples.data(), 100);
+    part.add(samples.data() + 100, 900);
+    merged.merge(part);
+
+    for(const auto& accumulator : {single, batch, merged})
+    {
+        EXPECT_EQ(accumulator.count(), samples.size());
+        EXPECT_NEAR(accumulator.mean(), mean, 1e-6);
+        EXPECT_NEAR(accumulator.variance(), variance, 1e-9);
+    }
+
+    EXPECT_TRUE(std::isnan(NRV::WelfordAccumulator().mean()));
+}
+
+double sum(NRV::SampleView inputs)
+{
+    return inputs[0] + inputs[1];
+}
+
+TEST(MonteCarlo, Moments)
+{
+    std::vector<NRV::NormalRandomVariable> inputs = {NRV::NormalRandomVariable(1, 2), NRV::NormalRandomVariable(-3, 0.5)};
+    auto accumulator = NRV::MonteCarlo(1).sample(sum, inputs, 1000001);
+
+    EXPECT_EQ(accumulator.count(), 1000001u);
+    EXPECT_NEAR(accumulator.mean(), -2, 0.01);
+    EXPECT_NEAR(accumulator.variance(), 2.5, 0.01);
+
+    // The fourth moment of the inputs checks the shape of the distribution, not just the mean and variance
+    auto kurtosis = NRV::MonteCarlo(2).sample([](NRV::SampleView x) { return std::pow(x[0], 4); },
+            {NRV::NormalRandomVariable()}, 1000000);
+    EXPECT_NEAR(kurtosis.mean(), 3, 0.05);
+}
+
+TEST(MonteCarlo, IndependentOfThreads)
+{
+    std::vector<NRV::NormalRandomVariable> inputs = {NRV::NormalRandomVariable(1, 2), NRV::NormalRandomVariable(-3, 0.5)};
+    auto product = [](NRV::SampleView x) { return x[0] * x[1]; };
+    auto single = NRV::MonteCarlo(7, 1).sample(product, inputs, 100000);
+    auto multiple = NRV::MonteCarlo(7, 5).sample(product, inputs, 100000);
+
+    EXPECT_EQ(single.count(), multiple.count());
+    EXPECT_EQ(single.mean(), multiple.mean());
+    EXPECT_EQ(single.variance(), multiple.variance());
+
+    // A different seed gives different samples
+    EXPECT_NE(NRV::MonteCarlo(8, 1).sample(product, inputs, 100000).mean(), single.mean());
+}
+
+TEST(MonteCarlo, DiscardsInvalidResults)
+{
+    // Only keep the positive half of a standard normal distribution
+    auto positive = [](NRV::SampleView x) { return x[0] > 0 ? x[0] : std::numeric_limits<double>::quiet_NaN(); };
+    auto accumulator = NRV::MonteCarlo().sample(positive, {NRV::NormalRandomVariable()}, 100000);
+
+    EXPECT_NEAR(accumulator.count(), 50000, 1000);
+    EXPECT_NEAR(accumulator.mean(), std::sqrt(2 / M_PI), 0.01);
+
+    auto throws = [](NRV::SampleView x) -> double { if(x[0] > 3) throw std::runtime_error("Too large"); return x[0]; };
+    EXPECT_THROW(NRV::MonteCarlo(0, 4).sample(throws, {NRV::NormalRandomVariable()}, 100000), std::runtime_error);
+}
+
+TEST(MonteCarlo, Precision)
+{
+    auto identity = [](NRV::BasicSampleView<float> x) { return x[0]; };
+    auto result = NRV::BasicMonteCarlo<float>().estimate(identity, {NRV::BasicNormalRandomVariable<float>(5, 4)}, 100000);
+
+    EXPECT_NEAR(result.mean(), 5, 0.05);
+    EXPECT_NEAR(result.variance(), 4, 0.1);
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "NormalRandomVariable/Parallel.h"
+
+/**
+ * Builds an array of size random variables, which is not a whole number of chunks
+ */
+NRV::NormalRandomVariableArray randomArray(std::size_t size, unsigned int seed, double offset)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> mean(-2, 2), variance(0.5, 2);
+
+    std::vector<double> means(size), variances(size);
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        means[i] = mean(generator) + offset;
+        variances[i] = variance(generator);
+    }
+
+    return NRV::NormalRandomVariableArray(means, variances);
+}
+
+/**
+ * Checks that the arrays are bit-identical
+ */
+void expectIdentical(const NRV::NormalRandomVariableArray& result, const NRV::NormalRandomVariableArray& expected)
+{
+    ASSERT_EQ(result.size(), expected.size());
+    for(std::size_t i = 0; i < expected.size(); ++i)
+    {
+        ASSERT_EQ(result.means()[i], expected.means()[i]) << "at " << i;
+        ASSERT_EQ(result.variances()[i], expected.variances()[i]) << "at " << i;
+    }
+}
+
+TEST(Parallel, MatchesSerial)
+{
+    std::size_t size = 20 * NRV::parallel::chunk_size + 13;
+    NRV::NormalRandomVariableArray rv = randomArray(size, 1, 0), other = randomArray(size, 2, 0);
+    NRV::NormalRandomVariableArray lower = randomArray(size, 3, -4), upper = randomArray(size, 4, 4);
+    NRV::NormalRandomVariableArray positive = randomArray(size, 5, 10);
+
+    for(unsigned int threads : {1u, 3u, 8u})
+    {
+        NRV::parallel::setThreads(threads);
+        expectIdentical(NRV::parallel::inverse(positive), positive.inverse());
+        expectIdentical(NRV::parallel::rectify(rv, -1, 1), rv.rectify(-1, 1));
+        expectIdentical(NRV::parallel::rectifyLower(rv, -1), rv.rectifyLower(-1));
+        expectIdentical(NRV::parallel::rectifyUpper(rv, 1), rv.rectifyUpper(1));
+        expectIdentical(NRV::parallel::truncate(rv, -1, 1), rv.truncate(-1, 1));
+        expectIdentical(NRV::parallel::truncateLower(rv, -1), rv.truncateLower(-1));
+        expectIdentical(NRV::parallel::truncateUpper(rv, 1), rv.truncateUpper(1));
+        expectIdentical(NRV::parallel::truncate(rv, lower, upper), rv.truncate(lower, upper));
+        expectIdentical(NRV::parallel::truncateLower(rv, lower), rv.truncateLower(lower));
+        expectIdentical(NRV::parallel::truncateUpper(rv, upper), rv.truncateUpper(upper));
+        expectIdentical(NRV::parallel::max(rv, other), rv.max(other));
+        expectIdentical(NRV::parallel::min(rv, other), rv.min(other));
+        expectIdentical(NRV::parallel::add(rv, other), rv + other);
+        expectIdentical(NRV::parallel::subtract(rv, other), rv - other);
+        expectIdentical(NRV::parallel::multiply(rv, other), rv * other);
+        expectIdentical(NRV::parallel::divide(rv, positive), rv / positive);
+    }
+
+    NRV::parallel::setThreads(0);
+    EXPECT_GE(NRV::parallel::threads(), 1u);
+}
+
+TEST(Parallel, OutputVersions)
+{
+    std::size_t size = 5 * NRV::parallel::chunk_size + 13;
+    NRV::NormalRandomVariableArray rv = randomArray(size, 1, 0), other = randomArray(size, 2, 0);
+    NRV::NormalRandomVariableArray lower = randomArray(size, 3, -4), upper = randomArray(size, 4, 4);
+    NRV::NormalRandomVariableArray positive = randomArray(size, 5, 10);
+    NRV::NormalRandomVariableArray result;
+
+    for(unsigned int threads : {1u, 3u})
+    {
+        NRV::parallel::setThreads(threads);
+        NRV::parallel::inverse(positive, result);
+        expectIdentical(result, positive.inverse());
+        NRV::parallel::rectify(rv, -1, 1, result);
+        expectIdentical(result, rv.rectify(-1, 1));
+        NRV::parallel::rectifyLower(rv, -1, result);
+        expectIdentical(result, rv.rectifyLower(-1));
+        NRV::parallel::rectifyUpper(rv, 1, result);
+        expectIdentical(result, rv.rectifyUpper(1));
+        NRV::parallel::truncate(rv, -1, 1, result);
+        expectIdentical(result, rv.truncate(-1, 1));
+        NRV::parallel::truncateLower(rv, -1, result);
+        expectIdentical(result, rv.truncateLower(-1));
+        NRV::parallel::truncateUpper(rv, 1, result);
+        expectIdentical(result, rv.truncateUpper(1));
+        NRV::parallel::truncate(rv, lower, upper, result);
+        expectIdentical(result, rv.truncate(lower, upper));
+        NRV::parallel::truncateLower(rv, lower, result);
+        expectIdentical(result, rv.truncateLower(lower));
+        NRV::parallel::truncateUpper(rv, upper, result);
+        expectIdentical(result, rv.truncateUpper(upper));
+        NRV::parallel::max(rv, other, result);
+        expectIdentical(result, rv.max(other));
+        NRV::parallel::min(rv, other, result);
+        expectIdentical(result, rv.min(other));
+        NRV::parallel::add(rv, other, result);
+        expectIdentical(result, rv + other);
+        NRV::parallel::subtract(rv, other, result);
+        expectIdentical(result, rv - other);
+        NRV::parallel::multiply(rv, other, result);
+        expectIdentical(result, rv * other);
+        NRV::parallel::divide(rv, positive, result);
+        expectIdentical(result, rv / positive);
+
+        // The result can be one of the inputs
+        result = rv;
+        NRV::parallel::max(result, other, result);
+        expectIdentical(result, rv.max(other));
+    }
+
+    NRV::parallel::setThreads(0);
+}
+
+TEST(Parallel, PairwiseMatchesSerial)
+{
+    // The rows are not a whole number of chunks, so chunks start and end part way through rows
+    NRV::NormalRandomVariableArray rv = randomArray(301, 1, 0), other = randomArray(1013, 2, 0);
+    std::vector<double> expected(rv.size() * other.size()), result(expected.size());
+    NRV::pairwiseProbabilityLessThan(rv, other, expected.data());
+
+    for(unsigned int threads : {1u, 3u, 8u})
+    {
+        NRV::parallel::setThreads(threads);
+        NRV::parallel::pairwiseProbabilityLessThan(rv, other, result.data());
+        for(std::size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_EQ(result[i], expected[i]) << "at " << i;
+        }
+    }
+
+    NRV::parallel::setThreads(0);
+}
+
+TEST(Parallel, InvalidInputs)
+{
+    NRV::NormalRandomVariableArray rv = randomArray(10, 1, 0), other = randomArray(11, 2, 0);
+
+    EXPECT_THROW(NRV::parallel::max(rv, other), std::length_error);
+    EXPECT_THROW(NRV::parallel::truncate(rv, rv, other), std::length_error);
+    EXPECT_THROW(NRV::parallel::truncate(rv, 1, 1), std::range_error);
+    EXPECT_THROW(NRV::parallel::rectify(rv, 2, 1), std::range_error);
+    EXPECT_EQ(NRV::parallel::add(NRV::NormalRandomVariableArray(), NRV::NormalRandomVariableArray()).size(), 0u);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+#include "NormalRandomVariable/NormalRandomVariable.h"
+#include "NormalRandomVariable/NormalRandomVariableArray.h"
+
+// The float and long double versions are checked against the double version, which is tested in nrv_test
+
+template<class T>
+class Precision : public ::testing::Test {
+protected:
+    typedef NRV::BasicNormalRandomVariable<T> RV;
+
+    /**
+     * Checks that the result matches the double result, to within the precision of T
+     */
+    void expectMatchesDouble(const RV& result, const NRV::NormalRandomVariable& expected)
+    {
+        double tolerance = std::max(1e3 * static_cast<double>(std::numeric_limits<T>::epsilon()), 1e-12);
+        EXPECT_NEAR(static_cast<double>(result.mean()), expected.mean(), tolerance * std::max(1.0, std::abs(expected.mean())));
+        EXPECT_NEAR(static_cast<double>(result.variance()), expected.variance(), tolerance * std::max(1.0, expected.variance()));
+    }
+};
+
+typedef ::testing::Types<float, long double> PrecisionTypes;
+TYPED_TEST_SUITE(Precision, PrecisionTypes);
+
+TYPED_TEST(Precision, Arithmetic)
+{
+    typedef typename TestFixture::RV RV;
+    RV rv1(1, 2);
+    RV rv2(10, 0.5);
+
+    this->expectMatchesDouble(2 * (rv1 + rv2) - 3, 2 * (NRV::NormalRandomVariable(1, 2) + NRV::NormalRandomVariable(10, 0.5)) - 3);
+    this->expectMatchesDouble(rv1 * rv2, NRV::NormalRandomVariable(1, 2) * NRV::NormalRandomVariable(10, 0.5));
+    this->expectMatchesDouble(rv1 / rv2, NRV::NormalRandomVariable(1, 2) / NRV::NormalRandomVariable(10, 0.5));
+    this->expectMatchesDouble(2 / rv2, 2 / NRV::NormalRandomVariable(10, 0.5));
+    EXPECT_ANY_THROW(RV(1, 0));
+    EXPECT_ANY_THROW(rv1.inverse());
+}
+
+TYPED_TEST(Precision, TruncationAndRectification)
+{
+    typedef typename TestFixture::RV RV;
+    RV rv(2, 3);
+    NRV::NormalRandomVariable expected(2, 3);
+
+    this->expectMatchesDouble(rv.truncate(0, 5), expected.truncate(0, 5));
+    this->expectMatchesDouble(rv.truncateLower(1), expected.truncateLower(1));
+    this->expectMatchesDouble(rv.truncateUpper(1), expected.truncateUpper(1));
+    this->expectMatchesDouble(rv.rectify(0, 5), expected.rectify(0, 5));
+    this->expectMatchesDouble(rv.rectifyLower(1), expected.rectifyLower(1));
+    this->expectMatchesDouble(rv.rectifyUpper(1), expected.rectifyUpper(1));
+    this->expectMatchesDouble(rv.truncate(RV(0, 1), RV(5, 2)),
+            expected.truncate(NRV::NormalRandomVariable(0, 1), NRV::NormalRandomVariable(5, 2)));
+    EXPECT_ANY_THROW(rv.truncate(5, 0));
+}
+
+TYPED_TEST(Precision, MaxMin)
+{
+    typedef typename TestFixture::RV RV;
+    RV rv1(1, 2);
+    RV rv2(2, 0.5);
+
+    this->expectMatchesDouble(rv1.max(rv2), NRV::NormalRandomVariable(1, 2).max(NRV::NormalRandomVariable(2, 0.5)));
+    this->expectMatchesDouble(rv1.min(rv2), NRV::NormalRandomVariable(1, 2).min(NRV::NormalRandomVariable(2, 0.5)));
+}
+
+TYPED_TEST(Precision, Array)
+{
+    // Only double has vectorised kernels, so the other precisions give the same results as the scalar operations
+    NRV::BasicNormalRandomVariableArray<TypeParam> rvs({1, 2, 3}, {2, 1, 0.5});
+    NRV::BasicNormalRandomVariableArray<TypeParam> others({3, 2, 1}, {0.5, 1, 2});
+
+    auto truncated = (rvs * 2 + 1).truncate(0, 5);
+    auto minimum = rvs.min(others);
+    for(std::size_t i = 0; i < rvs.size(); ++i)
+    {
+        auto expected_truncated = (rvs[i] * 2 + 1).truncate(0, 5);
+        EXPECT_EQ(truncated[i].mean(), expected_truncated.mean());
+        EXPECT_EQ(truncated[i].variance(), expected_truncated.variance());
+
+        auto expected_minimum = rvs[i].min(others[i]);
+        EXPECT_EQ(minimum[i].mean(), expected_minimum.mean());
+        EXPECT_EQ(minimum[i].variance(), expected_minimum.variance());
+    }
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "NormalRandomVariable/Serialization.h"
+
+NRV::NormalRandomVariableArray testArray()
+{
+    return NRV::NormalRandomVariableArray({10, 0, 5, -2, 8, 12, 1e-300, -7.25}, {0.5, 0.5, 10, 1, 1, 4, 1e300, 3});
+}
+
+TEST(Serialization, RandomVariable)
+{
+    unsigned char buffer[NRV::serialized_random_variable_size];
+    NRV::serialize(NRV::NormalRandomVariable(1.5, 2), buffer);
+
+    // Little-endian IEEE 754 on every platform
+    const unsigned char expected[] = {0, 0, 0, 0, 0, 0, 0xf8, 0x3f, 0, 0, 0, 0, 0, 0, 0, 0x40};
+    EXPECT_EQ(std::memcmp(buffer, expected, sizeof(expected)), 0);
+
+    auto result = NRV::deserializeRandomVariable(buffer);
+    EXPECT_EQ(result.mean(), 1.5);
+    EXPECT_EQ(result.variance(), 2);
+    EXPECT_EQ(NRV::deserializeRandomVariable<float>(buffer).mean(), 1.5f);
+
+    std::memset(buffer + 8, 0, 8);
+    EXPECT_THROW(NRV::deserializeRandomVariable(buffer), std::range_error);
+}
+
+TEST(Serialization, Layout)
+{
+    NRV::NormalRandomVariableArray array = testArray();
+    std::vector<unsigned char> data = NRV::serialize(array);
+
+    ASSERT_EQ(data.size(), NRV::serializedSize(array.size()));
+    EXPECT_EQ(data.size(), 64u + 2 * 64u);
+    EXPECT_EQ(std::memcmp(data.data(), "NRVA", 4), 0);
+    EXPECT_EQ(data[4], 1);
+    EXPECT_EQ(data[6], static_cast<unsigned char>(NRV::Encoding::Float64));
+    EXPECT_EQ(data[8], array.size());
+    EXPECT_EQ(data[16], 64);
+    EXPECT_EQ(data[24], 128);
+
+    EXPECT_EQ(NRV::serializedSize(0), 64u);
+    EXPECT_EQ(NRV::serializedSize(9), 64u + 2 * 128u);
+    EXPECT_EQ(NRV::serializedSize(9, NRV::Encoding::Float32), 64u + 2 * 64u);
+    EXPECT_EQ(NRV::serializedSize(1000, NRV::Encoding::Float32), 64u + 2 * 4032u);
+
+    std::vector<unsigned char> small(data.size() - 1);
+    EXPECT_THROW(NRV::serialize(array, small.data(), small.size()), std::length_error);
+}
+
+TEST(Serialization, RoundTrip)
+{
+    NRV::NormalRandomVariableArray array = testArray();
+    std::vector<unsigned char> data = NRV::serialize(array);
+
+    auto result = NRV::deserialize<double>(data.data(), data.size());
+    ASSERT_EQ(result.size(), array.size());
+    for(std::size_t i = 0; i < array.size(); ++i)
+    {
+        EXPECT_EQ(result.means()[i], array.means()[i]);
+        EXPECT_EQ(result.variances()[i], array.variances()[i]);
+    }
+
+    // Float32 rounds to single precision
+    std::vector<unsigned char> compressed = NRV::serialize(array, NRV::Encoding::Float32);
+    EXPECT_EQ(compressed[6], static_cast<unsigned char>(NRV::Encoding::Float32));
+    auto rounded = NRV::deserialize<double>(compressed.data(), compressed.size());
+    for(std::size_t i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(rounded.means()[i], static_cast<double>(static_cast<float>(array.means()[i])));
+        EXPECT_EQ(rounded.variances()[i], static_cast<double>(static_cast<float>(array.variances()[i])));
+    }
+
+    auto single = NRV::deserialize<float>(data.data(), data.size());
+    EXPECT_EQ(single.means()[7], -7.25f);
+}
+
+TEST(Serialization, ZeroCopyView)
+{
+    NRV::NormalRandomVariableArray array = testArray();
+
+    // Serialize into 64-byte aligned storage, as for a memory-mapped file
+    std::vector<double> storage(NRV::serializedSize(array.size()) / sizeof(double) + 8);
+    unsigned char* buffer = reinterpret_cast<unsigned char*>(storage.data());
+    buffer += (64 - reinterpret_cast<std::uintptr_t>(buffer) % 64) % 64;
+    std::size_t size = NRV::serialize(array, buffer, NRV::serializedSize(array.size()));
+
+    NRV::SerializedArrayView view(buffer, size);
+    ASSERT_TRUE(view.zeroCopy());
+    EXPECT_EQ(view.size(), array.size());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(view.means()) % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(view.variances()) % 64, 0u);
+    EXPECT_EQ(view.means()[3], -2);
+    EXPECT_EQ(view[4].variance(), 1);
+
+    // The batch operations on the view match those on the array
+    auto expectEqual = [](const NRV::NormalRandomVariableArray& result, const NRV::NormalRandomVariableArray& expected) {
+        ASSERT_EQ(result.size(), expected.size());
+        for(std::size_t i = 0; i < 6; ++i)
+        {
+            EXPECT_EQ(result.means()[i], expected.means()[i]);
+            EXPECT_EQ(result.variances()[i], expected.variances()[i]);
+        }
+    };
+    expectEqual(view.truncate(1, 9), array.truncate(1, 9));
+    expectEqual(view.truncateUpper(6), array.truncateUpper(6));
+    expectEqual(view.rectifyLower(3), array.rectifyLower(3));
+    expectEqual(view.max(view), array.max(array));
+    EXPECT_THROW(view.rectify(2, 1), std::range_error);
+
+    // Float32 data is decoded
+    std::vector<unsigned char> compressed = NRV::serialize(array, NRV::Encoding::Float32);
+    NRV::SerializedArrayView compressed_view(compressed.data(), compressed.size());
+    EXPECT_FALSE(compressed_view.zeroCopy());
+    EXPECT_THROW(compressed_view.means(), std::logic_error);
+    EXPECT_EQ(compressed_view.truncate(1, 9).size(), array.size());
+}
+
+TEST(Serialization, InvalidData)
+{
+    std::vector<unsigned char> data = NRV::serialize(testArray());
+
+    EXPECT_THROW(NRV::SerializedArrayView(data.data(), 32), std::invalid_argument);
+    EXPECT_THROW(NRV::SerializedArrayView(data.data(), data.size() - 1), std::invalid_argument);
+
+    std::vector<unsigned char> corrupt = data;
+    corrupt[0] = 'X';
+    EXPECT_THROW(NRV::SerializedArrayView(corrupt.data(), corrupt.size()), std::invalid_argument);
+
+    corrupt = data;
+    corrupt[4] = 2;
+    EXPECT_THROW(NRV::SerializedArrayView(corrupt.data(), corrupt.size()), std::invalid_argument);
+
+    corrupt = data;
+    corrupt[6] = 3;
+    EXPECT_THROW(NRV::SerializedArrayView(corrupt.data(), corrupt.size()), std::invalid_argument);
+
+    corrupt = data;
+    corrupt[15] = 0xff;
+    EXPECT_THROW(NRV::SerializedArrayView(corrupt.data(), corrupt.size()), std::invalid_argument);
+
+    corrupt = data;
+    corrupt[24] = 72;
+    EXPECT_THROW(NRV::SerializedArrayView(corrupt.data(), corrupt.size()), std::invalid_argument);
+}
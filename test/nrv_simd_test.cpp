@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "NormalRandomVariable/NormalRandomVariableArray.h"
+#include "NormalRandomVariable/Simd.h"
+
+/**
+ * Returns all of the instruction sets supported by the library and processor
+ */
+std::vector<NRV::InstructionSet> supportedInstructionSets()
+{
+    std::vector<NRV::InstructionSet> instruction_sets;
+    for(auto instruction_set : {NRV::InstructionSet::Scalar, NRV::InstructionSet::SSE2, NRV::InstructionSet::AVX2, NRV::InstructionSet::AVX512})
+    {
+        if(NRV::instructionSetSupported(instruction_set))
+        {
+            instruction_sets.push_back(instruction_set);
+        }
+    }
+
+    return instruction_sets;
+}
+
+/**
+ * Random variables with means spread either side of the bounds used below (0 and 10), but not so far into the tails
+ * that the scalar implementation loses precision (see FarIntoTail). The size is not a multiple of any vector width
+ * so that the remainder is also tested
+ */
+NRV::NormalRandomVariableArray testArray()
+{
+    NRV::NormalRandomVariableArray rvs;
+    for(int i = 0; i < 83; ++i)
+    {
+        rvs.push_back(NRV::NormalRandomVariable(-1 + 0.145 * i, 0.5 + 0.1 * (i % 30)));
+    }
+
+    return rvs;
+}
+
+/**
+ * Checks that the result using each instruction set is close to the result using the scalar implementation
+ */
+template<class Operation>
+void expectMatchesScalar(Operation operation, double tolerance)
+{
+    NRV::setInstructionSet(NRV::InstructionSet::Scalar);
+    auto expected = operation();
+
+    for(auto instruction_set : supportedInstructionSets())
+    {
+        NRV::setInstructionSet(instruction_set);
+        auto result = operation();
+
+        ASSERT_EQ(result.size(), expected.size());
+        for(std::size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_NEAR(result.means()[i], expected.means()[i], tolerance * std::max(1.0, std::abs(expected.means()[i])));
+            EXPECT_NEAR(result.variances()[i], expected.variances()[i], tolerance * std::max(1.0, expected.variances()[i]));
+        }
+    }
+
+    NRV::setInstructionSet(supportedInstructionSets().back());
+}
+
+TEST(Dispatch, DefaultIsBestSupported)
+{
+    EXPECT_TRUE(NRV::instructionSetSupported(NRV::InstructionSet::Scalar));
+    EXPECT_EQ(NRV::activeInstructionSet(), supportedInstructionSets().back());
+}
+
+TEST(Dispatch, Unsupported)
+{
+    for(auto instruction_set : {NRV::InstructionSet::SSE2, NRV::InstructionSet::AVX2, NRV::InstructionSet::AVX512})
+    {
+        if(!NRV::instructionSetSupported(instruction_set))
+        {
+            EXPECT_ANY_THROW(NRV::setInstructionSet(instruction_set));
+        }
+    }
+}
+
+TEST(Truncation, MatchesScalar)
+{
+    auto rvs = testArray();
+    expectMatchesScalar([&]() {return rvs.truncate(0, 10);}, 1e-9);
+    expectMatchesScalar([&]() {return rvs.truncateLower(0);}, 1e-9);
+    expectMatchesScalar([&]() {return rvs.truncateUpper(10);}, 1e-9);
+}
+
+TEST(Rectification, MatchesScalar)
+{
+    auto rvs = testArray();
+    expectMatchesScalar([&]() {return rvs.rectify(0, 10);}, 1e-9);
+    expectMatchesScalar([&]() {return rvs.rectifyLower(0);}, 1e-9);
+    expectMatchesScalar([&]() {return rvs.rectifyUpper(10);}, 1e-9);
+}
+
+TEST(MaxMin, MatchesScalar)
+{
+    auto rvs = testArray();
+    auto others = testArray() * -0.5 + 3;
+    expectMatchesScalar([&]() {return rvs.max(others);}, 1e-9);
+    expectMatchesScalar([&]() {return rvs.min(others);}, 1e-9);
+}
+
+TEST(Truncation, FarIntoTail)
+{
+    // Truncating a standard normal distribution 8 standard deviations from the mean, where 1 - erf loses most of its
+    // precision. The mean is the inverse Mills ratio, calculated here using std::erfc
+    double c = 8;
+    double expected_mean = std::exp(-c * c / 2) / std::sqrt(2 * 3.14159265358979323846) / (0.5 * std::erfc(c / std::sqrt(2)));
+    double expected_variance = 1 + expected_mean * (c - expected_mean);
+
+    NRV::NormalRandomVariableArray rvs(9);
+    for(auto instruction_set : supportedInstructionSets())
+    {
+        if(instruction_set == NRV::InstructionSet::Scalar)
+        {
+            continue;
+        }
+
+        NRV::setInstructionSet(instruction_set);
+        auto lower = rvs.truncateLower(c);
+        auto upper = rvs.truncateUpper(-c);
+        for(std::size_t i = 0; i < rvs.size(); ++i)
+        {
+            EXPECT_NEAR(lower.means()[i], expected_mean, 1e-12);
+            EXPECT_NEAR(lower.variances()[i], expected_variance, 1e-9);
+            EXPECT_NEAR(upper.means()[i], -expected_mean, 1e-12);
+            EXPECT_NEAR(upper.variances()[i], expected_variance, 1e-9);
+        }
+    }
+
+    NRV::setInstructionSet(supportedInstructionSets().back());
+}
+
+TEST(Probability, MatchesScalar)
+{
+    auto rvs = testArray();
+    auto others = testArray() * -0.5 + 3;
+
+    // The pairwise matrix is wider than a tile, and neither size is a multiple of any vector width
+    NRV::NormalRandomVariableArray columns;
+    for(int j = 0; j < 1100; ++j)
+    {
+        columns.push_back(NRV::NormalRandomVariable(-2 + 0.01 * j, 0.2 + 0.01 * (j % 50)));
+    }
+
+    auto calculate = [&]() {
+        std::vector<double> result = rvs.cdf(3);
+        std::vector<double> less_than = rvs.probabilityLessThan(others);
+        result.insert(result.end(), less_than.begin(), less_than.end());
+
+        std::vector<double> pairwise(rvs.size() * columns.size());
+        NRV::pairwiseProbabilityLessThan(rvs, columns, pairwise.data());
+        result.insert(result.end(), pairwise.begin(), pairwise.end());
+        return result;
+    };
+
+    NRV::setInstructionSet(NRV::InstructionSet::Scalar);
+    std::vector<double> expected = calculate();
+    for(auto instruction_set : supportedInstructionSets())
+    {
+        NRV::setInstructionSet(instruction_set);
+        std::vector<double> result = calculate();
+
+        ASSERT_EQ(result.size(), expected.size());
+        for(std::size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_NEAR(result[i], expected[i], 1e-13 * std::max(1e-3, expected[i])) << "at " << i;
+        }
+    }
+
+    NRV::setInstructionSet(supportedInstructionSets().back());
+}
+
+TEST(Probability, FarIntoTail)
+{
+    // Probabilities of 10 and 30 standard deviations below the mean, which 1 + erf can not represent
+    NRV::NormalRandomVariableArray rvs(5);
+    for(auto instruction_set : supportedInstructionSets())
+    {
+        NRV::setInstructionSet(instruction_set);
+        for(double cdf : rvs.cdf(-10))
+        {
+            EXPECT_NEAR(cdf / 7.61985302416052606597e-24, 1, 1e-12);
+        }
+        for(double cdf : rvs.cdf(-30))
+        {
+            EXPECT_NEAR(cdf / 4.90671392714818709e-198, 1, 1e-12);
+        }
+    }
+
+    NRV::setInstructionSet(supportedInstructionSets().back());
+}
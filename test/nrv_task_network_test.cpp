@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "NormalRandomVariable/TaskNetwork.h"
+
+/**
+ * Checks that the random variables are exactly equal
+ */
+void expectEqual(const NRV::NormalRandomVariable& result, const NRV::NormalRandomVariable& expected)
+{
+    EXPECT_EQ(result.mean(), expected.mean());
+    EXPECT_EQ(result.variance(), expected.variance());
+}
+
+TEST(TaskNetwork, MatchesRandomVariable)
+{
+    NRV::NormalRandomVariable a(1, 2), b(3, 1), c(2, 0.5), d(8, 4), e(10, 3);
+
+    // a -> b -> d, a -> c -> d, c -> e
+    NRV::TaskNetwork network;
+    std::size_t ta = network.addTask(a), tb = network.addTask(b), tc = network.addTask(c), td = network.addTask(d),
+            te = network.addTask(e);
+    network.addDependency(ta, tb);
+    network.addDependency(ta, tc);
+    network.addDependency(tb, td);
+    network.addDependency(tc, td);
+    network.addDependency(tc, te);
+    network.evaluate();
+
+    NRV::NormalRandomVariable end_d = NRV::max(std::vector<NRV::NormalRandomVariable>{a + b, a + c}) + d;
+    NRV::NormalRandomVariable end_e = a + c + e;
+
+    EXPECT_EQ(network.levels(), 3u);
+    expectEqual(network.completion(ta), a);
+    expectEqual(network.completion(tb), a + b);
+    expectEqual(network.completion(td), end_d);
+    expectEqual(network.completion(te), end_e);
+    expectEqual(network.makespan(), end_d.max(end_e));
+
+    // Changing a duration does not change the structure
+    network.setDuration(te, NRV::NormalRandomVariable(1, 1));
+    EXPECT_THROW(network.completion(te), std::logic_error);
+    network.evaluate();
+    expectEqual(network.completion(te), a + c + NRV::NormalRandomVariable(1, 1));
+}
+
+TEST(TaskNetwork, InvalidDependencies)
+{
+    NRV::TaskNetwork network;
+    std::size_t first = network.addTask(NRV::NormalRandomVariable(1, 1));
+    std::size_t second = network.addTask(NRV::NormalRandomVariable(2, 1));
+
+    EXPECT_THROW(network.addDependency(first, 2), std::invalid_argument);
+    EXPECT_THROW(network.addDependency(first, first), std::invalid_argument);
+    EXPECT_THROW(network.makespan(), std::logic_error);
+
+    // Repeated dependencies are only counted once
+    network.addDependency(first, second);
+    network.addDependency(first, second);
+    EXPECT_EQ(network.dependencies(), 1u);
+    network.evaluate();
+    expectEqual(network.completion(second), NRV::NormalRandomVariable(3, 2));
+
+    network.addDependency(second, first);
+    EXPECT_THROW(network.evaluate(), std::invalid_argument);
+}
+
+TEST(TaskNetwork, TryCompletion)
+{
+    NRV::TaskNetwork network;
+    std::size_t first = network.addTask(NRV::NormalRandomVariable(1, 1));
+    std::size_t second = network.addTask(NRV::NormalRandomVariable(2, 1));
+    network.addDependency(first, second);
+    EXPECT_EQ(network.tryCompletion(first).status, NRV::Status::NotEvaluated);
+
+    network.evaluate();
+    NRV::TryResult<double> result = network.tryCompletion(second);
+    ASSERT_TRUE(result.ok());
+    expectEqual(result.value, NRV::NormalRandomVariable(3, 2));
+    EXPECT_EQ(network.tryCompletion(2).status, NRV::Status::OutOfRange);
+
+    // Tasks added since the last evaluation have no completion time yet
+    std::size_t third = network.addTask(NRV::NormalRandomVariable(1, 1));
+    EXPECT_EQ(network.tryCompletion(third).status, NRV::Status::NotEvaluated);
+    EXPECT_EQ(network.tryCompletion(first).status, NRV::Status::NotEvaluated);
+    network.evaluate();
+    EXPECT_TRUE(network.tryCompletion(third).ok());
+}
+
+TEST(TaskNetwork, IndependentOfThreads)
+{
+    // Layers of tasks that each depend on a few tasks of the previous layer, so that the layers are split into chunks
+    const std::size_t layers = 6, width = 5000;
+    NRV::TaskNetwork single(1), multiple(4);
+    std::vector<NRV::NormalRandomVariable> expected;
+    std::uint32_t state = 1;
+    for(std::size_t layer = 0; layer < layers; ++layer)
+    {
+        for(std::size_t i = 0; i < width; ++i)
+        {
+            NRV::NormalRandomVariable duration(1 + (i % 7), 0.5 + (i % 3));
+            std::size_t task = single.addTask(duration);
+            multiple.addTask(duration);
+            if(layer == 0)
+            {
+                expected.push_back(duration);
+                continue;
+            }
+
+            std::vector<std::size_t> predecessors;
+            for(int j = 0; j < 3; ++j)
+            {
+                state = state * 1664525u + 1013904223u;
+                std::size_t predecessor = (layer - 1) * width + (state >> 8) % width;
+                single.addDependency(predecessor, task);
+                multiple.addDependency(predecessor, task);
+                if(std::find(predecessors.begin(), predecessors.end(), predecessor) == predecessors.end())
+                {
+                    predecessors.push_back(predecessor);
+                }
+            }
+
+            std::vector<NRV::NormalRandomVariable> ends;
+            for(std::size_t predecessor : predecessors)
+            {
+                ends.push_back(expected[predecessor]);
+            }
+            expected.push_back(NRV::max(ends) + duration);
+        }
+    }
+
+    single.evaluate();
+    multiple.evaluate();
+    EXPECT_EQ(multiple.levels(), layers);
+    for(std::size_t task = 0; task < expected.size(); ++task)
+    {
+        expectEqual(single.completion(task), multiple.completion(task));
+        EXPECT_NEAR(single.completion(task).mean(), expected[task].mean(), 1e-9);
+        EXPECT_NEAR(single.completion(task).variance(), expected[task].variance(), 1e-9);
+    }
+}
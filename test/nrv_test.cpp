@@ -2,52 +2,19 @@
 #include <vector>
 #include <random>
 #include <cmath>
-#include <numeric>
-#include <functional>
+#include <limits>
+#include <algorithm>
 
 #include "NormalRandomVariable/NormalRandomVariable.h"
+#include "NormalRandomVariable/MonteCarlo.h"
 
 /**
  * Samples from the normal random variables and runs them through func number_of_samples times in order
- * to estimate the resultant distribution
+ * to estimate the resultant distribution. Samples for which func returns NaN are discarded
  */
-NRV::NormalRandomVariable sampler(std::function<double(std::vector<double>)> func, std::vector<NRV::NormalRandomVariable> inputs, unsigned int number_of_samples)
+NRV::NormalRandomVariable sampler(double (*func)(NRV::SampleView), const std::vector<NRV::NormalRandomVariable>& inputs, unsigned int number_of_samples)
 {
-    // Set up the random number generator and store the distributions for each random variable
-    std::default_random_engine generator;
-    std::vector<std::normal_distribution<double>> distributions;
-    for(const auto& rv : inputs)
-    {
-        distributions.push_back(std::normal_distribution<double>(rv.mean(), std::sqrt(rv.variance())));
-    }
-
-    // Sample the function
-    std::vector<double> results;
-    for(unsigned int i = 0; i < number_of_samples; ++i)
-    {
-        std::vector<double> inputs_sampled;
-        for(auto& distribution : distributions)
-        {
-            inputs_sampled.push_back(distribution(generator));
-        }
-
-        // Use a try-catch block to handle cases where the function should not actually return a result
-        try
-        {
-            results.push_back(func(inputs_sampled));
-        }
-        catch (...)
-        {
-            // Do nothing
-        }
-    }
-
-    // Calculate the mean and variance of the results
-    double mean = std::accumulate(results.begin(), results.end(), 0.0, [=](double a, double b) -> double {return a + b / results.size();});
-    double variance = std::accumulate(results.begin(), results.end(), 0.0, [=](double a, double b) -> double {return a + std::pow(b - mean, 2) / results.size();});
-    NRV::NormalRandomVariable output(mean, variance);
-
-    return output;
+    return NRV::MonteCarlo().estimate(func, inputs, number_of_samples);
 }
 
 TEST(Instantiation, ValidVariance)
@@ -144,7 +111,7 @@ TEST(Negation, RandomVariable)
 }
 
 template<class T>
-T addition(std::vector<T> inputs)
+T addition(NRV::BasicSampleView<T> inputs)
 {
     return inputs[0] + inputs[1];
 }
@@ -162,7 +129,7 @@ TEST(Sampler, Sampler)
 }
 
 template<class T>
-T inverse(std::vector<T> inputs)
+T inverse(NRV::BasicSampleView<T> inputs)
 {
     return 1 / inputs[0];
 }
@@ -186,7 +153,7 @@ TEST(Inverse, CloseToZero)
 }
 
 template<class T>
-T divideNumByRv(std::vector<T> inputs)
+T divideNumByRv(NRV::BasicSampleView<T> inputs)
 {
     return 5 / inputs[0];
 }
@@ -203,7 +170,7 @@ TEST(Division, DivideNumByRV)
 }
 
 template<class T>
-T divideRvByNum(std::vector<T> inputs)
+T divideRvByNum(NRV::BasicSampleView<T> inputs)
 {
     return inputs[0] / 5;
 }
@@ -220,7 +187,7 @@ TEST(Division, DivideRVbyNum)
 }
 
 template<class T>
-T divideRvByRv(std::vector<T> inputs)
+T divideRvByRv(NRV::BasicSampleView<T> inputs)
 {
     return inputs[0] /inputs[1];
 }
@@ -254,7 +221,7 @@ TEST(Division, DivideRVbyRV)
 
 
 template<class T>
-T multiplyRvByNum(std::vector<T> inputs)
+T multiplyRvByNum(NRV::BasicSampleView<T> inputs)
 {
     return inputs[0] * 0.2;
 }
@@ -271,7 +238,7 @@ TEST(Multiplication, MultiplyRVbyNum)
 }
 
 template<class T>
-T multiplyNumByRv(std::vector<T> inputs)
+T multiplyNumByRv(NRV::BasicSampleView<T> inputs)
 {
     return 0.2 * inputs[0];
 }
@@ -288,7 +255,7 @@ TEST(Multiplication, MultiplyNumbyRV)
 }
 
 template<class T>
-T multiplyRvByRv(std::vector<T> inputs)
+T multiplyRvByRv(NRV::BasicSampleView<T> inputs)
 {
     return inputs[0] * inputs[1];
 }
@@ -302,13 +269,14 @@ TEST(Multiplication, MultiplyRVbyRV)
     auto sample_output = sampler(multiplyRvByRv<double>, inputs, 1000000);
     
     // Note: needed to relax the threshold for saying that they are near because the
-    // multiplication magnifies sampling error
+    // multiplication magnifies sampling error. The standard error of the sampled variance
+    // is around 220 * sqrt(2 / 1000000) = 0.3
     EXPECT_NEAR(calc_output.mean(), sample_output.mean(), 0.1); 
-    EXPECT_NEAR(calc_output.variance(), sample_output.variance(), 0.1); 
+    EXPECT_NEAR(calc_output.variance(), sample_output.variance(), 1.0); 
 }
 
 template<class T>
-T rectify(std::vector<T> inputs)
+T rectify(NRV::BasicSampleView<T> inputs)
 {
     // Use a lower bound of 0 and an upper bound of 10
     if(inputs[0] < 0)
@@ -352,7 +320,7 @@ TEST(Rectification, RectificationWithUpperAndLower)
 }
 
 template<class T>
-T rectifyLower(std::vector<T> inputs)
+T rectifyLower(NRV::BasicSampleView<T> inputs)
 {
     // Use a lower bound of 0
     if(inputs[0] < 0)
@@ -384,7 +352,7 @@ TEST(Rectification, RectificationWithLower)
 }
 
 template<class T>
-T rectifyUpper(std::vector<T> inputs)
+T rectifyUpper(NRV::BasicSampleView<T> inputs)
 {
     // Use a lower bound of 0
     if(inputs[0] > 10)
@@ -416,16 +384,16 @@ TEST(Rectification, RectificationWithUpper)
 }
 
 template<class T>
-T truncate(std::vector<T> inputs)
+T truncate(NRV::BasicSampleView<T> inputs)
 {
     // Use a lower bound of 0 and an upper bound of 10
     if(inputs[0] < 0)
     {
-        throw "Outside of bounds";
+        return std::numeric_limits<T>::quiet_NaN();
     }
     if(inputs[0] > 10)
     {
-        throw "Outside of bounds";
+        return std::numeric_limits<T>::quiet_NaN();
     }
 
     return inputs[0];
@@ -477,12 +445,12 @@ TEST(Truncation, TruncationWithInvalidBounds)
 }
 
 template<class T>
-T truncateLower(std::vector<T> inputs)
+T truncateLower(NRV::BasicSampleView<T> inputs)
 {
     // Use a lower bound of 0 and an upper bound of 10
     if(inputs[0] < 0)
     {
-        throw "Outside of bounds";
+        return std::numeric_limits<T>::quiet_NaN();
     }
 
     return inputs[0];
@@ -518,12 +486,12 @@ TEST(Truncation, TruncationWithLower)
 
 
 template<class T>
-T truncateUpper(std::vector<T> inputs)
+T truncateUpper(NRV::BasicSampleView<T> inputs)
 {
     // Use a lower bound of 0 and an upper bound of 10
     if(inputs[0] > 10)
     {
-        throw "Outside of bounds";
+        return std::numeric_limits<T>::quiet_NaN();
     }
 
     return inputs[0];
@@ -559,15 +527,15 @@ TEST(Truncation, TruncationWithUpper)
 
 
 template<class T>
-T truncateSoftBounds(std::vector<T> inputs)
+T truncateSoftBounds(NRV::BasicSampleView<T> inputs)
 {
     if(inputs[0] < inputs[1])
     {
-        throw "Outside of bounds";
+        return std::numeric_limits<T>::quiet_NaN();
     }
     if(inputs[0] > inputs[2])
     {
-        throw "Outside of bounds";
+        return std::numeric_limits<T>::quiet_NaN();
     }
 
     return inputs[0];
@@ -619,11 +587,11 @@ TEST(Truncation, TruncationWithUpperAndLowerSoftBounds)
 }
 
 template<class T>
-T truncateSoftBoundsLower(std::vector<T> inputs)
+T truncateSoftBoundsLower(NRV::BasicSampleView<T> inputs)
 {
     if(inputs[0] < inputs[1])
     {
-        throw "Outside of bounds";
+        return std::numeric_limits<T>::quiet_NaN();
     }
 
     return inputs[0];
@@ -661,11 +629,11 @@ TEST(Truncation, TruncationWithLowerSoftBounds)
 
 
 template<class T>
-T truncateSoftBoundsUpper(std::vector<T> inputs)
+T truncateSoftBoundsUpper(NRV::BasicSampleView<T> inputs)
 {
     if(inputs[0] > inputs[1])
     {
-        throw "Outside of bounds";
+        return std::numeric_limits<T>::quiet_NaN();
     }
 
     return inputs[0];
@@ -703,7 +671,95 @@ TEST(Truncation, TruncationWithUpperSoftBounds)
 }
 
 template<class T>
-T maxOfVec(std::vector<T> inputs)
+T withinSoftBounds(NRV::BasicSampleView<T> inputs)
+{
+    return inputs[1] < inputs[0] && inputs[0] < inputs[2] ? 1 : 0;
+}
+
+TEST(Truncation, TruncationWithMass)
+{
+    NRV::NormalRandomVariable rv(10, 4);
+
+    // The mass is the probability under the normal distribution, and the value is the same as the truncation
+    auto truncated = rv.truncateWithMass(9, 13);
+    EXPECT_NEAR(truncated.mass, (std::erf(1.5 / std::sqrt(2)) - std::erf(-0.5 / std::sqrt(2))) / 2, 1e-12);
+    EXPECT_DOUBLE_EQ(truncated.value.mean(), rv.truncate(9, 13).mean());
+    EXPECT_DOUBLE_EQ(truncated.value.variance(), rv.truncate(9, 13).variance());
+
+    auto lower = rv.truncateLowerWithMass(11);
+    EXPECT_NEAR(lower.mass, std::erfc(0.5 / std::sqrt(2)) / 2, 1e-12);
+    EXPECT_DOUBLE_EQ(lower.value.mean(), rv.truncateLower(11).mean());
+
+    auto upper = rv.truncateUpperWithMass(11);
+    EXPECT_NEAR(upper.mass, 1 - lower.mass, 1e-12);
+    EXPECT_DOUBLE_EQ(upper.value.variance(), rv.truncateUpper(11).variance());
+
+    EXPECT_THROW(rv.truncateWithMass(2, 1), std::range_error);
+
+    // Bounds that are random variables, truncating together and one bound after the other
+    std::vector<NRV::NormalRandomVariable> inputs = {NRV::NormalRandomVariable(5, 10), NRV::NormalRandomVariable(0, 1),
+            NRV::NormalRandomVariable(10, 1)};
+    for(const NRV::NormalRandomVariable& bound : {NRV::NormalRandomVariable(10, 1), NRV::NormalRandomVariable(1, 1.2)})
+    {
+        inputs[2] = bound;
+        auto by_bounds = inputs[0].truncateWithMass(inputs[1], inputs[2]);
+        EXPECT_DOUBLE_EQ(by_bounds.value.mean(), inputs[0].truncate(inputs[1], inputs[2]).mean());
+        EXPECT_NEAR(by_bounds.mass, sampler(withinSoftBounds<double>, inputs, 1000000).mean(), 0.01);
+    }
+
+    EXPECT_NEAR(inputs[0].truncateLowerWithMass(inputs[1]).mass, std::erfc(-5 / std::sqrt(22.0)) / 2, 1e-12);
+    EXPECT_NEAR(inputs[0].truncateUpperWithMass(inputs[1]).mass, std::erfc(5 / std::sqrt(22.0)) / 2, 1e-12);
+}
+
+TEST(Probability, CdfPdfQuantile)
+{
+    NRV::NormalRandomVariable rv(10, 4);
+
+    EXPECT_DOUBLE_EQ(rv.cdf(10), 0.5);
+    EXPECT_NEAR(rv.cdf(12), 0.841344746068542948585, 1e-15);
+    EXPECT_NEAR(rv.cdf(8), 0.158655253931457051415, 1e-15);
+    EXPECT_NEAR(rv.pdf(10), 0.199471140200716338970, 1e-15);
+    EXPECT_NEAR(rv.pdf(14), 0.199471140200716338970 * std::exp(-2.0), 1e-15);
+
+    // The lower tail keeps its relative accuracy
+    EXPECT_NEAR(rv.cdf(-10) / 7.61985302416052606597e-24, 1, 1e-12);
+
+    EXPECT_NEAR(rv.quantile(0.975), 10 + 2 * 1.95996398454005423552, 1e-13);
+    EXPECT_NEAR(rv.quantile(0.5), 10, 1e-14);
+    for(double probability : {1e-300, 1e-20, 1e-5, 0.02, 0.03, 0.3, 0.7, 0.99, 1 - 1e-12})
+    {
+        double x = rv.quantile(probability);
+        double expected = probability < 0.5 ? probability : 1 - probability;
+        double actual = probability < 0.5 ? rv.cdf(x) : 1 - rv.cdf(x);
+        EXPECT_NEAR(actual / expected, 1, probability < 0.5 ? 1e-13 : 1e-3) << probability;
+    }
+
+    EXPECT_NEAR(NRV::BasicNormalRandomVariable<float>(1, 4).quantile(0.9f), 1 + 2 * 1.28155156554f, 1e-5);
+    EXPECT_NEAR(static_cast<double>(NRV::BasicNormalRandomVariable<long double>(0, 1).quantile(0.1L)), -1.28155156554, 1e-10);
+
+    EXPECT_THROW(rv.quantile(0), std::range_error);
+    EXPECT_THROW(rv.quantile(1), std::range_error);
+    EXPECT_THROW(rv.quantile(std::numeric_limits<double>::quiet_NaN()), std::range_error);
+}
+
+double firstLessThanSecond(NRV::SampleView inputs)
+{
+    return inputs[0] < inputs[1] ? 1 : 0;
+}
+
+TEST(Probability, LessThan)
+{
+    NRV::NormalRandomVariable a(1, 2), b(2, 2);
+
+    EXPECT_NEAR(a.probabilityLessThan(b), 0.691462461274013103637, 1e-15);
+    EXPECT_NEAR(a.probabilityLessThan(b) + b.probabilityLessThan(a), 1, 1e-15);
+    EXPECT_DOUBLE_EQ(a.probabilityLessThan(a), 0.5);
+    EXPECT_NEAR(a.probabilityLessThan(b), (a - b).cdf(0), 1e-15);
+    EXPECT_NEAR(a.probabilityLessThan(b), sampler(firstLessThanSecond, {a, b}, 1000000).mean(), 0.002);
+}
+
+template<class T>
+T maxOfVec(NRV::BasicSampleView<T> inputs)
 {
     T max_value = inputs[0];
     for(auto input = inputs.begin() + 1; input != inputs.end(); ++input)
@@ -748,7 +804,7 @@ TEST(Max, MaxOf3)
 }
 
 template<class T>
-T minOfVec(std::vector<T> inputs)
+T minOfVec(NRV::BasicSampleView<T> inputs)
 {
     T min_value = inputs[0];
     for(auto input = inputs.begin() + 1; input != inputs.end(); ++input)
@@ -799,3 +855,88 @@ TEST(Min, MinOf3)
     EXPECT_NEAR(calc_output.mean(), sample_output.mean(), 0.02); 
     EXPECT_NEAR(calc_output.variance(), sample_output.variance(), 0.02); 
 }
+
+TEST(TryOperations, Success)
+{
+    NRV::NormalRandomVariable rv(100, 1);
+    NRV::NormalRandomVariable bound(10, 2);
+
+    auto inverse = rv.tryInverse();
+    ASSERT_TRUE(inverse.ok());
+    EXPECT_DOUBLE_EQ(inverse.value.mean(), rv.inverse().mean());
+    EXPECT_DOUBLE_EQ(inverse.value.variance(), rv.inverse().variance());
+
+    auto division = NRV::tryDivide(bound, rv);
+    ASSERT_TRUE(division.ok());
+    EXPECT_DOUBLE_EQ(division.value.mean(), (bound / rv).mean());
+    EXPECT_DOUBLE_EQ(division.value.variance(), (bound / rv).variance());
+
+    auto truncated = rv.tryTruncate(99, 102);
+    ASSERT_TRUE(truncated.ok());
+    EXPECT_DOUBLE_EQ(truncated.value.mean(), rv.truncate(99, 102).mean());
+    EXPECT_DOUBLE_EQ(truncated.value.variance(), rv.truncate(99, 102).variance());
+
+    EXPECT_TRUE(NRV::NormalRandomVariable::tryCreate(1, 2).ok());
+    EXPECT_TRUE(rv.tryRectify(99, 102).ok());
+    EXPECT_TRUE(rv.tryTruncateLower(99).ok());
+    EXPECT_TRUE(rv.tryTruncateUpper(101).ok());
+    EXPECT_TRUE(NRV::tryDivide(5, rv).ok());
+    EXPECT_TRUE(NRV::tryDivide(rv, 5).ok());
+}
+
+TEST(TryOperations, Failure)
+{
+    NRV::NormalRandomVariable rv(1, 1);
+
+    EXPECT_EQ(NRV::NormalRandomVariable::tryCreate(1, 0).status, NRV::Status::InvalidVariance);
+    EXPECT_EQ(rv.tryInverse().status, NRV::Status::InvalidApproximation);
+    EXPECT_EQ(NRV::tryDivide(5, rv).status, NRV::Status::InvalidApproximation);
+    EXPECT_EQ(NRV::tryDivide(NRV::NormalRandomVariable(10, 1), rv).status, NRV::Status::InvalidApproximation);
+    EXPECT_EQ(rv.tryRectify(2, 1).status, NRV::Status::InvalidBounds);
+    EXPECT_EQ(rv.tryTruncate(2, 1).status, NRV::Status::InvalidBounds);
+
+    // Far enough into the tail that 1 - erf is 0, where truncateLower returns a variance that is not a number
+    auto truncated = NRV::NormalRandomVariable().tryTruncateLower(40);
+    EXPECT_EQ(truncated.status, NRV::Status::InvalidVariance);
+    EXPECT_EQ(truncated.value.mean(), 0);
+    EXPECT_EQ(truncated.value.variance(), 1);
+    EXPECT_TRUE(std::isnan(NRV::NormalRandomVariable().truncateLower(40).variance()));
+}
+
+TEST(Max, MaxOfMany)
+{
+    // Arrival times that overlap. The error of the approximation grows with the number of overlapping random
+    // variables, so the tolerance is larger than for MaxOf3
+    std::vector<NRV::NormalRandomVariable> inputs;
+    for(int i = 0; i < 8; ++i)
+    {
+        inputs.push_back(NRV::NormalRandomVariable(10 - 0.5 * i, 1 + 0.25 * i));
+    }
+    auto calc_output = NRV::max(inputs);
+    auto sample_output = sampler(maxOfVec<double>, inputs, 1000000);
+
+    EXPECT_NEAR(calc_output.mean(), sample_output.mean(), 0.05);
+    EXPECT_NEAR(calc_output.variance(), sample_output.variance(), 0.05);
+
+    // The result does not depend on the order of the inputs
+    std::reverse(inputs.begin(), inputs.end());
+    EXPECT_DOUBLE_EQ(NRV::max(inputs).mean(), calc_output.mean());
+    EXPECT_DOUBLE_EQ(NRV::max(inputs).variance(), calc_output.variance());
+}
+
+TEST(Min, MinOfMany)
+{
+    std::vector<NRV::NormalRandomVariable> inputs;
+    for(int i = 0; i < 8; ++i)
+    {
+        inputs.push_back(NRV::NormalRandomVariable(10 + 0.5 * i, 1 + 0.25 * i));
+    }
+    auto calc_output = NRV::min(inputs);
+    auto sample_output = sampler(minOfVec<double>, inputs, 1000000);
+
+    EXPECT_NEAR(calc_output.mean(), sample_output.mean(), 0.05);
+    EXPECT_NEAR(calc_output.variance(), sample_output.variance(), 0.05);
+
+    EXPECT_DOUBLE_EQ(NRV::min(inputs.data(), 1).mean(), inputs[0].mean());
+    EXPECT_ANY_THROW(NRV::min(inputs.data(), 0));
+}
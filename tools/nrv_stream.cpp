@@ -0,0 +1,698 @@
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NRV_STREAM_MMAP
+#endif
+
+#include "NormalRandomVariable/NormalRandomVariableArray.h"
+
+/**
+ * Command-line tool that applies a pipeline of operations to every random variable in a file of (mean, variance)
+ * rows, and writes the results to another file. The rows are processed in chunks of a fixed number of rows using the
+ * array operations, so files larger than the available memory can be processed
+ * - CSV files are streamed through a fixed-size buffer, one row of "mean,variance" per line. Blank lines and lines
+ *   starting with # are skipped, and a header on the first line is copied to the output
+ * - Binary files are pairs of native doubles (mean then variance), and are memory-mapped where supported. Pages that
+ *   have been processed are released, so that only the current chunk is resident
+ */
+
+namespace {
+
+typedef NRV::NormalRandomVariableArray Array;
+
+const char* const usage =
+    "Usage: nrv_stream [options] [stage...]\n"
+    "\n"
+    "Applies each stage in turn to every (mean, variance) row of the input\n"
+    "\n"
+    "Options:\n"
+    "  -i, --input FILE          Input file, or - for standard input (default: -)\n"
+    "  -o, --output FILE         Output file, or - for standard output (default: -)\n"
+    "  --input-format FORMAT     csv or binary (default: binary for .bin files, otherwise csv)\n"
+    "  --output-format FORMAT    csv or binary (default: binary for .bin files, otherwise csv)\n"
+    "  -c, --chunk ROWS          Number of rows processed at a time (default: 65536)\n"
+    "  -h, --help                Show this message\n"
+    "\n"
+    "Stages are written as name:arg1,arg2,... where a random variable argument is a\n"
+    "mean and variance (e.g., max:10,4). X is the random variable of the row\n"
+    "  add:c | add:m,v           X + c or X + N(m, v) (also subtract, multiply and divide)\n"
+    "  max:m,v | min:m,v         Maximum or minimum of X and N(m, v)\n"
+    "  truncate:l,u              X truncated to [l, u] (or truncate:lm,lv,um,uv for random bounds)\n"
+    "  truncateLower:l | :m,v    X truncated below (also truncateUpper)\n"
+    "  rectify:l,u               X rectified to [l, u] (also rectifyLower:l and rectifyUpper:u)\n"
+    "  inverse                   1 / X\n";
+
+enum class Format {
+    Csv,
+    Binary
+};
+
+/**
+ * Returns an array of size copies of the random variable N(mean, variance)
+ */
+Array constant(std::size_t size, double mean, double variance)
+{
+    return Array(std::vector<double>(size, mean), std::vector<double>(size, variance));
+}
+
+/**
+ * Operation applied to each chunk, with the arguments given on the command line. Operations that can fail (inverse
+ * and division by a random variable) report the status of each row, and the others leave status empty
+ */
+typedef std::function<Array(const Array&, const std::vector<double>&, std::vector<NRV::Status>&)> Operation;
+
+struct OperationInfo {
+    const char* name;
+    std::size_t arguments;
+    bool random_variables;
+    Operation operation;
+};
+
+const std::vector<OperationInfo>& operations()
+{
+    typedef const Array& A;
+    typedef const std::vector<double>& P;
+    typedef std::vector<NRV::Status>& S;
+    static const std::vector<OperationInfo> operations = {
+        {"add", 1, false, [](A x, P p, S) { return x + p[0]; }},
+        {"add", 2, true, [](A x, P p, S) { return x + constant(x.size(), p[0], p[1]); }},
+        {"subtract", 1, false, [](A x, P p, S) { return x - p[0]; }},
+        {"subtract", 2, true, [](A x, P p, S) { return x - constant(x.size(), p[0], p[1]); }},
+        {"multiply", 1, false, [](A x, P p, S) { return x * p[0]; }},
+        {"multiply", 2, true, [](A x, P p, S) { return x * constant(x.size(), p[0], p[1]); }},
+        {"divide", 1, false, [](A x, P p, S) { return x / p[0]; }},
+        {"divide", 2, true, [](A x, P p, S s) { return NRV::tryDivide(x, constant(x.size(), p[0], p[1]), s); }},
+        {"max", 2, true, [](A x, P p, S) { return x.max(constant(x.size(), p[0], p[1])); }},
+        {"min", 2, true, [](A x, P p, S) { return x.min(constant(x.size(), p[0], p[1])); }},
+        {"truncate", 2, false, [](A x, P p, S) { return x.truncate(p[0], p[1]); }},
+        {"truncate", 4, true, [](A x, P p, S) { return x.truncate(constant(x.size(), p[0], p[1]), constant(x.size(), p[2], p[3])); }},
+        {"truncateLower", 1, false, [](A x, P p, S) { return x.truncateLower(p[0]); }},
+        {"truncateLower", 2, true, [](A x, P p, S) { return x.truncateLower(constant(x.size(), p[0], p[1])); }},
+        {"truncateUpper", 1, false, [](A x, P p, S) { return x.truncateUpper(p[0]); }},
+        {"truncateUpper", 2, true, [](A x, P p, S) { return x.truncateUpper(constant(x.size(), p[0], p[1])); }},
+        {"rectify", 2, false, [](A x, P p, S) { return x.rectify(p[0], p[1]); }},
+        {"rectifyLower", 1, false, [](A x, P p, S) { return x.rectifyLower(p[0]); }},
+        {"rectifyUpper", 1, false, [](A x, P p, S) { return x.rectifyUpper(p[0]); }},
+        {"inverse", 0, false, [](A x, P, S s) { return x.tryInverse(s); }}
+    };
+    return operations;
+}
+
+struct Stage {
+    Operation operation;
+    std::vector<double> arguments;
+};
+
+/**
+ * Parses a stage of the form name:arg1,arg2,...
+ */
+Stage parseStage(const std::string& text)
+{
+    std::size_t colon = text.find(':');
+    std::string name = text.substr(0, colon);
+    std::vector<double> arguments;
+    if(colon != std::string::npos)
+    {
+        const char* position = text.c_str() + colon + 1;
+        while(true)
+        {
+            char* end;
+            errno = 0;
+            double value = std::strtod(position, &end);
+            if(end == position || errno == ERANGE || (*end != ',' && *end != '\0'))
+            {
+                throw std::invalid_argument("Invalid argument in stage '" + text + "'");
+            }
+            arguments.push_back(value);
+            if(*end == '\0')
+            {
+                break;
+            }
+            position = end + 1;
+        }
+    }
+
+    bool known = false;
+    for(const auto& info : operations())
+    {
+        known = known || name == info.name;
+        if(name == info.name && arguments.size() == info.arguments)
+        {
+            // Random variable arguments are pairs of mean and variance, which are checked by constructing them
+            if(info.random_variables)
+            {
+                for(std::size_t i = 0; i < arguments.size(); i += 2)
+                {
+                    NRV::NormalRandomVariable(arguments[i], arguments[i + 1]);
+                }
+            }
+
+            // Apply the stage to a single random variable so that invalid bounds are reported before any output
+            std::vector<NRV::Status> status;
+            info.operation(Array(1), arguments, status);
+            return Stage{info.operation, arguments};
+        }
+    }
+
+    throw std::invalid_argument(known ? "Wrong number of arguments in stage '" + text + "'"
+            : "Unknown operation '" + name + "'");
+}
+
+/**
+ * Throws an exception with the description of the last system error
+ */
+[[noreturn]] void throwSystemError(const std::string& message)
+{
+    throw std::runtime_error(message + ": " + std::strerror(errno));
+}
+
+/**
+ * Source of rows, which reads up to size rows into the array (resizing it) and returns the number of rows read
+ */
+class Reader {
+public:
+    virtual ~Reader() {}
+    virtual std::size_t read(Array& chunk, std::size_t size) = 0;
+
+    /**
+     * Get the header line of a CSV file, or an empty string if there is none
+     */
+    virtual std::string header() const
+    {
+        return std::string();
+    }
+};
+
+/**
+ * Checks that a row read from the input is a valid random variable
+ */
+void checkRow(double mean, double variance, std::size_t row)
+{
+    if(!std::isfinite(mean) || !(variance > 0) || !std::isfinite(variance))
+    {
+        throw std::runtime_error("Row " + std::to_string(row) + " is not a valid random variable");
+    }
+}
+
+class CsvReader : public Reader {
+public:
+    explicit CsvReader(std::FILE* file)
+    : file_(file), buffer_(buffer_size + 1), begin_(0), end_(0), line_(0), end_of_file_(false)
+    {
+        // A first line that does not start with a number is a header
+        const char* line;
+        while(nextLine(line) && skip(line))
+        {
+
+        }
+        if(line != nullptr)
+        {
+            char* end;
+            std::strtod(line, &end);
+            if(end == line)
+            {
+                header_ = line;
+                line = nullptr;
+            }
+        }
+        pending_ = line;
+    }
+
+    std::size_t read(Array& chunk, std::size_t size) override
+    {
+        chunk.resize(size);
+        std::size_t rows = 0;
+        const char* line = pending_;
+        pending_ = nullptr;
+        while(rows < size && (line != nullptr || nextLine(line)))
+        {
+            if(!skip(line))
+            {
+                parse(line, chunk.means()[rows], chunk.variances()[rows]);
+                ++rows;
+            }
+            line = nullptr;
+        }
+
+        chunk.resize(rows);
+        return rows;
+    }
+
+    std::string header() const override
+    {
+        return header_;
+    }
+
+private:
+    static constexpr std::size_t buffer_size = 1 << 20;
+
+    static bool skip(const char* line)
+    {
+        line += std::strspn(line, " \t\r");
+        return *line == '\0' || *line == '#';
+    }
+
+    /**
+     * Gets the next line as a null-terminated string in the buffer, returning false at the end of the file
+     */
+    bool nextLine(const char*& line)
+    {
+        line = nullptr;
+        while(true)
+        {
+            char* newline = static_cast<char*>(std::memchr(buffer_.data() + begin_, '\n', end_ - begin_));
+            if(newline != nullptr || (end_of_file_ && begin_ < end_))
+            {
+                char* last = newline != nullptr ? newline : buffer_.data() + end_;
+                *last = '\0';
+                line = buffer_.data() + begin_;
+                begin_ = static_cast<std::size_t>(last - buffer_.data()) + 1;
+                begin_ = std::min(begin_, end_);
+                ++line_;
+                return true;
+            }
+            if(end_of_file_)
+            {
+                return false;
+            }
+
+            // Move the partial line to the start of the buffer (growing it if the line fills it) and read more
+            std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+            if(end_ + 1 >= buffer_.size())
+            {
+                buffer_.resize(buffer_.size() * 2);
+            }
+            std::size_t read = std::fread(buffer_.data() + end_, 1, buffer_.size() - 1 - end_, file_);
+            if(read == 0)
+            {
+                if(std::ferror(file_))
+                {
+                    throwSystemError("Can not read input");
+                }
+                end_of_file_ = true;
+            }
+            end_ += read;
+        }
+    }
+
+    void parse(const char* line, double& mean, double& variance)
+    {
+        char* end;
+        mean = std::strtod(line, &end);
+        const char* separator = end + std::strspn(end, " \t");
+        if(end == line || *separator != ',')
+        {
+            throw std::runtime_error("Line " + std::to_string(line_) + " is not a pair of numbers");
+        }
+
+        variance = std::strtod(separator + 1, &end);
+        if(end == separator + 1 || end[std::strspn(end, " \t\r")] != '\0')
+        {
+            throw std::runtime_error("Line " + std::to_string(line_) + " is not a pair of numbers");
+        }
+
+        checkRow(mean, variance, line_);
+    }
+
+    std::FILE* file_;
+    std::vector<char> buffer_;
+    std::size_t begin_;
+    std::size_t end_;
+    std::size_t line_;
+    bool end_of_file_;
+    const char* pending_;
+    std::string header_;
+};
+
+constexpr std::size_t CsvReader::buffer_size;
+
+class BinaryReader : public Reader {
+public:
+    BinaryReader(std::FILE* file, const std::string& path)
+    : file_(file), data_(nullptr), size_(0), position_(0), row_(0)
+    {
+#if defined(NRV_STREAM_MMAP)
+        // Regular files are mapped, and anything else (e.g., a pipe) is read in chunks
+        struct stat status;
+        if(path != "-" && fstat(fileno(file), &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0)
+        {
+            size_ = static_cast<std::size_t>(status.st_size);
+            void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+            if(data == MAP_FAILED)
+            {
+                throwSystemError("Can not map " + path);
+            }
+            data_ = static_cast<const double*>(data);
+            madvise(data, size_, MADV_SEQUENTIAL);
+            if(size_ % (2 * sizeof(double)) != 0)
+            {
+                throw std::runtime_error("Size of " + path + " is not a whole number of rows");
+            }
+        }
+#else
+        (void)path;
+#endif
+    }
+
+    ~BinaryReader() override
+    {
+#if defined(NRV_STREAM_MMAP)
+        if(data_ != nullptr)
+        {
+            munmap(const_cast<double*>(data_), size_);
+        }
+#endif
+    }
+
+    std::size_t read(Array& chunk, std::size_t size) override
+    {
+        const double* rows;
+        std::size_t count;
+        if(data_ != nullptr)
+        {
+            rows = data_ + 2 * position_;
+            count = std::min(size, size_ / (2 * sizeof(double)) - position_);
+        }
+        else
+        {
+            buffer_.resize(2 * size);
+            count = std::fread(buffer_.data(), 2 * sizeof(double), size, file_);
+            if(count < size && std::ferror(file_))
+            {
+                throwSystemError("Can not read input");
+            }
+            rows = buffer_.data();
+        }
+
+        chunk.resize(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            chunk.means()[i] = rows[2 * i];
+            chunk.variances()[i] = rows[2 * i + 1];
+            checkRow(rows[2 * i], rows[2 * i + 1], row_ + i + 1);
+        }
+
+#if defined(NRV_STREAM_MMAP)
+        // Release the whole pages that have been processed
+        if(data_ != nullptr && count > 0)
+        {
+            std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            std::size_t first = 2 * sizeof(double) * position_ / page * page;
+            std::size_t last = 2 * sizeof(double) * (position_ + count) / page * page;
+            if(last > first)
+            {
+                madvise(const_cast<char*>(reinterpret_cast<const char*>(data_)) + first, last - first, MADV_DONTNEED);
+            }
+        }
+#endif
+
+        position_ += count;
+        row_ += count;
+        return count;
+    }
+
+private:
+    std::FILE* file_;
+    const double* data_;
+    std::size_t size_;
+    std::size_t position_;
+    std::size_t row_;
+    std::vector<double> buffer_;
+};
+
+/**
+ * Destination of rows
+ */
+class Writer {
+public:
+    virtual ~Writer() {}
+    virtual void write(const Array& chunk) = 0;
+};
+
+class CsvWriter : public Writer {
+public:
+    CsvWriter(std::FILE* file, const std::string& header)
+    : file_(file)
+    {
+        if(!header.empty())
+        {
+            output(header + "\n");
+        }
+    }
+
+    void write(const Array& chunk) override
+    {
+        buffer_.clear();
+        char row[64];
+        for(std::size_t i = 0; i < chunk.size(); ++i)
+        {
+            int length = std::snprintf(row, sizeof(row), "%.17g,%.17g\n", chunk.means()[i], chunk.variances()[i]);
+            buffer_.append(row, static_cast<std::size_t>(length));
+        }
+        output(buffer_);
+    }
+
+private:
+    void output(const std::string& text)
+    {
+        if(std::fwrite(text.data(), 1, text.size(), file_) != text.size())
+        {
+            throwSystemError("Can not write output");
+        }
+    }
+
+    std::FILE* file_;
+    std::string buffer_;
+};
+
+class BinaryWriter : public Writer {
+public:
+    explicit BinaryWriter(std::FILE* file)
+    : file_(file)
+    {
+
+    }
+
+    void write(const Array& chunk) override
+    {
+        buffer_.resize(2 * chunk.size());
+        for(std::size_t i = 0; i < chunk.size(); ++i)
+        {
+            buffer_[2 * i] = chunk.means()[i];
+            buffer_[2 * i + 1] = chunk.variances()[i];
+        }
+        if(std::fwrite(buffer_.data(), 2 * sizeof(double), chunk.size(), file_) != chunk.size())
+        {
+            throwSystemError("Can not write output");
+        }
+    }
+
+private:
+    std::FILE* file_;
+    std::vector<double> buffer_;
+};
+
+/**
+ * Returns the format given on the command line, or guesses it from the extension of path
+ */
+Format formatOf(const std::string& format, const std::string& path)
+{
+    if(format == "csv")
+    {
+        return Format::Csv;
+    }
+    if(format == "binary")
+    {
+        return Format::Binary;
+    }
+    if(!format.empty())
+    {
+        throw std::invalid_argument("Unknown format '" + format + "'");
+    }
+
+    bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+    return binary ? Format::Binary : Format::Csv;
+}
+
+/**
+ * Closes a file that is not standard input or output
+ */
+struct FileCloser {
+    void operator()(std::FILE* file) const
+    {
+        if(file != stdin && file != stdout)
+        {
+            std::fclose(file);
+        }
+    }
+};
+
+typedef std::unique_ptr<std::FILE, FileCloser> File;
+
+File open(const std::string& path, const char* mode, std::FILE* standard)
+{
+    if(path == "-")
+    {
+        return File(standard);
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), mode);
+    if(file == nullptr)
+    {
+        throwSystemError("Can not open " + path);
+    }
+    return File(file);
+}
+
+int run(int argc, char* argv[])
+{
+    std::string input_path = "-", output_path = "-", input_format, output_format;
+    std::size_t chunk_size = 65536;
+    std::vector<Stage> stages;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        auto value = [&]() -> std::string {
+            if(i + 1 >= argc)
+            {
+                throw std::invalid_argument("Missing value for " + argument);
+            }
+            return argv[++i];
+        };
+
+        if(argument == "-h" || argument == "--help")
+        {
+            std::fputs(usage, stdout);
+            return 0;
+        }
+        else if(argument == "-i" || argument == "--input")
+        {
+            input_path = value();
+        }
+        else if(argument == "-o" || argument == "--output")
+        {
+            output_path = value();
+        }
+        else if(argument == "--input-format")
+        {
+            input_format = value();
+        }
+        else if(argument == "--output-format")
+        {
+            output_format = value();
+        }
+        else if(argument == "-c" || argument == "--chunk")
+        {
+            std::string rows = value();
+            char* end;
+            unsigned long long parsed = std::strtoull(rows.c_str(), &end, 10);
+            if(rows.empty() || *end != '\0' || parsed == 0)
+            {
+                throw std::invalid_argument("Invalid chunk size '" + rows + "'");
+            }
+            chunk_size = static_cast<std::size_t>(parsed);
+        }
+        else
+        {
+            stages.push_back(parseStage(argument));
+        }
+    }
+
+    File input = open(input_path, "rb", stdin);
+    File output = open(output_path, "wb", stdout);
+
+    std::unique_ptr<Reader> reader;
+    if(formatOf(input_format, input_path) == Format::Binary)
+    {
+        reader.reset(new BinaryReader(input.get(), input_path));
+    }
+    else
+    {
+        reader.reset(new CsvReader(input.get()));
+    }
+
+    std::unique_ptr<Writer> writer;
+    if(formatOf(output_format, output_path) == Format::Binary)
+    {
+        writer.reset(new BinaryWriter(output.get()));
+    }
+    else
+    {
+        writer.reset(new CsvWriter(output.get(), reader->header()));
+    }
+
+    // The array operations do not throw for invalid rows, so the rows that fail in any stage or do not have a valid
+    // result are counted and reported at the end
+    Array chunk;
+    std::vector<NRV::Status> status;
+    std::vector<char> failed;
+    std::size_t rows = 0, invalid = 0;
+    while(reader->read(chunk, chunk_size) > 0)
+    {
+        failed.assign(chunk.size(), 0);
+        for(const Stage& stage : stages)
+        {
+            status.clear();
+            chunk = stage.operation(chunk, stage.arguments, status);
+            for(std::size_t i = 0; i < status.size(); ++i)
+            {
+                failed[i] |= status[i] != NRV::Status::Ok;
+            }
+        }
+
+        for(std::size_t i = 0; i < chunk.size(); ++i)
+        {
+            invalid += failed[i] || !(chunk.variances()[i] > 0) || !std::isfinite(chunk.means()[i]);
+        }
+        rows += chunk.size();
+        writer->write(chunk);
+    }
+
+    if(std::fflush(output.get()) != 0)
+    {
+        throwSystemError("Can not write output");
+    }
+
+    if(invalid > 0)
+    {
+        std::fprintf(stderr, "nrv_stream: %zu of %zu results are not valid\n", invalid, rows);
+        return 2;
+    }
+
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        return run(argc, argv);
+    }
+    catch(const std::exception& e)
+    {
+        std::fprintf(stderr, "nrv_stream: %s\n", e.what());
+        if(dynamic_cast<const std::invalid_argument*>(&e) != nullptr)
+        {
+            std::fputs(usage, stderr);
+        }
+        return 1;
+    }
+}
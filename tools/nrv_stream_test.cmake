@@ -0,0 +1,49 @@
+# Runs nrv_stream (given by -DNRV_STREAM=...) on small files in WORKING_DIRECTORY and checks the output and exit status
+
+function(run_stream expected_result)
+    execute_process(
+        COMMAND ${NRV_STREAM} ${ARGN}
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE error
+    )
+    if(NOT result EQUAL expected_result)
+        message(FATAL_ERROR "nrv_stream ${ARGN} exited with ${result} instead of ${expected_result}: ${error}")
+    endif()
+    set(output "${output}" PARENT_SCOPE)
+endfunction()
+
+function(check_file path expected)
+    file(READ ${path} contents)
+    if(NOT contents STREQUAL expected)
+        message(FATAL_ERROR "${path} is\n${contents}\ninstead of\n${expected}")
+    endif()
+endfunction()
+
+# The header is copied, and comments and blank lines are skipped
+file(WRITE input.csv "mean,variance\n# comment\n0,1\n\n  \n1.5,0.25\n")
+run_stream(0 -i input.csv -o output.csv add:1 multiply:2)
+check_file(output.csv "mean,variance\n2,4\n5,1\n")
+
+# Round trip through a binary file, in chunks smaller than the file
+run_stream(0 -i input.csv -o output.bin -c 1 add:1)
+file(SIZE output.bin size)
+if(NOT size EQUAL 32)
+    message(FATAL_ERROR "output.bin has ${size} bytes instead of 32")
+endif()
+run_stream(0 -i output.bin --output-format csv multiply:2)
+if(NOT output STREQUAL "2,4\n5,1\n")
+    message(FATAL_ERROR "Round trip through binary gave\n${output}")
+endif()
+
+# Invalid rows and arguments
+file(WRITE invalid.csv "0,1\n1,-1\n")
+run_stream(1 -i invalid.csv -o output.csv)
+file(WRITE invalid.csv "0,1\n1\n")
+run_stream(1 -i invalid.csv -o output.csv)
+run_stream(1 -i input.csv -o output.csv unknown:1)
+
+# Results outside the range of the approximations
+file(WRITE inverse.csv "2,2\n10,1\n")
+run_stream(2 -i inverse.csv -o output.csv inverse)
+run_stream(0 -i inverse.csv -o output.csv add:18 inverse)